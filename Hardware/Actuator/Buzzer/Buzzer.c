@@ -10,57 +10,188 @@
 
 /* 包含头文件 ----------------------------------------------------------------*/
 #include "stm32f10x.h"    // 设备头文件
-#include "Delay.h"        // 延时函数
 #include "Buzzer.h"       // 蜂鸣器控制接口
+#include "Clock.h"        // 定时器时钟
 #include <stddef.h>       // 定义NULL
 
-/* 全局变量 ------------------------------------------------------------------*/
-// 默认环境阈值
-static EnvThreshold_t env_threshold = {
-	.light_min = 200,    // 光照最小阈值
-	.light_max = 700,    // 光照最大阈值
-	.temp_min = 10,      // 温度最小阈值
-	.temp_max = 30,      // 温度最大阈值
-	.humi_min = 30,      // 湿度最小阈值
-	.humi_max = 70       // 湿度最大阈值
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define BUZZER_STEP_MS      10      // 节拍时长(ms)，即TIM1更新周期
+#define BUZZER_NO_LOOP      0xFF    // 模式播放一遍后停止
+
+/* 私有类型定义 --------------------------------------------------------------*/
+/**
+  * @brief  鸣叫模式定义
+  * @note   steps为交替的响/停节拍数（单位BUZZER_STEP_MS），以0结束；
+  *         播放到结尾后从loop_index处继续循环
+  */
+typedef struct {
+	const uint16_t *steps;
+	uint8_t loop_index;
+} BuzzerPatternDef_t;
+
+/* 私有常量 ------------------------------------------------------------------*/
+static const uint16_t pattern_fast[] = { 10, 10, 0 };                 // 100ms响/100ms停
+static const uint16_t pattern_slow[] = { 50, 50, 0 };                 // 500ms响/500ms停
+static const uint16_t pattern_sos[] = {
+	15, 15, 15, 15, 15, 45,                                           // ...
+	45, 15, 45, 15, 45, 45,                                           // ---
+	15, 15, 15, 15, 15, 150,                                          // ...
+	0
+};
+static const uint16_t pattern_escalating[] = {
+	50, 50, 50, 50,                                                   // 慢速两次
+	25, 25, 25, 25, 25, 25,                                           // 中速三次
+	10, 10, 0                                                         // 之后保持快速
 };
+static uint16_t pattern_beep[] = { 0, 0 };                            // 单次短鸣，时长运行时填写
 
+static const BuzzerPatternDef_t pattern_table[] = {
+	[BUZZER_PATTERN_NONE]       = { NULL, BUZZER_NO_LOOP },
+	[BUZZER_PATTERN_FAST]       = { pattern_fast, 0 },
+	[BUZZER_PATTERN_SLOW]       = { pattern_slow, 0 },
+	[BUZZER_PATTERN_SOS]        = { pattern_sos, 0 },
+	[BUZZER_PATTERN_ESCALATING] = { pattern_escalating, 10 },
+	[BUZZER_PATTERN_BEEP]       = { pattern_beep, BUZZER_NO_LOOP },
+};
+
+/* 全局变量 ------------------------------------------------------------------*/
 // 当前蜂鸣器模式
 static BuzzerMode_t buzzer_mode = BUZZER_MODE_CONTINUOUS;
 
-// 蜂鸣器状态（用于间歇模式）
-static uint8_t buzzer_state = 0;
-static uint32_t last_toggle_time = 0;
+// 当前报警级别，用于只在报警解除时关闭蜂鸣器而不打断短鸣
+static BuzzerAlert_t alert_level = BUZZER_ALERT_NONE;
+
+// 模式播放状态，由TIM1中断推进
+static volatile BuzzerPattern_t play_pattern = BUZZER_PATTERN_NONE;
+static volatile uint8_t play_index = 0;        // 当前节拍下标
+static volatile uint16_t play_remaining = 0;   // 当前节拍剩余时长
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  设置蜂鸣器输出电平
+  * @param  on: 1响 0停
+  * @retval 无
+  * @note   PB13为TIM1_CH1N，通过强制输出模式直接控制引脚，无需改为GPIO
+  */
+static void Buzzer_Output(uint8_t on)
+{
+	TIM_ForcedOC1Config(TIM1, on ? TIM_ForcedAction_Active : TIM_ForcedAction_InActive);
+}
+
+/**
+  * @brief  停止模式播放
+  * @param  无
+  * @retval 无
+  * @note   只在主循环中调用，先关更新中断再修改播放状态
+  */
+static void Buzzer_StopPattern(void)
+{
+	TIM_ITConfig(TIM1, TIM_IT_Update, DISABLE);
+	play_pattern = BUZZER_PATTERN_NONE;
+}
+
+/**
+  * @brief  开始播放指定模式
+  * @param  pattern: 鸣叫模式
+  * @retval 无
+  */
+static void Buzzer_StartPattern(BuzzerPattern_t pattern)
+{
+	Buzzer_StopPattern();
+	
+	play_pattern = pattern;
+	play_index = 0;
+	play_remaining = pattern_table[pattern].steps[0];
+	Buzzer_Output(1);
+	
+	/* 从完整的节拍开始计时 */
+	TIM_SetCounter(TIM1, 0);
+	TIM_ClearITPendingBit(TIM1, TIM_IT_Update);
+	TIM_ITConfig(TIM1, TIM_IT_Update, ENABLE);
+}
 
 /**
   * @brief  蜂鸣器初始化
   * @param  无
   * @retval 无
+  * @note   TIM1以10ms为节拍驱动模式播放，主循环无需参与
   */
 void Buzzer_Init(void)
 {
-	// 使能蜂鸣器GPIO时钟
-	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+	// 使能GPIO与TIM1时钟
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB | RCC_APB2Periph_TIM1, ENABLE);
 	
-	// 配置蜂鸣器GPIO为推挽输出
+	// PB13复用推挽输出，作为TIM1_CH1N
 	GPIO_InitTypeDef GPIO_InitStructure;
-	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
 	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_13;
 	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
 	GPIO_Init(GPIOB, &GPIO_InitStructure);
 	
+	// 时基：定时器时钟分频到10kHz（72MHz档为7200），计满100为10ms
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure;
+	TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+	TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+	TIM_TimeBaseInitStructure.TIM_Period = 100 - 1;
+	TIM_TimeBaseInitStructure.TIM_Prescaler = Clock_GetTimerClock(TIM1) / 10000 - 1;
+	TIM_TimeBaseInitStructure.TIM_RepetitionCounter = 0;
+	TIM_TimeBaseInit(TIM1, &TIM_TimeBaseInitStructure);
+	
+	// 只有计数溢出产生更新中断，切换时钟时重装预分频不会多走一拍
+	TIM_UpdateRequestConfig(TIM1, TIM_UpdateSource_Regular);
+	
+	// 只使能互补输出CH1N，低电平有效：强制有效时引脚为低，蜂鸣器响
+	TIM_OCInitTypeDef TIM_OCInitStructure;
+	TIM_OCStructInit(&TIM_OCInitStructure);
+	TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Inactive;
+	TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Disable;
+	TIM_OCInitStructure.TIM_OutputNState = TIM_OutputNState_Enable;
+	TIM_OCInitStructure.TIM_OCNPolarity = TIM_OCNPolarity_Low;
+	TIM_OCInitStructure.TIM_OCNIdleState = TIM_OCNIdleState_Set;
+	TIM_OC1Init(TIM1, &TIM_OCInitStructure);
+	
 	// 默认蜂鸣器关闭
-	GPIO_SetBits(GPIOB, GPIO_Pin_13);
+	Buzzer_Output(0);
+	
+	// 更新中断：优先级最低，不影响串口接收和时基
+	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+	
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel = TIM1_UP_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 3;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+	NVIC_Init(&NVIC_InitStructure);
+	
+	TIM_ClearFlag(TIM1, TIM_FLAG_Update);
+	TIM_Cmd(TIM1, ENABLE);
+	TIM_CtrlPWMOutputs(TIM1, ENABLE);   // 高级定时器需打开主输出
+}
+
+/**
+  * @brief  系统时钟变化后重新计算预分频
+  * @param  无
+  * @retval 无
+  * @note   保留计数值，正在播放的节拍不会被拉长或截断
+  */
+void Buzzer_ClockUpdate(void)
+{
+	uint16_t count = TIM_GetCounter(TIM1);
+	
+	TIM_PrescalerConfig(TIM1, Clock_GetTimerClock(TIM1) / 10000 - 1, TIM_PSCReloadMode_Immediate);
+	TIM_SetCounter(TIM1, count);
 }
 
 /**
   * @brief  蜂鸣器打开
   * @param  无
   * @retval 无
+  * @note   持续鸣叫，会停止正在播放的模式
   */
 void Buzzer_ON(void)
 {	
-	GPIO_ResetBits(GPIOB, GPIO_Pin_13);
+	Buzzer_StopPattern();
+	Buzzer_Output(1);
 }
 
 /**
@@ -70,112 +201,148 @@ void Buzzer_ON(void)
   */
 void Buzzer_OFF(void)
 {
-	GPIO_SetBits(GPIOB, GPIO_Pin_13);
+	Buzzer_Stop();
 }
 
 /**
   * @brief  蜂鸣器短鸣一段时间
-  * @param  duration_ms: 蜂鸣持续时间(ms)
+  * @param  duration_ms: 蜂鸣持续时间(ms)，按10ms向上取整
   * @retval 无
+  * @note   立即返回，由TIM1中断在到时后关闭
   */
 void Buzzer_Beep(uint16_t duration_ms)
 {
-	Buzzer_ON();
-	Delay_ms(duration_ms);
-	Buzzer_OFF();
+	if (duration_ms == 0) {
+		return;
+	}
+	
+	Buzzer_StopPattern();
+	pattern_beep[0] = (duration_ms + BUZZER_STEP_MS - 1) / BUZZER_STEP_MS;
+	Buzzer_StartPattern(BUZZER_PATTERN_BEEP);
 }
 
 /**
-  * @brief  设置环境参数阈值
-  * @param  threshold: 阈值结构体指针
+  * @brief  播放鸣叫模式
+  * @param  pattern: 鸣叫模式
   * @retval 无
+  * @note   立即返回；正在播放同一模式时不会从头开始，可在每次采样后重复调用
   */
-void Buzzer_SetThreshold(EnvThreshold_t *threshold)
+void Buzzer_PlayPattern(BuzzerPattern_t pattern)
 {
-	if (threshold != NULL) {
-		env_threshold = *threshold;
+	if (pattern == BUZZER_PATTERN_NONE || pattern >= BUZZER_PATTERN_COUNT) {
+		Buzzer_Stop();
+		return;
+	}
+	
+	if (pattern != play_pattern) {
+		Buzzer_StartPattern(pattern);
 	}
 }
 
 /**
-  * @brief  设置报警模式
-  * @param  mode: 报警模式
+  * @brief  停止鸣叫
+  * @param  无
   * @retval 无
   */
-void Buzzer_SetMode(BuzzerMode_t mode)
+void Buzzer_Stop(void)
 {
-	buzzer_mode = mode;
-	
-	// 切换模式时关闭蜂鸣器
-	if (mode == BUZZER_MODE_OFF) {
-		Buzzer_OFF();
-	}
+	Buzzer_StopPattern();
+	Buzzer_Output(0);
 }
 
 /**
-  * @brief  更新间歇式报警状态
+  * @brief  获取正在播放的鸣叫模式
+  * @param  无
+  * @retval 当前模式，未播放时为BUZZER_PATTERN_NONE
+  */
+BuzzerPattern_t Buzzer_GetPattern(void)
+{
+	return play_pattern;
+}
+
+/**
+  * @brief  TIM1更新中断处理函数
   * @param  无
   * @retval 无
-  * @note   此函数需要在主循环中定期调用
+  * @note   每10ms推进一次节拍，节拍结束时切换响/停
   */
-static void Buzzer_UpdateIntermittent(void)
+void TIM1_UP_IRQHandler(void)
 {
-	// 使用系统计数替代实际系统时钟
-	static uint32_t beep_interval = 500; // 500ms间隔
-	uint32_t current_time = 0;
-	
-	// 简化的时间计算，实际应使用系统滴答计时器
-	current_time++;
-	
-	if (current_time - last_toggle_time >= beep_interval) {
-		buzzer_state = !buzzer_state;
-		last_toggle_time = current_time;
-		
-		// 根据状态控制蜂鸣器
-		if (buzzer_state) {
-			Buzzer_ON();
-		} else {
-			Buzzer_OFF();
+	if (TIM_GetITStatus(TIM1, TIM_IT_Update) == RESET) {
+		return;
+	}
+	TIM_ClearITPendingBit(TIM1, TIM_IT_Update);
+	
+	if (play_pattern == BUZZER_PATTERN_NONE) {
+		return;
+	}
+	
+	if (play_remaining > 1) {
+		play_remaining--;
+		return;
+	}
+	
+	/* 进入下一节拍，偶数下标为响，奇数下标为停 */
+	const BuzzerPatternDef_t *def = &pattern_table[play_pattern];
+	uint8_t next = play_index + 1;
+	
+	if (def->steps[next] == 0) {
+		if (def->loop_index == BUZZER_NO_LOOP) {
+			play_pattern = BUZZER_PATTERN_NONE;
+			TIM_ITConfig(TIM1, TIM_IT_Update, DISABLE);
+			Buzzer_Output(0);
+			return;
 		}
+		next = def->loop_index;
 	}
+	
+	play_index = next;
+	play_remaining = def->steps[next];
+	Buzzer_Output((next & 1) == 0);
 }
 
 /**
-  * @brief  根据传感器数据控制蜂鸣器
-  * @param  Light: 光照强度
-  * @param  temp: 温度值
-  * @param  hum: 湿度值
+  * @brief  设置报警模式
+  * @param  mode: 报警模式
   * @retval 无
   */
-void Buzzer_Control(uint16_t Light, uint16_t temp, uint16_t hum)
+void Buzzer_SetMode(BuzzerMode_t mode)
 {
-	// 检查是否超出阈值范围
-	uint8_t alarm_condition = (Light < env_threshold.light_min || 
-							   Light > env_threshold.light_max || 
-							   temp < env_threshold.temp_min || 
-							   temp > env_threshold.temp_max || 
-							   hum < env_threshold.humi_min || 
-							   hum > env_threshold.humi_max);
-	
-	// 根据报警模式和条件控制蜂鸣器
-	if (alarm_condition) {
-		switch (buzzer_mode) {
-			case BUZZER_MODE_CONTINUOUS:
-				Buzzer_ON();
-				break;
-			
-			case BUZZER_MODE_INTERMITTENT:
-				Buzzer_UpdateIntermittent();
-				break;
-			
-			case BUZZER_MODE_OFF:
-			default:
-				Buzzer_OFF();
-				break;
+	buzzer_mode = mode;
+	
+	// 切换模式时关闭蜂鸣器，下次报警按新模式鸣叫
+	Buzzer_Stop();
+	alert_level = BUZZER_ALERT_NONE;
+}
+
+/**
+  * @brief  按报警级别控制蜂鸣器
+  * @param  level: 报警级别
+  * @retval 无
+  * @note   连续模式下严重报警常响、警告慢速鸣叫；间歇模式下严重报警快速鸣叫、
+  *          警告慢速鸣叫；级别不变时重复调用不会打断正在播放的模式
+  */
+void Buzzer_Alert(BuzzerAlert_t level)
+{
+	if (buzzer_mode == BUZZER_MODE_OFF) {
+		level = BUZZER_ALERT_NONE;
+	}
+	
+	if (level == BUZZER_ALERT_NONE) {
+		if (alert_level != BUZZER_ALERT_NONE) {
+			Buzzer_Stop();
+		}
+	} else if (level == BUZZER_ALERT_WARNING) {
+		Buzzer_PlayPattern(BUZZER_PATTERN_SLOW);
+	} else if (buzzer_mode == BUZZER_MODE_CONTINUOUS) {
+		if (alert_level != BUZZER_ALERT_CRITICAL) {
+			Buzzer_ON();
 		}
 	} else {
-		Buzzer_OFF();
+		Buzzer_PlayPattern(BUZZER_PATTERN_FAST);
 	}
+	
+	alert_level = level;
 }
 
 /* 文件结束 -----------------------------------------------------------------*/
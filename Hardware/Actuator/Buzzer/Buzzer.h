@@ -16,18 +16,6 @@
 #include <stddef.h>    // 定义NULL
 
 /* 类型定义 ------------------------------------------------------------------*/
-/**
-  * @brief  环境参数阈值结构体
-  */
-typedef struct {
-    uint16_t light_min;    // 光照最小阈值
-    uint16_t light_max;    // 光照最大阈值
-    uint16_t temp_min;     // 温度最小阈值
-    uint16_t temp_max;     // 温度最大阈值
-    uint16_t humi_min;     // 湿度最小阈值
-    uint16_t humi_max;     // 湿度最大阈值
-} EnvThreshold_t;
-
 /**
   * @brief  蜂鸣器报警模式枚举
   */
@@ -37,6 +25,28 @@ typedef enum {
     BUZZER_MODE_INTERMITTENT// 间歇性报警
 } BuzzerMode_t;
 
+/**
+  * @brief  蜂鸣器鸣叫模式枚举
+  */
+typedef enum {
+    BUZZER_PATTERN_NONE = 0,   // 不鸣叫
+    BUZZER_PATTERN_FAST,       // 快速鸣叫：100ms响/100ms停
+    BUZZER_PATTERN_SLOW,       // 慢速鸣叫：500ms响/500ms停
+    BUZZER_PATTERN_SOS,        // SOS摩尔斯码
+    BUZZER_PATTERN_ESCALATING, // 由慢到快，最后保持快速
+    BUZZER_PATTERN_BEEP,       // 单次短鸣（由Buzzer_Beep使用）
+    BUZZER_PATTERN_COUNT
+} BuzzerPattern_t;
+
+/**
+  * @brief  蜂鸣器报警级别枚举
+  */
+typedef enum {
+    BUZZER_ALERT_NONE = 0,     // 无报警
+    BUZZER_ALERT_WARNING,      // 警告
+    BUZZER_ALERT_CRITICAL      // 严重
+} BuzzerAlert_t;
+
 /* 函数声明 ------------------------------------------------------------------*/
 /**
   * @brief  蜂鸣器初始化
@@ -45,6 +55,14 @@ typedef enum {
   */
 void Buzzer_Init(void);
 
+/**
+  * @brief  系统时钟变化后重新计算预分频
+  * @param  无
+  * @retval 无
+  * @note   由Clock模块在每次切换系统时钟后调用
+  */
+void Buzzer_ClockUpdate(void);
+
 /**
   * @brief  蜂鸣器打开
   * @param  无
@@ -63,24 +81,39 @@ void Buzzer_OFF(void);
   * @brief  蜂鸣器短鸣一段时间
   * @param  duration_ms: 蜂鸣持续时间(ms)
   * @retval 无
+  * @note   非阻塞，立即返回
   */
 void Buzzer_Beep(uint16_t duration_ms);
 
 /**
-  * @brief  设置环境参数阈值
-  * @param  threshold: 阈值结构体指针
+  * @brief  播放鸣叫模式
+  * @param  pattern: 鸣叫模式
+  * @retval 无
+  * @note   非阻塞，由TIM1中断驱动；正在播放同一模式时不会从头开始
+  */
+void Buzzer_PlayPattern(BuzzerPattern_t pattern);
+
+/**
+  * @brief  停止鸣叫
+  * @param  无
   * @retval 无
   */
-void Buzzer_SetThreshold(EnvThreshold_t *threshold);
+void Buzzer_Stop(void);
+
+/**
+  * @brief  获取正在播放的鸣叫模式
+  * @param  无
+  * @retval 当前模式，未播放时为BUZZER_PATTERN_NONE
+  */
+BuzzerPattern_t Buzzer_GetPattern(void);
 
 /**
-  * @brief  根据传感器数据控制蜂鸣器
-  * @param  Light: 光照强度值
-  * @param  temp: 温度值
-  * @param  hum: 湿度值
+  * @brief  按报警级别控制蜂鸣器
+  * @param  level: 报警级别
   * @retval 无
+  * @note   鸣叫方式由当前报警模式决定，应在报警状态变化后调用
   */
-void Buzzer_Control(uint16_t Light, uint16_t temp, uint16_t hum);
+void Buzzer_Alert(BuzzerAlert_t level);
 
 /**
   * @brief  设置报警模式
@@ -12,23 +12,79 @@
 #include "stm32f10x.h"                  // 设备头文件
 #include "string.h"                     // 字符串处理
 #include "Delay.h"                      // 延时函数
+#include "Tick.h"                       // 毫秒时基
+#include "RingBuffer.h"                 // 接收环形缓冲区
 #include "ESP8266.h"                    // ESP8266接口
+#include "Settings.h"                   // 服务器地址
+#include "Config/config.h"              // 模块功耗配置
 #include <stdio.h>                      // 标准输入输出
+#include <stdlib.h>                     // 字符串转整数
 #include "stdint.h"                     // 标准整型
 #include <stdarg.h>                     // 可变参数
 
 /* 私有定义 ------------------------------------------------------------------*/
-#define USART1_RX_BUFFER_SIZE 256       // 接收缓冲区大小
+#define USART1_RX_BUFFER_SIZE 256       // 接收缓冲区大小，必须为2的幂
 #define ESP8266_TIMEOUT        1000     // 通用超时时间(ms)
 #define ESP8266_MAX_RETRIES    3        // 最大重试次数
+#define ESP8266_HTTP_TIMEOUT   3000     // HTTP响应无数据超时时间(ms)
+#define ESP8266_HTTP_LINE_SIZE 96       // 应答头单行缓冲区，须容纳状态行、Date和Content-Length
+#define ESP8266_ESCAPE_GUARD   1000     // 退出透传"+++"前后的静默时间(ms)
+#define ESP8266_TCP_TIMEOUT    5000     // 建立TCP连接超时时间(ms)
+#define ESP8266_JOIN_TIMEOUT   15000    // 加入WiFi热点超时时间(ms)
+#define ESP8266_WAKE_TIMEOUT   10000    // 上电后等待自动入网的超时时间(ms)
+#define ESP8266_WAKE_POLL      100      // 上电后查询入网状态的间隔(ms)
+#define ESP8266_WAKE_LEAD_INIT 3000     // 提前唤醒时间的初值(ms)
+#define ESP8266_HOUR_MS        3600000UL
+#define ESP8266_POWER_CYCLE_MS 10       // 断电重启时CH_PD保持低电平的时间(ms)
+#define ESP8266_RECOVER_ESCALATE 2      // 连续失败几次恢复后起始等级升一级
+
+// CH_PD（EN）引脚，高电平工作；板上未接时模块始终上电，断电不起作用
+#define ESP8266_EN_PORT        GPIOA
+#define ESP8266_EN_PIN         GPIO_Pin_4
+
+// 射频省电模式：2为Modem-sleep，保持与热点的关联，信标间隙关闭射频；重启后需重新设置
+#if MODEM_SLEEP_ENABLE
+#define ESP8266_SLEEP_CMD      "AT+SLEEP=2\r\n"
+#else
+#define ESP8266_SLEEP_CMD      "AT+SLEEP=0\r\n"
+#endif
 
 /* 私有变量 ------------------------------------------------------------------*/
-volatile uint8_t  USART1_RxBuffer[USART1_RX_BUFFER_SIZE]; // 接收缓冲区
-volatile uint16_t USART1_RxHead = 0;    // 缓冲区头指针
-volatile uint16_t USART1_RxTail = 0;    // 缓冲区尾指针
+static uint8_t USART1_RxStorage[USART1_RX_BUFFER_SIZE]; // 接收缓冲区存储区
+static RingBuffer_t USART1_RxBuffer;    // 接收环形缓冲区，中断写入、主循环读取
+static volatile uint32_t USART1_LastRxMs = 0;   // 最近一次收到字节的时刻
+
+static ESP8266_RecoverStats_t recover_stats[ESP8266_RECOVER_TIER_COUNT]; // 各级恢复统计
+static uint8_t recover_failures = 0;        // 收到HTTP应答以来连续失败的恢复次数
+
+static ESP8266_PowerState_t power_state = ESP8266_POWER_ON;
+static ESP8266_PowerStats_t power_stats;    // 供电统计
+static uint32_t power_since_ms = 0;         // 上电时长已累计到的时刻
+static uint32_t power_hour_ms = 0;          // 当前统计小时的起点
+static uint32_t wake_start_ms = 0;          // 本次拉高CH_PD的时刻
+static uint32_t wake_lead_ms = ESP8266_WAKE_LEAD_INIT;  // 上电到入网的平滑耗时
+static char tcp_start_cmd[64];              // 建立TCP连接命令，按配置的服务器地址生成
+static uint32_t http_date = 0;              // 最近一次应答Date头的Unix时间，0表示没有
 
 /* 私有函数声明 --------------------------------------------------------------*/
-static int ESP8266_WaitForResponse(void);
+static int ESP8266_WaitFor(const char *expect, uint16_t timeout_ms);
+static void USART1_FlushRx(void);
+
+/**
+  * @brief  生成建立TCP连接的命令
+  * @param  无
+  * @retval 命令字符串，初始化与快速重连共用
+  * @note   配置中的地址为"IP:端口"，每次按当前配置生成，修改后下次连接生效
+  */
+static const char *ESP8266_TcpStartCmd(void)
+{
+    const char *host = Settings_Get()->server_host;
+    const char *port = strchr(host, ':');
+
+    snprintf(tcp_start_cmd, sizeof(tcp_start_cmd), "AT+CIPSTART=\"TCP\",\"%.*s\",%s\r\n",
+             (int)(port - host), host, port + 1);
+    return tcp_start_cmd;
+}
 
 /* 串口通信模块 --------------------------------------------------------------*/
 
@@ -39,6 +95,9 @@ static int ESP8266_WaitForResponse(void);
   */
 void Serial_Init(void)
 {
+    /* 初始化接收缓冲区，此时接收中断尚未使能 */
+    RingBuffer_Init(&USART1_RxBuffer, USART1_RxStorage, USART1_RX_BUFFER_SIZE);
+    
     /* 开启外设时钟 */
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART1, ENABLE);  // USART1时钟
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);   // GPIOA时钟
@@ -58,14 +117,7 @@ void Serial_Init(void)
     GPIO_Init(GPIOA, &GPIO_InitStructure);
 	
     /* USART初始化 */
-    USART_InitTypeDef USART_InitStructure;
-    USART_InitStructure.USART_BaudRate = 115200;                // 波特率
-    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;  // 无硬件流控
-    USART_InitStructure.USART_Mode = USART_Mode_Tx | USART_Mode_Rx; // 收发模式
-    USART_InitStructure.USART_Parity = USART_Parity_No;         // 无校验
-    USART_InitStructure.USART_StopBits = USART_StopBits_1;      // 1位停止位
-    USART_InitStructure.USART_WordLength = USART_WordLength_8b; // 8位数据位
-    USART_Init(USART1, &USART_InitStructure);
+    Serial_ClockUpdate();
 	
     /* 中断配置 */
     USART_ITConfig(USART1, USART_IT_RXNE, ENABLE);  // 使能接收中断
@@ -83,6 +135,25 @@ void Serial_Init(void)
     USART_Cmd(USART1, ENABLE);
 }
 
+/**
+  * @brief  配置串口1参数
+  * @param  无
+  * @retval 无
+  * @note   波特率分频按当前PCLK2计算，初始化和每次切换系统时钟后调用；
+  *          USART_Init不改变UE和中断使能位
+  */
+void Serial_ClockUpdate(void)
+{
+    USART_InitTypeDef USART_InitStructure;
+    USART_InitStructure.USART_BaudRate = 115200;                // 波特率
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;  // 无硬件流控
+    USART_InitStructure.USART_Mode = USART_Mode_Tx | USART_Mode_Rx; // 收发模式
+    USART_InitStructure.USART_Parity = USART_Parity_No;         // 无校验
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;      // 1位停止位
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b; // 8位数据位
+    USART_Init(USART1, &USART_InitStructure);
+}
+
 /**
   * @brief  串口发送一个字节
   * @param  Byte: 要发送的字节
@@ -110,21 +181,14 @@ int fputc(int ch, FILE *f)
   * @brief  USART1中断处理函数
   * @param  无
   * @retval 无
-  * @note   接收数据并存储到环形缓冲区
+  * @note   接收数据并存储到环形缓冲区，缓冲区满时丢弃并计数
   */
 void USART1_IRQHandler(void)
 {
     if (USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)
     {
-        uint8_t data = USART_ReceiveData(USART1);
-        uint16_t nextHead = (USART1_RxHead + 1) % USART1_RX_BUFFER_SIZE;
-        
-        // 检查缓冲区是否已满
-        if (nextHead != USART1_RxTail)
-        {
-            USART1_RxBuffer[USART1_RxHead] = data;
-            USART1_RxHead = nextHead;
-        }
+        RingBuffer_Put(&USART1_RxBuffer, (uint8_t)USART_ReceiveData(USART1));
+        USART1_LastRxMs = Tick_GetMs();
     }
 }
 
@@ -135,76 +199,116 @@ void USART1_IRQHandler(void)
   */
 int USART1_ReadByte(uint8_t *data)
 {
-    if (USART1_RxHead == USART1_RxTail)
-        return 0; // 缓冲区为空
-    
-    *data = USART1_RxBuffer[USART1_RxTail];
-    USART1_RxTail = (USART1_RxTail + 1) % USART1_RX_BUFFER_SIZE;
-    
-    return 1;
+    return RingBuffer_Get(&USART1_RxBuffer, data);
 }
 
-/* ESP8266模块功能实现 -------------------------------------------------------*/
+/**
+  * @brief  丢弃接收缓冲区中尚未读取的数据
+  * @param  无
+  * @retval 无
+  * @note   只移动读指针，不与接收中断争用写指针
+  */
+static void USART1_FlushRx(void)
+{
+    RingBuffer_Flush(&USART1_RxBuffer);
+}
 
 /**
-  * @brief  等待并检查ESP8266响应
+  * @brief  获取串口接收缓冲区
   * @param  无
-  * @retval 1:收到OK响应 0:超时或未收到期望响应
+  * @retval 接收环形缓冲区指针，用于读取高水位和丢弃计数
   */
-static int ESP8266_WaitForResponse(void)
+const RingBuffer_t *USART1_GetRxBuffer(void)
 {
-    uint8_t data;
-    uint8_t response[20] = {0};
-    uint8_t index = 0;
-    uint16_t timeout = 0;
+    return &USART1_RxBuffer;
+}
+
+/**
+  * @brief  获取串口已静默的时长
+  * @param  无
+  * @retval 距最近一次收到字节的毫秒数
+  */
+uint32_t USART1_GetIdleMs(void)
+{
+    return Tick_ElapsedMs(USART1_LastRxMs);
+}
+
+/* ESP8266模块功能实现 -------------------------------------------------------*/
+
+/**
+  * @brief  等待ESP8266返回指定字符串
+  * @param  expect: 期望收到的字符串，长度不超过31个字符
+  * @param  timeout_ms: 超时时间(ms)，收到数据时不重新计时
+  * @retval 1:收到期望字符串 0:超时
+  */
+static int ESP8266_WaitFor(const char *expect, uint16_t timeout_ms)
+{
+    const uint8_t *span;
+    char window[32] = {0};          // 最近收到的字符滑动窗口
+    uint8_t len = strlen(expect);
+    uint8_t count = 0;
+    uint16_t elapsed = 0;
+    uint16_t avail, i;
     
-    while (timeout < ESP8266_TIMEOUT)
+    if (len == 0 || len >= sizeof(window))
+        return 0;
+    
+    while (elapsed < timeout_ms)
     {
-        if (USART1_ReadByte(&data))
+        avail = RingBuffer_Peek(&USART1_RxBuffer, &span);
+        if (avail == 0)
         {
-            response[index++] = data;
-            if (index >= sizeof(response) - 1)
-                index = 0; // 防止缓冲区溢出
-                
-            // 检查响应是否包含"OK"
-            if (index >= 2 && response[index-2] == 'O' && response[index-1] == 'K')
-                return 1;
+            elapsed++;
+            Delay_ms(1);
+            continue;
         }
-        else
+        
+        for (i = 0; i < avail; i++)
         {
-            timeout++;
-            Delay_ms(1);
+            // 窗口左移一位并追加新字符
+            memmove(window, window + 1, len - 1);
+            window[len - 1] = (char)span[i];
+            if (count < len)
+                count++;
+            
+            if (count == len && memcmp(window, expect, len) == 0)
+            {
+                // 只消费到匹配位置，后续数据留给调用者
+                RingBuffer_Consume(&USART1_RxBuffer, i + 1);
+                return 1;
+            }
         }
+        RingBuffer_Consume(&USART1_RxBuffer, avail);
     }
     
-    return 0; // 超时未收到OK
+    return 0;
 }
 
 /**
-  * @brief  初始化ESP8266
+  * @brief  执行AT命令序列，建立TCP连接并进入透传模式
   * @param  无
-  * @retval 无
+  * @retval 1:成功 0:重试次数用尽仍失败
   */
-void ESP8266_Init(void)
+static int ESP8266_Connect(void)
 {
-    /* 初始化串口 */
-    Serial_Init();
-    
     uint8_t retryCount = 0;
     uint8_t cmdIndex = 0;
     uint8_t success = 0;
     
     /* 清空接收缓冲区 */
-    USART1_RxHead = USART1_RxTail = 0;
+    USART1_FlushRx();
     
     /* 配置命令列表 */
     const char *commands[] = {
         "AT\r\n",                                       // 测试AT指令
-        "AT+CIPSTART=\"TCP\",\"117.72.118.76\",3000\r\n", // 建立TCP连接
+        ESP8266_SLEEP_CMD,                              // 射频省电模式
+        ESP8266_TcpStartCmd(),                          // 建立TCP连接
         "AT+CIPMODE=1\r\n",                             // 透传模式
         "AT+CIPSEND\r\n"                                // 开始透传
     };
-    uint8_t cmdCount = 4; // 命令数量
+    /* AT+CIPSEND在OK之后还会回">"，必须等到">"，否则它会混入第一次HTTP应答 */
+    const char *expects[] = { "OK", "OK", "OK", "OK", ">" };
+    uint8_t cmdCount = 5; // 命令数量
     
     /* 尝试执行AT命令序列 */
     while (retryCount < ESP8266_MAX_RETRIES && !success)
@@ -221,7 +325,7 @@ void ESP8266_Init(void)
             Delay_ms(1000);
             
             // 检查响应
-            if (!ESP8266_WaitForResponse())
+            if (!ESP8266_WaitFor(expects[cmdIndex], ESP8266_TIMEOUT))
             {
                 success = 0;
                 break;
@@ -236,20 +340,474 @@ void ESP8266_Init(void)
             Delay_ms(2000);
         }
     }
+    
+    return success;
 }
 
 /**
-  * @brief  重启ESP8266
+  * @brief  初始化串口和CH_PD引脚
   * @param  无
   * @retval 无
   */
-void ESP8266_Restart(void)
+static void ESP8266_LowLevelInit(void)
+{
+    /* 初始化串口 */
+    Serial_Init();
+    
+    /* CH_PD先输出高电平再切为推挽输出，避免初始化时模块被短暂断电 */
+    GPIO_InitTypeDef GPIO_InitStructure;
+    GPIO_SetBits(ESP8266_EN_PORT, ESP8266_EN_PIN);
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_PP;
+    GPIO_InitStructure.GPIO_Pin = ESP8266_EN_PIN;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_2MHz;
+    GPIO_Init(ESP8266_EN_PORT, &GPIO_InitStructure);
+    
+    power_state = ESP8266_POWER_ON;
+    power_since_ms = Tick_GetMs();
+    power_hour_ms = power_since_ms - power_since_ms % ESP8266_HOUR_MS;
+}
+
+/**
+  * @brief  初始化ESP8266
+  * @param  无
+  * @retval 无
+  */
+void ESP8266_Init(void)
+{
+    ESP8266_LowLevelInit();
+    ESP8266_Connect();
+}
+
+/**
+  * @brief  快速初始化ESP8266，不等待入网
+  * @param  无
+  * @retval 无
+  * @note   经CH_PD给模块断电重启，清除模块可能卡住的状态；模块自动连接保存
+  *          的热点，第一次上传时由ESP8266_PowerOnWait重建透传连接
+  */
+void ESP8266_InitAsync(void)
+{
+    ESP8266_LowLevelInit();
+    ESP8266_PowerOff();
+    Delay_ms(ESP8266_POWER_CYCLE_MS);
+    ESP8266_PowerOnAsync();
+}
+
+/**
+  * @brief  复位ESP8266并重新建立连接
+  * @param  无
+  * @retval 1:成功 0:失败
+  */
+static int ESP8266_Reset(void)
 {
     printf("+++");            // 退出透传模式
     Delay_ms(500);
     printf("AT+RST\r\n");     // 发送重启命令
     Delay_ms(3000);           // 等待重启完成
-    ESP8266_Init();           // 重新初始化
+    
+    return ESP8266_Connect(); // 重新执行初始化命令序列
+}
+
+/**
+  * @brief  重启ESP8266
+  * @param  无
+  * @retval 无
+  */
+void ESP8266_Restart(void)
+{
+    ESP8266_Reset();
+}
+
+/**
+  * @brief  退出透传模式，回到AT命令模式
+  * @param  无
+  * @retval 无
+  * @note   "+++"前后必须各保持一段时间无数据，模块才会识别为退出序列
+  */
+static void ESP8266_ExitTransparent(void)
+{
+    Delay_ms(ESP8266_ESCAPE_GUARD);
+    printf("+++");
+    Delay_ms(ESP8266_ESCAPE_GUARD);
+    USART1_FlushRx();
+}
+
+/**
+  * @brief  查询ESP8266连接状态
+  * @param  无
+  * @retval AT+CIPSTATUS返回的STATUS值(2~5)，模块无响应时返回0
+  * @note   调用前模块需处于AT命令模式
+  */
+static uint8_t ESP8266_QueryStatus(void)
+{
+    uint8_t data;
+    uint16_t elapsed = 0;
+    
+    USART1_FlushRx();
+    printf("AT+CIPSTATUS\r\n");
+    
+    if (!ESP8266_WaitFor("STATUS:", ESP8266_TIMEOUT))
+        return 0;
+    
+    /* 读取STATUS:后面的状态数字 */
+    while (elapsed < ESP8266_TIMEOUT)
+    {
+        if (USART1_ReadByte(&data))
+        {
+            if (data >= '0' && data <= '9')
+                return data - '0';
+            return 0;
+        }
+        elapsed++;
+        Delay_ms(1);
+    }
+    
+    return 0;
+}
+
+/**
+  * @brief  重新建立TCP连接并进入透传模式
+  * @param  status: 当前连接状态，已有连接时先关闭
+  * @retval 1:成功 0:失败
+  */
+static int ESP8266_OpenTCP(uint8_t status)
+{
+    if (status == ESP8266_STATUS_CONNECTED)
+    {
+        printf("AT+CIPCLOSE\r\n");
+        ESP8266_WaitFor("OK", ESP8266_TIMEOUT);
+    }
+    
+    USART1_FlushRx();
+    printf("%s", ESP8266_TcpStartCmd());
+    if (!ESP8266_WaitFor("OK", ESP8266_TCP_TIMEOUT))
+        return 0;
+    
+    printf("AT+CIPMODE=1\r\n");
+    if (!ESP8266_WaitFor("OK", ESP8266_TIMEOUT))
+        return 0;
+    
+    printf("AT+CIPSEND\r\n");
+    return ESP8266_WaitFor(">", ESP8266_TIMEOUT);
+}
+
+/**
+  * @brief  轮询等待模块连上保存的热点
+  * @param  start: 模块开始启动的时刻
+  * @param  timeout: 从start起的超时时间(ms)
+  * @param  polls: 存放额外查询的次数，可为NULL
+  * @retval 入网时为AT+CIPSTATUS的状态(2~4)，超时为最后一次查询的结果
+  * @note   模块启动完成前不应答，每次查询最多等待1s；超时后仍至少查询一次
+  */
+static uint8_t ESP8266_WaitJoin(uint32_t start, uint32_t timeout, uint8_t *polls)
+{
+    uint8_t status;
+    
+    while (1)
+    {
+        status = ESP8266_QueryStatus();
+        if (status >= ESP8266_STATUS_GOT_IP && status <= ESP8266_STATUS_DISCONNECTED)
+            return status;
+        if (Tick_ElapsedMs(start) >= timeout)
+            return status;
+        if (polls)
+            (*polls)++;
+        Delay_ms(ESP8266_WAKE_POLL);
+    }
+}
+
+/**
+  * @brief  重启模块，重新加入模块保存的热点
+  * @param  无
+  * @retval 1:成功 0:失败
+  * @note   不用AT+CWJAP：它会把热点写入模块Flash，覆盖现场配置好的热点。
+  *          AT+RST后模块按保存的配置自动入网，射频省电模式需重新设置
+  */
+static int ESP8266_Rejoin(void)
+{
+    uint32_t start;
+    uint8_t status;
+    
+    USART1_FlushRx();
+    printf("AT+RST\r\n");
+    if (!ESP8266_WaitFor("OK", ESP8266_TIMEOUT))
+        return 0;
+    start = Tick_GetMs();
+    
+    status = ESP8266_WaitJoin(start, ESP8266_JOIN_TIMEOUT, NULL);
+    if (status < ESP8266_STATUS_GOT_IP || status > ESP8266_STATUS_DISCONNECTED)
+        return 0;
+    
+    printf(ESP8266_SLEEP_CMD);
+    return ESP8266_WaitFor("OK", ESP8266_TIMEOUT) && ESP8266_OpenTCP(status);
+}
+
+/**
+  * @brief  经CH_PD给模块断电重启
+  * @param  无
+  * @retval 1:重新入网并建立透传连接 0:失败
+  * @note   模块不应答AT命令时AT+RST无效，只能断电；重启后同样连接保存的热点
+  */
+static int ESP8266_PowerCycle(void)
+{
+    ESP8266_PowerOff();
+    Delay_ms(ESP8266_POWER_CYCLE_MS);
+    return ESP8266_PowerOnWait();
+}
+
+/**
+  * @brief  记录一次恢复尝试的结果
+  * @param  tier: 恢复等级
+  * @param  ok: 该等级是否恢复成功
+  * @param  start: 本次恢复流程的起始时刻
+  * @retval 无
+  */
+static void ESP8266_RecordRecover(ESP8266_RecoverTier_t tier, int ok, uint32_t start)
+{
+    ESP8266_RecoverStats_t *stats = &recover_stats[tier];
+    
+    stats->attempts++;
+    if (ok)
+    {
+        uint32_t cost = Tick_ElapsedMs(start);
+        
+        stats->successes++;
+        stats->last_ms = cost;
+        stats->total_ms += cost;
+        if (cost > stats->max_ms)
+            stats->max_ms = cost;
+    }
+}
+
+/**
+  * @brief  分级恢复网络连接
+  * @param  无
+  * @retval 成功恢复所用的等级，失败时返回ESP8266_RECOVER_NONE
+  * @note   先用AT+CIPSTATUS探测，按模块状态选起始等级：WiFi仍在线时只重建
+  *         TCP连接，失败多为服务器不可达，交给上传退避处理；未连接热点时重启
+  *         模块，重新加入保存的热点；模块不应答AT命令时经CH_PD断电重启。
+  *         状态可能误报（模块卡在查询正常但连接建不起来的状态），收到HTTP
+  *         应答之前每连续失败ESP8266_RECOVER_ESCALATE次，起始等级升一级，
+  *         最高到断电重启；每次只做一级，耗时有上限
+  */
+ESP8266_RecoverTier_t ESP8266_Recover(void)
+{
+    uint32_t start = Tick_GetMs();
+    ESP8266_RecoverTier_t tier;
+    uint8_t status, level;
+    int ok;
+    
+    ESP8266_ExitTransparent();
+    status = ESP8266_QueryStatus();
+    
+    if (status >= ESP8266_STATUS_GOT_IP && status <= ESP8266_STATUS_DISCONNECTED)
+        level = ESP8266_RECOVER_TCP;
+    else if (status != 0)
+        level = ESP8266_RECOVER_WIFI;
+    else
+        level = ESP8266_RECOVER_RESET;
+    level += recover_failures / ESP8266_RECOVER_ESCALATE;
+    tier = (level < ESP8266_RECOVER_RESET) ? (ESP8266_RecoverTier_t)level : ESP8266_RECOVER_RESET;
+    
+    switch (tier)
+    {
+        case ESP8266_RECOVER_TCP:
+            /* 第一级：WiFi已连接，只重建TCP连接 */
+            ok = ESP8266_OpenTCP(status);
+            break;
+        
+        case ESP8266_RECOVER_WIFI:
+            /* 第二级：重启模块，重新加入保存的热点 */
+            ok = ESP8266_Rejoin();
+            break;
+        
+        default:
+            /* 第三级：断电重启 */
+            ok = ESP8266_PowerCycle();
+            break;
+    }
+    ESP8266_RecordRecover(tier, ok, start);
+    
+    if (!ok)
+    {
+        if (recover_failures < 0xFF)
+            recover_failures++;
+        return ESP8266_RECOVER_NONE;
+    }
+    return tier;
+}
+
+/**
+  * @brief  获取指定等级的恢复统计
+  * @param  tier: 恢复等级
+  * @retval 统计数据指针，等级无效时返回NULL
+  */
+const ESP8266_RecoverStats_t *ESP8266_GetRecoverStats(ESP8266_RecoverTier_t tier)
+{
+    if (tier <= ESP8266_RECOVER_NONE || tier >= ESP8266_RECOVER_TIER_COUNT)
+        return NULL;
+    
+    return &recover_stats[tier];
+}
+
+/* 模块功耗管理 --------------------------------------------------------------*/
+
+/**
+  * @brief  把上电时长累计到按整点划分的小时统计中
+  * @param  无
+  * @retval 无
+  * @note   两次调用之间跨过多个小时时，中间的整小时按当时的供电状态计
+  */
+static void ESP8266_PowerAccount(void)
+{
+    uint32_t now = Tick_GetMs();
+    uint32_t hour = now - now % ESP8266_HOUR_MS;
+    uint8_t on = (power_state != ESP8266_POWER_OFF);
+    
+    if (hour != power_hour_ms)
+    {
+        /* 先补齐上一个统计小时剩余的部分 */
+        if (on)
+            power_stats.on_ms_this_hour += power_hour_ms + ESP8266_HOUR_MS - power_since_ms;
+        if (hour - power_hour_ms > ESP8266_HOUR_MS)
+            power_stats.on_ms_last_hour = on ? ESP8266_HOUR_MS : 0;
+        else
+            power_stats.on_ms_last_hour = power_stats.on_ms_this_hour;
+        power_stats.on_ms_this_hour = 0;
+        power_hour_ms = hour;
+        power_since_ms = hour;
+    }
+    
+    if (on)
+        power_stats.on_ms_this_hour += now - power_since_ms;
+    power_since_ms = now;
+}
+
+/**
+  * @brief  拉低CH_PD给模块断电
+  * @param  无
+  * @retval 无
+  */
+void ESP8266_PowerOff(void)
+{
+    if (power_state == ESP8266_POWER_OFF)
+        return;
+    
+    ESP8266_PowerAccount();
+    GPIO_ResetBits(ESP8266_EN_PORT, ESP8266_EN_PIN);
+    power_state = ESP8266_POWER_OFF;
+    USART1_FlushRx();
+}
+
+/**
+  * @brief  拉高CH_PD开始唤醒模块，不等待
+  * @param  无
+  * @retval 无
+  */
+void ESP8266_PowerOnAsync(void)
+{
+    if (power_state != ESP8266_POWER_OFF)
+        return;
+    
+    ESP8266_PowerAccount();
+    GPIO_SetBits(ESP8266_EN_PORT, ESP8266_EN_PIN);
+    power_state = ESP8266_POWER_WAKING;
+    wake_start_ms = Tick_GetMs();
+    power_stats.wakes++;
+}
+
+/**
+  * @brief  等待模块入网并重建透传连接
+  * @param  无
+  * @retval 1:透传就绪 0:超时
+  * @note   启动输出（波特率74880）和自动入网的提示都不可靠，改为轮询
+  *          AT+CIPSTATUS；模块启动完成前不应答，每次查询最多等待1s。
+  *          采样周期较长时可能在上电超时之后才调用，此时仍查询一次
+  */
+int ESP8266_PowerOnWait(void)
+{
+    uint32_t start = Tick_GetMs();
+    uint8_t status = 0;
+    uint8_t polls = 0;
+    uint32_t cost;
+    int ok = 0;
+    
+    if (power_state == ESP8266_POWER_ON)
+        return 1;
+    ESP8266_PowerOnAsync();
+    
+    status = ESP8266_WaitJoin(wake_start_ms, ESP8266_WAKE_TIMEOUT, &polls);
+    
+    if (status >= ESP8266_STATUS_GOT_IP && status <= ESP8266_STATUS_DISCONNECTED)
+    {
+        /* 等过才量得到真实的入网耗时，按1/4权重平滑；一次就绪说明唤醒得
+           过早，提前量缩短1/8，逐步逼近实际耗时 */
+        if (polls)
+            wake_lead_ms = (wake_lead_ms * 3 + Tick_ElapsedMs(wake_start_ms)) / 4;
+        else
+            wake_lead_ms -= wake_lead_ms / 8;
+        
+        printf(ESP8266_SLEEP_CMD);
+        ok = ESP8266_WaitFor("OK", ESP8266_TIMEOUT) && ESP8266_OpenTCP(status);
+    }
+    
+    /* 失败时保持上电，交给分级恢复处理 */
+    power_state = ESP8266_POWER_ON;
+    if (!ok)
+    {
+        power_stats.wake_failures++;
+        return 0;
+    }
+    
+    cost = Tick_ElapsedMs(start);
+    power_stats.last_wake_ms = cost;
+    if (cost > power_stats.max_wake_ms)
+        power_stats.max_wake_ms = cost;
+    return 1;
+}
+
+/**
+  * @brief  判断唤醒中的模块是否已到预计入网的时刻
+  * @param  无
+  * @retval 1:已上电、已断电或已到预计时刻，可以调用ESP8266_PowerOnWait
+  *         0:刚拉高CH_PD，此时等待会阻塞主循环数秒
+  */
+uint8_t ESP8266_IsWakeDue(void)
+{
+    if (power_state != ESP8266_POWER_WAKING)
+        return 1;
+    return Tick_ElapsedMs(wake_start_ms) >= wake_lead_ms;
+}
+
+/**
+  * @brief  获取模块供电状态
+  * @param  无
+  * @retval 供电状态
+  */
+ESP8266_PowerState_t ESP8266_GetPowerState(void)
+{
+    return power_state;
+}
+
+/**
+  * @brief  获取建议的提前唤醒时间
+  * @param  无
+  * @retval 从拉高CH_PD到模块入网的平滑耗时(ms)
+  */
+uint32_t ESP8266_GetWakeLeadMs(void)
+{
+    return wake_lead_ms;
+}
+
+/**
+  * @brief  获取模块供电统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const ESP8266_PowerStats_t *ESP8266_GetPowerStats(void)
+{
+    ESP8266_PowerAccount();
+    return &power_stats;
 }
 
 /**
@@ -259,7 +817,7 @@ void ESP8266_Restart(void)
   * @param  json: JSON格式的数据
   * @retval 1:发送成功 0:发送失败
   */
-int ESP8266_Send_http_post(char *POST, char *Host, char *json)
+int ESP8266_Send_http_post(const char *POST, const char *Host, const char *json)
 {
     int length = strlen(json);
     int ret = printf("POST %s HTTP/1.1\r\n"
@@ -274,54 +832,167 @@ int ESP8266_Send_http_post(char *POST, char *Host, char *json)
     return (ret > 0) ? 1 : 0;
 }
 
+/**
+  * @brief  匹配一行应答头的字段名
+  * @param  header: 以'\0'结尾的一行应答头
+  * @param  name: 小写的字段名，含冒号
+  * @retval 字段值的起始位置，不是该字段时为NULL
+  * @note   字段名不区分大小写，只在行首匹配
+  */
+static const char *ESP8266_FindHeader(const char *header, const char *name)
+{
+    uint8_t i;
+
+    for (i = 0; name[i] && (header[i] | 0x20) == name[i]; i++)
+        ;
+    return (name[i] == '\0') ? header + i : NULL;
+}
+
+/**
+  * @brief  解析一行应答头中的Content-Length
+  * @param  header: 以'\0'结尾的一行应答头
+  * @retval 应答体长度，不是该字段时为0
+  */
+static uint32_t ESP8266_ContentLength(const char *header)
+{
+    const char *value = ESP8266_FindHeader(header, "content-length:");
+
+    return value ? strtoul(value, NULL, 10) : 0;
+}
+
+/**
+  * @brief  解析一行应答头中的Date
+  * @param  header: 以'\0'结尾的一行应答头
+  * @retval Unix时间(s)，不是该字段或格式不符时为0
+  * @note   格式为RFC 7231的IMF-fixdate，如"Sun, 18 Oct 2026 08:00:00 GMT"
+  */
+static uint32_t ESP8266_HttpDate(const char *header)
+{
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    const char *value = ESP8266_FindHeader(header, "date:");
+    char mon[4];
+    unsigned d, y, hh, mm, ss, m, era, yoe, doy, doe;
+
+    if (value == NULL || (value = strchr(value, ',')) == NULL ||
+        sscanf(value + 1, "%u %3s %u %u:%u:%u", &d, mon, &y, &hh, &mm, &ss) != 6)
+        return 0;
+    for (m = 0; m < 12 && strncmp(mon, months + m * 3, 3) != 0; m++)
+        ;
+    if (m == 12 || y < 1970 || d < 1 || d > 31 || hh > 23 || mm > 59 || ss > 60)
+        return 0;
+
+    /* 公历日期换算为1970-01-01起的天数，年份从3月起算，闰日落在年末 */
+    m++;
+    if (m <= 2)
+        y--;
+    era = y / 400;
+    yoe = y - era * 400;
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (era * 146097 + doe - 719468) * 86400UL + hh * 3600UL + mm * 60UL + ss;
+}
+
 /**
   * @brief  接收HTTP响应并解析状态码
   * @param  code: 解析出的HTTP状态码存放地址
+  * @param  on_body: 应答体的逐字节处理函数，为NULL时丢弃
   * @retval 1:接收并解析成功 0:接收失败或解析失败
+  * @note   应答头逐字节读取，每收完一行解析状态行、Date和Content-Length，
+  *          超长的行只保留开头；应答头的结束标志在字节流上滚动匹配，应答头
+  *          多长都能找到，之后按Content-Length把应答体逐字节交给on_body。
+  *          应答体接收超时不影响返回值，交给on_body的一方按截断处理
   */
-int ESP8266_Receive_http_response(uint32_t *code)
+int ESP8266_Receive_http_response(uint32_t *code, ESP8266_BodyHandler_t on_body)
 {
-    char response_buffer[256] = {0};
-    uint16_t index = 0;
-    char ch;
-    uint16_t noDataCounter = 0;
-    const uint16_t maxNoDataCount = 15000;  // 无数据超时阈值
+    static const char header_end[] = "\r\n\r\n";
+    char line[ESP8266_HTTP_LINE_SIZE];
+    uint16_t len = 0;
+    uint8_t matched = 0;                    // 已匹配的结束标志字节数
+    uint8_t status = 0;                     // 是否已收到状态行
+    uint16_t noDataCounter = 0;             // 连续无数据的毫秒数
+    uint32_t body_len = 0, fed = 0, value;
+    uint8_t byte;
+    char *http_header;
     
-    /* 接收HTTP响应 */
-    while (noDataCounter < maxNoDataCount)
+    http_date = 0;
+    
+    /* 接收HTTP应答头 */
+    while (!(status && matched == 4) && noDataCounter < ESP8266_HTTP_TIMEOUT)
     {
-        if (USART1_ReadByte((uint8_t *)&ch))
+        if (!RingBuffer_Get(&USART1_RxBuffer, &byte))
         {
-            response_buffer[index++] = ch;
-            noDataCounter = 0;  // 收到数据时重置计数器
-            
-            // 防止缓冲区溢出
-            if (index >= sizeof(response_buffer) - 1) {
-                break;
-            }
-            
-            // 检查是否已接收到HTTP头结束标志
-            if (index >= 4 && strstr(response_buffer, "\r\n\r\n") != NULL) {
-                break;
-            }
+            noDataCounter++;
+            Delay_ms(1);
+            continue;
         }
+        noDataCounter = 0;  // 收到数据时重置计数器
+        
+        /* 失配时只有'\r'能作为结束标志的开头 */
+        if (byte == header_end[matched])
+            matched++;
         else
+            matched = (byte == '\r');
+        
+        if (byte != '\n')
         {
-            noDataCounter++;
+            if (len < sizeof(line) - 1)
+                line[len++] = byte;
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+        
+        if (!status)
+        {
+            /* 解析HTTP状态码，状态行之前的残留数据跳过 */
+            http_header = strstr(line, "HTTP/1.1 ");
+            if (http_header && sscanf(http_header + 9, "%3u", code) == 1)
+                status = 1;
+        }
+        else if ((value = ESP8266_ContentLength(line)) != 0)
+        {
+            body_len = value;
+        }
+        else if ((value = ESP8266_HttpDate(line)) != 0)
+        {
+            http_date = value;
         }
     }
-    response_buffer[index] = '\0';  // 字符串结束标志
-    
-    /* 解析HTTP状态码 */
-    char *http_header = strstr(response_buffer, "HTTP/1.1 ");
-    if (!http_header) return 0;
-    
-    char *status_start = http_header + 9;  // 指向状态码起始位置
-    if (sscanf(status_start, "%3u", code) != 1) {
+    if (!status)
         return 0;
+    recover_failures = 0;                   // 链路畅通，恢复重新从探测的等级开始
+    if (matched < 4)
+        return 1;                           // 应答头未收完，没有应答体可读
+    
+    /* 接收应答体，保持透传连接上的字节流与请求一一对应 */
+    noDataCounter = 0;
+    while (fed < body_len && noDataCounter < ESP8266_HTTP_TIMEOUT)
+    {
+        if (RingBuffer_Get(&USART1_RxBuffer, &byte))
+        {
+            if (on_body)
+                on_body(byte);
+            fed++;
+            noDataCounter = 0;
+        }
+        else
+        {
+            noDataCounter++;
+            Delay_ms(1);
+        }
     }
     
     return 1;
 }
 
+/**
+  * @brief  获取最近一次应答Date头中的时间
+  * @param  无
+  * @retval Unix时间(s)，应答中没有Date头时为0
+  */
+uint32_t ESP8266_GetHttpDate(void)
+{
+    return http_date;
+}
+
 /* 文件结束 -----------------------------------------------------------------*/
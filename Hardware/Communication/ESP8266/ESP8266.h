@@ -13,9 +13,89 @@
 
 /* 包含头文件 ----------------------------------------------------------------*/
 #include <stdint.h>
+#include "RingBuffer.h"
 //#include "Serial.h"
 
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  AT+CIPSTATUS返回的连接状态
+  */
+#define ESP8266_STATUS_GOT_IP        2   // 已连接热点并获得IP
+#define ESP8266_STATUS_CONNECTED     3   // 已建立TCP连接
+#define ESP8266_STATUS_DISCONNECTED  4   // TCP连接已断开
+#define ESP8266_STATUS_NO_WIFI       5   // 未连接热点
+
+/**
+  * @brief  网络恢复等级枚举
+  */
+typedef enum {
+    ESP8266_RECOVER_NONE = 0,   // 恢复失败
+    ESP8266_RECOVER_TCP,        // 第一级：仅重建TCP连接
+    ESP8266_RECOVER_WIFI,       // 第二级：重新加入热点
+    ESP8266_RECOVER_RESET,      // 第三级：复位模块
+    ESP8266_RECOVER_TIER_COUNT
+} ESP8266_RecoverTier_t;
+
+/**
+  * @brief  单个恢复等级的统计数据
+  */
+typedef struct {
+    uint16_t attempts;     // 尝试次数
+    uint16_t successes;    // 成功次数
+    uint32_t last_ms;      // 最近一次恢复耗时(ms)
+    uint32_t max_ms;       // 最长恢复耗时(ms)
+    uint32_t total_ms;     // 成功恢复累计耗时(ms)，除以successes即平均值
+} ESP8266_RecoverStats_t;
+
+/**
+  * @brief  HTTP应答体的逐字节处理函数
+  */
+typedef void (*ESP8266_BodyHandler_t)(uint8_t byte);
+
+/**
+  * @brief  模块供电状态枚举
+  */
+typedef enum {
+    ESP8266_POWER_ON = 0,       // 已上电，透传连接可用或交给分级恢复处理
+    ESP8266_POWER_WAKING,       // CH_PD已拉高，模块正在启动和自动入网
+    ESP8266_POWER_OFF           // CH_PD拉低，模块断电
+} ESP8266_PowerState_t;
+
+/**
+  * @brief  模块供电统计
+  */
+typedef struct {
+    uint32_t on_ms_last_hour;   // 上一个整点小时内的上电时长(ms)
+    uint32_t on_ms_this_hour;   // 本小时到目前为止的上电时长(ms)
+    uint16_t wakes;             // 上电唤醒次数
+    uint16_t wake_failures;     // 超时未能重建透传连接的次数
+    uint32_t last_wake_ms;      // 最近一次上传因等待透传就绪而阻塞的时间(ms)
+    uint32_t max_wake_ms;       // 最长阻塞时间(ms)
+} ESP8266_PowerStats_t;
+
 /* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  获取串口接收缓冲区
+  * @param  无
+  * @retval 接收环形缓冲区指针，用于读取高水位和丢弃计数
+  */
+const RingBuffer_t *USART1_GetRxBuffer(void);
+
+/**
+  * @brief  获取串口已静默的时长
+  * @param  无
+  * @retval 距最近一次收到字节的毫秒数，低功耗模块据此判断能否进入Stop
+  */
+uint32_t USART1_GetIdleMs(void);
+
+/**
+  * @brief  按当前时钟重新计算串口1波特率分频
+  * @param  无
+  * @retval 无
+  * @note   由Clock模块在每次切换系统时钟后调用
+  */
+void Serial_ClockUpdate(void);
+
 /**
   * @brief  初始化ESP8266
   * @param  无
@@ -23,6 +103,14 @@
   */
 void ESP8266_Init(void);
 
+/**
+  * @brief  快速初始化ESP8266，不等待入网
+  * @param  无
+  * @retval 无
+  * @note   模块断电重启后立即返回，入网在后台进行，采集不必等待网络
+  */
+void ESP8266_InitAsync(void);
+
 /**
   * @brief  重启ESP8266
   * @param  无
@@ -30,6 +118,75 @@ void ESP8266_Init(void);
   */
 void ESP8266_Restart(void);
 
+/**
+  * @brief  分级恢复网络连接
+  * @param  无
+  * @retval 成功恢复所用的等级，失败时返回ESP8266_RECOVER_NONE
+  * @note   每次只尝试一级，起始等级按探测到的状态选择；收到HTTP应答之前
+  *          连续失败时逐次升级，最高到断电重启；耗时从探测开始计算
+  */
+ESP8266_RecoverTier_t ESP8266_Recover(void);
+
+/**
+  * @brief  获取指定等级的恢复统计
+  * @param  tier: 恢复等级
+  * @retval 统计数据指针，等级无效时返回NULL
+  */
+const ESP8266_RecoverStats_t *ESP8266_GetRecoverStats(ESP8266_RecoverTier_t tier);
+
+/**
+  * @brief  拉低CH_PD给模块断电
+  * @param  无
+  * @retval 无
+  * @note   不退出透传，TCP连接随断电失效，由服务器按超时回收
+  */
+void ESP8266_PowerOff(void);
+
+/**
+  * @brief  拉高CH_PD开始唤醒模块，不等待
+  * @param  无
+  * @retval 无
+  * @note   模块启动后自动连接保存的热点，提前调用可把入网时间藏在采样间隙里
+  */
+void ESP8266_PowerOnAsync(void);
+
+/**
+  * @brief  等待模块入网并重建透传连接
+  * @param  无
+  * @retval 1:透传就绪 0:超时
+  * @note   已上电时立即返回1；尚未开始唤醒时先拉高CH_PD
+  */
+int ESP8266_PowerOnWait(void);
+
+/**
+  * @brief  获取模块供电状态
+  * @param  无
+  * @retval 供电状态
+  */
+ESP8266_PowerState_t ESP8266_GetPowerState(void);
+
+/**
+  * @brief  判断唤醒中的模块是否已到预计入网的时刻
+  * @param  无
+  * @retval 1:可以调用ESP8266_PowerOnWait 0:刚拉高CH_PD，等待会阻塞主循环
+  * @note   预计时刻按ESP8266_GetWakeLeadMs，用于启动和唤醒时不阻塞采集
+  */
+uint8_t ESP8266_IsWakeDue(void);
+
+/**
+  * @brief  获取建议的提前唤醒时间
+  * @param  无
+  * @retval 从拉高CH_PD到模块入网的平滑耗时(ms)
+  */
+uint32_t ESP8266_GetWakeLeadMs(void);
+
+/**
+  * @brief  获取模块供电统计
+  * @param  无
+  * @retval 统计数据指针，上电时长已累计到调用时刻
+  */
+const ESP8266_PowerStats_t *ESP8266_GetPowerStats(void);
+
 /**
   * @brief  发送HTTP POST请求
   * @param  POST: POST请求路径
@@ -37,14 +194,24 @@ void ESP8266_Restart(void);
   * @param  json: JSON格式的数据
   * @retval 1:发送成功 0:发送失败
   */
-int ESP8266_Send_http_post(char *POST, char *Host, char *json);
+int ESP8266_Send_http_post(const char *POST, const char *Host, const char *json);
 
 /**
   * @brief  接收HTTP响应并解析状态码
   * @param  code: 解析出的HTTP状态码存放地址
+  * @param  on_body: 按Content-Length接收应答体，逐字节交给此函数；为NULL时丢弃
   * @retval 1:接收并解析成功 0:接收失败或解析失败
+  * @note   应答体不在此缓存，长度不受接收缓冲区限制
+  */
+int ESP8266_Receive_http_response(uint32_t *code, ESP8266_BodyHandler_t on_body);
+
+/**
+  * @brief  获取最近一次应答Date头中的时间
+  * @param  无
+  * @retval Unix时间(s)，应答中没有Date头时为0
+  * @note   Date只有秒分辨率，用于时间同步，见TimeSync.h
   */
-int ESP8266_Receive_http_response(uint32_t *code);
+uint32_t ESP8266_GetHttpDate(void);
 
 #endif /* __ESP8266_H */
 
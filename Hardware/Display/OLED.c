@@ -268,16 +268,11 @@ void OLED_ShowBinNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Leng
   * @brief  OLED初始化
   * @param  无
   * @retval 无
+  * @note   上电后须等待OLED_POWER_ON_MS再调用，由调用者按复位原因决定；
+  *          原来的空循环延时在开启优化后可能被整个删除
   */
 void OLED_Init(void)
 {
-	uint32_t i, j;
-	
-	for (i = 0; i < 1000; i++)			//上电延时
-	{
-		for (j = 0; j < 1000; j++);
-	}
-	
 	OLED_I2C_Init();			//端口初始化
 	
 	OLED_WriteCommand(0xAE);	//关闭显示
@@ -2,6 +2,8 @@
 #define __OLED_H
 #include "stdint.h"
 
+#define OLED_POWER_ON_MS	100		//上电到可以初始化的等待时间(ms)
+
 void OLED_Init(void);
 void OLED_Clear(void);
 void OLED_ShowChar(uint8_t Line, uint8_t Column, char Char);
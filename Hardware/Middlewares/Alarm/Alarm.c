@@ -0,0 +1,173 @@
+/**
+  ******************************************************************************
+  * @file    Alarm.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   环境报警规则判定实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Alarm.h"
+#include "Settings.h"
+#include <stddef.h>
+
+/* 私有类型定义 --------------------------------------------------------------*/
+/**
+  * @brief  单个报警位的消抖状态
+  */
+typedef struct {
+    uint8_t  pending;      // 是否正在等待消抖
+    uint32_t since;        // 开始等待的时刻
+} AlarmDebounce_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static AlarmRule_t rules[ALARM_CH_COUNT];
+static AlarmDebounce_t debounce[ALARM_CH_COUNT * 2];
+static uint8_t active_mask = 0;
+
+/**
+  * @brief  判定单个报警位
+  * @param  bit: 报警位下标（通道*2+方向）
+  * @param  outside: 数值是否越过报警限
+  * @param  inside: 数值是否回到限值内侧回差以外
+  * @param  debounce_ms: 消抖时间
+  * @param  now_ms: 采样时刻
+  * @retval 1:报警状态发生变化 0:未变化
+  */
+static uint8_t Alarm_Step(uint8_t bit, uint8_t outside, uint8_t inside,
+                          uint16_t debounce_ms, uint32_t now_ms)
+{
+    AlarmDebounce_t *db = &debounce[bit];
+    uint8_t active = (active_mask >> bit) & 1;
+    uint8_t want = active ? inside : outside;   // 是否朝相反状态变化
+
+    if (!want)
+    {
+        db->pending = 0;
+        return 0;
+    }
+
+    if (!db->pending)
+    {
+        db->pending = 1;
+        db->since = now_ms;
+    }
+
+    if (now_ms - db->since < debounce_ms)
+        return 0;
+
+    db->pending = 0;
+    active_mask ^= (uint8_t)(1u << bit);
+    return 1;
+}
+
+/**
+  * @brief  初始化报警模块
+  * @param  无
+  * @retval 无
+  */
+void Alarm_Init(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < ALARM_CH_COUNT; i++)
+        rules[i] = Settings_Get()->alarm[i];
+
+    for (i = 0; i < ALARM_CH_COUNT * 2; i++)
+        debounce[i].pending = 0;
+
+    active_mask = 0;
+}
+
+/**
+  * @brief  设置通道报警规则
+  * @param  ch: 报警通道
+  * @param  rule: 规则指针
+  * @retval 无
+  */
+void Alarm_SetRule(AlarmChannel_t ch, const AlarmRule_t *rule)
+{
+    if (ch < ALARM_CH_COUNT && rule != NULL)
+        rules[ch] = *rule;
+}
+
+/**
+  * @brief  获取通道报警规则
+  * @param  ch: 报警通道
+  * @retval 规则指针，通道无效时返回NULL
+  */
+const AlarmRule_t *Alarm_GetRule(AlarmChannel_t ch)
+{
+    return (ch < ALARM_CH_COUNT) ? &rules[ch] : NULL;
+}
+
+/**
+  * @brief  用一组新采样值判定报警
+  * @param  values: 各通道采样值
+  * @param  now_ms: 采样时刻(ms)
+  * @retval 本次状态发生变化的报警位
+  */
+uint8_t Alarm_Evaluate(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms)
+{
+    uint8_t changed = 0;
+    uint8_t ch;
+
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        const AlarmRule_t *r = &rules[ch];
+        int32_t v = values[ch];
+        uint8_t bit_low = ch * 2 + ALARM_DIR_LOW;
+        uint8_t bit_high = ch * 2 + ALARM_DIR_HIGH;
+
+        if (r->severity == ALARM_SEVERITY_NONE)
+        {
+            /* 通道被禁用时直接解除其报警 */
+            changed |= active_mask & ALARM_CH_MASK(ch);
+            active_mask &= (uint8_t)~ALARM_CH_MASK(ch);
+            continue;
+        }
+
+        if (Alarm_Step(bit_low, v < r->low,
+                       v >= (int32_t)r->low + r->hysteresis, r->debounce_ms, now_ms))
+            changed |= (uint8_t)(1u << bit_low);
+
+        if (Alarm_Step(bit_high, v > r->high,
+                       v <= (int32_t)r->high - r->hysteresis, r->debounce_ms, now_ms))
+            changed |= (uint8_t)(1u << bit_high);
+    }
+
+    return changed;
+}
+
+/**
+  * @brief  获取当前处于报警状态的位掩码
+  * @param  无
+  * @retval 报警位掩码
+  */
+uint8_t Alarm_GetActiveMask(void)
+{
+    return active_mask;
+}
+
+/**
+  * @brief  获取当前报警中的最高严重等级
+  * @param  无
+  * @retval 严重等级
+  */
+AlarmSeverity_t Alarm_GetSeverity(void)
+{
+    AlarmSeverity_t worst = ALARM_SEVERITY_NONE;
+    uint8_t ch;
+
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        if ((active_mask & ALARM_CH_MASK(ch)) && rules[ch].severity > worst)
+            worst = rules[ch].severity;
+    }
+
+    return worst;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    Alarm.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   环境报警规则判定头文件
+  * @note    每个通道独立配置上下限、回差、消抖时间和严重等级，
+  *          数值统一使用0.1单位的定点数（如253表示25.3℃）
+  ******************************************************************************
+  */
+
+#ifndef __ALARM_H
+#define __ALARM_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include <stdint.h>
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  报警通道枚举
+  */
+typedef enum {
+    ALARM_CH_TEMP = 0,     // 温度，单位0.1℃
+    ALARM_CH_HUMI,         // 湿度，单位0.1%RH
+    ALARM_CH_LIGHT,        // 光照，单位0.1（0~10000）
+    ALARM_CH_COUNT
+} AlarmChannel_t;
+
+/**
+  * @brief  报警方向枚举
+  */
+typedef enum {
+    ALARM_DIR_LOW = 0,     // 低于下限
+    ALARM_DIR_HIGH         // 高于上限
+} AlarmDir_t;
+
+/**
+  * @brief  报警严重等级枚举，数值越大越严重
+  */
+typedef enum {
+    ALARM_SEVERITY_NONE = 0,   // 无报警
+    ALARM_SEVERITY_INFO,       // 提示：仅显示和上报
+    ALARM_SEVERITY_WARNING,    // 警告
+    ALARM_SEVERITY_CRITICAL    // 严重
+} AlarmSeverity_t;
+
+/**
+  * @brief  单个通道的报警规则
+  */
+typedef struct {
+    int16_t  low;              // 下限
+    int16_t  high;             // 上限
+    uint16_t hysteresis;       // 回差：报警后需回到限值内侧该距离才解除
+    uint16_t debounce_ms;      // 消抖：越限/恢复持续该时长才改变状态
+    AlarmSeverity_t severity;  // 严重等级
+} AlarmRule_t;
+
+/* 宏定义 --------------------------------------------------------------------*/
+// 报警位掩码：每个通道占两位，低位为下限报警，高位为上限报警
+#define ALARM_BIT(ch, dir)     ((uint8_t)(1u << ((ch) * 2 + (dir))))
+#define ALARM_CH_MASK(ch)      ((uint8_t)(3u << ((ch) * 2)))
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化报警模块，载入配置中的规则并清除全部报警状态
+  * @param  无
+  * @retval 无
+  */
+void Alarm_Init(void);
+
+/**
+  * @brief  设置通道报警规则
+  * @param  ch: 报警通道
+  * @param  rule: 规则指针
+  * @retval 无
+  * @note   修改规则不会清除当前报警状态，下次判定按新规则执行
+  */
+void Alarm_SetRule(AlarmChannel_t ch, const AlarmRule_t *rule);
+
+/**
+  * @brief  获取通道报警规则
+  * @param  ch: 报警通道
+  * @retval 规则指针，通道无效时返回NULL
+  */
+const AlarmRule_t *Alarm_GetRule(AlarmChannel_t ch);
+
+/**
+  * @brief  用一组新采样值判定报警
+  * @param  values: 各通道采样值，按AlarmChannel_t顺序排列
+  * @param  now_ms: 采样时刻(ms)
+  * @retval 本次状态发生变化的报警位，结合Alarm_GetActiveMask区分产生与解除
+  * @note   只应在获得新采样后调用，消抖时间按采样时刻计算
+  */
+uint8_t Alarm_Evaluate(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms);
+
+/**
+  * @brief  获取当前处于报警状态的位掩码
+  * @param  无
+  * @retval 报警位掩码
+  */
+uint8_t Alarm_GetActiveMask(void);
+
+/**
+  * @brief  获取当前报警中的最高严重等级
+  * @param  无
+  * @retval 严重等级，无报警时为ALARM_SEVERITY_NONE
+  */
+AlarmSeverity_t Alarm_GetSeverity(void);
+
+#endif /* __ALARM_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
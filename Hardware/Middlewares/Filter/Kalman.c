@@ -55,4 +55,20 @@ double KalmanFilter_Update(KalmanFilter_t *filter, double measurement)
     return filter->x;
 }
 
+/**
+  * @brief  用保存的状态恢复滤波器
+  * @param  filter: 指向卡尔曼滤波器结构体，Q和R须已初始化
+  * @param  x: 保存的状态估计值
+  * @param  P: 保存的估计误差协方差
+  * @param  steps: 保存后错过的更新次数
+  * @retval 无
+  * @note   常数模型的预测只增加过程噪声，错过的steps次预测合并为一步
+  */
+void KalmanFilter_Restore(KalmanFilter_t *filter, double x, double P, uint32_t steps)
+{
+    filter->x = x;
+    filter->P = P + filter->Q * steps;
+    filter->K = 0.0;
+}
+
 /* 文件结束 -----------------------------------------------------------------*/
@@ -11,6 +11,9 @@
 #ifndef INC_KALMAN_FILTER_H_
 #define INC_KALMAN_FILTER_H_
 
+/* 包含头文件 ----------------------------------------------------------------*/
+#include <stdint.h>
+
 /* 类型定义 ------------------------------------------------------------------*/
 /**
   * @brief  卡尔曼滤波器结构体
@@ -42,6 +45,16 @@ void KalmanFilter_Init(KalmanFilter_t *filter, double init_value, double Q, doub
   */
 double KalmanFilter_Update(KalmanFilter_t *filter, double measurement);
 
+/**
+  * @brief  用保存的状态恢复滤波器
+  * @param  filter: 指向卡尔曼滤波器结构体，Q和R须已初始化
+  * @param  x: 保存的状态估计值
+  * @param  P: 保存的估计误差协方差
+  * @param  steps: 保存后错过的更新次数，每次按一步预测增大P
+  * @retval 无
+  */
+void KalmanFilter_Restore(KalmanFilter_t *filter, double x, double P, uint32_t steps);
+
 #endif /* INC_KALMAN_FILTER_H_ */
 
 /* 文件结束 -----------------------------------------------------------------*/
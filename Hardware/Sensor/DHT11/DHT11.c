@@ -11,6 +11,9 @@
 /* 包含头文件 ----------------------------------------------------------------*/
 #include "DHT11.h"
 #include "Delay.h"
+#include "Trace.h"
+#include "Prof.h"
+#include "Settings.h"
 
 /* 私有宏定义 ----------------------------------------------------------------*/
 #define DHT_TIMEOUT_VALUE  1000   // 通信超时时间（单位：循环次数）
@@ -20,6 +23,20 @@ static KalmanFilter_t temp_filter;  // 温度卡尔曼滤波器
 static KalmanFilter_t humi_filter;  // 湿度卡尔曼滤波器
 static uint8_t is_filter_initialized = 0;  // 滤波器初始化标志
 
+/**
+  * @brief  按配置的噪声参数初始化温湿度滤波器
+  * @param  temp: 温度初值
+  * @param  humi: 湿度初值
+  * @retval 无
+  */
+static void DHT_Filter_Start(double temp, double humi)
+{
+	const SettingsKalman_t *k = Settings_Get()->kalman;
+	
+	KalmanFilter_Init(&temp_filter, temp, k[SETTINGS_FILTER_TEMP].Q, k[SETTINGS_FILTER_TEMP].R);
+	KalmanFilter_Init(&humi_filter, humi, k[SETTINGS_FILTER_HUMI].Q, k[SETTINGS_FILTER_HUMI].R);
+}
+
 /**
   * @brief  DHT11 GPIO初始化函数
   * @param  Mode: 指定输入或输出模式
@@ -140,6 +157,10 @@ uint8_t DHT_Get_Byte_Data(void)
   */
 uint8_t DHT_Get_Temp_Humi_Data(uint8_t buffer[])
 {
+	uint8_t status = DHT_TIMEOUT;
+	
+	PROF_BEGIN(PROF_ZONE_DHT);
+	
 	// 清空数据缓冲区
 	buffer[0] = buffer[1] = buffer[2] = buffer[3] = buffer[4] = 0;
 	
@@ -154,12 +175,15 @@ uint8_t DHT_Get_Temp_Humi_Data(uint8_t buffer[])
 		buffer[4] = DHT_Get_Byte_Data();  // 校验和
 		
 		// 验证数据有效性：前四个字节之和等于校验和
-		if (buffer[0] + buffer[1] + buffer[2] + buffer[3] == buffer[4]) {
-			return 1;  // 数据有效
-		}
+		status = (buffer[0] + buffer[1] + buffer[2] + buffer[3] == buffer[4]) ? DHT_OK : DHT_ERROR;
 	}
 	
-	return 0;  // 通信失败或数据无效
+	PROF_END(PROF_ZONE_DHT);
+	
+	// 原始帧连同读取结果一起记入采集轨迹
+	Trace_DhtFrame(status, buffer);
+	
+	return status == DHT_OK;  // 通信失败或数据无效时返回0
 }
 
 /**
@@ -201,17 +225,13 @@ void DHT_Filter_Init(void)
 			init_humi += humi_decimal;
 		}
 		
-		// 温度滤波器初始化
-		KalmanFilter_Init(&temp_filter, init_temp, 0.02, 1.0);
-		
-		// 湿度滤波器初始化
-		KalmanFilter_Init(&humi_filter, init_humi, 0.01, 2.0);
+		// 温湿度滤波器初始化
+		DHT_Filter_Start(init_temp, init_humi);
 		
 		is_filter_initialized = 1;
 	} else {
 		// 读取失败时使用默认值初始化
-		KalmanFilter_Init(&temp_filter, 25.0, 0.02, 1.0);  // 默认25℃
-		KalmanFilter_Init(&humi_filter, 50.0, 0.01, 2.0);  // 默认50%
+		DHT_Filter_Start(25.0, 50.0);  // 默认25℃、50%
 	}
 }
 
@@ -228,11 +248,6 @@ uint8_t DHT_Get_Filtered_Data(uint8_t buffer[], DHT_FilteredData_t *filtered_dat
 		return 0;  // 校验和错误
 	}
 	
-	// 如果滤波器未初始化，先初始化
-	if (!is_filter_initialized) {
-		DHT_Filter_Init();
-	}
-	
 	// 计算原始温度和湿度值
 	// 根据小数部分的数值大小，自动确定小数位数
 	double raw_temp, raw_humi;
@@ -263,6 +278,12 @@ uint8_t DHT_Get_Filtered_Data(uint8_t buffer[], DHT_FilteredData_t *filtered_dat
 		raw_humi += humi_decimal;
 	}
 	
+	// 滤波器未初始化时用本次读数作为初值，不再为初始化单独读一次传感器
+	if (!is_filter_initialized) {
+		DHT_Filter_Start(raw_temp, raw_humi);
+		is_filter_initialized = 1;
+	}
+	
 	// 应用卡尔曼滤波器
 	filtered_data->temperature = KalmanFilter_Update(&temp_filter, raw_temp);
 	filtered_data->humidity = KalmanFilter_Update(&humi_filter, raw_humi);
@@ -280,12 +301,7 @@ uint8_t DHT_GetProcessedData(DHT_FilteredData_t *filtered_data)
 {
     uint8_t buffer[5] = {0};
     
-    // 如果滤波器未初始化，先初始化
-    if (!is_filter_initialized) {
-        DHT_Filter_Init();
-    }
-    
-    // 获取原始温湿度数据
+    // 获取原始温湿度数据，滤波器未初始化时由第一次有效读数初始化
     if (DHT_Get_Temp_Humi_Data(buffer)) {
         // 应用卡尔曼滤波处理数据
         return DHT_Get_Filtered_Data(buffer, filtered_data);
@@ -294,4 +310,35 @@ uint8_t DHT_GetProcessedData(DHT_FilteredData_t *filtered_data)
     return 0; // 采集失败
 }
 
+/**
+  * @brief  获取温湿度滤波器的当前状态
+  * @param  temp: 存放温度滤波器状态
+  * @param  humi: 存放湿度滤波器状态
+  * @retval 1:滤波器已由实际读数初始化 0:尚未读到数据
+  */
+uint8_t DHT_Filter_GetState(KalmanFilter_t *temp, KalmanFilter_t *humi)
+{
+	*temp = temp_filter;
+	*humi = humi_filter;
+	return is_filter_initialized;
+}
+
+/**
+  * @brief  用保存的状态恢复温湿度滤波器
+  * @param  temp: 温度估计值
+  * @param  temp_P: 温度估计误差协方差
+  * @param  humi: 湿度估计值
+  * @param  humi_P: 湿度估计误差协方差
+  * @param  steps: 保存后错过的采样次数
+  * @retval 无
+  * @note   不读取传感器，第一次采样直接进入已收敛的滤波器
+  */
+void DHT_Filter_Restore(double temp, double temp_P, double humi, double humi_P, uint32_t steps)
+{
+	DHT_Filter_Start(temp, humi);
+	KalmanFilter_Restore(&temp_filter, temp, temp_P, steps);
+	KalmanFilter_Restore(&humi_filter, humi, humi_P, steps);
+	is_filter_initialized = 1;
+}
+
 /* 文件结束 -----------------------------------------------------------------*/
@@ -28,6 +28,9 @@
 #define DHT_ERROR        0   // 读取失败
 #define DHT_TIMEOUT      2   // 通信超时
 
+/* 时序定义 ------------------------------------------------------------------*/
+#define DHT_POWER_ON_MS  1000    // 上电到DHT11可以应答的等待时间(ms)，期间不发起始信号
+
 /* 数据结构定义 --------------------------------------------------------------*/
 /**
   * @brief  DHT11滤波后的温湿度数据结构体
@@ -94,6 +97,25 @@ uint8_t DHT_Get_Filtered_Data(uint8_t buffer[], DHT_FilteredData_t *filtered_dat
   */
 uint8_t DHT_GetProcessedData(DHT_FilteredData_t *filtered_data);
 
+/**
+  * @brief  获取温湿度滤波器的当前状态
+  * @param  temp: 存放温度滤波器状态
+  * @param  humi: 存放湿度滤波器状态
+  * @retval 1:滤波器已由实际读数初始化 0:尚未读到数据，状态无意义
+  */
+uint8_t DHT_Filter_GetState(KalmanFilter_t *temp, KalmanFilter_t *humi);
+
+/**
+  * @brief  用保存的状态恢复温湿度滤波器，代替DHT_Filter_Init
+  * @param  temp: 温度估计值
+  * @param  temp_P: 温度估计误差协方差
+  * @param  humi: 湿度估计值
+  * @param  humi_P: 湿度估计误差协方差
+  * @param  steps: 保存后错过的采样次数
+  * @retval 无
+  */
+void DHT_Filter_Restore(double temp, double temp_P, double humi, double humi_P, uint32_t steps);
+
 #endif /* __DHT11_H */
 
 /* 文件结束 -----------------------------------------------------------------*/
@@ -10,25 +10,46 @@
 
 /* 包含头文件 ----------------------------------------------------------------*/
 #include "light.h"
+#include "Trace.h"
+#include "Prof.h"
+#include "Settings.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define AD_CHANNEL_COUNT    LIGHT_CHANNEL_COUNT     // 扫描的通道数，PA1、PA2
+#define AD_OVERSAMPLE       16      // 每个通道过采样次数，多出2位有效分辨率
+#define AD_SHIFT            2       // 累加和右移位数，结果为14位
+#define AD_FULL_SCALE       ((4095 * AD_OVERSAMPLE) >> AD_SHIFT)   // 过采样结果的满量程
 
 /* 私有变量 ------------------------------------------------------------------*/
 static KalmanFilter_t light_filter; // 光照传感器卡尔曼滤波器实例
 
+/* 扫描序列，序号与ad_buffer的列对应 */
+static const uint8_t ad_channels[AD_CHANNEL_COUNT] = { ADC_Channel_1, ADC_Channel_2 };
+
+/* DMA循环写入的转换结果，按扫描顺序交错存放，每行为一轮扫描 */
+static volatile uint16_t ad_buffer[AD_OVERSAMPLE][AD_CHANNEL_COUNT];
+
 /* 私有函数声明 --------------------------------------------------------------*/
 static void AD_Init(void);
+static void AD_Start(void);
 static uint16_t AD_GetValue(uint8_t ADC_Channel);
+static uint32_t AD_Sum(uint8_t rank);
 
 /* ADC模块 -------------------------------------------------------------------*/
 /**
   * @brief  ADC模块初始化
   * @param  无
   * @retval 无
-  * @note   配置ADC1和GPIOA的时钟，初始化ADC参数并执行校准
+  * @note   配置ADC1、DMA1和GPIOA的时钟，ADC1按扫描+连续模式依次转换各通道，
+  *          校准后启动，此后不再需要CPU参与
   */
 static void AD_Init(void)
 {
+    uint8_t rank;
+
     /* 时钟配置 */
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1 | RCC_APB2Periph_GPIOA, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
     RCC_ADCCLKConfig(RCC_PCLK2_Div6);  // 设置ADC时钟为PCLK2的6分频
 
     /* GPIO配置 */
@@ -42,33 +63,106 @@ static void AD_Init(void)
     /* ADC参数初始化 */
     ADC_InitTypeDef ADC_InitStruct = {
         .ADC_Mode               = ADC_Mode_Independent,     // 独立模式
-        .ADC_ScanConvMode       = DISABLE,                   // 非扫描模式
-        .ADC_ContinuousConvMode = DISABLE,                   // 单次转换模式
+        .ADC_ScanConvMode       = ENABLE,                    // 扫描模式
+        .ADC_ContinuousConvMode = ENABLE,                    // 连续转换模式
         .ADC_ExternalTrigConv   = ADC_ExternalTrigConv_None, // 软件触发
         .ADC_DataAlign          = ADC_DataAlign_Right,       // 数据右对齐
-        .ADC_NbrOfChannel       = 1                          // 转换通道数
+        .ADC_NbrOfChannel       = AD_CHANNEL_COUNT           // 转换通道数
     };
     ADC_Init(ADC1, &ADC_InitStruct);
 
+    /* 扫描序列：光敏电阻分压内阻较大，取最长的采样时间，72MHz时一轮扫描约42us */
+    for (rank = 0; rank < AD_CHANNEL_COUNT; rank++)
+        ADC_RegularChannelConfig(ADC1, ad_channels[rank], rank + 1, ADC_SampleTime_239Cycles5);
+
+    AD_Start();
+}
+
+/**
+  * @brief  校准ADC并启动连续扫描
+  * @param  无
+  * @retval 无
+  * @note   校准码在校准结束时写入ADC_DR，校准完成后才开启DMA请求，以免被
+  *          当作转换结果搬走。DMA1通道1按循环模式把结果依次写入ad_buffer，
+  *          写满一轮置位传输完成标志后回到开头
+  */
+static void AD_Start(void)
+{
+    DMA_InitTypeDef DMA_InitStruct = {
+        .DMA_PeripheralBaseAddr = (uint32_t)&ADC1->DR,
+        .DMA_MemoryBaseAddr     = (uint32_t)ad_buffer,
+        .DMA_DIR                = DMA_DIR_PeripheralSRC,            // ADC到内存
+        .DMA_BufferSize         = AD_CHANNEL_COUNT * AD_OVERSAMPLE,
+        .DMA_PeripheralInc      = DMA_PeripheralInc_Disable,
+        .DMA_MemoryInc          = DMA_MemoryInc_Enable,
+        .DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord,
+        .DMA_MemoryDataSize     = DMA_MemoryDataSize_HalfWord,
+        .DMA_Mode               = DMA_Mode_Circular,                // 循环模式
+        .DMA_Priority           = DMA_Priority_Low,
+        .DMA_M2M                = DMA_M2M_Disable
+    };
+
     /* 使能ADC并校准 */
     ADC_Cmd(ADC1, ENABLE);
     ADC_ResetCalibration(ADC1);
     while(ADC_GetResetCalibrationStatus(ADC1));  // 等待复位校准完成
     ADC_StartCalibration(ADC1);
     while(ADC_GetCalibrationStatus(ADC1));       // 等待校准完成
+
+    /* DMA配置 */
+    DMA_DeInit(DMA1_Channel1);
+    DMA_Init(DMA1_Channel1, &DMA_InitStruct);
+    DMA_Cmd(DMA1_Channel1, ENABLE);
+    ADC_DMACmd(ADC1, ENABLE);
+
+    ADC_SoftwareStartConvCmd(ADC1, ENABLE);      // 连续模式下启动一次后不再停止
 }
 
 /**
-  * @brief  获取指定通道的ADC值
-  * @param  ADC_Channel: ADC输入通道号
-  * @retval 12位ADC转换结果
+  * @brief  获取指定通道的过采样结果
+  * @param  ADC_Channel: ADC输入通道号，须在扫描序列中
+  * @retval 最近16次转换之和右移2位，14位结果（0~AD_FULL_SCALE）
+  * @note   直接累加DMA缓冲区，不等待转换。距上次读取DMA没有写满一轮（传输
+  *          完成标志未置位）时认为ADC已停止，重新校准并启动，本次仍返回缓冲区
+  *          中的旧值
   */
 static uint16_t AD_GetValue(uint8_t ADC_Channel)
 {
-    ADC_RegularChannelConfig(ADC1, ADC_Channel, 1, ADC_SampleTime_55Cycles5);
-    ADC_SoftwareStartConvCmd(ADC1, ENABLE);      // 启动转换
-    while(!ADC_GetFlagStatus(ADC1, ADC_FLAG_EOC)); // 等待转换完成
-    return ADC_GetConversionValue(ADC1);         // 自动清除EOC标志
+    uint32_t sum;
+    uint8_t rank;
+
+    for (rank = 0; rank < AD_CHANNEL_COUNT - 1; rank++)
+        if (ad_channels[rank] == ADC_Channel)
+            break;
+
+    PROF_BEGIN(PROF_ZONE_ADC);
+    if (DMA_GetFlagStatus(DMA1_FLAG_TC1) == RESET)
+    {
+        ADC_Cmd(ADC1, DISABLE);
+        DMA_Cmd(DMA1_Channel1, DISABLE);
+        AD_Start();
+    }
+    DMA_ClearFlag(DMA1_FLAG_TC1);
+    sum = AD_Sum(rank);
+    PROF_END(PROF_ZONE_ADC);
+
+    Trace_Adc(ADC_Channel, (uint16_t)sum);       // 记入采集轨迹
+    return (uint16_t)(sum >> AD_SHIFT);
+}
+
+/**
+  * @brief  累加DMA缓冲区中一个通道的转换结果
+  * @param  rank: 扫描序号
+  * @retval 最近16次转换之和
+  */
+static uint32_t AD_Sum(uint8_t rank)
+{
+    uint32_t sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < AD_OVERSAMPLE; i++)
+        sum += ad_buffer[i][rank];
+    return sum;
 }
 
 /* 光照传感器模块 -------------------------------------------------------------*/
@@ -76,43 +170,42 @@ static uint16_t AD_GetValue(uint8_t ADC_Channel)
   * @brief  光照传感器初始化
   * @param  无
   * @retval 无
-  * @note   执行ADC初始化并进行20次空读取稳定ADC
+  * @note   执行ADC初始化，等DMA写满一轮后读取初始值
   */
 void Light_Init(void)
 {
     AD_Init();
     
-    /* 进行20次空读取以稳定读数 */
-    uint8_t i;
-    for(i = 0; i < 20; i++) {
-        AD_GetValue(ADC_Channel_1);  // 通道1对应光照传感器
-    }
+    /* 等待缓冲区中都是有效的转换结果，72MHz时约0.7ms */
+    while(DMA_GetFlagStatus(DMA1_FLAG_TC1) == RESET);
     
-    /* 获取初始光照值用于初始化卡尔曼滤波器 */
+    /* 获取初始光照值用于初始化卡尔曼滤波器，通道1对应光照传感器 */
     uint16_t init_adc_value = AD_GetValue(ADC_Channel_1);
-    float init_light = 1000.0f - (init_adc_value / 4095.0f) * 1000.0f;
+    float init_light = 1000.0f - ((float)init_adc_value / AD_FULL_SCALE) * 1000.0f;
     
-    /* 初始化卡尔曼滤波器 
+    /* 初始化卡尔曼滤波器，噪声参数取自配置，默认值：
      * Q = 0.01: 较小的过程噪声，因为光照变化通常较为缓慢
      * R = 10.0: 较大的测量噪声，考虑到ADC读数可能有波动
      */
-    KalmanFilter_Init(&light_filter, (double)init_light, 0.01, 10.0);
+    KalmanFilter_Init(&light_filter, (double)init_light,
+                      Settings_Get()->kalman[SETTINGS_FILTER_LIGHT].Q,
+                      Settings_Get()->kalman[SETTINGS_FILTER_LIGHT].R);
 }
 
 /**
   * @brief  获取当前光照强度
   * @param  无
   * @retval 0-1000范围的光照强度值（0最暗，1000最亮）
-  * @note   转换公式假设ADC满量程对应反向比例关系
+  * @note   转换公式假设ADC满量程对应反向比例关系；读取DMA缓冲区，不等待转换
   */
 uint16_t Light_Get(void)
 {
     uint16_t adc_value = AD_GetValue(ADC_Channel_1);
     
     /* 将ADC值转换为光照强度：
-       - ADC满量程4095对应0光照
+       - 过采样满量程AD_FULL_SCALE对应0光照
        - ADC最小值0对应1000光照 */
-    float light_raw = 1000.0f - (adc_value / 4095.0f) * 1000.0f;
+    float light_raw = 1000.0f - ((float)adc_value / AD_FULL_SCALE) * 1000.0f;
     
     /* 使用卡尔曼滤波器处理光照数据 */
     double light_filtered = KalmanFilter_Update(&light_filter, (double)light_raw);
@@ -121,4 +214,40 @@ uint16_t Light_Get(void)
     return (uint16_t)(light_filtered + 0.5);
 }
 
+/**
+  * @brief  获取扫描序列中一个通道的过采样值
+  * @param  rank: 扫描序号，0~LIGHT_CHANNEL_COUNT-1
+  * @retval 14位过采样值（0~AD_FULL_SCALE），序号无效时为0
+  * @note   不检查ADC是否停止，也不记入采集轨迹：两次读取间隔不到一轮扫描时
+  *          会被误判为停止，这两项只在每个采样周期的Light_Get中做一次
+  */
+uint16_t Light_GetChannel(uint8_t rank)
+{
+    if (rank >= AD_CHANNEL_COUNT)
+        return 0;
+    return (uint16_t)(AD_Sum(rank) >> AD_SHIFT);
+}
+
+/**
+  * @brief  获取光照滤波器的当前状态
+  * @param  filter: 存放滤波器状态
+  * @retval 无
+  */
+void Light_Filter_GetState(KalmanFilter_t *filter)
+{
+    *filter = light_filter;
+}
+
+/**
+  * @brief  用保存的状态恢复光照滤波器
+  * @param  x: 光照估计值
+  * @param  P: 估计误差协方差
+  * @param  steps: 保存后错过的采样次数
+  * @retval 无
+  */
+void Light_Filter_Restore(double x, double P, uint32_t steps)
+{
+    KalmanFilter_Restore(&light_filter, x, P, steps);
+}
+
 /* 文件结束 -----------------------------------------------------------------*/
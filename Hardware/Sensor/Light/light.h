@@ -16,6 +16,9 @@
 #include <stdint.h>
 #include "kalman.h"
 
+/* 宏定义 --------------------------------------------------------------------*/
+#define LIGHT_CHANNEL_COUNT     2       // ADC扫描的通道数，序号0为PA1（光照），1为PA2
+
 /* 函数声明 ------------------------------------------------------------------*/
 /**
   * @brief  光照传感器模块初始化
@@ -31,6 +34,31 @@ void Light_Init(void);
   */
 uint16_t Light_Get(void);
 
+/**
+  * @brief  获取扫描序列中一个通道的过采样值
+  * @param  rank: 扫描序号，0~LIGHT_CHANNEL_COUNT-1
+  * @retval 14位过采样值（0~16380），序号无效时为0
+  * @note   只读取DMA缓冲区，ADC停止的检测和重启由Light_Get负责
+  */
+uint16_t Light_GetChannel(uint8_t rank);
+
+/**
+  * @brief  获取光照滤波器的当前状态
+  * @param  filter: 存放滤波器状态
+  * @retval 无
+  */
+void Light_Filter_GetState(KalmanFilter_t *filter);
+
+/**
+  * @brief  用保存的状态恢复光照滤波器
+  * @param  x: 光照估计值
+  * @param  P: 估计误差协方差
+  * @param  steps: 保存后错过的采样次数
+  * @retval 无
+  * @note   须在Light_Init之后调用
+  */
+void Light_Filter_Restore(double x, double P, uint32_t steps);
+
 #endif /* LIGHT_H_ */
 
 /* 文件结束 -----------------------------------------------------------------*/
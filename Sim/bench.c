@@ -0,0 +1,584 @@
+/**
+  ******************************************************************************
+  * @file    bench.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   固件热点函数的主机基准测试
+  * @note    与仿真链接同一批固件目标文件，不做任何修改，逐个计时：
+  *          卡尔曼更新、DHT11小数解码+滤波、上传JSON拼接、HTTP应答解析、
+  *          OLED字符串刷新、报警判定、历史数据写入、窗口统计累计与汇总拼接、
+  *          批量上传的压缩拼接、
+  *          启动时载入Flash配置、解析服务器下发的配置，以及各时钟档位之间的
+  *          切换。每项先预热，
+  *          再采集多组样本，输出最小/中位/平均/P90/最大值和标准差；涉及外设
+  *          的项目同时给出按仿真外设耗时估算的目标板时间和MCU消耗的电荷。
+  *          结果可写成JSON，并与上一次的结果比较
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "App/app.h"
+#include "Kalman.h"
+#include "DHT11.h"
+#include "OLED.h"
+#include "ESP8266.h"
+#include "Alarm.h"
+#include "Tick.h"
+#include "Clock.h"
+#include "Settings.h"
+#include "Remote.h"
+#include "History.h"
+#include "Aggregate.h"
+#include "Batch.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define BENCH_WARMUP        50      // 预热样本数，不计入结果
+#define BENCH_MAX_SAMPLES   10000
+#define BENCH_MAX_CASES     16
+#define BENCH_EPOCH         1792281600UL    // 2026-10-18 00:00:00 UTC，十位数的时间戳
+
+/* 私有类型 ------------------------------------------------------------------*/
+/**
+  * @brief  一个基准项目
+  */
+typedef struct {
+    const char *name;
+    void (*setup)(void);        // 每组样本前调用，不计时，可为NULL
+    void (*run)(uint32_t i);    // 被测调用，i为本组内的序号
+    uint32_t batch;             // 每组样本连续调用的次数
+} BenchCase_t;
+
+/**
+  * @brief  一个项目的统计结果（单位：每次调用的主机纳秒数）
+  */
+typedef struct {
+    double min, median, mean, p90, max, stddev;
+    double target_us;           // 每次调用消耗的虚拟时间，即估算的目标板耗时
+    double target_uc;           // 每次调用MCU消耗的电荷(uC)
+} BenchResult_t;
+
+/* 仿真运行参数（基准测试不解析仿真参数，使用默认环境） ----------------------*/
+SimConfig_t Sim_Config = {
+    .uart        = "model",
+    .oled        = "none",
+    .temperature = 25.0,
+    .humidity    = 55.0,
+    .lux         = 500.0,
+    .env         = "const",
+    .seed        = 1,
+};
+
+void Sim_Finish(void)
+{
+    exit(0);
+}
+
+/* 固件中未在头文件声明的函数 ------------------------------------------------*/
+void Serial_Init(void);
+
+/* 测试输入 ------------------------------------------------------------------*/
+static KalmanFilter_t kalman;
+static double kalman_input[256];        // 25℃附近缓慢变化并带噪声的温度
+static uint8_t dht_frames[64][5];       // 覆盖各种小数位的原始帧
+static float payload_temp[64];
+static float payload_humi[64];
+static uint16_t payload_light[64];
+static int16_t alarm_values[64][ALARM_CH_COUNT];
+static uint32_t alarm_now_ms;
+static uint32_t history_now_ms;
+static AggregateWindow_t summary_window;
+static char sink[APP_PAYLOAD_SIZE];     // 防止编译器省略被测调用
+static volatile double sink_value;
+static uint32_t http_code;
+
+static char *const oled_lines[4] = {
+    "Lux: 512        ", "T:25.3C      HI!", "H:61.8%         ", "send: 200       "
+};
+
+/* 模块自带ESP8266模型返回的HTTP应答头 */
+static const char http_response[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 16\r\n"
+    "Date: Sun, 18 Oct 2026 08:00:00 GMT\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "{\"status\": \"ok\"}";
+
+/* 服务器下发的配置，第一次应用后编号相同，不再写Flash */
+static const char remote_body[] =
+    "{\"cfg\": 7, \"period\": 1000, \"upload\": 60000, \"t_lo\": 100, \"t_hi\": 320, "
+    "\"t_db\": 10, \"h_db\": 30, \"buzzer\": 1}";
+
+static void Bench_InitInputs(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < 256; i++)
+        kalman_input[i] = 25.0 + 2.0 * sin(i / 40.0) + ((int32_t)(Sim_Rand() % 201) - 100) / 100.0;
+
+    for (i = 0; i < 64; i++)
+    {
+        uint8_t *f = dht_frames[i];
+        f[0] = (uint8_t)(40 + Sim_Rand() % 50);
+        f[1] = (uint8_t)(Sim_Rand() % 10);
+        f[2] = (uint8_t)(15 + Sim_Rand() % 20);
+        f[3] = (uint8_t)(Sim_Rand() % 10);
+        f[4] = (uint8_t)(f[0] + f[1] + f[2] + f[3]);
+
+        payload_temp[i] = 15.0f + (Sim_Rand() % 250) / 10.0f;
+        payload_humi[i] = 40.0f + (Sim_Rand() % 500) / 10.0f;
+        payload_light[i] = (uint16_t)(Sim_Rand() % 1001);
+
+        alarm_values[i][ALARM_CH_TEMP] = (int16_t)(payload_temp[i] * 10);
+        alarm_values[i][ALARM_CH_HUMI] = (int16_t)(payload_humi[i] * 10);
+        alarm_values[i][ALARM_CH_LIGHT] = (int16_t)(payload_light[i] * 10);
+    }
+}
+
+/* 被测调用 ------------------------------------------------------------------*/
+static void Bench_Kalman(uint32_t i)
+{
+    sink_value = KalmanFilter_Update(&kalman, kalman_input[i & 255]);
+}
+
+static void Bench_DhtDecode(uint32_t i)
+{
+    DHT_FilteredData_t out;
+
+    DHT_Get_Filtered_Data(dht_frames[i & 63], &out);
+    sink_value = out.temperature;
+}
+
+static void Bench_Payload(uint32_t i)
+{
+    App_FormatPayload(sink, payload_temp[i & 63], payload_humi[i & 63], payload_light[i & 63],
+                      BENCH_EPOCH + i);
+}
+
+static void Bench_AggregateAdd(uint32_t i)
+{
+    Aggregate_Add(alarm_values[i & 63], i * 1000, BENCH_EPOCH + i);
+}
+
+/* 一个5分钟窗口：300个采样累计后的统计量 */
+static void Bench_SummarySetup(void)
+{
+    uint32_t i;
+    int ch;
+
+    memset(&summary_window, 0, sizeof(summary_window));
+    summary_window.epoch = BENCH_EPOCH;
+    summary_window.length_ms = 300000;
+    for (i = 0; i < 300; i++)
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            Aggregate_Update(&summary_window.ch[ch], alarm_values[i & 63][ch]);
+}
+
+static void Bench_Summary(uint32_t i)
+{
+    (void)i;
+    App_FormatSummary(sink, &summary_window);
+}
+
+/* 队列中1分钟的采样，按位压缩后拼接 */
+static void Bench_BatchSetup(void)
+{
+    uint32_t i;
+
+    Batch_Remove(Batch_GetCount(), 0);
+    for (i = 0; i < 60; i++)
+        Batch_Add(BENCH_EPOCH + i, alarm_values[i]);
+}
+
+static void Bench_Batch(uint32_t i)
+{
+    uint16_t count;
+    int bytes;
+
+    (void)i;
+    App_FormatBatch(sink, BATCH_FLAG_BITPACK, &count, &bytes);
+}
+
+static void Bench_HttpSetup(void)
+{
+    const char *p;
+
+    for (p = http_response; *p; p++)
+        Sim_Usart1_Inject((uint8_t)*p);
+}
+
+static void Bench_HttpParse(uint32_t i)
+{
+    (void)i;
+    Remote_Begin();
+    if (!ESP8266_Receive_http_response(&http_code, Remote_Feed) || http_code != 200)
+    {
+        fprintf(stderr, "[bench] http_response_parse: unexpected result %u\n", http_code);
+        exit(1);
+    }
+}
+
+static void Bench_RemoteParse(uint32_t i)
+{
+    const char *p;
+    RemoteResult_t result;
+
+    (void)i;
+    Remote_Begin();
+    for (p = remote_body; *p; p++)
+        Remote_Feed((uint8_t)*p);
+    result = Remote_End();
+    if (result != REMOTE_APPLIED && result != REMOTE_UNCHANGED)
+    {
+        fprintf(stderr, "[bench] remote_config_parse: unexpected result %d\n", result);
+        exit(1);
+    }
+}
+
+static void Bench_OledString(uint32_t i)
+{
+    OLED_ShowString((uint8_t)(1 + (i & 3)), 1, oled_lines[i & 3]);
+}
+
+static void Bench_Alarm(uint32_t i)
+{
+    alarm_now_ms += 1000;
+    sink_value = Alarm_Evaluate(alarm_values[i & 63], alarm_now_ms);
+}
+
+/* 按1s节拍写入，每60次和900次分别存入一格分钟和刻钟汇总 */
+static void Bench_History(uint32_t i)
+{
+    history_now_ms += 1000;
+    History_Add(alarm_values[i & 63], history_now_ms);
+}
+
+static void Bench_ClockFull(void)
+{
+    Clock_SetProfile(CLOCK_PROFILE_FULL);
+}
+
+static void Bench_ClockHalf(void)
+{
+    Clock_SetProfile(CLOCK_PROFILE_HALF);
+}
+
+static void Bench_ClockLow(void)
+{
+    Clock_SetProfile(CLOCK_PROFILE_LOW);
+}
+
+static void Bench_ToFull(uint32_t i)
+{
+    (void)i;
+    Clock_SetProfile(CLOCK_PROFILE_FULL);
+}
+
+static void Bench_ToHalf(uint32_t i)
+{
+    (void)i;
+    Clock_SetProfile(CLOCK_PROFILE_HALF);
+}
+
+static void Bench_ToLow(uint32_t i)
+{
+    (void)i;
+    Clock_SetProfile(CLOCK_PROFILE_LOW);
+}
+
+/* Stop醒来时的时钟状态：HSI 8MHz，HSE和PLL关闭 */
+static void Bench_StopWakeSetup(void)
+{
+    Clock_SetProfile(CLOCK_PROFILE_FULL);
+    Sim_Rcc_StopWake();
+}
+
+static void Bench_StopWake(uint32_t i)
+{
+    (void)i;
+    Clock_Restore();
+}
+
+/* 两页都写有记录，载入时两页都要校验 */
+static void Bench_SettingsSetup(void)
+{
+    static uint8_t saved = 0;
+    Settings_t s;
+
+    if (saved)
+        return;
+    saved = 1;
+    s = *Settings_GetDefault();
+    s.upload_interval_ms = 60000;
+    Settings_Save(&s);
+    s.upload_interval_ms = 30000;
+    Settings_Save(&s);
+}
+
+static void Bench_SettingsLoad(uint32_t i)
+{
+    (void)i;
+    Settings_Init();
+}
+
+static const BenchCase_t bench_cases[] = {
+    { "kalman_update",       NULL,            Bench_Kalman,     1000 },
+    { "dht_decode_filter",   NULL,            Bench_DhtDecode,  1000 },
+    { "payload_format",      NULL,            Bench_Payload,    100  },
+    { "summary_format",      Bench_SummarySetup, Bench_Summary, 100  },
+    { "batch_format",        Bench_BatchSetup, Bench_Batch,     100  },
+    { "http_response_parse", Bench_HttpSetup, Bench_HttpParse,  1    },
+    { "remote_config_parse", NULL,            Bench_RemoteParse, 100 },
+    { "oled_show_string",    NULL,            Bench_OledString, 4    },
+    { "alarm_evaluate",      NULL,            Bench_Alarm,      1000 },
+    { "history_add",         NULL,            Bench_History,    1000 },
+    { "aggregate_add",       NULL,            Bench_AggregateAdd, 1000 },
+    { "clock_full_to_half",  Bench_ClockFull, Bench_ToHalf,     1    },
+    { "clock_half_to_full",  Bench_ClockHalf, Bench_ToFull,     1    },
+    { "clock_full_to_low",   Bench_ClockFull, Bench_ToLow,      1    },
+    { "clock_low_to_full",   Bench_ClockLow,  Bench_ToFull,     1    },
+    { "clock_half_to_low",   Bench_ClockHalf, Bench_ToLow,      1    },
+    { "clock_low_to_half",   Bench_ClockLow,  Bench_ToHalf,     1    },
+    { "clock_stop_wake",     Bench_StopWakeSetup, Bench_StopWake, 1  },
+    { "settings_load",       Bench_SettingsSetup, Bench_SettingsLoad, 1 },
+};
+#define BENCH_CASE_COUNT    (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+/* 计时与统计 ----------------------------------------------------------------*/
+static uint64_t Bench_NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int Bench_CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+  * @brief  运行一个项目
+  * @param  bc: 项目
+  * @param  samples: 样本组数
+  * @param  res: 输出结果
+  * @retval 无
+  */
+static void Bench_Run(const BenchCase_t *bc, uint32_t samples, BenchResult_t *res)
+{
+    static double ns[BENCH_MAX_SAMPLES];
+    uint64_t virt_ns = 0;
+    double sum = 0, sq = 0, charge = 0;
+    uint32_t s, k;
+
+    for (s = 0; s < BENCH_WARMUP + samples; s++)
+    {
+        const SimClockStats_t *rcc;
+        uint64_t t0, t1, v0;
+        double c0;
+
+        if (bc->setup)
+            bc->setup();
+        rcc = Sim_Rcc_GetStats();
+        c0 = rcc->run_mas + rcc->sleep_mas + rcc->stop_mas;
+        v0 = Sim_NowNs();
+        t0 = Bench_NowNs();
+        for (k = 0; k < bc->batch; k++)
+            bc->run(k);
+        t1 = Bench_NowNs();
+        if (s < BENCH_WARMUP)
+            continue;
+        virt_ns += Sim_NowNs() - v0;
+        rcc = Sim_Rcc_GetStats();
+        charge += rcc->run_mas + rcc->sleep_mas + rcc->stop_mas - c0;
+        ns[s - BENCH_WARMUP] = (double)(t1 - t0) / bc->batch;
+    }
+
+    for (s = 0; s < samples; s++)
+    {
+        sum += ns[s];
+        sq += ns[s] * ns[s];
+    }
+    qsort(ns, samples, sizeof(ns[0]), Bench_CompareDouble);
+    res->min = ns[0];
+    res->max = ns[samples - 1];
+    res->median = ns[samples / 2];
+    res->p90 = ns[samples * 9 / 10];
+    res->mean = sum / samples;
+    res->stddev = sqrt(sq / samples - res->mean * res->mean > 0 ? sq / samples - res->mean * res->mean : 0);
+    res->target_us = (double)virt_ns / 1000.0 / ((double)samples * bc->batch);
+    res->target_uc = charge * 1000.0 / ((double)samples * bc->batch);     // mA*s = mC
+}
+
+/**
+  * @brief  从上一次的JSON结果中查找某项的中位数
+  * @retval 中位数(ns)，未找到时为负数
+  */
+static double Bench_LoadBaseline(const char *path, const char *name)
+{
+    FILE *fp = fopen(path, "r");
+    char line[512], key[64];
+    double median;
+
+    if (fp == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), fp))
+    {
+        const char *p = strstr(line, "\"name\": \"");
+        const char *m = strstr(line, "\"median_ns\": ");
+        if (p && m && sscanf(p, "\"name\": \"%63[^\"]\"", key) == 1 &&
+            strcmp(key, name) == 0 && sscanf(m, "\"median_ns\": %lf", &median) == 1)
+        {
+            fclose(fp);
+            return median;
+        }
+    }
+    fclose(fp);
+    return -1;
+}
+
+static void Bench_Usage(const char *prog)
+{
+    printf("usage: %s [options]\n"
+           "  --samples=N        timed samples per benchmark (default: 200)\n"
+           "  --filter=TEXT      only run benchmarks whose name contains TEXT\n"
+           "  --json=FILE        write results as JSON\n"
+           "  --compare=FILE     compare medians with a previous JSON result\n"
+           "  --threshold=PCT    exit with 1 if a median is PCT%% slower than the baseline (default: 10)\n",
+           prog);
+}
+
+/**
+  * @brief  基准测试主函数
+  */
+int main(int argc, char *argv[])
+{
+    static const struct option options[] = {
+        { "samples",   required_argument, NULL, 'n' },
+        { "filter",    required_argument, NULL, 'f' },
+        { "json",      required_argument, NULL, 'j' },
+        { "compare",   required_argument, NULL, 'c' },
+        { "threshold", required_argument, NULL, 't' },
+        { "help",      no_argument,       NULL, '?' },
+        { NULL, 0, NULL, 0 }
+    };
+    BenchResult_t results[BENCH_MAX_CASES];
+    uint32_t samples = 200;
+    const char *filter = NULL, *json = NULL, *compare = NULL;
+    double threshold = 10.0;
+    int regressions = 0;
+    uint32_t i, ran = 0;
+    FILE *fp = NULL;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "", options, NULL)) != -1)
+    {
+        switch (c)
+        {
+        case 'n': samples = (uint32_t)atoi(optarg); break;
+        case 'f': filter = optarg; break;
+        case 'j': json = optarg; break;
+        case 'c': compare = optarg; break;
+        case 't': threshold = atof(optarg); break;
+        default:
+            Bench_Usage(argv[0]);
+            return 2;
+        }
+    }
+    if (samples < 1 || samples > BENCH_MAX_SAMPLES)
+    {
+        fprintf(stderr, "[bench] --samples must be 1..%d\n", BENCH_MAX_SAMPLES);
+        return 2;
+    }
+
+    /* 与仿真相同的初始化顺序，被测函数依赖的模块状态均已就绪 */
+    Sim_RandSeed(Sim_Config.seed);
+    Sim_Env_Open(Sim_Config.env);
+    Sim_Uart_Open(Sim_Config.uart);
+    Sim_Flash_Init();
+    Sim_ClockInit();
+    SystemInit();
+    Clock_Init();
+    Tick_Init();
+    Serial_Init();
+    Settings_Init();
+    OLED_Init();
+    DHT_Filter_Init();
+    Alarm_Init();
+    KalmanFilter_Init(&kalman, 25.0, 0.02, 1.0);
+    Bench_InitInputs();
+
+    if (json && (fp = fopen(json, "w")) == NULL)
+    {
+        fprintf(stderr, "[bench] cannot write %s\n", json);
+        return 1;
+    }
+    if (fp)
+        fprintf(fp, "{\n  \"samples\": %u,\n  \"compiler\": \"%s\",\n  \"benchmarks\": [\n",
+                samples, __VERSION__);
+
+    printf("%-20s %10s %10s %10s %10s %10s %12s %10s%s\n", "benchmark", "min ns", "median", "p90",
+           "max", "stddev", "target us", "target uC", compare ? "   vs base" : "");
+    for (i = 0; i < BENCH_CASE_COUNT; i++)
+    {
+        const BenchCase_t *bc = &bench_cases[i];
+        BenchResult_t *r = &results[i];
+
+        if (filter && strstr(bc->name, filter) == NULL)
+            continue;
+        Bench_Run(bc, samples, r);
+
+        printf("%-20s %10.1f %10.1f %10.1f %10.1f %10.1f", bc->name, r->min, r->median,
+               r->p90, r->max, r->stddev);
+        if (r->target_us > 0)
+            printf(" %12.3f %10.4f", r->target_us, r->target_uc);
+        else
+            printf(" %12s %10s", "-", "-");     // 纯计算，仿真不计CPU周期
+        if (compare)
+        {
+            double base = Bench_LoadBaseline(compare, bc->name);
+            if (base > 0)
+            {
+                double pct = (r->median - base) / base * 100.0;
+                printf("   %+7.1f%%%s", pct, pct > threshold ? " !" : "");
+                regressions += pct > threshold;
+            }
+            else
+            {
+                printf("        new");
+            }
+        }
+        printf("\n");
+
+        if (fp)
+            fprintf(fp, "%s    {\"name\": \"%s\", \"batch\": %u, \"min_ns\": %.1f, \"median_ns\": %.1f, "
+                        "\"mean_ns\": %.1f, \"p90_ns\": %.1f, \"max_ns\": %.1f, \"stddev_ns\": %.1f, "
+                        "\"target_us\": %.3f, \"target_uc\": %.4f}",
+                    ran ? ",\n" : "", bc->name, bc->batch, r->min, r->median, r->mean, r->p90,
+                    r->max, r->stddev, r->target_us, r->target_uc);
+        ran++;
+    }
+
+    if (fp)
+    {
+        fprintf(fp, "\n  ]\n}\n");
+        fclose(fp);
+    }
+    if (regressions)
+        printf("[bench] %d benchmark(s) more than %.0f%% slower than %s\n", regressions, threshold, compare);
+    return regressions ? 1 : 0;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
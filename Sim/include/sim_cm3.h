@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file    sim_cm3.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主机仿真用Cortex-M3内核定义
+  * @note    替代Start/core_cm3.h：保留固件用到的寄存器结构体和位定义，
+  *          内核寄存器映射到仿真内存，内联汇编指令改为仿真函数
+  ******************************************************************************
+  */
+
+#ifndef __SIM_CM3_H
+#define __SIM_CM3_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include <stdint.h>
+
+/* 编译器相关定义 ------------------------------------------------------------*/
+#define __ASM            __asm
+#define __INLINE         inline
+
+#define __I     volatile const
+#define __O     volatile
+#define __IO    volatile
+
+/* 内核寄存器结构体（与core_cm3.h一致） --------------------------------------*/
+typedef struct
+{
+  __IO uint32_t ISER[8];
+       uint32_t RESERVED0[24];
+  __IO uint32_t ICER[8];
+       uint32_t RSERVED1[24];
+  __IO uint32_t ISPR[8];
+       uint32_t RESERVED2[24];
+  __IO uint32_t ICPR[8];
+       uint32_t RESERVED3[24];
+  __IO uint32_t IABR[8];
+       uint32_t RESERVED4[56];
+  __IO uint8_t  IP[240];
+       uint32_t RESERVED5[644];
+  __O  uint32_t STIR;
+} NVIC_Type;
+
+typedef struct
+{
+  __I  uint32_t CPUID;
+  __IO uint32_t ICSR;
+  __IO uint32_t VTOR;
+  __IO uint32_t AIRCR;
+  __IO uint32_t SCR;
+  __IO uint32_t CCR;
+  __IO uint8_t  SHP[12];
+  __IO uint32_t SHCSR;
+  __IO uint32_t CFSR;
+  __IO uint32_t HFSR;
+  __IO uint32_t DFSR;
+  __IO uint32_t MMFAR;
+  __IO uint32_t BFAR;
+  __IO uint32_t AFSR;
+  __I  uint32_t PFR[2];
+  __I  uint32_t DFR;
+  __I  uint32_t ADR;
+  __I  uint32_t MMFR[4];
+  __I  uint32_t ISAR[5];
+} SCB_Type;
+
+typedef struct
+{
+  __IO uint32_t CTRL;
+  __IO uint32_t LOAD;
+  __IO uint32_t VAL;
+  __I  uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+  __IO uint32_t DHCSR;
+  __O  uint32_t DCRSR;
+  __IO uint32_t DCRDR;
+  __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/* 位定义 --------------------------------------------------------------------*/
+#define SCB_AIRCR_VECTKEY_Pos              16
+#define SCB_AIRCR_VECTKEY_Msk              (0xFFFFul << SCB_AIRCR_VECTKEY_Pos)
+#define SCB_AIRCR_PRIGROUP_Pos              8
+#define SCB_AIRCR_PRIGROUP_Msk             (7ul << SCB_AIRCR_PRIGROUP_Pos)
+#define SCB_AIRCR_SYSRESETREQ_Pos           2
+#define SCB_AIRCR_SYSRESETREQ_Msk          (1ul << SCB_AIRCR_SYSRESETREQ_Pos)
+
+#define SCB_SCR_SEVONPEND_Pos               4
+#define SCB_SCR_SEVONPEND_Msk              (1ul << SCB_SCR_SEVONPEND_Pos)
+#define SCB_SCR_SLEEPDEEP_Pos               2
+#define SCB_SCR_SLEEPDEEP_Msk              (1ul << SCB_SCR_SLEEPDEEP_Pos)
+#define SCB_SCR_SLEEPONEXIT_Pos             1
+#define SCB_SCR_SLEEPONEXIT_Msk            (1ul << SCB_SCR_SLEEPONEXIT_Pos)
+
+#define SysTick_CTRL_COUNTFLAG_Pos         16
+#define SysTick_CTRL_COUNTFLAG_Msk         (1ul << SysTick_CTRL_COUNTFLAG_Pos)
+#define SysTick_CTRL_CLKSOURCE_Pos          2
+#define SysTick_CTRL_CLKSOURCE_Msk         (1ul << SysTick_CTRL_CLKSOURCE_Pos)
+#define SysTick_CTRL_TICKINT_Pos            1
+#define SysTick_CTRL_TICKINT_Msk           (1ul << SysTick_CTRL_TICKINT_Pos)
+#define SysTick_CTRL_ENABLE_Pos             0
+#define SysTick_CTRL_ENABLE_Msk            (1ul << SysTick_CTRL_ENABLE_Pos)
+#define SysTick_LOAD_RELOAD_Pos             0
+#define SysTick_LOAD_RELOAD_Msk            (0xFFFFFFul << SysTick_LOAD_RELOAD_Pos)
+
+#define CoreDebug_DEMCR_TRCENA_Pos         24
+#define CoreDebug_DEMCR_TRCENA_Msk         (1ul << CoreDebug_DEMCR_TRCENA_Pos)
+
+/* 内核寄存器实例：映射到仿真内存 ------------------------------------------*/
+extern NVIC_Type      Sim_NVIC;
+extern SCB_Type       Sim_SCB;
+extern SysTick_Type   Sim_SysTick;
+extern CoreDebug_Type Sim_CoreDebug;
+
+#define NVIC          (&Sim_NVIC)
+#define SCB           (&Sim_SCB)
+#define SysTick       (&Sim_SysTick)
+#define CoreDebug     (&Sim_CoreDebug)
+
+/* DWT周期计数器：读取时按虚拟时间和SystemCoreClock折算，写入的值作为新的起点 */
+extern uint32_t Sim_DwtCtrl;
+uint32_t *Sim_DwtCyccnt(void);
+
+#define DWT_CTRL      Sim_DwtCtrl
+#define DWT_CYCCNT    (*Sim_DwtCyccnt())
+
+/* 内核指令 ------------------------------------------------------------------*/
+void Sim_IrqDisable(void);
+void Sim_IrqEnable(void);
+void Sim_WaitForInterrupt(void);
+void Sim_SystemReset(void);
+
+#define __enable_irq()      Sim_IrqEnable()
+#define __disable_irq()     Sim_IrqDisable()
+#define __WFI()             Sim_WaitForInterrupt()
+#define __WFE()             Sim_WaitForInterrupt()
+#define __SEV()             ((void)0)
+#define __NOP()             ((void)0)
+#define __ISB()             __asm volatile ("" ::: "memory")
+#define __DSB()             __asm volatile ("" ::: "memory")
+#define __DMB()             __asm volatile ("" ::: "memory")
+
+static inline void NVIC_SystemReset(void)
+{
+    Sim_SystemReset();
+}
+
+#endif /* __SIM_CM3_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
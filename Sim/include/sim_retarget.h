@@ -0,0 +1,22 @@
+/**
+  ******************************************************************************
+  * @file    sim_retarget.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主机仿真用printf重定向
+  * @note    编译固件源文件时通过-include强制包含。目标板上printf经Keil库
+  *          调用用户实现的fputc发往USART1，主机C库不会这样做，因此把固件中的
+  *          printf和fputc改名，由仿真层按目标板的方式转发到串口
+  ******************************************************************************
+  */
+
+#ifndef __SIM_RETARGET_H
+#define __SIM_RETARGET_H
+
+#define printf  Sim_Printf
+#define fputc   Sim_Fputc
+
+#endif /* __SIM_RETARGET_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,24 @@
+/**
+  ******************************************************************************
+  * @file    stm32f10x.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主机仿真用设备头文件
+  * @note    仿真构建时位于包含路径最前面，先载入主机版内核定义并屏蔽
+  *          core_cm3.h，再包含Start/stm32f10x.h，外设类型和常量与目标板一致
+  ******************************************************************************
+  */
+
+#ifndef __SIM_STM32F10X_H
+#define __SIM_STM32F10X_H
+
+#include "sim_cm3.h"
+
+#define __CM3_CORE_H__      /* core_cm3.h含ARM内联汇编，主机上由sim_cm3.h代替 */
+
+#include "../../Start/stm32f10x.h"
+
+#endif /* __SIM_STM32F10X_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,256 @@
+/**
+  ******************************************************************************
+  * @file    sim.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主机仿真内部接口
+  * @note    仿真层用虚拟时钟驱动全部外设模型：固件调用延时或外设函数时
+  *          推进虚拟时间，途经的定时器溢出、串口接收等事件按时刻依次
+  *          调用固件的中断处理函数
+  ******************************************************************************
+  */
+
+#ifndef __SIM_H
+#define __SIM_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  仿真运行参数
+  */
+typedef struct {
+    uint64_t duration_ms;       // 运行的虚拟时长，0表示一直运行
+    uint8_t  realtime;          // 1:虚拟时间与墙钟同步 0:尽快运行
+    uint8_t  verbose;           // 打印串口收发内容
+    const char *uart;           // 串口后端："model" / "pty" / "tcp:主机:端口"
+    const char *oled;           // OLED输出："none" / "term"
+    const char *oled_png;       // 退出时保存OLED画面的PNG路径，可为NULL
+    double   temperature;       // 环境温度(℃)
+    double   humidity;          // 环境湿度(%RH)
+    double   lux;               // 环境光照(0~1000)
+    const char *env;            // 环境波形："const" / "diurnal" / 脚本文件
+    uint64_t seed;              // 随机数种子
+    const char *json;           // 退出时写入统计结果的JSON路径，可为NULL
+    const char *trace;          // 保存固件采集轨迹的路径，可为NULL
+    const char *replay;         // 回放的采集轨迹路径，可为NULL
+    uint8_t  oled_decode;       // 是否需要解码OLED画面（无输出时跳过以加速）
+
+    /* 网络故障模型 */
+    uint32_t net_latency_ms;    // HTTP应答延迟
+    uint32_t net_jitter_ms;     // 延迟的随机抖动上限
+    double   net_drop;          // 每个请求丢失应答的概率
+    double   net_close;         // 每个请求后服务器断开TCP的概率
+    double   net_reset;         // 每个请求后模块自行重启的概率
+    uint32_t outage_period_s;   // WiFi断线周期，0表示不断线
+    uint32_t outage_len_s;      // 每次断线持续时间
+
+    /* 服务器下发配置 */
+    const char *push;           // 应答体中下发的配置JSON，可为NULL
+    uint64_t push_at_ms;        // 从此时刻起下发，直到上传中回报了同一编号
+
+    /* 时间 */
+    uint32_t epoch;             // 虚拟时间0对应的Unix时间(s)，服务器Date头按此给出
+    int32_t  rtc_ppm;           // RTC时钟（LSE）相对标称值的偏差，正值为偏快
+
+    /* 复位与故障注入 */
+    const char *bkp;            // 备份域文件，启动时载入、退出时保存，可为NULL
+    const char *flash;          // Flash映像文件，启动时载入、退出时保存，可为NULL
+    uint64_t adc_hang_ms;       // 此后ADC不再转换、校准不再结束，0表示不注入
+} SimConfig_t;
+
+/**
+  * @brief  ESP8266模型统计
+  */
+typedef struct {
+    uint32_t requests;          // 收到的HTTP请求
+    uint32_t responses;         // 返回的HTTP应答
+    uint32_t dropped;           // 注入丢失
+    uint32_t lost;              // 链路断开时发出、未到达服务器的字节
+    uint32_t closes;            // 注入的TCP断开
+    uint32_t resets;            // 注入的模块重启
+    uint32_t outages;           // WiFi断线次数
+    uint32_t at_commands;       // 处理的AT指令
+    uint32_t power_ups;         // CH_PD拉高的次数
+    uint64_t on_ns;             // 模块上电时长
+    double   charge_mas;        // 模块耗电(mA·s)
+    uint32_t pushes;            // 带下发配置的应答
+    uint8_t  push_acked;        // 上传中已回报下发的配置编号
+    uint64_t push_ack_ns;       // 第一次回报的时刻
+    uint32_t summaries;         // 收到的窗口汇总
+    uint32_t summarized;        // 汇总覆盖的采样数
+    uint32_t http_bytes;        // 服务器收到的HTTP请求字节，含请求头
+    uint32_t batches;           // 收到的批量上传
+    uint32_t batched;           // 批量上传中核对一致的采样数
+    uint32_t batch_bytes;       // 核对一致的批量上传的请求字节，含请求头
+    uint32_t batch_errors;      // 解码失败、采样数与"n"不符或有采样与固件数据不符的上传
+    uint32_t batch_mismatched;  // 与固件数据不符的采样
+    uint32_t backfills;         // 收到的补传，即带"res"的批量上传
+    uint32_t backfilled;        // 补传中核对一致的格数
+    uint32_t event_uploads;     // 只含报警事件的上传
+    uint32_t events;            // 收到的报警事件，含重发
+} SimNetStats_t;
+
+/**
+  * @brief  低功耗模型统计
+  */
+typedef struct {
+    uint32_t stop_count;        // 进入Stop的次数
+    uint64_t stop_ns;           // Stop累计时长
+    uint32_t rx_wakeups;        // 被USART1接收唤醒的次数
+    uint32_t rx_lost;           // Stop期间到达、未被接收的字节
+} SimPowerStats_t;
+
+/**
+  * @brief  独立看门狗模型统计
+  */
+typedef struct {
+    uint8_t  enabled;           // 固件已启动IWDG
+    uint32_t feeds;             // 喂狗次数
+    uint64_t min_margin_ns;     // 喂狗时距到期的最小余量
+    uint32_t resets;            // 看门狗复位
+} SimWatchdogStats_t;
+
+/**
+  * @brief  Flash模型统计
+  */
+typedef struct {
+    uint32_t erases;            // 页擦除次数
+    uint32_t words;             // 编程的字数
+    uint32_t errors;            // 未解锁、越界或目标未擦除
+} SimFlashStats_t;
+
+/**
+  * @brief  时钟与功耗模型统计
+  */
+#define SIM_CLOCK_BINS  4       // 72MHz / 36MHz / 8MHz / 其他
+typedef struct {
+    uint64_t run_ns[SIM_CLOCK_BINS];    // 各频率下的运行时长
+    uint64_t sleep_ns[SIM_CLOCK_BINS];  // 各频率下的Sleep时长
+    uint64_t stop_ns;                   // Stop时长
+    double   run_mas;                   // 运行电荷(mA·s)
+    double   sleep_mas;                 // Sleep电荷(mA·s)
+    double   stop_mas;                  // Stop电荷(mA·s)
+    uint32_t sysclk_switches;           // 系统时钟源切换次数
+    uint32_t pll_locks;                 // PLL锁定次数
+    uint32_t hse_starts;                // HSE起振次数
+    uint32_t clock_errors;              // 时钟配置错误和外设分频失配
+} SimClockStats_t;
+
+/* 虚拟时钟 ------------------------------------------------------------------*/
+extern SimConfig_t Sim_Config;
+
+void     Sim_ClockInit(void);
+uint64_t Sim_NowNs(void);
+void     Sim_Advance(uint64_t ns);
+void     Sim_Charge(uint32_t ns);
+void     Sim_Reschedule(void);
+void     Sim_DwtRebase(void);
+void     Sim_Finish(void);
+
+/* 环境与随机数 --------------------------------------------------------------*/
+int      Sim_Env_Open(const char *spec);
+void     Sim_Env_Read(double *temp, double *humi, double *lux);
+void     Sim_RandSeed(uint64_t seed);
+uint32_t Sim_Rand(void);
+int      Sim_Chance(double p);
+
+/* 外设模型 ------------------------------------------------------------------*/
+void     Sim_PeriphPoll(void);
+uint64_t Sim_PeriphNextEventNs(void);
+uint8_t  Sim_BuzzerIsOn(void);
+uint64_t Sim_BuzzerOnNs(void);
+void     Sim_Usart1_Inject(uint8_t byte);
+void     Sim_PeriphResume(uint64_t stopped_ns);
+void     Sim_PeriphClockChanged(void);
+uint8_t  Sim_NvicEnabled(int irq);
+
+void     Sim_Dht11_PinWrite(uint8_t level);
+void     Sim_Dht11_PinMode(uint8_t input);
+uint8_t  Sim_Dht11_PinRead(void);
+uint32_t Sim_Dht11_EarlyStarts(void);
+
+uint16_t Sim_Adc_Sample(uint8_t channel);
+
+void     Sim_Oled_PinWrite(uint8_t scl, uint8_t sda);
+void     Sim_Oled_Render(void);
+int      Sim_Oled_SavePng(const char *path);
+
+/* 低功耗模型 ----------------------------------------------------------------*/
+uint64_t Sim_Power_NextEventNs(void);
+void     Sim_Power_Poll(void);
+void     Sim_Power_RxWhileStopped(void);
+uint8_t  Sim_Power_IsStopped(void);
+uint32_t Sim_Power_RtcCounter(void);
+void     Sim_Power_RtcLoad(uint32_t counter);
+const SimPowerStats_t *Sim_Power_GetStats(void);
+
+/* 备份域与看门狗模型 ------------------------------------------------------*/
+int      Sim_Bkp_Load(const char *path);
+void     Sim_Bkp_Save(const char *path);
+void     Sim_Bkp_SoftwareReset(void);
+uint8_t  Sim_Bkp_ResetFlag(uint8_t flag);
+uint8_t  Sim_Bkp_PowerOn(void);
+uint64_t Sim_Iwdg_NextEventNs(void);
+void     Sim_Iwdg_Poll(void);
+const SimWatchdogStats_t *Sim_Iwdg_GetStats(void);
+
+/* Flash与CRC模型 ------------------------------------------------------------*/
+int      Sim_Flash_Init(void);
+int      Sim_Flash_Load(const char *path);
+void     Sim_Flash_Save(const char *path);
+const SimFlashStats_t *Sim_Flash_GetStats(void);
+
+/* 时钟树模型 ----------------------------------------------------------------*/
+uint32_t Sim_Rcc_HclkHz(void);
+uint32_t Sim_Rcc_PclkHz(uint8_t apb);
+uint32_t Sim_Rcc_TimerHz(uint8_t apb);
+uint32_t Sim_Rcc_AdcHz(void);
+void     Sim_Rcc_Cycles(uint32_t cycles);
+void     Sim_Rcc_Account(void);
+void     Sim_Rcc_Sleep(uint8_t sleep);
+void     Sim_Rcc_EnterStop(void);
+void     Sim_Rcc_StopWake(void);
+uint32_t Sim_Rcc_CpuHz(void);
+void     Sim_Rcc_ClockError(const char *fmt, ...);
+uint32_t Sim_Rcc_BinMHz(int bin);
+const SimClockStats_t *Sim_Rcc_GetStats(void);
+
+/* 串口后端 ------------------------------------------------------------------*/
+int      Sim_Uart_Open(const char *spec);
+void     Sim_Uart_Close(void);
+void     Sim_Uart_Tx(uint8_t byte);
+int      Sim_Uart_Rx(uint8_t *byte);
+uint64_t Sim_Uart_Digest(void);
+
+/* ESP8266模型 ---------------------------------------------------------------*/
+void     Sim_Esp_Reset(void);
+void     Sim_Esp_Input(uint8_t byte);
+int      Sim_Esp_Output(uint8_t *byte);
+uint32_t Sim_Esp_UploadCount(void);
+void     Sim_Esp_SetPower(uint8_t on);
+const SimNetStats_t *Sim_Esp_GetStats(void);
+void     Sim_Esp_Sample(int16_t temp, int16_t humi, uint16_t light);
+
+/* 采集轨迹 ------------------------------------------------------------------*/
+int      Sim_Trace_Open(const char *record_path, const char *replay_path);
+void     Sim_Trace_Input(uint8_t byte);
+int      Sim_Trace_NextDht(uint8_t data[5]);
+int      Sim_Trace_NextAdc(uint8_t channel, uint16_t *value);
+int      Sim_Trace_HasAdc(uint8_t channel);
+void     Sim_Trace_Report(void);
+void     Sim_Trace_WriteJson(FILE *json);
+int      Sim_Trace_Dump(const char *path);
+
+/* 运行统计 ------------------------------------------------------------------*/
+void     Sim_Stats_LoopBegin(void);
+void     Sim_Stats_LoopEnd(void);
+void     Sim_Stats_Report(void);
+
+#endif /* __SIM_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file    sim_bkp.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   备份域、复位标志与独立看门狗模型
+  * @note    固件用-flto编译，无法在进程内把静态变量恢复到上电状态，因此
+  *          看门狗复位和软件复位都结束本次运行。备份寄存器、RTC计数和下次
+  *          启动的复位标志可用--bkp保存到文件，下一次运行载入后即相当于
+  *          复位后重新启动。IWDG由LSI驱动，Stop期间继续计数
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "sim.h"
+#include <stdio.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define SIM_LSI_HZ          40000ULL    // 与固件按标称值换算
+#define SIM_BKP_DR_COUNT    42          // 中容量器件DR1~DR10，大容量器件到DR42
+#define SIM_RSTF(flag)      (1U << ((flag) - RCC_FLAG_PINRST))
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint16_t bkp_dr[SIM_BKP_DR_COUNT];
+static uint32_t reset_flags = SIM_RSTF(RCC_FLAG_PORRST) | SIM_RSTF(RCC_FLAG_PINRST);
+static uint32_t next_flags = SIM_RSTF(RCC_FLAG_PINRST);     // 正常结束时按NRST复位处理
+static uint8_t  power_on = 1;           // 本次启动是否为上电，固件清除复位标志后保留
+
+static struct {
+    uint8_t  enabled;
+    uint8_t  pr;                // 分频系数：4 << pr
+    uint16_t rlr;               // 重装值
+    uint64_t deadline_ns;       // 计数到0的时刻，UINT64_MAX表示未启动
+} sim_iwdg = { 0, 0, 0x0FFF, UINT64_MAX };
+
+static SimWatchdogStats_t stats = { .min_margin_ns = UINT64_MAX };
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  把寄存器偏移换算为数组下标
+  * @retval 下标，非法偏移时为-1
+  */
+static int Sim_Bkp_Index(uint16_t BKP_DR)
+{
+    if (BKP_DR >= BKP_DR1 && BKP_DR <= BKP_DR10 && (BKP_DR & 3) == 0)
+        return BKP_DR / 4 - 1;
+    if (BKP_DR >= BKP_DR11 && BKP_DR <= BKP_DR42 && (BKP_DR & 3) == 0)
+        return (BKP_DR - BKP_DR11) / 4 + 10;
+    return -1;
+}
+
+/**
+  * @brief  看门狗一次计满的时长
+  */
+static uint64_t Sim_Iwdg_PeriodNs(void)
+{
+    return (uint64_t)sim_iwdg.rlr * (4U << sim_iwdg.pr) * 1000000000ULL / SIM_LSI_HZ;
+}
+
+/* 备份文件 ------------------------------------------------------------------*/
+/**
+  * @brief  载入上次运行保存的备份域
+  * @param  path: 文件路径，不存在时按上电处理
+  * @retval 0:成功 -1:格式错误
+  */
+int Sim_Bkp_Load(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    char line[64];
+    unsigned idx, val;
+    int ret = 0;
+
+    if (fp == NULL)
+        return 0;
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (sscanf(line, "flags %x", &val) == 1)
+            reset_flags = val;
+        else if (sscanf(line, "rtc %x", &val) == 1)
+            Sim_Power_RtcLoad(val);
+        else if (sscanf(line, "dr%u %x", &idx, &val) == 2 && idx >= 1 && idx <= SIM_BKP_DR_COUNT)
+            bkp_dr[idx - 1] = (uint16_t)val;
+        else
+            ret = -1;
+    }
+    fclose(fp);
+    power_on = Sim_Bkp_ResetFlag(RCC_FLAG_PORRST);
+    return ret;
+}
+
+/**
+  * @brief  保存备份域和下次启动的复位标志
+  * @param  path: 文件路径
+  * @retval 无
+  */
+void Sim_Bkp_Save(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    int i;
+
+    if (fp == NULL)
+    {
+        fprintf(stderr, "[sim] cannot write %s\n", path);
+        return;
+    }
+    fprintf(fp, "flags %02x\n", next_flags);
+    fprintf(fp, "rtc %08x\n", Sim_Power_RtcCounter());
+    for (i = 0; i < SIM_BKP_DR_COUNT; i++)
+        if (bkp_dr[i])
+            fprintf(fp, "dr%d %04x\n", i + 1, bkp_dr[i]);
+    fclose(fp);
+}
+
+/**
+  * @brief  软件复位，下次启动时置位SFTRST
+  * @param  无
+  * @retval 无
+  */
+void Sim_Bkp_SoftwareReset(void)
+{
+    next_flags = SIM_RSTF(RCC_FLAG_SFTRST) | SIM_RSTF(RCC_FLAG_PINRST);
+}
+
+/**
+  * @brief  查询复位标志
+  * @param  flag: RCC_FLAG_PINRST ~ RCC_FLAG_LPWRRST
+  * @retval 1:置位 0:未置位
+  */
+uint8_t Sim_Bkp_ResetFlag(uint8_t flag)
+{
+    return (reset_flags & SIM_RSTF(flag)) ? 1 : 0;
+}
+
+/**
+  * @brief  本次启动是否为上电
+  * @param  无
+  * @retval 1:上电启动 0:其他复位
+  * @note   不受固件清除复位标志影响，外设模型据此模拟上电后的不稳定期
+  */
+uint8_t Sim_Bkp_PowerOn(void)
+{
+    return power_on;
+}
+
+/* 事件调度 ------------------------------------------------------------------*/
+/**
+  * @brief  获取看门狗到期时刻
+  * @param  无
+  * @retval 虚拟时间(ns)，未启动时为UINT64_MAX
+  */
+uint64_t Sim_Iwdg_NextEventNs(void)
+{
+    return sim_iwdg.deadline_ns;
+}
+
+/**
+  * @brief  看门狗到期时复位
+  * @param  无
+  * @retval 无
+  */
+void Sim_Iwdg_Poll(void)
+{
+    if (sim_iwdg.deadline_ns > Sim_NowNs())
+        return;
+    sim_iwdg.deadline_ns = UINT64_MAX;
+    stats.resets++;
+    next_flags = SIM_RSTF(RCC_FLAG_IWDGRST) | SIM_RSTF(RCC_FLAG_PINRST);
+    printf("[sim] %10.3f s  IWDG reset\n", Sim_NowNs() / 1e9);
+    Sim_Finish();
+}
+
+/**
+  * @brief  获取看门狗统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const SimWatchdogStats_t *Sim_Iwdg_GetStats(void)
+{
+    stats.enabled = sim_iwdg.enabled;
+    return &stats;
+}
+
+/* RCC -----------------------------------------------------------------------*/
+void RCC_ClearFlag(void)
+{
+    reset_flags = 0;
+}
+
+/* BKP -----------------------------------------------------------------------*/
+void BKP_WriteBackupRegister(uint16_t BKP_DR, uint16_t Data)
+{
+    int i = Sim_Bkp_Index(BKP_DR);
+
+    if (i < 0)
+    {
+        fprintf(stderr, "[sim] BKP write to invalid register 0x%02x\n", BKP_DR);
+        return;
+    }
+    bkp_dr[i] = Data;
+}
+
+uint16_t BKP_ReadBackupRegister(uint16_t BKP_DR)
+{
+    int i = Sim_Bkp_Index(BKP_DR);
+
+    return i < 0 ? 0 : bkp_dr[i];
+}
+
+/* IWDG ----------------------------------------------------------------------*/
+void IWDG_WriteAccessCmd(uint16_t IWDG_WriteAccess)
+{
+    (void)IWDG_WriteAccess;
+}
+
+void IWDG_SetPrescaler(uint8_t IWDG_Prescaler)
+{
+    sim_iwdg.pr = IWDG_Prescaler & 0x07;
+    if (sim_iwdg.pr > 6)
+        sim_iwdg.pr = 6;
+}
+
+void IWDG_SetReload(uint16_t Reload)
+{
+    sim_iwdg.rlr = Reload & 0x0FFF;
+}
+
+void IWDG_ReloadCounter(void)
+{
+    uint64_t now = Sim_NowNs();
+
+    if (!sim_iwdg.enabled)
+        return;
+    if (sim_iwdg.deadline_ns - now < stats.min_margin_ns)
+        stats.min_margin_ns = sim_iwdg.deadline_ns - now;
+    stats.feeds++;
+    sim_iwdg.deadline_ns = now + Sim_Iwdg_PeriodNs();
+    Sim_Reschedule();
+}
+
+void IWDG_Enable(void)
+{
+    if (sim_iwdg.enabled)
+        return;
+    sim_iwdg.enabled = 1;
+    sim_iwdg.deadline_ns = Sim_NowNs() + Sim_Iwdg_PeriodNs();
+    Sim_Reschedule();
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
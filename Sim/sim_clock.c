@@ -0,0 +1,270 @@
+/**
+  ******************************************************************************
+  * @file    sim_clock.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   仿真虚拟时钟与延时函数
+  * @note    代替System/Delay.c：延时只推进虚拟时间，不占用主机CPU；
+  *          实时模式下再按墙钟节拍休眠，使仿真节奏与目标板一致
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Delay.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* 内核寄存器实例 ------------------------------------------------------------*/
+NVIC_Type      Sim_NVIC;
+SCB_Type       Sim_SCB;
+SysTick_Type   Sim_SysTick;
+CoreDebug_Type Sim_CoreDebug;
+uint32_t       Sim_DwtCtrl;
+
+uint32_t SystemCoreClock = 72000000;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint64_t now_ns = 0;             // 虚拟时间
+static uint64_t next_event_ns = 0;      // 缓存的下一个外设事件时刻，0表示需重新查询
+static uint64_t paced_ns = 0;           // 上次按墙钟同步的虚拟时刻
+static struct timespec wall_start;      // 墙钟起点
+static uint8_t irq_masked = 0;          // 是否关中断
+static uint8_t in_advance = 0;          // 防止中断处理函数中嵌套推进
+static uint32_t dwt_cyccnt = 0;         // 交给固件读写的CYCCNT
+static uint32_t dwt_reported = 0;       // 上次交给固件时的值，不同说明固件写过
+static uint32_t dwt_base = 0;           // 计数起点的计数值
+static uint64_t dwt_base_ns = 0;        // 计数起点的虚拟时刻
+
+/**
+  * @brief  按墙钟节拍休眠
+  * @param  无
+  * @retval 无
+  */
+static void Sim_Pace(void)
+{
+    struct timespec now;
+    int64_t wall_ns, ahead_ns;
+
+    if (!Sim_Config.realtime || now_ns - paced_ns < 1000000ULL)
+        return;
+    paced_ns = now_ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wall_ns = (int64_t)(now.tv_sec - wall_start.tv_sec) * 1000000000LL +
+              (now.tv_nsec - wall_start.tv_nsec);
+    ahead_ns = (int64_t)now_ns - wall_ns;
+    if (ahead_ns > 0)
+    {
+        struct timespec ts = { ahead_ns / 1000000000LL, ahead_ns % 1000000000LL };
+        nanosleep(&ts, NULL);
+    }
+}
+
+/**
+  * @brief  初始化虚拟时钟
+  * @param  无
+  * @retval 无
+  */
+void Sim_ClockInit(void)
+{
+    now_ns = 0;
+    paced_ns = 0;
+    dwt_cyccnt = dwt_reported = dwt_base = 0;
+    dwt_base_ns = 0;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+}
+
+/**
+  * @brief  获取虚拟时间
+  * @param  无
+  * @retval 自仿真开始经过的纳秒数
+  */
+uint64_t Sim_NowNs(void)
+{
+    return now_ns;
+}
+
+/**
+  * @brief  DWT周期计数器
+  * @param  无
+  * @retval 计数值的地址，固件通过它读写CYCCNT
+  * @note   每次访问时按虚拟时间和当前HCLK刷新；纯计算不推进虚拟时间，
+  *          因此只有延时和外设访问的耗时会反映在计数中
+  */
+uint32_t *Sim_DwtCyccnt(void)
+{
+    if (dwt_cyccnt != dwt_reported || !(Sim_DwtCtrl & 1))
+    {
+        /* 固件写入了新值或计数器未使能：从当前时刻重新起算 */
+        dwt_base = dwt_cyccnt;
+        dwt_base_ns = now_ns;
+    }
+    else
+    {
+        dwt_cyccnt = dwt_base + (uint32_t)((unsigned __int128)(now_ns - dwt_base_ns) *
+                                           Sim_Rcc_CpuHz() / 1000000000ULL);
+    }
+    dwt_reported = dwt_cyccnt;
+    return &dwt_cyccnt;
+}
+
+/**
+  * @brief  HCLK改变前从当前计数值重新起算
+  * @param  无
+  * @retval 无
+  */
+void Sim_DwtRebase(void)
+{
+    Sim_DwtCyccnt();
+    dwt_base = dwt_cyccnt;
+    dwt_base_ns = now_ns;
+}
+
+/**
+  * @brief  推进虚拟时间
+  * @param  ns: 推进的纳秒数
+  * @retval 无
+  * @note   途经的外设事件按时刻顺序处理，期间可能调用固件中断处理函数
+  */
+void Sim_Advance(uint64_t ns)
+{
+    uint64_t target = now_ns + ns;
+    uint64_t end = Sim_Config.duration_ms * 1000000ULL;
+    uint64_t next;
+
+    if (end && target > end)
+        target = end;           // 运行时长到达时停在该时刻，不再继续延时
+    if (in_advance)
+    {
+        /* 中断处理函数内的耗时只累加，不再嵌套分发事件 */
+        now_ns = target;
+        return;
+    }
+    in_advance = 1;
+
+    while (!irq_masked && (next = Sim_PeriphNextEventNs()) <= target)
+    {
+        if (next > now_ns)
+            now_ns = next;
+        Sim_Pace();
+        Sim_PeriphPoll();
+    }
+    next_event_ns = irq_masked ? 0 : next;
+    now_ns = target;
+    Sim_Pace();
+
+    in_advance = 0;
+
+    if (end && now_ns >= end)
+        Sim_Finish();
+}
+
+/**
+  * @brief  累计一次外设访问的耗时
+  * @param  ns: 耗时纳秒数
+  * @retval 无
+  * @note   OLED刷新等场景每秒调用十万次以上：没有越过下一个外设事件时
+  *         直接累加时间，不进入事件分发
+  */
+void Sim_Charge(uint32_t ns)
+{
+    if (in_advance || now_ns + ns < next_event_ns)
+    {
+        now_ns += ns;
+        return;
+    }
+    Sim_Advance(ns);
+}
+
+/**
+  * @brief  外设事件时刻发生变化，作废缓存
+  * @param  无
+  * @retval 无
+  */
+void Sim_Reschedule(void)
+{
+    next_event_ns = 0;
+}
+
+/**
+  * @brief  关中断
+  * @param  无
+  * @retval 无
+  */
+void Sim_IrqDisable(void)
+{
+    irq_masked = 1;
+}
+
+/**
+  * @brief  开中断，补发关中断期间到期的事件
+  * @param  无
+  * @retval 无
+  */
+void Sim_IrqEnable(void)
+{
+    irq_masked = 0;
+    Sim_Advance(0);
+}
+
+/**
+  * @brief  等待中断
+  * @param  无
+  * @retval 无
+  * @note   直接把虚拟时间推进到下一个外设事件，期间按Sleep电流计
+  */
+void Sim_WaitForInterrupt(void)
+{
+    uint64_t next = Sim_PeriphNextEventNs();
+
+    Sim_Rcc_Sleep(1);
+    if (next == UINT64_MAX || next <= now_ns)
+        Sim_Advance(1000);
+    else
+        Sim_Advance(next - now_ns);
+    Sim_Rcc_Sleep(0);
+}
+
+/**
+  * @brief  系统复位
+  * @param  无
+  * @retval 无
+  */
+void Sim_SystemReset(void)
+{
+    printf("[sim] %10.3f s  system reset requested\n", now_ns / 1e9);
+    Sim_Bkp_SoftwareReset();
+    Sim_Finish();
+}
+
+/* 延时函数（代替System/Delay.c） --------------------------------------------*/
+/**
+  * @brief  SysTick按SystemCoreClock装载、按实际HCLK计数
+  * @note   固件未在切换时钟后更新SystemCoreClock时延时随之变长或变短
+  */
+static void Sim_DelayCycles(uint64_t xus)
+{
+    uint64_t cycles = (uint64_t)(SystemCoreClock / 1000000) * xus;
+    Sim_Advance(cycles * 1000000000ULL / Sim_Rcc_HclkHz());
+}
+
+void Delay_us(uint32_t xus)
+{
+    Sim_DelayCycles(xus);
+}
+
+void Delay_ms(uint32_t xms)
+{
+    Sim_DelayCycles((uint64_t)xms * 1000ULL);
+}
+
+void Delay_s(uint32_t xs)
+{
+    Sim_DelayCycles((uint64_t)xs * 1000000ULL);
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
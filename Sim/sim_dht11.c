@@ -0,0 +1,151 @@
+/**
+  ******************************************************************************
+  * @file    sim_dht11.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   DHT11单总线时序模型
+  * @note    主机拉低总线至少18ms后释放，模型按数据手册时序应答：
+  *          等待30us -> 低80us -> 高80us -> 40位数据(低50us + 高26us/70us)
+  *          -> 低50us后释放总线。读数来自sim_env.c的环境波形。
+  *          上电启动时前1s处于不稳定期，不应答起始信号
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "sim.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define DHT_START_MIN_NS    18000000ULL     // 主机起始信号最短低电平
+#define DHT_SEGMENTS        (3 + 40 * 2 + 1)
+#define DHT_POWER_UP_NS     1000000000ULL   // 上电后的不稳定期
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t  host_output = 1;            // 主机是否驱动总线
+static uint8_t  host_level = 1;             // 主机驱动的电平
+static uint64_t low_start_ns = 0;           // 主机拉低的时刻
+static uint64_t frame_start_ns = 0;         // 应答开始的时刻
+static uint8_t  frame_active = 0;
+static uint32_t early_starts = 0;           // 不稳定期内收到的起始信号
+
+static uint32_t seg_ns[DHT_SEGMENTS];       // 应答波形各段时长，偶数段为高电平
+
+/**
+  * @brief  按当前环境值或回放记录生成一帧应答波形
+  * @retval 1:应答 0:本次不应答
+  */
+static int Sim_Dht11_BuildFrame(void)
+{
+    double t, h, lux;
+    uint8_t data[5];
+    uint32_t n = 0;
+    int i, b;
+
+    switch (Sim_Trace_NextDht(data))
+    {
+    case 0:
+        return 0;
+    case 1:
+        break;
+    default:
+        Sim_Env_Read(&t, &h, &lux);
+        if (t < 0) t = 0;       // DHT11量程0~50℃
+        if (h < 0) h = 0;
+
+        data[0] = (uint8_t)h;
+        data[1] = (uint8_t)((h - data[0]) * 10.0 + 0.5) % 10;
+        data[2] = (uint8_t)t;
+        data[3] = (uint8_t)((t - data[2]) * 10.0 + 0.5) % 10;
+        data[4] = (uint8_t)(data[0] + data[1] + data[2] + data[3]);
+        break;
+    }
+
+    seg_ns[n++] = 30000;        // 释放后等待
+    seg_ns[n++] = 80000;        // 应答低电平
+    seg_ns[n++] = 80000;        // 应答高电平
+    for (i = 0; i < 5; i++)
+    {
+        for (b = 7; b >= 0; b--)
+        {
+            seg_ns[n++] = 50000;
+            seg_ns[n++] = (data[i] >> b) & 1 ? 70000 : 26000;
+        }
+    }
+    seg_ns[n++] = 50000;        // 结束低电平
+    return 1;
+}
+
+/**
+  * @brief  主机写总线
+  * @param  level: 电平
+  * @retval 无
+  */
+void Sim_Dht11_PinWrite(uint8_t level)
+{
+    uint64_t now = Sim_NowNs();
+
+    if (host_level && !level)
+        low_start_ns = now;
+    if (!host_level && level && now - low_start_ns >= DHT_START_MIN_NS)
+    {
+        frame_start_ns = now;
+        if (Sim_Bkp_PowerOn() && now < DHT_POWER_UP_NS)
+        {
+            early_starts++;
+            frame_active = 0;
+        }
+        else
+            frame_active = Sim_Dht11_BuildFrame();
+    }
+    host_level = level;
+}
+
+/**
+  * @brief  主机切换引脚方向
+  * @param  input: 1:输入（释放总线） 0:推挽输出
+  * @retval 无
+  */
+void Sim_Dht11_PinMode(uint8_t input)
+{
+    if (input && host_output && !host_level)
+        Sim_Dht11_PinWrite(1);  // 直接释放也视为起始信号结束
+    host_output = !input;
+}
+
+/**
+  * @brief  主机读总线
+  * @param  无
+  * @retval 总线电平
+  */
+uint8_t Sim_Dht11_PinRead(void)
+{
+    uint64_t dt;
+    uint32_t i;
+
+    if (host_output)
+        return host_level;
+    if (!frame_active)
+        return 1;               // 上拉电阻
+
+    dt = Sim_NowNs() - frame_start_ns;
+    for (i = 0; i < DHT_SEGMENTS; i++)
+    {
+        if (dt < seg_ns[i])
+            return (i & 1) ? 0 : 1;
+        dt -= seg_ns[i];
+    }
+    frame_active = 0;
+    return 1;
+}
+
+/**
+  * @brief  上电不稳定期内收到的起始信号数
+  * @param  无
+  * @retval 次数
+  */
+uint32_t Sim_Dht11_EarlyStarts(void)
+{
+    return early_starts;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file    sim_env.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   仿真环境：传感器波形与伪随机数
+  * @note    --env=const     固定值，取自--temp/--humi/--lux
+  *          --env=diurnal   内置24小时昼夜曲线
+  *          --env=文件      脚本，每行"秒 温度 湿度 光照"，按时间线性插值，
+  *                          末尾之后保持最后一行的值；#开头为注释
+  *          所有随机量都来自同一个可设种子的生成器，相同参数的两次运行完全一致
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define ENV_MAX_POINTS      4096
+#define ENV_DAY_S           86400.0
+
+/* 私有类型 ------------------------------------------------------------------*/
+typedef enum {
+    ENV_CONST = 0,
+    ENV_DIURNAL,
+    ENV_SCRIPT
+} EnvMode_t;
+
+typedef struct {
+    double t;                   // 秒
+    double temp, humi, lux;
+} EnvPoint_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static EnvMode_t env_mode = ENV_CONST;
+static EnvPoint_t *points = NULL;
+static uint32_t point_count = 0;
+static uint32_t point_cursor = 0;       // 上次插值所在区间，时间单调递增时O(1)
+static uint64_t rand_state = 0x853C49E6748FEA9BULL;
+
+/**
+  * @brief  设置随机数种子
+  * @param  seed: 种子
+  * @retval 无
+  */
+void Sim_RandSeed(uint64_t seed)
+{
+    rand_state = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+}
+
+/**
+  * @brief  取一个32位伪随机数（PCG32）
+  * @param  无
+  * @retval 随机数
+  */
+uint32_t Sim_Rand(void)
+{
+    uint64_t old = rand_state;
+    uint32_t xorshifted, rot;
+
+    rand_state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+    xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+/**
+  * @brief  以概率p返回1
+  * @param  p: 概率(0~1)
+  * @retval 0或1
+  */
+int Sim_Chance(double p)
+{
+    return p > 0 && Sim_Rand() < p * 4294967296.0;
+}
+
+static int Sim_Env_LoadScript(const char *path)
+{
+    char buf[256];
+    FILE *fp = fopen(path, "r");
+
+    if (fp == NULL)
+        return -1;
+    points = malloc(sizeof(EnvPoint_t) * ENV_MAX_POINTS);
+    point_count = 0;
+    while (points && fgets(buf, sizeof(buf), fp) && point_count < ENV_MAX_POINTS)
+    {
+        EnvPoint_t p;
+        if (buf[0] == '#')
+            continue;
+        if (sscanf(buf, "%lf %lf %lf %lf", &p.t, &p.temp, &p.humi, &p.lux) != 4)
+            continue;
+        if (point_count && p.t < points[point_count - 1].t)
+        {
+            fprintf(stderr, "[sim] %s: time goes backwards at %.0f s\n", path, p.t);
+            fclose(fp);
+            return -1;
+        }
+        points[point_count++] = p;
+    }
+    fclose(fp);
+    return point_count ? 0 : -1;
+}
+
+/**
+  * @brief  选择环境波形
+  * @param  spec: "const" / "diurnal" / 脚本文件路径
+  * @retval 0:成功 -1:失败
+  */
+int Sim_Env_Open(const char *spec)
+{
+    if (spec == NULL || strcmp(spec, "const") == 0)
+        env_mode = ENV_CONST;
+    else if (strcmp(spec, "diurnal") == 0)
+        env_mode = ENV_DIURNAL;
+    else if (Sim_Env_LoadScript(spec) == 0)
+        env_mode = ENV_SCRIPT;
+    else
+        return -1;
+    return 0;
+}
+
+/**
+  * @brief  读取当前虚拟时刻的环境值
+  * @param  temp: 温度(℃)
+  * @param  humi: 湿度(%RH)
+  * @param  lux: 光照(0~1000)
+  * @retval 无
+  */
+void Sim_Env_Read(double *temp, double *humi, double *lux)
+{
+    double t = Sim_NowNs() / 1e9;
+
+    switch (env_mode)
+    {
+    case ENV_DIURNAL:
+    {
+        /* 以--temp/--humi为日均值：14点最热最干，光照6~18点按正弦变化 */
+        double phase = 2.0 * M_PI * (fmod(t, ENV_DAY_S) / ENV_DAY_S - 14.0 / 24.0);
+        double sun = sin(M_PI * (fmod(t, ENV_DAY_S) / ENV_DAY_S * 24.0 - 6.0) / 12.0);
+        *temp = Sim_Config.temperature + 8.0 * cos(phase);
+        *humi = Sim_Config.humidity - 20.0 * cos(phase);
+        *lux  = sun > 0 ? Sim_Config.lux * 1.8 * sun : 0.0;
+        if (*lux > 1000.0) *lux = 1000.0;
+        if (*humi < 5.0) *humi = 5.0;
+        if (*humi > 95.0) *humi = 95.0;
+        break;
+    }
+
+    case ENV_SCRIPT:
+    {
+        const EnvPoint_t *a, *b;
+        double k;
+
+        if (point_cursor >= point_count || points[point_cursor].t > t)
+            point_cursor = 0;
+        while (point_cursor + 1 < point_count && points[point_cursor + 1].t <= t)
+            point_cursor++;
+        a = &points[point_cursor];
+        if (t <= a->t || point_cursor + 1 >= point_count)
+        {
+            *temp = a->temp; *humi = a->humi; *lux = a->lux;
+            break;
+        }
+        b = a + 1;
+        k = (t - a->t) / (b->t - a->t);
+        *temp = a->temp + (b->temp - a->temp) * k;
+        *humi = a->humi + (b->humi - a->humi) * k;
+        *lux  = a->lux  + (b->lux  - a->lux)  * k;
+        break;
+    }
+
+    default:
+        *temp = Sim_Config.temperature;
+        *humi = Sim_Config.humidity;
+        *lux  = Sim_Config.lux;
+        break;
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
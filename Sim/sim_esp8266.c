@@ -0,0 +1,759 @@
+/**
+  ******************************************************************************
+  * @file    sim_esp8266.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   ESP8266 AT固件模型
+  * @note    实现固件用到的AT指令子集（带回显），透传模式下按HTTP/1.1解析
+  *          上传请求并返回200应答。应答按模块的典型延迟排队，到时才交给串口。
+  *          指定了下发配置时，到时后每个应答都带上该配置，直到上传的JSON中
+  *          "cfg"回报了同一编号。
+  *          网络故障模型按Sim_Config注入应答延迟、丢包、TCP断开、模块重启
+  *          和周期性WiFi断线，随机量取自可设种子的生成器。
+  *          电流模型：断电20uA；启动、未入网、未开Modem-sleep或收发后100ms内
+  *          按射频常开70mA计；Modem-sleep空闲时按15mA计
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "sim.h"
+#include "Batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define ESP_OUT_SIZE        4096            // 应答队列长度，2的幂
+#define ESP_LINE_SIZE       256
+#define ESP_HTTP_SIZE       1024
+#define ESP_ESCAPE_GAP_NS   200000000ULL    // "+++"前后的静默时间
+#define ESP_MS              1000000ULL
+#define ESP_BOOT_NS         (300 * ESP_MS)  // 上电到输出"ready"、开始接受AT指令
+#define ESP_ACTIVE_NS       (100 * ESP_MS)  // 收发后射频保持打开的时间
+#define ESP_MA_OFF          0.02
+#define ESP_MA_ACTIVE       70.0
+#define ESP_MA_MODEM_SLEEP  15.0
+#define ESP_SAMPLE_LOG      262144          // 按秒记下的采集值，约3天，2的幂
+
+/* 私有类型 ------------------------------------------------------------------*/
+typedef enum {
+    ESP_HTTP_HEADER = 0,                    // 接收请求头
+    ESP_HTTP_BODY                           // 接收请求体
+} EspHttpState_t;
+
+/**
+  * @brief  一秒内固件输出的处理结果，核对补传的格平均值
+  */
+typedef struct {
+    uint32_t sec;                           // Unix时间(s)
+    uint32_t count;
+    int32_t  sum[ALARM_CH_COUNT];
+    int16_t  min[ALARM_CH_COUNT];
+    int16_t  max[ALARM_CH_COUNT];
+} EspSampleSec_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t  out_buf[ESP_OUT_SIZE];
+static uint64_t out_ready[ESP_OUT_SIZE];    // 每个字节最早可发送的时刻
+static uint32_t out_head = 0, out_tail = 0;
+static uint64_t out_last_ready = 0;
+
+static char     line[ESP_LINE_SIZE];
+static uint32_t line_len = 0;
+static uint64_t last_rx_ns = 0;
+
+static uint64_t wifi_ready_ns = 0;          // 入网完成的时刻，上电后自动连接保存的热点
+static uint8_t  in_outage = 0;              // 处于注入的WiFi断线期间
+static uint8_t  tcp_connected = 0;
+static uint8_t  cipmode = 0;
+static uint8_t  transparent = 0;
+static uint8_t  plus_count = 0;             // 透传模式下连续收到的'+'个数
+
+static uint8_t  powered = 1;                // CH_PD电平，未接引脚时始终上电
+static uint8_t  sleep_mode = 0;             // AT+SLEEP设置，重启后恢复为0
+static uint64_t boot_done_ns = 0;           // 上电启动完成的时刻
+static uint64_t active_until_ns = 0;        // 射频保持打开到此时刻
+static uint64_t charge_ns = 0;              // 电流已积分到的时刻
+
+static EspHttpState_t http_state = ESP_HTTP_HEADER;
+static char     http_buf[ESP_HTTP_SIZE];
+static uint32_t http_len = 0;
+static uint32_t body_left = 0;
+static uint32_t request_bytes = 0;          // 当前请求已收到的字节
+
+static SimNetStats_t net_stats;
+static EspSampleSec_t sample_log[ESP_SAMPLE_LOG];
+static uint8_t  sample_seen = 0;            // 收到过处理结果，没有轨迹输出时补传无从核对
+static uint32_t push_id = 0;                // 下发配置中的"cfg"
+
+/**
+  * @brief  时刻t的模块电流
+  */
+static double Sim_Esp_CurrentMa(uint64_t t)
+{
+    if (!powered)
+        return ESP_MA_OFF;
+    if (t < wifi_ready_ns || in_outage || sleep_mode == 0 || t < active_until_ns)
+        return ESP_MA_ACTIVE;
+    return ESP_MA_MODEM_SLEEP;
+}
+
+/**
+  * @brief  把电流积分到当前时刻，在入网和射频空闲两个时刻处分段
+  */
+static void Sim_Esp_Account(void)
+{
+    uint64_t now = Sim_NowNs();
+    uint64_t edges[3] = { wifi_ready_ns, active_until_ns, now };
+    uint64_t t = charge_ns, end;
+    int i;
+
+    if (now <= charge_ns)
+        return;
+    if (edges[0] > edges[1])
+    {
+        edges[0] = active_until_ns;
+        edges[1] = wifi_ready_ns;
+    }
+    for (i = 0; i < 3; i++)
+    {
+        end = edges[i];
+        if (end <= t)
+            continue;
+        if (end > now)
+            end = now;
+        net_stats.charge_mas += Sim_Esp_CurrentMa(t) * ((end - t) / 1e9);
+        if (powered)
+            net_stats.on_ns += end - t;
+        t = end;
+    }
+    charge_ns = now;
+}
+
+/**
+  * @brief  串口有收发，射频保持打开
+  */
+static void Sim_Esp_Activity(void)
+{
+    Sim_Esp_Account();
+    active_until_ns = Sim_NowNs() + ESP_ACTIVE_NS;
+}
+
+/**
+  * @brief  将应答排入输出队列
+  * @param  delay_ms: 相对当前时刻的延迟
+  * @param  text: 应答内容
+  */
+static void Sim_Esp_Reply(uint32_t delay_ms, const char *text)
+{
+    uint64_t ready = Sim_NowNs() + delay_ms * ESP_MS;
+
+    if (ready < out_last_ready)
+        ready = out_last_ready;
+    out_last_ready = ready;
+
+    while (*text && out_head - out_tail < ESP_OUT_SIZE)
+    {
+        out_buf[out_head & (ESP_OUT_SIZE - 1)] = (uint8_t)*text++;
+        out_ready[out_head & (ESP_OUT_SIZE - 1)] = ready;
+        out_head++;
+    }
+}
+
+/**
+  * @brief  WiFi当前是否可用
+  */
+static int Sim_Esp_WifiUp(void)
+{
+    return !in_outage && Sim_NowNs() >= wifi_ready_ns;
+}
+
+/**
+  * @brief  模块重启：丢弃全部连接状态，2秒后自动重新入网
+  */
+static void Sim_Esp_Reboot(uint32_t delay_ms)
+{
+    Sim_Esp_Account();
+    sleep_mode = 0;
+    tcp_connected = 0;
+    cipmode = 0;
+    transparent = 0;
+    plus_count = 0;
+    line_len = 0;
+    wifi_ready_ns = Sim_NowNs() + (delay_ms + 2000) * ESP_MS;
+    Sim_Esp_Reply(delay_ms, "\r\n ets Jan  8 2013,rst cause:2, boot mode:(3,6)\r\n\r\nready\r\n");
+    if (!in_outage)
+        Sim_Esp_Reply(delay_ms + 2000, "WIFI CONNECTED\r\nWIFI GOT IP\r\n");
+}
+
+/**
+  * @brief  按断线周期更新WiFi状态
+  */
+static void Sim_Esp_UpdateOutage(void)
+{
+    uint64_t period, len, phase;
+    uint8_t outage;
+
+    if (Sim_Config.outage_period_s == 0 || Sim_Config.outage_len_s == 0)
+        return;
+    period = Sim_Config.outage_period_s * 1000ULL * ESP_MS;
+    len = Sim_Config.outage_len_s * 1000ULL * ESP_MS;
+    phase = Sim_NowNs() % period;
+    outage = phase >= period - len;     // 每个周期的末尾断线
+    if (outage == in_outage)
+        return;
+
+    Sim_Esp_Account();
+    in_outage = outage;
+    if (outage)
+    {
+        net_stats.outages++;
+        if (tcp_connected)
+            Sim_Esp_Reply(0, "CLOSED\r\n");
+        tcp_connected = 0;
+        Sim_Esp_Reply(0, "WIFI DISCONNECT\r\n");
+    }
+    else
+    {
+        wifi_ready_ns = Sim_NowNs() + 2000 * ESP_MS;
+        Sim_Esp_Reply(2000, "WIFI CONNECTED\r\nWIFI GOT IP\r\n");
+    }
+}
+
+/**
+  * @brief  执行一条AT指令
+  */
+static void Sim_Esp_Command(const char *cmd)
+{
+    char echo[ESP_LINE_SIZE + 4];
+
+    net_stats.at_commands++;
+    snprintf(echo, sizeof(echo), "%s\r\n", cmd);
+    Sim_Esp_Reply(1, echo);
+
+    if (strcmp(cmd, "AT") == 0 || strncmp(cmd, "ATE", 3) == 0)
+        Sim_Esp_Reply(2, "\r\nOK\r\n");
+    else if (strcmp(cmd, "AT+RST") == 0)
+    {
+        Sim_Esp_Reply(2, "\r\nOK\r\n");
+        Sim_Esp_Reboot(600);
+    }
+    else if (strncmp(cmd, "AT+CWJAP=", 9) == 0)
+    {
+        tcp_connected = 0;
+        if (in_outage)
+        {
+            Sim_Esp_Reply(5000, "WIFI DISCONNECT\r\n+CWJAP:3\r\n\r\nFAIL\r\n");
+        }
+        else
+        {
+            wifi_ready_ns = Sim_NowNs() + 3000 * ESP_MS;
+            Sim_Esp_Reply(1500, "WIFI DISCONNECT\r\nWIFI CONNECTED\r\n");
+            Sim_Esp_Reply(3000, "WIFI GOT IP\r\n\r\nOK\r\n");
+        }
+    }
+    else if (strncmp(cmd, "AT+SLEEP=", 9) == 0)
+    {
+        Sim_Esp_Account();
+        sleep_mode = (uint8_t)atoi(cmd + 9);
+        Sim_Esp_Reply(2, "\r\nOK\r\n");
+    }
+    else if (strcmp(cmd, "AT+CIPSTATUS") == 0)
+    {
+        Sim_Esp_Reply(5, !Sim_Esp_WifiUp() ? "STATUS:5\r\n\r\nOK\r\n" :
+                         tcp_connected ? "STATUS:3\r\n\r\nOK\r\n" : "STATUS:2\r\n\r\nOK\r\n");
+    }
+    else if (strncmp(cmd, "AT+CIPSTART=", 12) == 0)
+    {
+        if (!Sim_Esp_WifiUp())
+            Sim_Esp_Reply(20, "\r\nERROR\r\nCLOSED\r\n");
+        else if (tcp_connected)
+            Sim_Esp_Reply(5, "ALREADY CONNECTED\r\n\r\nERROR\r\n");
+        else
+        {
+            tcp_connected = 1;
+            Sim_Esp_Reply(Sim_Config.net_latency_ms, "CONNECT\r\n\r\nOK\r\n");
+        }
+    }
+    else if (strcmp(cmd, "AT+CIPCLOSE") == 0)
+    {
+        Sim_Esp_Reply(20, tcp_connected ? "CLOSED\r\n\r\nOK\r\n" : "\r\nERROR\r\n");
+        tcp_connected = 0;
+    }
+    else if (strncmp(cmd, "AT+CIPMODE=", 11) == 0)
+    {
+        cipmode = (uint8_t)atoi(cmd + 11);
+        Sim_Esp_Reply(2, "\r\nOK\r\n");
+    }
+    else if (strcmp(cmd, "AT+CIPSEND") == 0)
+    {
+        if (cipmode == 1 && tcp_connected)
+        {
+            Sim_Esp_Reply(2, "\r\nOK\r\n\r\n>");
+            transparent = 1;
+            http_state = ESP_HTTP_HEADER;
+            http_len = 0;
+            request_bytes = 0;
+        }
+        else
+            Sim_Esp_Reply(2, "\r\nERROR\r\n");
+    }
+    else
+        Sim_Esp_Reply(2, "\r\nERROR\r\n");
+}
+
+/**
+  * @brief  核对补传的一格：与这段时间内固件输出的处理结果的平均值比较
+  * @param  s: 解出的格，时间戳为格起点
+  * @param  res: 格宽(s)
+  * @retval 1:一致 0:不符
+  * @note   固件的RTC与仿真时钟有亚秒到数秒的偏差，格边界附近的采样可能
+  *          归入相邻的格，按最多3个采样归错放宽
+  */
+static int Sim_Esp_CheckSlot(const BatchSample_t *s, uint32_t res)
+{
+    int32_t sum[ALARM_CH_COUNT] = { 0 };
+    int16_t min[ALARM_CH_COUNT], max[ALARM_CH_COUNT];
+    uint32_t count = 0, sec;
+    int ch;
+
+    for (sec = s->ts; sec - s->ts < res; sec++)
+    {
+        const EspSampleSec_t *e = &sample_log[sec & (ESP_SAMPLE_LOG - 1)];
+
+        if (e->sec != sec || e->count == 0)
+            continue;
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        {
+            if (count == 0 || e->min[ch] < min[ch])
+                min[ch] = e->min[ch];
+            if (count == 0 || e->max[ch] > max[ch])
+                max[ch] = e->max[ch];
+            sum[ch] += e->sum[ch];
+        }
+        count += e->count;
+    }
+    if (count == 0)
+        return 0;
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        double mean = (double)sum[ch] / count;
+        double tol = 1.0 + (max[ch] - min[ch]) * 3.0 / count;
+
+        if (s->value[ch] < mean - tol || s->value[ch] > mean + tol)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+  * @brief  用固件的参考解码器解出批量上传，逐个采样核对
+  * @param  field: "batch"字段的值，从引号后开始
+  * @param  count: "n"字段的值
+  * @param  res: "res"字段的值，0表示逐个采样
+  * @param  mismatched: 存放与固件数据不符的采样数
+  * @retval 解出的采样数，解码失败或与"n"不符时为-1
+  * @note   逐个采样的上传与固件队列中尚未移除的采样比较，时间戳和三个
+  *          通道须完全相同；补传的格与Sim_Esp_CheckSlot的平均值比较
+  */
+static int Sim_Esp_DecodeBatch(const char *field, uint32_t count, uint32_t res, uint32_t *mismatched)
+{
+    static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static BatchSample_t samples[1024];
+    uint8_t data[ESP_HTTP_SIZE];
+    uint32_t bits = 0, acc = 0;
+    int len = 0, n, i;
+    const char *p;
+
+    *mismatched = 0;
+    for (; *field && *field != '"' && *field != '='; field++)
+    {
+        if ((p = strchr(digits, *field)) == NULL)
+            return -1;
+        acc = (acc << 6) | (uint32_t)(p - digits);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            data[len++] = (uint8_t)(acc >> bits);
+        }
+    }
+    n = Batch_Decode(data, len, samples, 1024);
+    if (n != (int)count)
+        return -1;
+
+    for (i = 0; i < n; i++)
+    {
+        BatchSample_t queued;
+        int ok;
+
+        if (res)
+            ok = !sample_seen || Sim_Esp_CheckSlot(&samples[i], res);
+        else
+            ok = Batch_Peek((uint16_t)i, &queued) && queued.ts == samples[i].ts &&
+                 memcmp(queued.value, samples[i].value, sizeof(queued.value)) == 0;
+        if (!ok)
+        {
+            (*mismatched)++;
+            if (Sim_Config.verbose)
+                printf("[sim] %10.3f s  batch sample %d ts %lu (%d, %d, %d) does not match\n",
+                       Sim_NowNs() / 1e9, i, (unsigned long)samples[i].ts, samples[i].value[0],
+                       samples[i].value[1], samples[i].value[2]);
+        }
+    }
+    return n;
+}
+
+/**
+  * @brief  固件输出一条处理结果，按仿真时钟的秒记下，供核对补传
+  * @param  temp: 温度(0.1℃)
+  * @param  humi: 湿度(0.1%)
+  * @param  light: 光照值
+  * @retval 无
+  */
+void Sim_Esp_Sample(int16_t temp, int16_t humi, uint16_t light)
+{
+    uint32_t sec = (uint32_t)(Sim_Config.epoch + Sim_NowNs() / 1000000000ULL);
+    EspSampleSec_t *e = &sample_log[sec & (ESP_SAMPLE_LOG - 1)];
+    int16_t value[ALARM_CH_COUNT] = { temp, humi, (int16_t)light };
+    int ch;
+
+    if (e->sec != sec)
+    {
+        memset(e, 0, sizeof(*e));
+        e->sec = sec;
+    }
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        if (e->count == 0 || value[ch] < e->min[ch])
+            e->min[ch] = value[ch];
+        if (e->count == 0 || value[ch] > e->max[ch])
+            e->max[ch] = value[ch];
+        e->sum[ch] += value[ch];
+    }
+    e->count++;
+    sample_seen = 1;
+}
+
+/**
+  * @brief  一个完整的HTTP请求已到达服务器，按故障模型返回应答
+  */
+static void Sim_Esp_HttpDone(void)
+{
+    uint32_t latency = Sim_Config.net_latency_ms;
+    const char *cfg = strstr(http_buf, "\"cfg\": ");
+    const char *count = strstr(http_buf, "\"n\": ");
+    const char *batch = strstr(http_buf, "\"batch\": \"");
+    const char *res = strstr(http_buf, "\"res\": ");
+    const char *event = strstr(http_buf, "\"events\": [");
+    char reply[ESP_LINE_SIZE * 2];
+    char date[40];
+    time_t now = (time_t)(Sim_Config.epoch + Sim_NowNs() / 1000000000ULL);
+    struct tm tm;
+    uint8_t push;
+
+    /* 服务器核对上传中回报的配置编号 */
+    if (Sim_Config.push && cfg && !net_stats.push_acked &&
+        strtoul(cfg + 7, NULL, 10) == push_id)
+    {
+        net_stats.push_acked = 1;
+        net_stats.push_ack_ns = Sim_NowNs();
+        if (Sim_Config.verbose)
+            printf("[sim] %10.3f s  config %lu acknowledged\n", Sim_NowNs() / 1e9,
+                   (unsigned long)push_id);
+    }
+    push = Sim_Config.push && !net_stats.push_acked &&
+           Sim_NowNs() >= Sim_Config.push_at_ms * ESP_MS;
+
+    http_state = ESP_HTTP_HEADER;
+    http_len = 0;
+    net_stats.requests++;
+    if (strstr(http_buf, "\"window\": ") && count)
+    {
+        net_stats.summaries++;
+        net_stats.summarized += strtoul(count + 5, NULL, 10);
+    }
+    if (batch && count)
+    {
+        uint32_t mismatched;
+        int n = Sim_Esp_DecodeBatch(batch + 10, strtoul(count + 5, NULL, 10),
+                                    res ? strtoul(res + 7, NULL, 10) : 0, &mismatched);
+        uint8_t verified = n > 0 && mismatched == 0;
+
+        /* 只有全部核对一致的上传计入采样数和字节数 */
+        if (!verified)
+            net_stats.batch_errors++;
+        net_stats.batch_mismatched += mismatched;
+        if (res)
+        {
+            net_stats.backfills++;
+            if (verified)
+                net_stats.backfilled += n;
+        }
+        else
+        {
+            net_stats.batches++;
+            if (verified)
+            {
+                net_stats.batched += n;
+                net_stats.batch_bytes += request_bytes;
+            }
+        }
+    }
+    request_bytes = 0;
+    if (event)
+    {
+        net_stats.event_uploads++;
+        while ((event = strstr(event, "\"id\": ")) != NULL)
+        {
+            net_stats.events++;
+            event += 6;
+        }
+    }
+
+    if (Sim_Config.net_jitter_ms)
+        latency += Sim_Rand() % (Sim_Config.net_jitter_ms + 1);
+
+    if (Sim_Chance(Sim_Config.net_drop))
+        net_stats.dropped++;
+    else
+    {
+        /* Date在服务器处理请求时取值，截断到秒 */
+        gmtime_r(&now, &tm);
+        strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        net_stats.responses++;
+        net_stats.pushes += push;
+        snprintf(reply, sizeof(reply), "HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: application/json\r\n"
+                                       "Content-Length: %u\r\n"
+                                       "Date: %s\r\n"
+                                       "Connection: keep-alive\r\n"
+                                       "\r\n%s",
+                 push ? (unsigned)strlen(Sim_Config.push) : 0, date, push ? Sim_Config.push : "");
+        Sim_Esp_Reply(latency, reply);
+    }
+
+    if (Sim_Chance(Sim_Config.net_close))
+    {
+        net_stats.closes++;
+        tcp_connected = 0;
+        Sim_Esp_Reply(latency, "CLOSED\r\n");
+    }
+    if (Sim_Chance(Sim_Config.net_reset))
+    {
+        net_stats.resets++;
+        Sim_Esp_Reboot(latency);
+    }
+}
+
+/**
+  * @brief  透传模式下接收的字节，按HTTP请求解析
+  */
+static void Sim_Esp_HttpByte(uint8_t byte)
+{
+    if (!tcp_connected)
+    {
+        net_stats.lost++;       // 链路已断，透传数据被模块丢弃
+        return;
+    }
+    net_stats.http_bytes++;
+    request_bytes++;
+
+    /* 请求体接在请求头后面保存，用于核对回报的配置编号 */
+    if (http_state == ESP_HTTP_BODY)
+    {
+        if (http_len < ESP_HTTP_SIZE - 1)
+            http_buf[http_len++] = (char)byte;
+        http_buf[http_len] = '\0';
+        if (--body_left == 0)
+            Sim_Esp_HttpDone();
+        return;
+    }
+
+    /* 请求之间多出的空行（固件在请求体后追加了CRLF）直接跳过 */
+    if (http_len == 0 && (byte == '\r' || byte == '\n'))
+        return;
+    if (http_len < ESP_HTTP_SIZE - 1)
+        http_buf[http_len++] = (char)byte;
+    http_buf[http_len] = '\0';
+
+    if (http_len >= 4 && memcmp(http_buf + http_len - 4, "\r\n\r\n", 4) == 0)
+    {
+        const char *cl = strstr(http_buf, "Content-Length:");
+
+        body_left = cl ? (uint32_t)strtoul(cl + 15, NULL, 10) : 0;
+        if (body_left)
+            http_state = ESP_HTTP_BODY;
+        else
+            Sim_Esp_HttpDone();
+    }
+}
+
+/**
+  * @brief  复位模型状态
+  * @param  无
+  * @retval 无
+  */
+void Sim_Esp_Reset(void)
+{
+    out_head = out_tail = 0;
+    out_last_ready = 0;
+    line_len = 0;
+    wifi_ready_ns = 0;
+    in_outage = 0;
+    tcp_connected = 0;
+    cipmode = 0;
+    transparent = 0;
+    plus_count = 0;
+    http_state = ESP_HTTP_HEADER;
+    http_len = 0;
+    request_bytes = 0;
+    powered = 1;
+    sleep_mode = 0;
+    boot_done_ns = 0;
+    active_until_ns = 0;
+    charge_ns = 0;
+    memset(&net_stats, 0, sizeof(net_stats));
+
+    if (Sim_Config.push)
+    {
+        const char *cfg = strstr(Sim_Config.push, "\"cfg\"");
+        push_id = cfg ? (uint32_t)strtoul(cfg + 6 + strspn(cfg + 6, " :"), NULL, 10) : 0;
+    }
+}
+
+/**
+  * @brief  CH_PD引脚电平变化
+  * @param  on: 1:拉高上电 0:拉低断电
+  * @retval 无
+  * @note   断电丢弃全部状态和待发应答；上电后按重启处理，300ms后接受AT指令，
+  *          约2s后自动连上保存的热点
+  */
+void Sim_Esp_SetPower(uint8_t on)
+{
+    if (on == powered)
+        return;
+
+    Sim_Esp_Account();
+    powered = on;
+    out_head = out_tail = 0;
+    out_last_ready = 0;
+    if (on)
+    {
+        net_stats.power_ups++;
+        boot_done_ns = Sim_NowNs() + ESP_BOOT_NS;
+        Sim_Esp_Reboot(ESP_BOOT_NS / ESP_MS);
+    }
+    else
+    {
+        sleep_mode = 0;
+        tcp_connected = 0;
+        cipmode = 0;
+        transparent = 0;
+        plus_count = 0;
+        line_len = 0;
+        http_state = ESP_HTTP_HEADER;
+        http_len = 0;
+        request_bytes = 0;
+    }
+}
+
+/**
+  * @brief  模块收到一个字节
+  * @param  byte: 固件经USART1发出的数据
+  * @retval 无
+  */
+void Sim_Esp_Input(uint8_t byte)
+{
+    uint64_t now = Sim_NowNs();
+    uint64_t gap = now - last_rx_ns;
+
+    /* 断电或启动期间不接收 */
+    if (!powered || now < boot_done_ns)
+        return;
+    last_rx_ns = now;
+    Sim_Esp_Activity();
+
+    if (transparent)
+    {
+        /* "+++"必须前后静默，否则按普通数据透传 */
+        if (byte == '+' && (plus_count > 0 || gap >= ESP_ESCAPE_GAP_NS) && plus_count < 3)
+        {
+            plus_count++;
+            return;
+        }
+        while (plus_count)
+        {
+            plus_count--;
+            Sim_Esp_HttpByte('+');
+        }
+        Sim_Esp_HttpByte(byte);
+        return;
+    }
+
+    /* 命令模式下孤立的"+++"被模块丢弃 */
+    if (line_len == 3 && memcmp(line, "+++", 3) == 0 && gap >= ESP_ESCAPE_GAP_NS)
+        line_len = 0;
+
+    if (byte == '\n')
+    {
+        if (line_len && line[line_len - 1] == '\r')
+            line_len--;
+        line[line_len] = '\0';
+        if (line_len)
+            Sim_Esp_Command(line);
+        line_len = 0;
+    }
+    else if (line_len < ESP_LINE_SIZE - 1)
+        line[line_len++] = (char)byte;
+}
+
+/**
+  * @brief  取模块要发给固件的下一个字节
+  * @param  byte: 输出数据
+  * @retval 1:有数据 0:无数据
+  */
+int Sim_Esp_Output(uint8_t *byte)
+{
+    uint64_t now = Sim_NowNs();
+
+    Sim_Esp_UpdateOutage();
+
+    if (transparent && plus_count == 3 && now - last_rx_ns >= ESP_ESCAPE_GAP_NS)
+    {
+        transparent = 0;
+        plus_count = 0;
+    }
+
+    if (out_head == out_tail || out_ready[out_tail & (ESP_OUT_SIZE - 1)] > now)
+        return 0;
+    *byte = out_buf[out_tail & (ESP_OUT_SIZE - 1)];
+    out_tail++;
+    Sim_Esp_Activity();
+    return 1;
+}
+
+/**
+  * @brief  获取到达服务器的HTTP请求数
+  * @param  无
+  * @retval 上传次数
+  */
+uint32_t Sim_Esp_UploadCount(void)
+{
+    return net_stats.requests;
+}
+
+/**
+  * @brief  获取网络模型统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const SimNetStats_t *Sim_Esp_GetStats(void)
+{
+    Sim_Esp_Account();
+    return &net_stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
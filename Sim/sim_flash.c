@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @file    sim_flash.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   片内Flash与CRC单元模型
+  * @note    固件按地址直接读取Flash中的配置记录，这里在主机进程的同一地址
+  *          （FLASH_BASE起64KB）映射一块内存，平时只读，擦写函数临时放开写
+  *          权限。擦除后为0xFF，半字不是0xFFFF时再写入报PGERR，与芯片一致。
+  *          映像可用--flash保存到文件，下一次运行载入后相当于重新上电。
+  *          系统存储区中的Flash容量和96位唯一ID也映射到原地址，唯一ID由
+  *          --seed导出，不同种子相当于不同的芯片
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+#define SIM_FLASH_SIZE      0x10000     // STM32F103C8
+#define SIM_FLASH_PAGE      0x400
+#define SIM_ERASE_NS        20000000U   // 页擦除典型值20ms
+#define SIM_PROGRAM_NS      105000U     // 字编程，两个半字各约52.5us
+#define SIM_CRC_CYCLES      4           // 每个字的计算周期
+#define SIM_SYSMEM_BASE     0x1FFFF000  // 系统存储区最后一页，含F_SIZE和UID
+#define SIM_SYSMEM_SIZE     0x1000
+#define SIM_FSIZE_OFFSET    0x7E0
+#define SIM_UID_OFFSET      0x7E8
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t *flash = NULL;
+static uint8_t locked = 1;
+static uint32_t crc_dr = 0xFFFFFFFF;
+static SimFlashStats_t stats;
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  地址是否在模型范围内
+  */
+static int Sim_Flash_InRange(uint32_t addr, uint32_t len)
+{
+    return addr >= FLASH_BASE && addr - FLASH_BASE + len <= SIM_FLASH_SIZE;
+}
+
+/**
+  * @brief  放开或收回写权限
+  */
+static void Sim_Flash_Writable(int on)
+{
+    mprotect(flash, SIM_FLASH_SIZE, on ? PROT_READ | PROT_WRITE : PROT_READ);
+}
+
+/**
+  * @brief  在指定地址映射一块可读写的匿名内存
+  */
+static uint8_t *Sim_Flash_Map(uint32_t addr, uint32_t size)
+{
+    void *p = mmap((void *)(uintptr_t)addr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p == MAP_FAILED)
+        return NULL;
+    if (p != (void *)(uintptr_t)addr)
+    {
+        munmap(p, size);
+        return NULL;
+    }
+    return p;
+}
+
+/**
+  * @brief  映射系统存储区，写入Flash容量和由随机数种子导出的唯一ID
+  */
+static int Sim_Flash_MapSystem(void)
+{
+    uint8_t *sys = Sim_Flash_Map(SIM_SYSMEM_BASE, SIM_SYSMEM_SIZE);
+    uint64_t x = Sim_Config.seed;
+    uint16_t fsize = SIM_FLASH_SIZE / 1024;
+    int i;
+
+    if (sys == NULL)
+        return -1;
+    memset(sys, 0xFF, SIM_SYSMEM_SIZE);
+    memcpy(sys + SIM_FSIZE_OFFSET, &fsize, sizeof(fsize));
+
+    /* splitmix64，相邻种子得到的ID也互不相关 */
+    for (i = 0; i < 12; i++)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        sys[SIM_UID_OFFSET + i] = (uint8_t)(z ^ (z >> 31));
+    }
+    mprotect(sys, SIM_SYSMEM_SIZE, PROT_READ);
+    return 0;
+}
+
+/* 初始化与映像文件 ----------------------------------------------------------*/
+/**
+  * @brief  在FLASH_BASE映射64KB，内容为擦除状态，并映射系统存储区
+  * @param  无
+  * @retval 0:成功 -1:地址已被占用
+  * @note   须在Sim_Config.seed确定后调用
+  */
+int Sim_Flash_Init(void)
+{
+    flash = Sim_Flash_Map(FLASH_BASE, SIM_FLASH_SIZE);
+    if (flash == NULL || Sim_Flash_MapSystem() != 0)
+        return -1;
+    memset(flash, 0xFF, SIM_FLASH_SIZE);
+    Sim_Flash_Writable(0);
+    return 0;
+}
+
+/**
+  * @brief  载入上次运行保存的映像
+  * @param  path: 文件路径，不存在时保持擦除状态
+  * @retval 0:成功 -1:大小不符
+  */
+int Sim_Flash_Load(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    size_t n;
+
+    if (fp == NULL)
+        return 0;
+    Sim_Flash_Writable(1);
+    n = fread(flash, 1, SIM_FLASH_SIZE, fp);
+    Sim_Flash_Writable(0);
+    fclose(fp);
+    return n == SIM_FLASH_SIZE ? 0 : -1;
+}
+
+/**
+  * @brief  保存映像
+  * @param  path: 文件路径
+  * @retval 无
+  */
+void Sim_Flash_Save(const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+
+    if (fp == NULL || fwrite(flash, 1, SIM_FLASH_SIZE, fp) != SIM_FLASH_SIZE)
+        fprintf(stderr, "[sim] cannot write %s\n", path);
+    if (fp)
+        fclose(fp);
+}
+
+/**
+  * @brief  获取擦写统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const SimFlashStats_t *Sim_Flash_GetStats(void)
+{
+    return &stats;
+}
+
+/* FLASH ---------------------------------------------------------------------*/
+void FLASH_Unlock(void)
+{
+    locked = 0;
+}
+
+void FLASH_Lock(void)
+{
+    locked = 1;
+}
+
+void FLASH_ClearFlag(uint32_t FLASH_FLAG)
+{
+    (void)FLASH_FLAG;
+}
+
+FLASH_Status FLASH_ErasePage(uint32_t Page_Address)
+{
+    uint32_t base = Page_Address & ~(uint32_t)(SIM_FLASH_PAGE - 1);
+
+    if (locked || !Sim_Flash_InRange(base, SIM_FLASH_PAGE))
+    {
+        stats.errors++;
+        return FLASH_ERROR_WRP;
+    }
+    Sim_Flash_Writable(1);
+    memset(flash + (base - FLASH_BASE), 0xFF, SIM_FLASH_PAGE);
+    Sim_Flash_Writable(0);
+    stats.erases++;
+    Sim_Charge(SIM_ERASE_NS);
+    return FLASH_COMPLETE;
+}
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
+{
+    uint16_t *hw;
+
+    if (locked || (Address & 3) || !Sim_Flash_InRange(Address, 4))
+    {
+        stats.errors++;
+        return FLASH_ERROR_WRP;
+    }
+    hw = (uint16_t *)(flash + (Address - FLASH_BASE));
+    Sim_Charge(SIM_PROGRAM_NS);
+
+    /* 按半字编程，目标不是擦除状态且写入值不为0时报错 */
+    if ((hw[0] != 0xFFFF && (uint16_t)Data != 0) || (hw[1] != 0xFFFF && (Data >> 16) != 0))
+    {
+        stats.errors++;
+        return FLASH_ERROR_PG;
+    }
+    Sim_Flash_Writable(1);
+    hw[0] = (uint16_t)Data;
+    hw[1] = (uint16_t)(Data >> 16);
+    Sim_Flash_Writable(0);
+    stats.words++;
+    return FLASH_COMPLETE;
+}
+
+/* CRC -----------------------------------------------------------------------*/
+/* 多项式0x04C11DB7，初值全1，按字从高位到低位移入，不取反 */
+void CRC_ResetDR(void)
+{
+    crc_dr = 0xFFFFFFFF;
+}
+
+uint32_t CRC_CalcCRC(uint32_t Data)
+{
+    uint8_t i;
+
+    crc_dr ^= Data;
+    for (i = 0; i < 32; i++)
+        crc_dr = (crc_dr & 0x80000000) ? (crc_dr << 1) ^ 0x04C11DB7 : crc_dr << 1;
+    Sim_Rcc_Cycles(SIM_CRC_CYCLES);
+    return crc_dr;
+}
+
+uint32_t CRC_CalcBlockCRC(uint32_t pBuffer[], uint32_t BufferLength)
+{
+    uint32_t i;
+
+    for (i = 0; i < BufferLength; i++)
+        CRC_CalcCRC(pBuffer[i]);
+    return crc_dr;
+}
+
+uint32_t CRC_GetCRC(void)
+{
+    return crc_dr;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
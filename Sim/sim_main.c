@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  * @file    sim_main.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主机仿真入口
+  * @note    代替User/main.c：解析命令行参数，打开串口后端，然后与目标板
+  *          一样调用App_Init和App_MainLoop。用法见Sim/README.md
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "App/app.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+/* 全局变量 ------------------------------------------------------------------*/
+SimConfig_t Sim_Config = {
+    .duration_ms = 0,
+    .realtime    = 0,
+    .verbose     = 0,
+    .uart        = "model",
+    .oled        = "none",
+    .oled_png    = NULL,
+    .temperature = 25.0,
+    .humidity    = 55.0,
+    .lux         = 500.0,
+    .env         = "const",
+    .seed        = 1,
+    .json        = NULL,
+    .trace       = NULL,
+    .replay      = NULL,
+    .oled_decode = 0,
+    .net_latency_ms = 120,
+    .epoch       = 1792281600,  // 2026-10-18 00:00:00 UTC
+};
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t finishing = 0;
+
+/**
+  * @brief  结束仿真：输出统计并退出
+  * @param  无
+  * @retval 无
+  */
+void Sim_Finish(void)
+{
+    if (finishing)
+        return;
+    finishing = 1;
+
+    if (strcmp(Sim_Config.oled, "term") == 0)
+        Sim_Oled_Render();
+    if (Sim_Config.oled_png && Sim_Oled_SavePng(Sim_Config.oled_png) != 0)
+        fprintf(stderr, "[sim] cannot write %s\n", Sim_Config.oled_png);
+
+    Sim_Stats_Report();
+    if (Sim_Config.bkp)
+        Sim_Bkp_Save(Sim_Config.bkp);
+    if (Sim_Config.flash)
+        Sim_Flash_Save(Sim_Config.flash);
+
+    Sim_Uart_Close();
+    fflush(stdout);
+    exit(0);
+}
+
+static void Sim_Usage(const char *prog)
+{
+    printf("usage: %s [options]\n"
+           "  --duration=SEC     stop after SEC seconds of virtual time (default: run forever)\n"
+           "  --realtime         pace virtual time to the wall clock\n"
+           "  --fast             run as fast as possible (default)\n"
+           "  --uart=BACKEND     model | pty | tcp:HOST:PORT (default: model)\n"
+           "  --oled=MODE        none | term (default: none)\n"
+           "  --oled-png=FILE    save the OLED frame as PNG on exit\n"
+           "  --temp=C --humi=RH --lux=L   environment seen by the sensors\n"
+           "  --env=MODE         const | diurnal | FILE (lines: sec temp humi lux)\n"
+           "  --seed=N           random seed for noise and network faults (default: 1)\n"
+           "  --net-latency=MS   server response latency (default: 120)\n"
+           "  --net-jitter=MS    extra random latency, 0..MS\n"
+           "  --net-drop=P       probability a request gets no response\n"
+           "  --net-close=P      probability the server closes TCP after a request\n"
+           "  --net-reset=P      probability the module reboots after a request\n"
+           "  --outage=PER:LEN   drop WiFi for LEN seconds at the end of every PER seconds\n"
+           "  --push=SEC:JSON    from SEC on, return JSON as a config push in every HTTP\n"
+           "                     response until an upload reports the same \"cfg\"\n"
+           "  --epoch=SEC        Unix time at virtual time 0, sent in the Date header\n"
+           "                     (default: 1792281600, 2026-10-18 00:00:00 UTC)\n"
+           "  --rtc-ppm=PPM      RTC crystal error, positive runs fast (default: 0)\n"
+           "  --bkp=FILE         load backup registers and reset flags from FILE, save on exit\n"
+           "  --flash=FILE       load the 64 KB flash image from FILE, save on exit\n"
+           "  --adc-hang=SEC     ADC stops converting and never recalibrates after SEC s\n"
+           "  --json=FILE        write run statistics as JSON on exit\n"
+           "  --trace=FILE       save the firmware's sensor trace (USART3 stream)\n"
+           "  --replay=FILE      feed DHT11/ADC readings from a trace and compare outputs\n"
+           "  --trace-dump=FILE  print a trace file as CSV and exit\n"
+           "  -v, --verbose      log USART1 traffic and alarm changes\n", prog);
+}
+
+/**
+  * @brief  仿真主函数
+  */
+int main(int argc, char *argv[])
+{
+    static const struct option options[] = {
+        { "duration", required_argument, NULL, 'd' },
+        { "realtime", no_argument,       NULL, 'r' },
+        { "fast",     no_argument,       NULL, 'f' },
+        { "uart",     required_argument, NULL, 'u' },
+        { "oled",     required_argument, NULL, 'o' },
+        { "oled-png", required_argument, NULL, 'p' },
+        { "temp",     required_argument, NULL, 't' },
+        { "humi",     required_argument, NULL, 'h' },
+        { "lux",      required_argument, NULL, 'l' },
+        { "env",      required_argument, NULL, 'e' },
+        { "seed",     required_argument, NULL, 's' },
+        { "json",     required_argument, NULL, 'j' },
+        { "net-latency", required_argument, NULL, 'L' },
+        { "net-jitter",  required_argument, NULL, 'J' },
+        { "net-drop",    required_argument, NULL, 'D' },
+        { "net-close",   required_argument, NULL, 'C' },
+        { "net-reset",   required_argument, NULL, 'R' },
+        { "outage",      required_argument, NULL, 'O' },
+        { "trace",       required_argument, NULL, 'T' },
+        { "replay",      required_argument, NULL, 'P' },
+        { "trace-dump",  required_argument, NULL, 'U' },
+        { "push",        required_argument, NULL, 'S' },
+        { "epoch",       required_argument, NULL, 'E' },
+        { "rtc-ppm",     required_argument, NULL, 'W' },
+        { "bkp",         required_argument, NULL, 'B' },
+        { "flash",       required_argument, NULL, 'F' },
+        { "adc-hang",    required_argument, NULL, 'H' },
+        { "verbose",  no_argument,       NULL, 'v' },
+        { "help",     no_argument,       NULL, '?' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);   // pty名称等提示需要立即可见
+
+    while ((c = getopt_long(argc, argv, "v", options, NULL)) != -1)
+    {
+        switch (c)
+        {
+        case 'd': Sim_Config.duration_ms = (uint64_t)(atof(optarg) * 1000.0); break;
+        case 'r': Sim_Config.realtime = 1; break;
+        case 'f': Sim_Config.realtime = 0; break;
+        case 'u': Sim_Config.uart = optarg; break;
+        case 'o': Sim_Config.oled = optarg; break;
+        case 'p': Sim_Config.oled_png = optarg; break;
+        case 't': Sim_Config.temperature = atof(optarg); break;
+        case 'h': Sim_Config.humidity = atof(optarg); break;
+        case 'l': Sim_Config.lux = atof(optarg); break;
+        case 'e': Sim_Config.env = optarg; break;
+        case 's': Sim_Config.seed = strtoull(optarg, NULL, 0); break;
+        case 'j': Sim_Config.json = optarg; break;
+        case 'L': Sim_Config.net_latency_ms = (uint32_t)atoi(optarg); break;
+        case 'J': Sim_Config.net_jitter_ms = (uint32_t)atoi(optarg); break;
+        case 'D': Sim_Config.net_drop = atof(optarg); break;
+        case 'C': Sim_Config.net_close = atof(optarg); break;
+        case 'R': Sim_Config.net_reset = atof(optarg); break;
+        case 'O':
+            if (sscanf(optarg, "%u:%u", &Sim_Config.outage_period_s, &Sim_Config.outage_len_s) != 2 ||
+                Sim_Config.outage_len_s >= Sim_Config.outage_period_s)
+            {
+                fprintf(stderr, "[sim] --outage expects PERIOD:LEN with LEN < PERIOD\n");
+                return 2;
+            }
+            break;
+        case 'T': Sim_Config.trace = optarg; break;
+        case 'P': Sim_Config.replay = optarg; break;
+        case 'S':
+        {
+            char *json = strchr(optarg, ':');
+            if (json == NULL || strlen(json + 1) > 300)
+            {
+                fprintf(stderr, "[sim] --push expects SEC:JSON with at most 300 bytes of JSON\n");
+                return 2;
+            }
+            Sim_Config.push_at_ms = (uint64_t)(atof(optarg) * 1000.0);
+            Sim_Config.push = json + 1;
+            break;
+        }
+        case 'E': Sim_Config.epoch = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'W': Sim_Config.rtc_ppm = atoi(optarg); break;
+        case 'B': Sim_Config.bkp = optarg; break;
+        case 'F': Sim_Config.flash = optarg; break;
+        case 'H': Sim_Config.adc_hang_ms = (uint64_t)(atof(optarg) * 1000.0); break;
+        case 'U': return Sim_Trace_Dump(optarg) == 0 ? 0 : 1;
+        case 'v': Sim_Config.verbose = 1; break;
+        default:
+            Sim_Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    Sim_Config.oled_decode = Sim_Config.oled_png != NULL || strcmp(Sim_Config.oled, "term") == 0;
+    Sim_RandSeed(Sim_Config.seed);
+    if (Sim_Env_Open(Sim_Config.env) != 0)
+    {
+        fprintf(stderr, "[sim] cannot load environment '%s'\n", Sim_Config.env);
+        return 1;
+    }
+    if (Sim_Trace_Open(Sim_Config.trace, Sim_Config.replay) != 0)
+    {
+        fprintf(stderr, "[sim] cannot open trace '%s'\n",
+                Sim_Config.replay ? Sim_Config.replay : Sim_Config.trace);
+        return 1;
+    }
+    if (Sim_Config.bkp && Sim_Bkp_Load(Sim_Config.bkp) != 0)
+    {
+        fprintf(stderr, "[sim] cannot parse backup file '%s'\n", Sim_Config.bkp);
+        return 1;
+    }
+    if (Sim_Flash_Init() != 0)
+    {
+        fprintf(stderr, "[sim] cannot map flash at 0x%08x\n", (unsigned)FLASH_BASE);
+        return 1;
+    }
+    if (Sim_Config.flash && Sim_Flash_Load(Sim_Config.flash) != 0)
+    {
+        fprintf(stderr, "[sim] flash image '%s' is not 64 KB\n", Sim_Config.flash);
+        return 1;
+    }
+    if (Sim_Uart_Open(Sim_Config.uart) != 0)
+    {
+        fprintf(stderr, "[sim] cannot open uart backend '%s'\n", Sim_Config.uart);
+        return 1;
+    }
+    if (strcmp(Sim_Config.oled, "term") == 0)
+        printf("\x1b[2J");
+
+    Sim_ClockInit();
+    SystemInit();
+    App_Init();
+
+    while (1)
+    {
+        Sim_Stats_LoopBegin();
+        App_MainLoop();
+        Sim_Stats_LoopEnd();
+        if (strcmp(Sim_Config.oled, "term") == 0)
+            Sim_Oled_Render();
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file    sim_oled.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   SSD1306 OLED模型
+  * @note    从PB6/PB7的电平变化中解码软件I2C，按页寻址模式写入128x64显存，
+  *          可在终端中用半高字符块显示，或在退出时保存为PNG
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define OLED_WIDTH      128
+#define OLED_PAGES      8
+#define OLED_HEIGHT     (OLED_PAGES * 8)
+#define OLED_ADDRESS    0x78
+#define PNG_SCALE       2
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t gram[OLED_PAGES][OLED_WIDTH];
+static uint8_t page = 0, column = 0;
+static uint8_t display_on = 0, inverse = 0;
+static uint8_t seg_remap = 0, com_reverse = 0;
+static uint8_t dirty = 0;
+
+/* I2C解码状态 */
+static uint8_t bus_scl = 1, bus_sda = 1;
+static uint8_t bus_active = 0;          // 起始条件之后
+static uint8_t bit_count = 0;
+static uint8_t shift = 0;
+static uint32_t byte_index = 0;         // 本次传输中的字节序号
+static uint8_t addressed = 0;
+static uint8_t data_mode = 0;           // 控制字节：0x00命令 0x40数据
+static uint8_t cmd_args = 0;            // 当前命令还需要的参数字节数
+
+/**
+  * @brief  执行一个命令字节
+  */
+static void Sim_Oled_Command(uint8_t cmd)
+{
+    if (cmd_args)
+    {
+        cmd_args--;             // 对比度、复用率等参数只影响模拟显示效果，忽略
+        return;
+    }
+
+    if (cmd >= 0xB0 && cmd <= 0xB7)
+        page = cmd & 0x07;
+    else if (cmd <= 0x0F)
+        column = (column & 0xF0) | cmd;
+    else if (cmd >= 0x10 && cmd <= 0x1F)
+        column = (uint8_t)((column & 0x0F) | ((cmd & 0x0F) << 4));
+    else switch (cmd)
+    {
+    case 0xAE: display_on = 0; dirty = 1; break;
+    case 0xAF: display_on = 1; dirty = 1; break;
+    case 0xA6: inverse = 0; dirty = 1; break;
+    case 0xA7: inverse = 1; dirty = 1; break;
+    case 0xA0: seg_remap = 0; break;
+    case 0xA1: seg_remap = 1; break;
+    case 0xC0: com_reverse = 0; break;
+    case 0xC8: com_reverse = 1; break;
+    case 0x81: case 0xA8: case 0xD3: case 0xD5: case 0xD9:
+    case 0xDA: case 0xDB: case 0x8D: case 0x20:
+        cmd_args = 1;
+        break;
+    case 0x21: case 0x22:
+        cmd_args = 2;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+  * @brief  处理一个完整接收的字节
+  */
+static void Sim_Oled_Byte(uint8_t byte)
+{
+    if (byte_index == 0)
+        addressed = (byte == OLED_ADDRESS);
+    else if (!addressed)
+        ;
+    else if (byte_index == 1)
+        data_mode = (byte & 0x40) != 0;
+    else if (data_mode)
+    {
+        if (column < OLED_WIDTH)
+        {
+            gram[page][column] = byte;
+            dirty = 1;
+        }
+        column = (column + 1) % OLED_WIDTH;
+    }
+    else
+        Sim_Oled_Command(byte);
+    byte_index++;
+}
+
+/**
+  * @brief  SCL/SDA电平变化
+  * @param  scl: SCL电平
+  * @param  sda: SDA电平
+  * @retval 无
+  */
+void Sim_Oled_PinWrite(uint8_t scl, uint8_t sda)
+{
+    if (scl && bus_scl && sda != bus_sda)
+    {
+        /* SCL高电平期间SDA跳变：起始或停止条件 */
+        bus_active = !sda;
+        bit_count = 0;
+        shift = 0;
+        byte_index = 0;
+    }
+    else if (scl && !bus_scl && bus_active)
+    {
+        /* SCL上升沿采样，第9个时钟为应答位 */
+        if (bit_count < 8)
+            shift = (uint8_t)((shift << 1) | sda);
+        if (++bit_count == 9)
+        {
+            Sim_Oled_Byte(shift);
+            bit_count = 0;
+            shift = 0;
+        }
+    }
+    bus_scl = scl;
+    bus_sda = sda;
+}
+
+/**
+  * @brief  读取显示像素（已考虑扫描方向）
+  */
+static uint8_t Sim_Oled_Pixel(int x, int y)
+{
+    int cx = seg_remap ? x : OLED_WIDTH - 1 - x;
+    int cy = com_reverse ? y : OLED_HEIGHT - 1 - y;
+    uint8_t on;
+
+    if (!display_on)
+        return 0;
+    on = (gram[cy / 8][cx] >> (cy % 8)) & 1;
+    return inverse ? !on : on;
+}
+
+/**
+  * @brief  在终端中重绘OLED画面
+  * @param  无
+  * @retval 无
+  * @note   每个字符显示上下两个像素，画面没有变化时不重绘
+  */
+void Sim_Oled_Render(void)
+{
+    static const char *blocks[4] = { " ", "\xe2\x96\x80", "\xe2\x96\x84", "\xe2\x96\x88" };
+    int x, y;
+
+    if (!dirty)
+        return;
+    dirty = 0;
+
+    fputs("\x1b[H", stdout);
+    fputs("+", stdout);
+    for (x = 0; x < OLED_WIDTH; x++) fputs("-", stdout);
+    fputs("+\n", stdout);
+    for (y = 0; y < OLED_HEIGHT; y += 2)
+    {
+        fputs("|", stdout);
+        for (x = 0; x < OLED_WIDTH; x++)
+            fputs(blocks[Sim_Oled_Pixel(x, y) | (Sim_Oled_Pixel(x, y + 1) << 1)], stdout);
+        fputs("|\n", stdout);
+    }
+    fputs("+", stdout);
+    for (x = 0; x < OLED_WIDTH; x++) fputs("-", stdout);
+    fputs("+\x1b[K\n", stdout);
+    fflush(stdout);
+}
+
+/* PNG输出 -------------------------------------------------------------------*/
+static uint32_t Sim_Crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    size_t i;
+    int k;
+
+    crc = ~crc;
+    for (i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void Sim_PutBe32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void Sim_PngChunk(FILE *fp, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t hdr[8];
+    uint32_t crc;
+
+    Sim_PutBe32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    crc = Sim_Crc32(0, hdr + 4, 4);
+    crc = Sim_Crc32(crc, data, len);
+    fwrite(hdr, 1, 8, fp);
+    fwrite(data, 1, len, fp);
+    Sim_PutBe32(hdr, crc);
+    fwrite(hdr, 1, 4, fp);
+}
+
+/**
+  * @brief  把OLED画面保存为PNG
+  * @param  path: 文件路径
+  * @retval 0:成功 -1:失败
+  * @note   8位灰度，放大PNG_SCALE倍；数据量小于64KB，用单个不压缩的deflate块
+  */
+int Sim_Oled_SavePng(const char *path)
+{
+    enum { W = OLED_WIDTH * PNG_SCALE, H = OLED_HEIGHT * PNG_SCALE, RAW = (W + 1) * H };
+    static uint8_t idat[2 + 5 + RAW + 4];
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    uint8_t ihdr[13];
+    uint8_t *raw = idat + 7;
+    uint32_t a = 1, b = 0;
+    uint32_t i;
+    int x, y;
+    FILE *fp;
+
+    for (y = 0; y < H; y++)
+    {
+        uint8_t *row = raw + y * (W + 1);
+        row[0] = 0;             // 无滤波
+        for (x = 0; x < W; x++)
+            row[1 + x] = Sim_Oled_Pixel(x / PNG_SCALE, y / PNG_SCALE) ? 0xFF : 0x00;
+    }
+    for (i = 0; i < RAW; i++)
+    {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    idat[0] = 0x78;             // zlib头：deflate，32K窗口
+    idat[1] = 0x01;
+    idat[2] = 0x01;             // 最后一个块，不压缩
+    idat[3] = (uint8_t)(RAW & 0xFF);
+    idat[4] = (uint8_t)(RAW >> 8);
+    idat[5] = (uint8_t)(~RAW & 0xFF);
+    idat[6] = (uint8_t)((~RAW >> 8) & 0xFF);
+    Sim_PutBe32(idat + 7 + RAW, (b << 16) | a);
+
+    Sim_PutBe32(ihdr, W);
+    Sim_PutBe32(ihdr + 4, H);
+    ihdr[8] = 8;                // 位深
+    ihdr[9] = 0;                // 灰度
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+
+    fp = fopen(path, "wb");
+    if (fp == NULL)
+        return -1;
+    fwrite(sig, 1, sizeof(sig), fp);
+    Sim_PngChunk(fp, "IHDR", ihdr, sizeof(ihdr));
+    Sim_PngChunk(fp, "IDAT", idat, sizeof(idat));
+    Sim_PngChunk(fp, "IEND", NULL, 0);
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
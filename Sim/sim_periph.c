@@ -0,0 +1,982 @@
+/**
+  ******************************************************************************
+  * @file    sim_periph.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   标准外设库的仿真实现
+  * @note    代替Library/中固件用到的函数。外设指针只作为标识比较，从不解引用；
+  *          定时器和串口按虚拟时钟产生事件，并调用固件中的中断处理函数
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define SIM_GPIO_CYCLES     11      // 一次GPIO库函数调用的周期数，72MHz时约150ns
+#define SIM_POLL_CYCLES     10      // 轮询一次状态寄存器的周期数
+#define SIM_ADC_CAL_CYCLES  83      // 校准，按ADCCLK计
+#define SIM_BAUD_TOLERANCE  40      // 波特率偏差超过1/40（2.5%）时收发出错
+#define SIM_UART_IDLE_NS    1000000ULL  // 串口后端空闲时的轮询间隔
+
+/* 中断处理函数（由固件提供，未链接时为空） ----------------------------------*/
+extern void TIM1_UP_IRQHandler(void) __attribute__((weak));
+extern void TIM2_IRQHandler(void) __attribute__((weak));
+extern void TIM3_IRQHandler(void) __attribute__((weak));
+extern void TIM4_IRQHandler(void) __attribute__((weak));
+extern void USART1_IRQHandler(void) __attribute__((weak));
+extern void USART3_IRQHandler(void) __attribute__((weak));
+
+/* 类型定义 ------------------------------------------------------------------*/
+typedef struct {
+    TIM_TypeDef *tim;
+    IRQn_Type irq;
+    void (*handler)(void);
+    uint16_t psc;
+    uint16_t arr;
+    uint8_t enabled;            // CEN
+    uint8_t it_update;          // UIE
+    uint8_t uif;                // 更新中断标志
+    uint8_t urs;                // 1:软件更新事件不置位UIF
+    uint16_t psc_pending;       // 下次溢出时装入的预分频值
+    uint64_t next_ns;           // 下一次溢出时刻
+    uint64_t period_ns;         // 按当前时钟计算的溢出周期
+} SimTimer_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static SimTimer_t sim_timers[] = {
+    { TIM1, TIM1_UP_IRQn, TIM1_UP_IRQHandler, 0, 0xFFFF, 0, 0, 0, 0, 0, 0, 0 },
+    { TIM2, TIM2_IRQn,    TIM2_IRQHandler,    0, 0xFFFF, 0, 0, 0, 0, 0, 0, 0 },
+    { TIM3, TIM3_IRQn,    TIM3_IRQHandler,    0, 0xFFFF, 0, 0, 0, 0, 0, 0, 0 },
+    { TIM4, TIM4_IRQn,    TIM4_IRQHandler,    0, 0xFFFF, 0, 0, 0, 0, 0, 0, 0 },
+};
+#define SIM_TIMER_COUNT     (sizeof(sim_timers) / sizeof(sim_timers[0]))
+
+static uint8_t nvic_enabled[64];
+
+static struct {
+    uint32_t baud;
+    uint32_t brr;               // 初始化时按PCLK2算出的分频值，0表示未初始化
+    uint8_t enabled;
+    uint8_t it_rxne;
+    uint8_t rxne;
+    uint8_t ore;
+    uint16_t rdr;
+    uint64_t next_rx_ns;
+} sim_usart1 = { 115200, 0, 0, 0, 0, 0, 0, UINT64_MAX };
+
+static struct {
+    uint32_t baud;
+    uint32_t brr;               // 初始化时按PCLK1算出的分频值
+    uint8_t enabled;
+    uint8_t it_txe;
+    uint64_t tx_done_ns;        // 发送数据寄存器再次为空的时刻
+} sim_usart3 = { 115200, 0, 0, 0, 0 };     // 采集轨迹输出，仅发送
+
+static uint16_t gpio_odr[3];    // GPIOA~GPIOC输出寄存器
+static uint8_t buzzer_on = 0;
+static uint64_t buzzer_since_ns = 0;    // 本次鸣叫开始时刻
+static uint64_t buzzer_total_ns = 0;    // 已结束的鸣叫累计时长
+
+static struct {
+    uint8_t cont;               // 连续转换
+    uint8_t dma;                // 转换结果由DMA取走
+    uint8_t running;            // 连续转换进行中
+    uint8_t nbr;                // 规则序列长度
+    uint8_t rank;               // 下一次转换的序号
+    uint8_t eoc;
+    uint8_t seq[16];            // 各序号的通道
+    uint8_t smp[18];            // 各通道的采样时间
+    uint64_t conv_ns[16];       // 按当前ADCCLK计算的各序号转换耗时
+    uint64_t seq_ns;            // 一轮扫描的耗时
+    uint64_t last_ns;           // 已完成的转换推进到的时刻
+} sim_adc = { 0, 0, 0, 1 };
+
+static struct {                 // DMA1通道1，只模拟外设到内存的循环模式
+    volatile uint16_t *mem;
+    uint16_t size;
+    uint16_t pos;               // 下一次写入的位置
+    uint8_t enabled;
+    uint8_t wrapped;            // 上次查询后写满过一圈
+    uint32_t flags;             // DMA1_FLAG_xx1
+} sim_dma;
+
+/* 12.5周期转换加上各档采样时间，按ADCCLK计 */
+static const uint16_t sim_adc_cycles[8] = { 14, 20, 26, 41, 54, 68, 84, 252 };
+
+/* 私有函数 ------------------------------------------------------------------*/
+static void Sim_AdcRun(uint64_t end);
+static void Sim_AdcTiming(void);
+
+static SimTimer_t *Sim_FindTimer(TIM_TypeDef *TIMx)
+{
+    uint32_t i;
+
+    for (i = 0; i < SIM_TIMER_COUNT; i++)
+        if (sim_timers[i].tim == TIMx)
+            return &sim_timers[i];
+    return NULL;
+}
+
+/**
+  * @brief  按当前定时器时钟计算溢出周期，TIM1挂在APB2上
+  */
+static uint64_t Sim_TimerPeriodNs(const SimTimer_t *t)
+{
+    uint32_t hz = Sim_Rcc_TimerHz(t->tim == TIM1 ? 2 : 1);
+    return ((uint64_t)t->psc + 1) * ((uint64_t)t->arr + 1) * 1000000000ULL / hz;
+}
+
+/**
+  * @brief  从计数值0重新开始一个周期
+  */
+static void Sim_TimerRestart(SimTimer_t *t)
+{
+    t->period_ns = Sim_TimerPeriodNs(t);
+    t->next_ns = Sim_NowNs() + t->period_ns;
+    Sim_Reschedule();
+}
+
+/**
+  * @brief  按初始化时的分频值和当前PCLK计算实际波特率
+  * @param  brr: 分频值，0表示按标称波特率
+  * @param  baud: 标称波特率
+  * @param  apb: 串口所在的APB总线
+  */
+static uint32_t Sim_UsartBaud(uint32_t brr, uint32_t baud, uint8_t apb)
+{
+    return brr ? Sim_Rcc_PclkHz(apb) / brr : baud;
+}
+
+/**
+  * @brief  实际波特率与标称值偏差过大时记一次时钟错误
+  * @retval 1:字节出错 0:正常
+  */
+static uint8_t Sim_UsartBaudError(const char *name, uint32_t brr, uint32_t baud, uint8_t apb)
+{
+    uint32_t actual = Sim_UsartBaud(brr, baud, apb);
+    uint32_t diff = actual > baud ? actual - baud : baud - actual;
+
+    if (diff * SIM_BAUD_TOLERANCE <= baud)
+        return 0;
+    Sim_Rcc_ClockError("%s at %u baud, expected %u", name, actual, baud);
+    return 1;
+}
+
+static uint64_t Sim_UartByteNs(uint32_t baud)
+{
+    return 10ULL * 1000000000ULL / baud;
+}
+
+static int Sim_GpioIndex(GPIO_TypeDef *GPIOx)
+{
+    if (GPIOx == GPIOA) return 0;
+    if (GPIOx == GPIOB) return 1;
+    if (GPIOx == GPIOC) return 2;
+    return -1;
+}
+
+/**
+  * @brief  GPIO输出变化时通知挂在引脚上的器件模型
+  */
+static void Sim_GpioChanged(int port, uint16_t changed)
+{
+    uint16_t odr = gpio_odr[port];
+
+    if (port == 0 && (changed & GPIO_Pin_4))
+        Sim_Esp_SetPower((odr & GPIO_Pin_4) != 0);
+    if (port != 1)
+        return;
+    if (changed & GPIO_Pin_5)
+        Sim_Dht11_PinWrite((odr & GPIO_Pin_5) != 0);
+    if ((changed & (GPIO_Pin_6 | GPIO_Pin_7)) && Sim_Config.oled_decode)
+        Sim_Oled_PinWrite((odr & GPIO_Pin_6) != 0, (odr & GPIO_Pin_7) != 0);
+}
+
+static void Sim_GpioWrite(GPIO_TypeDef *GPIOx, uint16_t pins, uint8_t level)
+{
+    int port = Sim_GpioIndex(GPIOx);
+    uint16_t old;
+
+    Sim_Rcc_Cycles(SIM_GPIO_CYCLES);
+    if (port < 0)
+        return;
+    old = gpio_odr[port];
+    gpio_odr[port] = level ? (old | pins) : (old & ~pins);
+    if (gpio_odr[port] != old)
+        Sim_GpioChanged(port, gpio_odr[port] ^ old);
+}
+
+/* 事件调度 ------------------------------------------------------------------*/
+/**
+  * @brief  获取下一个外设事件的时刻
+  * @param  无
+  * @retval 虚拟时间(ns)，无事件时为UINT64_MAX
+  */
+uint64_t Sim_PeriphNextEventNs(void)
+{
+    uint64_t next = sim_usart1.next_rx_ns;
+    uint64_t rtc = Sim_Power_NextEventNs();
+    uint64_t wdg = Sim_Iwdg_NextEventNs();
+    uint32_t i;
+
+    if (rtc < next)
+        next = rtc;
+    if (wdg < next)
+        next = wdg;
+    if (Sim_Power_IsStopped())
+        return next;            // Stop期间定时器和USART3停走，IWDG继续计数
+
+    if (sim_usart3.enabled && sim_usart3.it_txe && sim_usart3.tx_done_ns < next)
+        next = sim_usart3.tx_done_ns;
+    for (i = 0; i < SIM_TIMER_COUNT; i++)
+        if (sim_timers[i].enabled && sim_timers[i].next_ns < next)
+            next = sim_timers[i].next_ns;
+    return next;
+}
+
+/**
+  * @brief  处理所有已到期的外设事件
+  * @param  无
+  * @retval 无
+  */
+void Sim_PeriphPoll(void)
+{
+    uint64_t now = Sim_NowNs();
+    uint32_t i;
+
+    Sim_Power_Poll();
+    Sim_Iwdg_Poll();
+    if (Sim_Power_IsStopped())
+    {
+        uint8_t byte;
+
+        /* 串口时钟已停，线上的字节收不到 */
+        if (sim_usart1.next_rx_ns <= now)
+        {
+            int got = Sim_Uart_Rx(&byte);
+            sim_usart1.next_rx_ns = now + (got ? Sim_UartByteNs(sim_usart1.baud) : SIM_UART_IDLE_NS);
+            if (got)
+                Sim_Power_RxWhileStopped();
+        }
+        return;
+    }
+
+    for (i = 0; i < SIM_TIMER_COUNT; i++)
+    {
+        SimTimer_t *t = &sim_timers[i];
+
+        if (!t->enabled || t->next_ns > now)
+            continue;
+        if (t->psc_pending != t->psc)
+        {
+            t->psc = t->psc_pending;
+            t->period_ns = Sim_TimerPeriodNs(t);
+        }
+        t->next_ns += t->period_ns;
+        t->uif = 1;
+        if (t->it_update && nvic_enabled[t->irq] && t->handler)
+            t->handler();
+    }
+
+    if (sim_usart1.next_rx_ns <= now)
+    {
+        uint8_t byte;
+
+        if (Sim_Uart_Rx(&byte))
+        {
+            sim_usart1.next_rx_ns = now + Sim_UartByteNs(sim_usart1.baud);
+            if (Sim_UsartBaudError("USART1 RX", sim_usart1.brr, sim_usart1.baud, 2))
+                return;
+            if (sim_usart1.rxne)
+                sim_usart1.ore = 1;
+            sim_usart1.rdr = byte;
+            sim_usart1.rxne = 1;
+            if (sim_usart1.it_rxne && nvic_enabled[USART1_IRQn] && USART1_IRQHandler)
+                USART1_IRQHandler();
+        }
+        else
+        {
+            sim_usart1.next_rx_ns = now + SIM_UART_IDLE_NS;
+        }
+    }
+
+    /* 发送空中断：处理函数送出下一个字节或关闭中断 */
+    if (sim_usart3.enabled && sim_usart3.it_txe && sim_usart3.tx_done_ns <= now)
+    {
+        if (nvic_enabled[USART3_IRQn] && USART3_IRQHandler)
+            USART3_IRQHandler();
+        if (sim_usart3.tx_done_ns <= now)
+            sim_usart3.it_txe = 0;  // 处理函数未发送也未关中断时避免原地反复触发
+    }
+}
+
+/**
+  * @brief  退出Stop模式，停走的外设顺延
+  * @param  stopped_ns: Stop持续的纳秒数
+  * @retval 无
+  */
+void Sim_PeriphResume(uint64_t stopped_ns)
+{
+    uint64_t since = Sim_NowNs() - stopped_ns;
+    uint32_t i;
+
+    for (i = 0; i < SIM_TIMER_COUNT; i++)
+        if (sim_timers[i].enabled)
+            sim_timers[i].next_ns += stopped_ns;
+    if (sim_usart3.tx_done_ns > since)
+        sim_usart3.tx_done_ns += stopped_ns;
+    if (sim_adc.running)
+    {
+        Sim_AdcRun(since);
+        sim_adc.last_ns += stopped_ns;
+    }
+    Sim_Reschedule();
+}
+
+/**
+  * @brief  定时器时钟变化，正在进行的周期按新频率折算剩余时间
+  * @param  无
+  * @retval 无
+  */
+void Sim_PeriphClockChanged(void)
+{
+    uint64_t now = Sim_NowNs();
+    uint32_t i;
+
+    for (i = 0; i < SIM_TIMER_COUNT; i++)
+    {
+        SimTimer_t *t = &sim_timers[i];
+        uint64_t period = Sim_TimerPeriodNs(t);
+
+        if (t->enabled && t->period_ns && t->next_ns > now)
+            t->next_ns = now + (uint64_t)((unsigned __int128)(t->next_ns - now) * period / t->period_ns);
+        t->period_ns = period;
+    }
+    if (sim_adc.running)
+    {
+        Sim_AdcRun(now);
+        Sim_AdcTiming();
+    }
+    Sim_Reschedule();
+}
+
+/**
+  * @brief  查询中断通道是否使能
+  * @param  irq: 中断号
+  * @retval 1:使能 0:未使能
+  */
+uint8_t Sim_NvicEnabled(int irq)
+{
+    return nvic_enabled[irq & 63];
+}
+
+/**
+  * @brief  立即向USART1送入一个字节并触发接收中断
+  * @param  byte: 数据
+  * @retval 无
+  * @note   供基准测试预先填充固件的接收缓冲区，不经串口后端，也不消耗虚拟时间
+  */
+void Sim_Usart1_Inject(uint8_t byte)
+{
+    sim_usart1.rdr = byte;
+    sim_usart1.rxne = 1;
+    if (sim_usart1.it_rxne && nvic_enabled[USART1_IRQn] && USART1_IRQHandler)
+        USART1_IRQHandler();
+}
+
+/**
+  * @brief  查询蜂鸣器是否在响
+  * @param  无
+  * @retval 1:响 0:静音
+  */
+uint8_t Sim_BuzzerIsOn(void)
+{
+    return buzzer_on;
+}
+
+/**
+  * @brief  蜂鸣器累计鸣叫时长
+  * @param  无
+  * @retval 纳秒数
+  */
+uint64_t Sim_BuzzerOnNs(void)
+{
+    return buzzer_total_ns + (buzzer_on ? Sim_NowNs() - buzzer_since_ns : 0);
+}
+
+static void Sim_BuzzerSet(uint8_t on)
+{
+    if (on && !buzzer_on)
+        buzzer_since_ns = Sim_NowNs();
+    else if (!on && buzzer_on)
+        buzzer_total_ns += Sim_NowNs() - buzzer_since_ns;
+    buzzer_on = on;
+}
+
+/**
+  * @brief  光敏电阻分压的ADC读数
+  * @param  channel: ADC通道
+  * @retval 12位转换结果
+  * @note   与light.c的换算相反：光照0~1000对应ADC 4095~0，叠加几个LSB的噪声
+  */
+uint16_t Sim_Adc_Sample(uint8_t channel)
+{
+    double temp, humi, lux;
+    int32_t value;
+
+    if (channel != ADC_Channel_1)
+        return 2048;
+    Sim_Env_Read(&temp, &humi, &lux);
+    value = (int32_t)((1000.0 - lux) / 1000.0 * 4095.0 + 0.5);
+    value += (int32_t)(Sim_Rand() % 9) - 4;
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+    return (uint16_t)value;
+}
+
+/* RCC -----------------------------------------------------------------------*/
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState)
+{
+    (void)RCC_APB2Periph; (void)NewState;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState)
+{
+    (void)RCC_APB1Periph; (void)NewState;
+}
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState)
+{
+    (void)RCC_AHBPeriph; (void)NewState;
+}
+
+/* GPIO ----------------------------------------------------------------------*/
+void GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_InitStruct)
+{
+    if (GPIOx == GPIOB && (GPIO_InitStruct->GPIO_Pin & GPIO_Pin_5))
+    {
+        GPIOMode_TypeDef mode = GPIO_InitStruct->GPIO_Mode;
+        Sim_Dht11_PinMode(mode == GPIO_Mode_IN_FLOATING || mode == GPIO_Mode_IPU ||
+                          mode == GPIO_Mode_IPD);
+    }
+}
+
+void GPIO_SetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    Sim_GpioWrite(GPIOx, GPIO_Pin, 1);
+}
+
+void GPIO_ResetBits(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    Sim_GpioWrite(GPIOx, GPIO_Pin, 0);
+}
+
+void GPIO_WriteBit(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, BitAction BitVal)
+{
+    Sim_GpioWrite(GPIOx, GPIO_Pin, BitVal != Bit_RESET);
+}
+
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    int port = Sim_GpioIndex(GPIOx);
+
+    Sim_Rcc_Cycles(SIM_GPIO_CYCLES);
+    if (GPIOx == GPIOB && GPIO_Pin == GPIO_Pin_5)
+        return Sim_Dht11_PinRead();
+    if (port < 0)
+        return Bit_RESET;
+    return (gpio_odr[port] & GPIO_Pin) ? Bit_SET : Bit_RESET;
+}
+
+/* NVIC ----------------------------------------------------------------------*/
+void NVIC_PriorityGroupConfig(uint32_t NVIC_PriorityGroup)
+{
+    (void)NVIC_PriorityGroup;
+}
+
+void NVIC_Init(NVIC_InitTypeDef *NVIC_InitStruct)
+{
+    nvic_enabled[NVIC_InitStruct->NVIC_IRQChannel & 63] =
+        (NVIC_InitStruct->NVIC_IRQChannelCmd != DISABLE);
+}
+
+/* USART ---------------------------------------------------------------------*/
+void USART_Init(USART_TypeDef *USARTx, USART_InitTypeDef *USART_InitStruct)
+{
+    uint32_t baud = USART_InitStruct->USART_BaudRate;
+
+    /* 与库函数一致：分频值按初始化时的PCLK取整，时钟变化后不会自动更新 */
+    if (USARTx == USART1 && baud)
+    {
+        sim_usart1.baud = baud;
+        sim_usart1.brr = (Sim_Rcc_PclkHz(2) + baud / 2) / baud;
+    }
+    if (USARTx == USART3 && baud)
+    {
+        sim_usart3.baud = baud;
+        sim_usart3.brr = (Sim_Rcc_PclkHz(1) + baud / 2) / baud;
+    }
+}
+
+void USART_ITConfig(USART_TypeDef *USARTx, uint16_t USART_IT, FunctionalState NewState)
+{
+    if (USARTx == USART1 && USART_IT == USART_IT_RXNE)
+        sim_usart1.it_rxne = (NewState != DISABLE);
+    if (USARTx == USART3 && USART_IT == USART_IT_TXE)
+    {
+        sim_usart3.it_txe = (NewState != DISABLE);
+        Sim_Reschedule();
+    }
+}
+
+void USART_Cmd(USART_TypeDef *USARTx, FunctionalState NewState)
+{
+    if (USARTx == USART3)
+    {
+        sim_usart3.enabled = (NewState != DISABLE);
+        Sim_Reschedule();
+        return;
+    }
+    if (USARTx != USART1)
+        return;
+    sim_usart1.enabled = (NewState != DISABLE);
+    sim_usart1.next_rx_ns = sim_usart1.enabled ? Sim_NowNs() + Sim_UartByteNs(sim_usart1.baud) : UINT64_MAX;
+    Sim_Reschedule();
+}
+
+void USART_SendData(USART_TypeDef *USARTx, uint16_t Data)
+{
+    if (USARTx == USART3 && sim_usart3.enabled)
+    {
+        /* 只占用发送移位寄存器，不阻塞调用者 */
+        uint64_t now = Sim_NowNs();
+        if (!Sim_UsartBaudError("USART3 TX", sim_usart3.brr, sim_usart3.baud, 1))
+            Sim_Trace_Input((uint8_t)Data);
+        sim_usart3.tx_done_ns = (sim_usart3.tx_done_ns > now ? sim_usart3.tx_done_ns : now) +
+                                Sim_UartByteNs(Sim_UsartBaud(sim_usart3.brr, sim_usart3.baud, 1));
+        Sim_Reschedule();
+        return;
+    }
+    if (USARTx != USART1 || !sim_usart1.enabled)
+        return;
+    if (!Sim_UsartBaudError("USART1 TX", sim_usart1.brr, sim_usart1.baud, 2))
+        Sim_Uart_Tx((uint8_t)Data);
+    Sim_Advance(Sim_UartByteNs(Sim_UsartBaud(sim_usart1.brr, sim_usart1.baud, 2)));
+}
+
+uint16_t USART_ReceiveData(USART_TypeDef *USARTx)
+{
+    if (USARTx != USART1)
+        return 0;
+    sim_usart1.rxne = 0;
+    return sim_usart1.rdr;
+}
+
+FlagStatus USART_GetFlagStatus(USART_TypeDef *USARTx, uint16_t USART_FLAG)
+{
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);    // 轮询等待时推进时间，发送中断得以执行
+    if (USARTx == USART3 && USART_FLAG == USART_FLAG_TC)
+        return sim_usart3.tx_done_ns <= Sim_NowNs() ? SET : RESET;
+    if (USARTx != USART1)
+        return RESET;
+    switch (USART_FLAG)
+    {
+    case USART_FLAG_TXE:
+    case USART_FLAG_TC:   return SET;     // 发送时间已在USART_SendData中计入
+    case USART_FLAG_RXNE: return sim_usart1.rxne ? SET : RESET;
+    case USART_FLAG_ORE:  return sim_usart1.ore ? SET : RESET;
+    default:              return RESET;
+    }
+}
+
+ITStatus USART_GetITStatus(USART_TypeDef *USARTx, uint16_t USART_IT)
+{
+    if (USARTx == USART1 && USART_IT == USART_IT_RXNE)
+        return (sim_usart1.rxne && sim_usart1.it_rxne) ? SET : RESET;
+    if (USARTx == USART3 && USART_IT == USART_IT_TXE)
+        return (sim_usart3.it_txe && sim_usart3.tx_done_ns <= Sim_NowNs()) ? SET : RESET;
+    return RESET;
+}
+
+/* ADC -----------------------------------------------------------------------*/
+/**
+  * @brief  故障注入时刻之后ADC不再转换，校准也不再结束
+  */
+static uint8_t Sim_AdcHung(uint64_t at_ns)
+{
+    return Sim_Config.adc_hang_ms && at_ns >= Sim_Config.adc_hang_ms * 1000000ULL;
+}
+
+/**
+  * @brief  按当前ADCCLK计算各序号的转换耗时
+  */
+static void Sim_AdcTiming(void)
+{
+    uint32_t hz = Sim_Rcc_AdcHz();
+    uint8_t r;
+
+    sim_adc.seq_ns = 0;
+    for (r = 0; r < sim_adc.nbr; r++)
+    {
+        sim_adc.conv_ns[r] = sim_adc_cycles[sim_adc.smp[sim_adc.seq[r]] & 7] * 1000000000ULL / hz;
+        sim_adc.seq_ns += sim_adc.conv_ns[r];
+    }
+}
+
+/**
+  * @brief  回放轨迹时，用下一条记录重新填满该通道在缓冲区中的各个位置
+  * @note   固件记录的是一个通道在缓冲区中全部结果之和，平均分到各位置，
+  *          固件累加后得到相同的值。固件每次读取前查询一次传输完成标志，
+  *          查询时写满过一圈才取下一条记录
+  */
+static void Sim_AdcReplay(void)
+{
+    uint16_t slots = sim_dma.size / sim_adc.nbr;
+    uint16_t sum, i;
+    uint8_t r;
+
+    for (r = 0; r < sim_adc.nbr; r++)
+    {
+        if (!Sim_Trace_NextAdc(sim_adc.seq[r], &sum))
+            continue;
+        for (i = 0; i < slots; i++)
+            sim_dma.mem[i * sim_adc.nbr + r] = (uint16_t)(sum / slots + (i < sum % slots));
+    }
+}
+
+/**
+  * @brief  连续转换推进到end时刻，结果经DMA写入内存
+  * @param  end: 目标时刻
+  * @note   固件查询DMA状态时才按经过的时间补算，落后超过一圈时跳过不会留在
+  *          缓冲区中的整轮扫描。回放轨迹时有记录的通道不按环境模型写入，由
+  *          Sim_AdcReplay填写
+  */
+static void Sim_AdcRun(uint64_t end)
+{
+    uint8_t to_dma = sim_adc.dma && sim_dma.enabled && sim_dma.size > 0;
+
+    if (!sim_adc.running || sim_adc.seq_ns == 0)
+        return;
+    if (Sim_AdcHung(end))
+    {
+        uint64_t hang_ns = Sim_Config.adc_hang_ms * 1000000ULL;
+        end = hang_ns > sim_adc.last_ns ? hang_ns : sim_adc.last_ns;
+    }
+
+    if (to_dma)
+    {
+        uint64_t rounds = (end - sim_adc.last_ns) / sim_adc.seq_ns;
+        uint64_t keep = sim_dma.size / sim_adc.nbr + 1;
+
+        if (rounds > keep)
+        {
+            sim_adc.last_ns += (rounds - keep) * sim_adc.seq_ns;
+            sim_dma.pos = (uint16_t)((sim_dma.pos + (rounds - keep) * sim_adc.nbr) % sim_dma.size);
+            sim_dma.flags |= DMA1_FLAG_GL1 | DMA1_FLAG_TC1 | DMA1_FLAG_HT1;
+            sim_dma.wrapped = 1;
+        }
+    }
+
+    while (sim_adc.last_ns + sim_adc.conv_ns[sim_adc.rank] <= end)
+    {
+        uint8_t channel = sim_adc.seq[sim_adc.rank];
+
+        sim_adc.last_ns += sim_adc.conv_ns[sim_adc.rank];
+        if (++sim_adc.rank == sim_adc.nbr)
+            sim_adc.rank = 0;
+        if (!to_dma)
+            continue;
+
+        if (!Sim_Trace_HasAdc(channel))
+            sim_dma.mem[sim_dma.pos] = Sim_Adc_Sample(channel);
+        if (++sim_dma.pos == sim_dma.size)
+        {
+            sim_dma.pos = 0;
+            sim_dma.flags |= DMA1_FLAG_GL1 | DMA1_FLAG_TC1;
+            sim_dma.wrapped = 1;
+        }
+        else if (sim_dma.pos == sim_dma.size / 2)
+            sim_dma.flags |= DMA1_FLAG_GL1 | DMA1_FLAG_HT1;
+    }
+}
+
+void ADC_Init(ADC_TypeDef *ADCx, ADC_InitTypeDef *ADC_InitStruct)
+{
+    (void)ADCx;
+    sim_adc.cont = ADC_InitStruct->ADC_ContinuousConvMode == ENABLE;
+    sim_adc.nbr = ADC_InitStruct->ADC_NbrOfChannel ? ADC_InitStruct->ADC_NbrOfChannel : 1;
+}
+
+void ADC_Cmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+    (void)ADCx;
+    if (NewState == DISABLE)
+    {
+        Sim_AdcRun(Sim_NowNs());
+        sim_adc.running = 0;
+    }
+}
+
+void ADC_DMACmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+    (void)ADCx;
+    Sim_AdcRun(Sim_NowNs());
+    sim_adc.dma = NewState == ENABLE;
+}
+
+void ADC_ResetCalibration(ADC_TypeDef *ADCx)
+{
+    (void)ADCx;
+}
+
+FlagStatus ADC_GetResetCalibrationStatus(ADC_TypeDef *ADCx)
+{
+    (void)ADCx;
+    return RESET;
+}
+
+void ADC_StartCalibration(ADC_TypeDef *ADCx)
+{
+    (void)ADCx;
+    Sim_Advance(SIM_ADC_CAL_CYCLES * 1000000000ULL / Sim_Rcc_AdcHz());
+}
+
+FlagStatus ADC_GetCalibrationStatus(ADC_TypeDef *ADCx)
+{
+    (void)ADCx;
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    /* 故障注入：校准不再结束，固件卡在等待循环里 */
+    return Sim_AdcHung(Sim_NowNs()) ? SET : RESET;
+}
+
+void ADC_RegularChannelConfig(ADC_TypeDef *ADCx, uint8_t ADC_Channel, uint8_t Rank, uint8_t ADC_SampleTime)
+{
+    (void)ADCx;
+    sim_adc.seq[(Rank - 1) & 15] = ADC_Channel;
+    sim_adc.smp[ADC_Channel % 18] = ADC_SampleTime;
+}
+
+void ADC_SoftwareStartConvCmd(ADC_TypeDef *ADCx, FunctionalState NewState)
+{
+    (void)ADCx;
+    if (NewState == DISABLE)
+        return;
+    if (sim_adc.cont)
+    {
+        Sim_AdcTiming();
+        sim_adc.running = 1;
+        sim_adc.rank = 0;
+        sim_adc.last_ns = Sim_NowNs();
+        return;
+    }
+    Sim_Advance(sim_adc_cycles[sim_adc.smp[sim_adc.seq[0]] & 7] * 1000000000ULL / Sim_Rcc_AdcHz());
+    /* 故障注入：转换完成标志不再置位，固件卡在等待循环里 */
+    if (Sim_AdcHung(Sim_NowNs()))
+        return;
+    sim_adc.eoc = 1;
+}
+
+FlagStatus ADC_GetFlagStatus(ADC_TypeDef *ADCx, uint8_t ADC_FLAG)
+{
+    (void)ADCx;
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    if (ADC_FLAG == ADC_FLAG_EOC)
+        return sim_adc.eoc ? SET : RESET;
+    return RESET;
+}
+
+uint16_t ADC_GetConversionValue(ADC_TypeDef *ADCx)
+{
+    (void)ADCx;
+    sim_adc.eoc = 0;
+    return Sim_Adc_Sample(sim_adc.seq[0]);
+}
+
+/* DMA -----------------------------------------------------------------------*/
+void DMA_DeInit(DMA_Channel_TypeDef *DMAy_Channelx)
+{
+    if (DMAy_Channelx != DMA1_Channel1)
+        return;
+    Sim_AdcRun(Sim_NowNs());
+    memset(&sim_dma, 0, sizeof(sim_dma));
+}
+
+void DMA_Init(DMA_Channel_TypeDef *DMAy_Channelx, DMA_InitTypeDef *DMA_InitStruct)
+{
+    if (DMAy_Channelx != DMA1_Channel1)
+        return;
+    sim_dma.mem = (volatile uint16_t *)(uintptr_t)DMA_InitStruct->DMA_MemoryBaseAddr;
+    sim_dma.size = (uint16_t)DMA_InitStruct->DMA_BufferSize;
+    sim_dma.pos = 0;
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef *DMAy_Channelx, FunctionalState NewState)
+{
+    if (DMAy_Channelx != DMA1_Channel1)
+        return;
+    Sim_AdcRun(Sim_NowNs());
+    sim_dma.enabled = NewState == ENABLE;
+}
+
+FlagStatus DMA_GetFlagStatus(uint32_t DMAy_FLAG)
+{
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    Sim_AdcRun(Sim_NowNs());
+    if (sim_dma.wrapped)
+    {
+        sim_dma.wrapped = 0;
+        Sim_AdcReplay();
+    }
+    return (sim_dma.flags & DMAy_FLAG) ? SET : RESET;
+}
+
+void DMA_ClearFlag(uint32_t DMAy_FLAG)
+{
+    Sim_AdcRun(Sim_NowNs());
+    sim_dma.flags &= ~DMAy_FLAG;
+}
+
+/* TIM -----------------------------------------------------------------------*/
+void TIM_TimeBaseInit(TIM_TypeDef *TIMx, TIM_TimeBaseInitTypeDef *TIM_TimeBaseInitStruct)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL)
+        return;
+    t->psc = t->psc_pending = TIM_TimeBaseInitStruct->TIM_Prescaler;
+    t->arr = TIM_TimeBaseInitStruct->TIM_Period;
+    t->uif = 1;             // 与硬件一致：初始化产生的更新事件会置位UIF
+    Sim_TimerRestart(t);
+}
+
+void TIM_Cmd(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL)
+        return;
+    if (NewState != DISABLE && !t->enabled)
+        Sim_TimerRestart(t);
+    t->enabled = (NewState != DISABLE);
+    Sim_Reschedule();
+}
+
+void TIM_ITConfig(TIM_TypeDef *TIMx, uint16_t TIM_IT, FunctionalState NewState)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL || !(TIM_IT & TIM_IT_Update))
+        return;
+    t->it_update = (NewState != DISABLE);
+}
+
+void TIM_ClearFlag(TIM_TypeDef *TIMx, uint16_t TIM_FLAG)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t != NULL && (TIM_FLAG & TIM_FLAG_Update))
+        t->uif = 0;
+}
+
+ITStatus TIM_GetITStatus(TIM_TypeDef *TIMx, uint16_t TIM_IT)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL || !(TIM_IT & TIM_IT_Update))
+        return RESET;
+    return (t->uif && t->it_update) ? SET : RESET;
+}
+
+void TIM_ClearITPendingBit(TIM_TypeDef *TIMx, uint16_t TIM_IT)
+{
+    TIM_ClearFlag(TIMx, TIM_IT);
+}
+
+void TIM_SetCounter(TIM_TypeDef *TIMx, uint16_t Counter)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL)
+        return;
+    t->period_ns = Sim_TimerPeriodNs(t);
+    t->next_ns = Sim_NowNs() + t->period_ns - t->period_ns * Counter / ((uint64_t)t->arr + 1);
+    Sim_Reschedule();
+}
+
+uint16_t TIM_GetCounter(TIM_TypeDef *TIMx)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+    uint64_t now = Sim_NowNs(), left;
+
+    if (t == NULL || !t->enabled || t->period_ns == 0)
+        return 0;
+    left = t->next_ns > now ? t->next_ns - now : 0;
+    return (uint16_t)(((uint64_t)t->arr + 1) * (t->period_ns - left) / t->period_ns);
+}
+
+void TIM_UpdateRequestConfig(TIM_TypeDef *TIMx, uint16_t TIM_UpdateSource)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t != NULL)
+        t->urs = (TIM_UpdateSource == TIM_UpdateSource_Regular);
+}
+
+/**
+  * @brief  设置预分频值
+  * @note   立即模式产生软件更新事件：计数清零，URS未置位时同时置位UIF
+  */
+void TIM_PrescalerConfig(TIM_TypeDef *TIMx, uint16_t Prescaler, uint16_t TIM_PSCReloadMode)
+{
+    SimTimer_t *t = Sim_FindTimer(TIMx);
+
+    if (t == NULL)
+        return;
+    t->psc_pending = Prescaler;
+    if (TIM_PSCReloadMode != TIM_PSCReloadMode_Immediate)
+        return;
+    t->psc = Prescaler;
+    Sim_TimerRestart(t);
+    if (t->urs)
+        return;
+    t->uif = 1;
+    if (t->enabled && t->it_update && nvic_enabled[t->irq] && t->handler)
+        t->handler();
+}
+
+void TIM_OCStructInit(TIM_OCInitTypeDef *TIM_OCInitStruct)
+{
+    TIM_OCInitStruct->TIM_OCMode = TIM_OCMode_Timing;
+    TIM_OCInitStruct->TIM_OutputState = TIM_OutputState_Disable;
+    TIM_OCInitStruct->TIM_OutputNState = TIM_OutputNState_Disable;
+    TIM_OCInitStruct->TIM_Pulse = 0;
+    TIM_OCInitStruct->TIM_OCPolarity = TIM_OCPolarity_High;
+    TIM_OCInitStruct->TIM_OCNPolarity = TIM_OCPolarity_High;
+    TIM_OCInitStruct->TIM_OCIdleState = TIM_OCIdleState_Reset;
+    TIM_OCInitStruct->TIM_OCNIdleState = TIM_OCNIdleState_Reset;
+}
+
+void TIM_OC1Init(TIM_TypeDef *TIMx, TIM_OCInitTypeDef *TIM_OCInitStruct)
+{
+    if (TIMx == TIM1 && TIM_OCInitStruct->TIM_OCMode == TIM_OCMode_Inactive)
+        Sim_BuzzerSet(0);
+}
+
+void TIM_ForcedOC1Config(TIM_TypeDef *TIMx, uint16_t TIM_ForcedAction)
+{
+    if (TIMx == TIM1)
+        Sim_BuzzerSet(TIM_ForcedAction == TIM_ForcedAction_Active);
+}
+
+void TIM_CtrlPWMOutputs(TIM_TypeDef *TIMx, FunctionalState NewState)
+{
+    (void)TIMx; (void)NewState;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,335 @@
+/**
+  ******************************************************************************
+  * @file    sim_power.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   RTC、EXTI与Stop模式模型
+  * @note    RTC计数按虚拟时间和LSE分频折算，LSE可按--rtc-ppm偏快或偏慢；进入Stop后定时器和USART3停走，
+  *          直到RTC闹钟或PA10下降沿（EXTI10）唤醒。Stop期间到达USART1的字节
+  *          收不到，计为丢失；醒来后系统时钟回到HSI，由时钟树模型检查固件
+  *          是否恢复了时钟
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "sim.h"
+#include <stdio.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define SIM_RTCCLK_HZ       32768ULL    // LSE，仿真中总能起振
+
+/* 中断处理函数（由固件提供，未链接时为空） ----------------------------------*/
+extern void RTCAlarm_IRQHandler(void) __attribute__((weak));
+extern void EXTI15_10_IRQHandler(void) __attribute__((weak));
+
+/* 私有变量 ------------------------------------------------------------------*/
+static struct {
+    uint8_t  enabled;           // RTCEN
+    uint8_t  it_alr;            // 闹钟中断使能
+    uint8_t  alrf;              // 闹钟标志
+    uint32_t prl;               // 预分频值
+    uint32_t cnt_base;          // 计数起点
+    uint64_t base_ns;           // 计数起点的虚拟时刻
+    uint64_t alarm_ns;          // 闹钟到期时刻，UINT64_MAX表示未设置
+} sim_rtc = { 0, 0, 0, 0x7FFF, 0, 0, UINT64_MAX };
+
+static uint32_t exti_imr;       // 中断屏蔽
+static uint32_t exti_rtsr;      // 上升沿触发
+static uint32_t exti_ftsr;      // 下降沿触发
+static uint32_t exti_pr;        // 挂起
+
+static uint8_t  stopped = 0;
+static uint64_t stop_start_ns;
+static SimPowerStats_t stats;
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  RTC时钟的实际频率，单位为微赫兹
+  */
+static uint64_t Sim_Rtc_ClockUhz(void)
+{
+    return SIM_RTCCLK_HZ * (uint64_t)(1000000 + Sim_Config.rtc_ppm);
+}
+
+static uint32_t Sim_Rtc_Counter(void)
+{
+    unsigned __int128 ticks;
+
+    if (!sim_rtc.enabled)
+        return sim_rtc.cnt_base;
+    ticks = (unsigned __int128)(Sim_NowNs() - sim_rtc.base_ns) * Sim_Rtc_ClockUhz() /
+            ((unsigned __int128)(sim_rtc.prl + 1) * 1000000000000000ULL);
+    return sim_rtc.cnt_base + (uint32_t)ticks;
+}
+
+/**
+  * @brief  从当前时刻和计数值重新起算，预分频改变前调用
+  */
+static void Sim_Rtc_Rebase(void)
+{
+    sim_rtc.cnt_base = Sim_Rtc_Counter();
+    sim_rtc.base_ns = Sim_NowNs();
+}
+
+/**
+  * @brief  置位EXTI线，使能了中断的线唤醒Stop
+  */
+static void Sim_Exti_Trigger(uint32_t line)
+{
+    exti_pr |= line;
+    if (stopped && (exti_imr & line))
+    {
+        stopped = 0;
+        stats.stop_ns += Sim_NowNs() - stop_start_ns;
+        Sim_PeriphResume(Sim_NowNs() - stop_start_ns);
+        Sim_Rcc_StopWake();
+    }
+}
+
+/* 事件调度 ------------------------------------------------------------------*/
+/**
+  * @brief  获取RTC闹钟到期时刻
+  * @param  无
+  * @retval 虚拟时间(ns)，未设置时为UINT64_MAX
+  */
+uint64_t Sim_Power_NextEventNs(void)
+{
+    return sim_rtc.enabled ? sim_rtc.alarm_ns : UINT64_MAX;
+}
+
+/**
+  * @brief  处理RTC闹钟
+  * @param  无
+  * @retval 无
+  */
+void Sim_Power_Poll(void)
+{
+    if (!sim_rtc.enabled || sim_rtc.alarm_ns > Sim_NowNs())
+        return;
+    sim_rtc.alarm_ns = UINT64_MAX;
+    sim_rtc.alrf = 1;
+    if (!sim_rtc.it_alr || !(exti_rtsr & EXTI_Line17))
+        return;
+    Sim_Exti_Trigger(EXTI_Line17);
+    if ((exti_imr & EXTI_Line17) && Sim_NvicEnabled(RTCAlarm_IRQn) && RTCAlarm_IRQHandler)
+        RTCAlarm_IRQHandler();
+}
+
+/**
+  * @brief  Stop期间USART1收到一个字节
+  * @param  无
+  * @retval 无
+  * @note   串口时钟已停，字节丢失；起始位的下降沿可经EXTI10唤醒
+  */
+void Sim_Power_RxWhileStopped(void)
+{
+    stats.rx_lost++;
+    if (!(exti_ftsr & EXTI_Line10))
+        return;
+    Sim_Exti_Trigger(EXTI_Line10);
+    if (!stopped)
+        stats.rx_wakeups++;
+    if ((exti_imr & EXTI_Line10) && Sim_NvicEnabled(EXTI15_10_IRQn) && EXTI15_10_IRQHandler)
+        EXTI15_10_IRQHandler();
+}
+
+/**
+  * @brief  查询是否处于Stop模式
+  * @param  无
+  * @retval 1:Stop 0:运行
+  */
+uint8_t Sim_Power_IsStopped(void)
+{
+    return stopped;
+}
+
+/**
+  * @brief  读取RTC计数
+  * @param  无
+  * @retval 计数值
+  */
+uint32_t Sim_Power_RtcCounter(void)
+{
+    return Sim_Rtc_Counter();
+}
+
+/**
+  * @brief  载入上次运行结束时的RTC计数
+  * @param  counter: 计数值
+  * @retval 无
+  * @note   RTC在备份域中，系统复位后继续计数
+  */
+void Sim_Power_RtcLoad(uint32_t counter)
+{
+    sim_rtc.cnt_base = counter;
+    sim_rtc.base_ns = Sim_NowNs();
+}
+
+/**
+  * @brief  获取低功耗统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const SimPowerStats_t *Sim_Power_GetStats(void)
+{
+    return &stats;
+}
+
+/* RCC -----------------------------------------------------------------------*/
+void RCC_LSEConfig(uint8_t RCC_LSE)
+{
+    (void)RCC_LSE;
+}
+
+void RCC_LSICmd(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+void RCC_RTCCLKConfig(uint32_t RCC_RTCCLKSource)
+{
+    (void)RCC_RTCCLKSource;
+}
+
+void RCC_RTCCLKCmd(FunctionalState NewState)
+{
+    Sim_Rtc_Rebase();
+    sim_rtc.enabled = (NewState != DISABLE);
+    Sim_Reschedule();
+}
+
+/* PWR -----------------------------------------------------------------------*/
+void PWR_BackupAccessCmd(FunctionalState NewState)
+{
+    (void)NewState;
+}
+
+/**
+  * @brief  进入Stop模式
+  * @note   推进虚拟时间直到唤醒，期间只处理RTC闹钟和USART1线上的字节
+  */
+void PWR_EnterSTOPMode(uint32_t PWR_Regulator, uint8_t PWR_STOPEntry)
+{
+    (void)PWR_Regulator; (void)PWR_STOPEntry;
+
+    /* 已有挂起的唤醒中断时立即返回 */
+    if (exti_pr & exti_imr)
+        return;
+    Sim_Rcc_EnterStop();
+    stopped = 1;
+    stop_start_ns = Sim_NowNs();
+    stats.stop_count++;
+    Sim_Reschedule();
+    while (stopped)
+        Sim_WaitForInterrupt();
+}
+
+/* RTC -----------------------------------------------------------------------*/
+void RTC_WaitForSynchro(void)
+{
+}
+
+void RTC_WaitForLastTask(void)
+{
+}
+
+void RTC_ITConfig(uint16_t RTC_IT, FunctionalState NewState)
+{
+    if (RTC_IT & RTC_IT_ALR)
+        sim_rtc.it_alr = (NewState != DISABLE);
+}
+
+void RTC_SetPrescaler(uint32_t PrescalerValue)
+{
+    Sim_Rtc_Rebase();
+    sim_rtc.prl = PrescalerValue & 0xFFFFF;
+}
+
+uint32_t RTC_GetCounter(void)
+{
+    return Sim_Rtc_Counter();
+}
+
+void RTC_SetCounter(uint32_t CounterValue)
+{
+    sim_rtc.cnt_base = CounterValue;
+    sim_rtc.base_ns = Sim_NowNs();
+}
+
+/**
+  * @brief  设置闹钟
+  * @note   计数值到达AlarmValue的时刻即为闹钟事件
+  */
+void RTC_SetAlarm(uint32_t AlarmValue)
+{
+    uint32_t ticks = AlarmValue - sim_rtc.cnt_base;
+    unsigned __int128 ns = (unsigned __int128)ticks * (sim_rtc.prl + 1) * 1000000000000000ULL;
+    uint64_t clk = Sim_Rtc_ClockUhz();
+
+    sim_rtc.alarm_ns = sim_rtc.base_ns + (uint64_t)((ns + clk - 1) / clk);
+    Sim_Reschedule();
+}
+
+FlagStatus RTC_GetFlagStatus(uint16_t RTC_FLAG)
+{
+    if (RTC_FLAG == RTC_FLAG_ALR)
+        return sim_rtc.alrf ? SET : RESET;
+    return (RTC_FLAG == RTC_FLAG_RTOFF || RTC_FLAG == RTC_FLAG_RSF) ? SET : RESET;
+}
+
+void RTC_ClearFlag(uint16_t RTC_FLAG)
+{
+    if (RTC_FLAG & RTC_FLAG_ALR)
+        sim_rtc.alrf = 0;
+}
+
+ITStatus RTC_GetITStatus(uint16_t RTC_IT)
+{
+    if (RTC_IT == RTC_IT_ALR)
+        return (sim_rtc.alrf && sim_rtc.it_alr) ? SET : RESET;
+    return RESET;
+}
+
+void RTC_ClearITPendingBit(uint16_t RTC_IT)
+{
+    if (RTC_IT & RTC_IT_ALR)
+        sim_rtc.alrf = 0;
+}
+
+/* EXTI ----------------------------------------------------------------------*/
+void GPIO_EXTILineConfig(uint8_t GPIO_PortSource, uint8_t GPIO_PinSource)
+{
+    (void)GPIO_PortSource; (void)GPIO_PinSource;
+}
+
+void EXTI_Init(EXTI_InitTypeDef *EXTI_InitStruct)
+{
+    uint32_t line = EXTI_InitStruct->EXTI_Line;
+    EXTITrigger_TypeDef trigger = EXTI_InitStruct->EXTI_Trigger;
+
+    exti_imr &= ~line;
+    exti_rtsr &= ~line;
+    exti_ftsr &= ~line;
+    if (EXTI_InitStruct->EXTI_LineCmd == DISABLE)
+        return;
+    if (EXTI_InitStruct->EXTI_Mode == EXTI_Mode_Interrupt)
+        exti_imr |= line;
+    if (trigger == EXTI_Trigger_Rising || trigger == EXTI_Trigger_Rising_Falling)
+        exti_rtsr |= line;
+    if (trigger == EXTI_Trigger_Falling || trigger == EXTI_Trigger_Rising_Falling)
+        exti_ftsr |= line;
+}
+
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line)
+{
+    return ((exti_pr & exti_imr) & EXTI_Line) ? SET : RESET;
+}
+
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line)
+{
+    exti_pr &= ~EXTI_Line;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
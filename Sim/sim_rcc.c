@@ -0,0 +1,505 @@
+/**
+  ******************************************************************************
+  * @file    sim_rcc.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   时钟树与功耗模型
+  * @note    按RCC库函数的调用维护HSE/PLL/系统时钟/总线分频的状态，HSE起振和
+  *          PLL锁定按数据手册给出的时间推进虚拟时间；时钟变化时通知定时器、
+  *          DWT和串口模型。电流按运行/Sleep/Stop和HCLK查表积分，只计MCU本身
+  *
+  *          Flash等待周期不足、APB1超过36MHz、修改正在使用的PLL以及外设分频
+  *          与实际时钟不符都计为时钟错误
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdarg.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define SIM_HSI_HZ          8000000U
+#define SIM_HSE_HZ          8000000U
+#define SIM_HSE_STARTUP_NS  1000000ULL  // 8MHz晶振起振，数据手册典型值2ms以内
+#define SIM_PLL_LOCK_NS     200000ULL   // PLL锁定，取数据手册上限
+#define SIM_POLL_CYCLES     10          // 轮询一次RCC寄存器的循环周期数
+#define SIM_STOP_MA         0.014       // Stop模式，调压器低功耗
+#define SIM_ERROR_PRINTS    3           // 只打印前几次时钟错误
+
+/* 私有类型 ------------------------------------------------------------------*/
+/**
+  * @brief  一个频点的典型电流（数据手册，外设时钟全开，25℃）
+  */
+typedef struct {
+    uint32_t mhz;
+    double run_ma;
+    double sleep_ma;
+} SimCurrent_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static const SimCurrent_t sim_currents[] = {
+    { 8,   5.5,  2.6 },
+    { 16,  9.3,  4.2 },
+    { 24,  12.9, 5.3 },
+    { 36,  19.0, 7.6 },
+    { 48,  24.4, 9.9 },
+    { 72,  36.1, 14.4 },
+};
+#define SIM_CURRENT_POINTS  (sizeof(sim_currents) / sizeof(sim_currents[0]))
+
+static const uint32_t sim_bin_mhz[SIM_CLOCK_BINS] = { 72, 36, 8, 0 };
+
+/* 上电后由SystemInit配置为HSE×9=72MHz，APB1二分频，Flash两个等待周期 */
+static struct {
+    uint8_t  hse_on;
+    uint64_t hse_ready_ns;
+    uint8_t  pll_on;
+    uint64_t pll_ready_ns;
+    uint32_t pll_source;        // RCC_PLLSource_*
+    uint32_t pll_mul;           // 倍频数
+    uint8_t  sws;               // 系统时钟源：0x00 HSI，0x04 HSE，0x08 PLL
+    uint32_t hpre;              // AHB分频数
+    uint32_t ppre1;             // APB1分频数
+    uint32_t ppre2;             // APB2分频数
+    uint32_t adcpre;            // ADC分频数
+    uint32_t latency;           // Flash等待周期
+} rcc = { 1, 0, 1, 0, RCC_PLLSource_HSE_Div1, 9, 0x08, 1, 2, 1, 2, 2 };
+
+static uint8_t  sleeping = 0;
+static uint8_t  stopped = 0;
+static uint64_t account_ns = 0;         // 上次积分电流的时刻
+static SimClockStats_t stats;
+
+/* 私有函数 ------------------------------------------------------------------*/
+static uint32_t Sim_Rcc_PllHz(void)
+{
+    uint32_t in = (rcc.pll_source == RCC_PLLSource_HSE_Div1) ? SIM_HSE_HZ : SIM_HSE_HZ / 2;
+    return in * rcc.pll_mul;            // HSI/2与HSE/2同为4MHz
+}
+
+static uint32_t Sim_Rcc_SysclkHz(void)
+{
+    switch (rcc.sws)
+    {
+    case 0x04: return SIM_HSE_HZ;
+    case 0x08: return Sim_Rcc_PllHz();
+    default:   return SIM_HSI_HZ;
+    }
+}
+
+/**
+  * @brief  按HCLK在表中线性插值
+  */
+static double Sim_Rcc_CurrentMa(uint8_t sleep)
+{
+    double mhz = Sim_Rcc_HclkHz() / 1e6;
+    const SimCurrent_t *lo = &sim_currents[0], *hi = &sim_currents[SIM_CURRENT_POINTS - 1];
+    uint32_t i;
+
+    for (i = 1; i < SIM_CURRENT_POINTS; i++)
+    {
+        if (sim_currents[i].mhz >= mhz)
+        {
+            lo = &sim_currents[i - 1];
+            hi = &sim_currents[i];
+            break;
+        }
+    }
+    if (mhz <= lo->mhz)
+        return sleep ? lo->sleep_ma : lo->run_ma;
+    if (mhz >= hi->mhz)
+        return sleep ? hi->sleep_ma : hi->run_ma;
+    return (sleep ? lo->sleep_ma : lo->run_ma) +
+           ((sleep ? hi->sleep_ma : hi->run_ma) - (sleep ? lo->sleep_ma : lo->run_ma)) *
+           (mhz - lo->mhz) / (hi->mhz - lo->mhz);
+}
+
+static int Sim_Rcc_Bin(void)
+{
+    uint32_t mhz = Sim_Rcc_HclkHz() / 1000000;
+    int i;
+
+    for (i = 0; i < SIM_CLOCK_BINS - 1; i++)
+        if (sim_bin_mhz[i] == mhz)
+            return i;
+    return SIM_CLOCK_BINS - 1;
+}
+
+/**
+  * @brief  时钟变化前：按旧时钟结算电流和DWT计数
+  */
+static void Sim_Rcc_Before(void)
+{
+    Sim_Rcc_Account();
+    Sim_DwtRebase();
+}
+
+/**
+  * @brief  时钟变化后：检查配置并通知外设模型
+  */
+static void Sim_Rcc_After(void)
+{
+    uint32_t hclk = Sim_Rcc_HclkHz();
+
+    if (hclk > 24000000U * (rcc.latency + 1))
+        Sim_Rcc_ClockError("flash latency %u too low for %u MHz", rcc.latency, hclk / 1000000);
+    if (Sim_Rcc_PclkHz(1) > 36000000U)
+        Sim_Rcc_ClockError("APB1 at %u MHz exceeds 36 MHz", Sim_Rcc_PclkHz(1) / 1000000);
+    Sim_PeriphClockChanged();
+}
+
+/* 时钟查询 ------------------------------------------------------------------*/
+/**
+  * @brief  获取HCLK
+  * @param  无
+  * @retval 频率(Hz)
+  */
+uint32_t Sim_Rcc_HclkHz(void)
+{
+    return Sim_Rcc_SysclkHz() / rcc.hpre;
+}
+
+/**
+  * @brief  获取APB总线时钟
+  * @param  apb: 1或2
+  * @retval 频率(Hz)
+  */
+uint32_t Sim_Rcc_PclkHz(uint8_t apb)
+{
+    return Sim_Rcc_HclkHz() / (apb == 2 ? rcc.ppre2 : rcc.ppre1);
+}
+
+/**
+  * @brief  获取挂在某条APB总线上的定时器时钟
+  * @param  apb: 1或2
+  * @retval 频率(Hz)，APB分频不为1时为PCLK的2倍
+  */
+uint32_t Sim_Rcc_TimerHz(uint8_t apb)
+{
+    uint32_t div = (apb == 2) ? rcc.ppre2 : rcc.ppre1;
+    return Sim_Rcc_PclkHz(apb) * (div == 1 ? 1 : 2);
+}
+
+/**
+  * @brief  获取ADC时钟
+  * @param  无
+  * @retval 频率(Hz)
+  */
+uint32_t Sim_Rcc_AdcHz(void)
+{
+    return Sim_Rcc_PclkHz(2) / rcc.adcpre;
+}
+
+/**
+  * @brief  按当前HCLK累计若干CPU周期的耗时
+  * @param  cycles: 周期数
+  * @retval 无
+  */
+void Sim_Rcc_Cycles(uint32_t cycles)
+{
+    Sim_Charge((uint32_t)((uint64_t)cycles * 1000000000ULL / Sim_Rcc_HclkHz()));
+}
+
+/* 功耗与低功耗 --------------------------------------------------------------*/
+/**
+  * @brief  把上次结算以来的时长和电荷计入统计
+  * @param  无
+  * @retval 无
+  */
+void Sim_Rcc_Account(void)
+{
+    uint64_t now = Sim_NowNs();
+    uint64_t dt = now - account_ns;
+    int bin;
+
+    account_ns = now;
+    if (dt == 0)
+        return;
+    if (stopped)
+    {
+        stats.stop_ns += dt;
+        stats.stop_mas += SIM_STOP_MA * dt / 1e9;
+        return;
+    }
+    bin = Sim_Rcc_Bin();
+    if (sleeping)
+    {
+        stats.sleep_ns[bin] += dt;
+        stats.sleep_mas += Sim_Rcc_CurrentMa(1) * dt / 1e9;
+    }
+    else
+    {
+        stats.run_ns[bin] += dt;
+        stats.run_mas += Sim_Rcc_CurrentMa(0) * dt / 1e9;
+    }
+}
+
+/**
+  * @brief  进入或退出Sleep（WFI）
+  * @param  sleep: 1:进入 0:退出
+  * @retval 无
+  */
+void Sim_Rcc_Sleep(uint8_t sleep)
+{
+    Sim_Rcc_Account();
+    sleeping = sleep;
+}
+
+/**
+  * @brief  进入Stop：按运行时钟结算，此后CPU时钟停止
+  * @param  无
+  * @retval 无
+  */
+void Sim_Rcc_EnterStop(void)
+{
+    Sim_Rcc_Before();
+    stopped = 1;
+}
+
+/**
+  * @brief  Stop唤醒：结算Stop期间，时钟回到HSI，HSE和PLL关闭
+  * @param  无
+  * @retval 无
+  */
+void Sim_Rcc_StopWake(void)
+{
+    Sim_Rcc_Before();
+    stopped = 0;
+    rcc.sws = 0x00;
+    rcc.hse_on = 0;
+    rcc.pll_on = 0;
+    Sim_Rcc_After();
+}
+
+/**
+  * @brief  获取CPU时钟
+  * @param  无
+  * @retval 频率(Hz)，Stop期间为0
+  */
+uint32_t Sim_Rcc_CpuHz(void)
+{
+    return stopped ? 0 : Sim_Rcc_HclkHz();
+}
+
+/**
+  * @brief  记录一次时钟错误
+  * @param  fmt: 说明，printf格式
+  * @retval 无
+  */
+void Sim_Rcc_ClockError(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (stats.clock_errors++ >= SIM_ERROR_PRINTS)
+        return;
+    printf("[sim] %10.3f s  clock error: ", Sim_NowNs() / 1e9);
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    printf("\n");
+}
+
+/**
+  * @brief  获取时钟与功耗统计
+  * @param  无
+  * @retval 统计数据指针，已结算到当前时刻
+  */
+const SimClockStats_t *Sim_Rcc_GetStats(void)
+{
+    Sim_Rcc_Account();
+    return &stats;
+}
+
+/**
+  * @brief  获取统计档的频率
+  * @param  bin: 统计档
+  * @retval 频率(MHz)，0表示其他频率
+  */
+uint32_t Sim_Rcc_BinMHz(int bin)
+{
+    return (bin >= 0 && bin < SIM_CLOCK_BINS) ? sim_bin_mhz[bin] : 0;
+}
+
+/* 系统时钟接口 --------------------------------------------------------------*/
+void SystemInit(void)
+{
+    Sim_Rcc_Before();
+    rcc.hse_on = rcc.pll_on = 1;
+    rcc.hse_ready_ns = rcc.pll_ready_ns = Sim_NowNs();
+    rcc.pll_source = RCC_PLLSource_HSE_Div1;
+    rcc.pll_mul = 9;
+    rcc.sws = 0x08;
+    rcc.hpre = 1;
+    rcc.ppre1 = 2;
+    rcc.ppre2 = 1;
+    rcc.latency = 2;
+    Sim_Rcc_After();
+}
+
+void SystemCoreClockUpdate(void)
+{
+    SystemCoreClock = Sim_Rcc_HclkHz();
+}
+
+/* RCC -----------------------------------------------------------------------*/
+void RCC_HSEConfig(uint32_t RCC_HSE)
+{
+    if (RCC_HSE == RCC_HSE_OFF)
+    {
+        /* 正在作为系统时钟或PLL输入时硬件不会关闭 */
+        if (rcc.sws == 0x04 || (rcc.sws == 0x08 && rcc.pll_source != RCC_PLLSource_HSI_Div2))
+            return;
+        rcc.hse_on = 0;
+        return;
+    }
+    if (!rcc.hse_on)
+    {
+        rcc.hse_on = 1;
+        rcc.hse_ready_ns = Sim_NowNs() + SIM_HSE_STARTUP_NS;
+        stats.hse_starts++;
+    }
+}
+
+ErrorStatus RCC_WaitForHSEStartUp(void)
+{
+    if (!rcc.hse_on)
+        return ERROR;
+    while (Sim_NowNs() < rcc.hse_ready_ns)
+        Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    return SUCCESS;
+}
+
+void RCC_PLLConfig(uint32_t RCC_PLLSource, uint32_t RCC_PLLMul)
+{
+    uint32_t mul = ((RCC_PLLMul >> 18) & 0xF) + 2;
+
+    if (rcc.pll_on)
+    {
+        Sim_Rcc_ClockError("PLL reconfigured while enabled");
+        return;
+    }
+    rcc.pll_source = RCC_PLLSource;
+    rcc.pll_mul = mul > 16 ? 16 : mul;
+}
+
+void RCC_PLLCmd(FunctionalState NewState)
+{
+    if (NewState == DISABLE)
+    {
+        if (rcc.sws == 0x08)
+        {
+            Sim_Rcc_ClockError("PLL disabled while used as SYSCLK");
+            return;
+        }
+        rcc.pll_on = 0;
+        return;
+    }
+    if (rcc.pll_on)
+        return;
+    if (Sim_Rcc_PllHz() > 72000000U)
+        Sim_Rcc_ClockError("PLL output %u MHz exceeds 72 MHz", Sim_Rcc_PllHz() / 1000000);
+    rcc.pll_on = 1;
+    rcc.pll_ready_ns = Sim_NowNs() + SIM_PLL_LOCK_NS;
+    stats.pll_locks++;
+}
+
+void RCC_SYSCLKConfig(uint32_t RCC_SYSCLKSource)
+{
+    uint8_t sws = (uint8_t)(RCC_SYSCLKSource << 2);
+    uint64_t ready;
+
+    if (sws == rcc.sws)
+        return;
+    if ((sws == 0x04 && !rcc.hse_on) || (sws == 0x08 && !rcc.pll_on))
+    {
+        Sim_Rcc_ClockError("SYSCLK switched to a disabled source");
+        return;
+    }
+
+    /* 硬件等目标时钟就绪后才切换 */
+    ready = (sws == 0x04) ? rcc.hse_ready_ns : (sws == 0x08) ? rcc.pll_ready_ns : 0;
+    if (ready > Sim_NowNs())
+        Sim_Advance(ready - Sim_NowNs());
+
+    Sim_Rcc_Before();
+    rcc.sws = sws;
+    stats.sysclk_switches++;
+    Sim_Rcc_After();
+}
+
+uint8_t RCC_GetSYSCLKSource(void)
+{
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    return rcc.sws;
+}
+
+void RCC_HCLKConfig(uint32_t RCC_SYSCLK)
+{
+    static const uint16_t divs[8] = { 2, 4, 8, 16, 64, 128, 256, 512 };
+
+    Sim_Rcc_Before();
+    rcc.hpre = (RCC_SYSCLK & 0x80) ? divs[(RCC_SYSCLK >> 4) & 7] : 1;
+    Sim_Rcc_After();
+}
+
+void RCC_PCLK1Config(uint32_t RCC_HCLK)
+{
+    Sim_Rcc_Before();
+    rcc.ppre1 = (RCC_HCLK & 0x400) ? 2U << ((RCC_HCLK >> 8) & 3) : 1;
+    Sim_Rcc_After();
+}
+
+void RCC_PCLK2Config(uint32_t RCC_HCLK)
+{
+    Sim_Rcc_Before();
+    rcc.ppre2 = (RCC_HCLK & 0x400) ? 2U << ((RCC_HCLK >> 8) & 3) : 1;
+    Sim_Rcc_After();
+}
+
+void RCC_ADCCLKConfig(uint32_t RCC_PCLK2)
+{
+    rcc.adcpre = 2 + 2 * ((RCC_PCLK2 >> 14) & 3);
+}
+
+void RCC_GetClocksFreq(RCC_ClocksTypeDef *RCC_Clocks)
+{
+    RCC_Clocks->SYSCLK_Frequency = Sim_Rcc_SysclkHz();
+    RCC_Clocks->HCLK_Frequency = Sim_Rcc_HclkHz();
+    RCC_Clocks->PCLK1_Frequency = Sim_Rcc_PclkHz(1);
+    RCC_Clocks->PCLK2_Frequency = Sim_Rcc_PclkHz(2);
+    RCC_Clocks->ADCCLK_Frequency = Sim_Rcc_AdcHz();
+}
+
+FlagStatus RCC_GetFlagStatus(uint8_t RCC_FLAG)
+{
+    Sim_Rcc_Cycles(SIM_POLL_CYCLES);
+    switch (RCC_FLAG)
+    {
+    case RCC_FLAG_HSERDY: return (rcc.hse_on && Sim_NowNs() >= rcc.hse_ready_ns) ? SET : RESET;
+    case RCC_FLAG_PLLRDY: return (rcc.pll_on && Sim_NowNs() >= rcc.pll_ready_ns) ? SET : RESET;
+    case RCC_FLAG_HSIRDY:
+    case RCC_FLAG_LSERDY:
+    case RCC_FLAG_LSIRDY: return SET;   // 低速振荡器在仿真中总能起振
+    case RCC_FLAG_PINRST:
+    case RCC_FLAG_PORRST:
+    case RCC_FLAG_SFTRST:
+    case RCC_FLAG_IWDGRST:
+    case RCC_FLAG_WWDGRST:
+    case RCC_FLAG_LPWRRST: return Sim_Bkp_ResetFlag(RCC_FLAG) ? SET : RESET;
+    default:              return RESET;
+    }
+}
+
+/* FLASH ---------------------------------------------------------------------*/
+void FLASH_SetLatency(uint32_t FLASH_Latency)
+{
+    rcc.latency = FLASH_Latency;
+    if (Sim_Rcc_HclkHz() > 24000000U * (rcc.latency + 1))
+        Sim_Rcc_ClockError("flash latency %u too low for %u MHz", rcc.latency,
+                           Sim_Rcc_HclkHz() / 1000000);
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
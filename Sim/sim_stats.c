@@ -0,0 +1,513 @@
+/**
+  ******************************************************************************
+  * @file    sim_stats.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   仿真运行统计
+  * @note    记录每次App_MainLoop的虚拟耗时、报警状态变化、上传与网络故障
+  *          计数，退出时打印摘要，并可写成JSON供脚本比较。串口收发摘要值
+  *          相同说明两次运行的行为完全一致
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+#include "ESP8266.h"
+#include "Timing.h"
+#include "Idle.h"
+#include "Clock.h"
+#include "Watchdog.h"
+#include "Checkpoint.h"
+#include "Boot.h"
+#include "Settings.h"
+#include "Remote.h"
+#include "TimeSync.h"
+#include "Retry.h"
+#include "History.h"
+#include "Batch.h"
+#include "Event.h"
+#include "sim.h"
+#include <stdio.h>
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define LOOP_BUCKET_MS      10                  // 直方图分辨率
+#define LOOP_BUCKETS        (120000 / LOOP_BUCKET_MS)   // 最长记录120秒，更长的计入最后一格
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint64_t loop_start_ns;
+static uint64_t loop_count;
+static uint64_t loop_sum_ns;
+static uint64_t loop_min_ns = UINT64_MAX;
+static uint64_t loop_max_ns;
+static uint64_t loop_max_at_ns;                 // 最长一次循环的开始时刻
+static uint32_t loop_hist[LOOP_BUCKETS];
+
+static uint8_t  alarm_mask;
+static uint32_t alarm_raised[ALARM_CH_COUNT];   // 各通道进入报警的次数
+static uint32_t alarm_cleared[ALARM_CH_COUNT];  // 各通道解除报警的次数
+
+static const char *const channel_names[ALARM_CH_COUNT] = { "temp", "humi", "light" };
+static const char *const profile_names[CLOCK_PROFILE_COUNT] = { "full", "half", "low" };
+static const char *const reset_names[] = { "power", "pin", "software", "iwdg", "lowpower" };
+static const char *const settings_names[] = { "default", "flash", "upgraded" };
+static const char *const retry_names[] = { "closed", "open", "half-open" };
+
+/**
+  * @brief  一次主循环开始
+  * @param  无
+  * @retval 无
+  */
+void Sim_Stats_LoopBegin(void)
+{
+    loop_start_ns = Sim_NowNs();
+}
+
+/**
+  * @brief  一次主循环结束：记录耗时并检查报警状态变化
+  * @param  无
+  * @retval 无
+  */
+void Sim_Stats_LoopEnd(void)
+{
+    uint64_t dur = Sim_NowNs() - loop_start_ns;
+    uint64_t bucket = dur / (LOOP_BUCKET_MS * 1000000ULL);
+    uint8_t mask = Alarm_GetActiveMask();
+    uint8_t changed = mask ^ alarm_mask;
+    int ch;
+
+    loop_count++;
+    loop_sum_ns += dur;
+    if (dur < loop_min_ns)
+        loop_min_ns = dur;
+    if (dur > loop_max_ns)
+    {
+        loop_max_ns = dur;
+        loop_max_at_ns = loop_start_ns;
+    }
+    loop_hist[bucket < LOOP_BUCKETS ? bucket : LOOP_BUCKETS - 1]++;
+
+    if (!changed)
+        return;
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        uint8_t before = alarm_mask & ALARM_CH_MASK(ch);
+        uint8_t after = mask & ALARM_CH_MASK(ch);
+
+        if (!(changed & ALARM_CH_MASK(ch)))
+            continue;
+        if (after)
+            alarm_raised[ch]++;
+        else
+            alarm_cleared[ch]++;
+        if (Sim_Config.verbose)
+            printf("[alarm] %10.3f s %-5s %s\n", Sim_NowNs() / 1e9, channel_names[ch],
+                   !after ? "clear" : before ? "flip" :
+                   (after & ALARM_BIT(ch, ALARM_DIR_HIGH)) ? "high" : "low");
+    }
+    alarm_mask = mask;
+}
+
+/**
+  * @brief  按直方图求分位数
+  * @param  q: 分位(0~1)
+  * @retval 该分位所在格的上界(ms)
+  */
+static uint32_t Sim_Stats_LoopPercentileMs(double q)
+{
+    uint64_t target = (uint64_t)(q * loop_count + 0.5);
+    uint64_t seen = 0;
+    uint32_t i;
+
+    if (target == 0)
+        target = 1;
+    for (i = 0; i < LOOP_BUCKETS; i++)
+    {
+        seen += loop_hist[i];
+        if (seen >= target)
+            return (i + 1) * LOOP_BUCKET_MS;
+    }
+    return LOOP_BUCKETS * LOOP_BUCKET_MS;
+}
+
+/**
+  * @brief  整个运行期间MCU的平均电流
+  */
+static double Sim_Stats_MeanMa(const SimClockStats_t *rcc)
+{
+    if (Sim_NowNs() == 0)
+        return 0.0;
+    return (rcc->run_mas + rcc->sleep_mas + rcc->stop_mas) / (Sim_NowNs() / 1e9);
+}
+
+/**
+  * @brief  整个运行期间ESP8266的平均电流
+  */
+static double Sim_Stats_RadioMeanMa(const SimNetStats_t *net)
+{
+    if (Sim_NowNs() == 0)
+        return 0.0;
+    return net->charge_mas / (Sim_NowNs() / 1e9);
+}
+
+/**
+  * @brief  从固件的分钟历史汇总最近一小时
+  * @param  rec: 存放各通道的平均、最小和最大值
+  * @retval 有效的分钟数，0表示没有历史
+  */
+static int Sim_Stats_LastHour(HistoryRecord_t *rec)
+{
+    HistoryRecord_t m;
+    int32_t sum[ALARM_CH_COUNT] = { 0 };
+    int age, ch, n = 0;
+
+    for (age = 0; age < 60; age++)
+    {
+        if (!History_Get(HISTORY_TIER_MINUTE, (uint16_t)age, &m))
+            continue;
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        {
+            sum[ch] += m.avg.value[ch];
+            if (n == 0 || m.min.value[ch] < rec->min.value[ch])
+                rec->min.value[ch] = m.min.value[ch];
+            if (n == 0 || m.max.value[ch] > rec->max.value[ch])
+                rec->max.value[ch] = m.max.value[ch];
+        }
+        n++;
+    }
+    for (ch = 0; ch < ALARM_CH_COUNT && n; ch++)
+        rec->avg.value[ch] = (int16_t)(sum[ch] / n);
+    return n;
+}
+
+/**
+  * @brief  固件时间与虚拟时间对应的Unix时间之差
+  * @param  error_ms: 存放差值(ms)，正值表示固件时间偏快
+  * @retval 1:固件已同步 0:未同步
+  */
+static int Sim_Stats_TimeError(double *error_ms)
+{
+    uint64_t ms;
+
+    if (!TimeSync_GetEpochMs(&ms))
+        return 0;
+    *error_ms = (double)ms - (Sim_Config.epoch * 1000.0 + Sim_NowNs() / 1e6);
+    return 1;
+}
+
+static void Sim_Stats_WriteJson(const char *path)
+{
+    const SimNetStats_t *net = Sim_Esp_GetStats();
+    const SimPowerStats_t *pw = Sim_Power_GetStats();
+    const SimClockStats_t *rcc = Sim_Rcc_GetStats();
+    const ClockStats_t *cs = Clock_GetStats();
+    const SimWatchdogStats_t *wdg = Sim_Iwdg_GetStats();
+    const SimFlashStats_t *flash = Sim_Flash_GetStats();
+    const RemoteStats_t *remote = Remote_GetStats();
+    const TimeSyncStats_t *ts = TimeSync_GetStats();
+    const RetryStats_t *retry = Retry_GetStats();
+    HistoryRecord_t hour;
+    double time_error;
+    ClockProfile_t profile;
+    ESP8266_RecoverTier_t tier;
+    BootStage_t stage;
+    TimingTask_t task;
+    FILE *fp = fopen(path, "w");
+    int ch;
+
+    if (fp == NULL)
+    {
+        fprintf(stderr, "[sim] cannot write %s\n", path);
+        return;
+    }
+
+    fprintf(fp, "{\n  \"virtual_s\": %.3f,\n  \"seed\": %llu,\n  \"uart_digest\": \"%016llx\",\n",
+            Sim_NowNs() / 1e9, (unsigned long long)Sim_Config.seed,
+            (unsigned long long)Sim_Uart_Digest());
+    fprintf(fp, "  \"loop\": {\"count\": %llu, \"min_ms\": %.3f, \"mean_ms\": %.3f, "
+                "\"p50_ms\": %u, \"p99_ms\": %u, \"max_ms\": %.3f},\n",
+            (unsigned long long)loop_count,
+            loop_count ? loop_min_ns / 1e6 : 0.0,
+            loop_count ? loop_sum_ns / 1e6 / loop_count : 0.0,
+            Sim_Stats_LoopPercentileMs(0.50), Sim_Stats_LoopPercentileMs(0.99),
+            loop_max_ns / 1e6);
+    fprintf(fp, "  \"timing\": {");
+    for (task = TIMING_TASK_PERIOD; task < TIMING_TASK_COUNT; task++)
+    {
+        const TimingStats_t *s = Timing_GetStats(task);
+        fprintf(fp, "%s\"%s\": {\"count\": %u, \"p50_ms\": %u, \"p99_ms\": %u, "
+                    "\"max_ms\": %u, \"overruns\": %u}",
+                task == TIMING_TASK_PERIOD ? "" : ", ", Timing_GetTaskName(task), s->count,
+                Timing_GetPercentile(task, 50), Timing_GetPercentile(task, 99), s->max_ms,
+                s->overruns);
+    }
+    fprintf(fp, "},\n");
+    fprintf(fp, "  \"idle\": {\"sleep_pct\": %u, \"stop_pct\": %u, \"stops\": %u, "
+                "\"stopped_s\": %.3f, \"rx_wakeups\": %u, \"rx_lost\": %u},\n",
+            Idle_GetPercent(IDLE_MODE_SLEEP), Idle_GetPercent(IDLE_MODE_STOP), pw->stop_count,
+            pw->stop_ns / 1e9, pw->rx_wakeups, pw->rx_lost);
+    fprintf(fp, "  \"clock\": {\"switches\": %u, \"last_us\": %u, \"max_us\": %u, "
+                "\"hse_failures\": %u, \"rx_skips\": %u, \"pll_locks\": %u, \"clock_errors\": %u, "
+                "\"time_s\": {",
+            cs->switches, cs->last_us, cs->max_us, cs->hse_failures, cs->rx_skips, rcc->pll_locks,
+            rcc->clock_errors);
+    for (profile = CLOCK_PROFILE_FULL; profile < CLOCK_PROFILE_COUNT; profile++)
+        fprintf(fp, "%s\"%s\": %.3f", profile ? ", " : "", profile_names[profile],
+                cs->time_ms[profile] / 1e3);
+    fprintf(fp, "}},\n");
+    fprintf(fp, "  \"power\": {\"mean_ma\": %.3f, \"run_mas\": %.3f, \"sleep_mas\": %.3f, "
+                "\"stop_mas\": %.3f},\n",
+            Sim_Stats_MeanMa(rcc), rcc->run_mas, rcc->sleep_mas, rcc->stop_mas);
+    fprintf(fp, "  \"network\": {\"requests\": %u, \"responses\": %u, \"dropped\": %u, "
+                "\"lost_bytes\": %u, \"closes\": %u, \"resets\": %u, \"outages\": %u, "
+                "\"at_commands\": %u, \"power_ups\": %u, \"radio_on_s\": %.3f, "
+                "\"radio_mean_ma\": %.3f, \"summaries\": %u, \"summarized\": %u, "
+                "\"http_bytes\": %u, \"batches\": %u, \"batched\": %u, \"batch_bytes\": %u, "
+                "\"batch_errors\": %u, \"batch_mismatched\": %u, \"backfills\": %u, "
+                "\"backfilled\": %u, "
+                "\"event_uploads\": %u, \"events\": %u},\n",
+            net->requests, net->responses, net->dropped, net->lost,
+            net->closes, net->resets, net->outages, net->at_commands,
+            net->power_ups, net->on_ns / 1e9, Sim_Stats_RadioMeanMa(net),
+            net->summaries, net->summarized, net->http_bytes, net->batches, net->batched,
+            net->batch_bytes, net->batch_errors, net->batch_mismatched, net->backfills, net->backfilled,
+            net->event_uploads, net->events);
+    fprintf(fp, "  \"recover\": [");
+    for (tier = ESP8266_RECOVER_TCP; tier < ESP8266_RECOVER_TIER_COUNT; tier++)
+    {
+        const ESP8266_RecoverStats_t *s = ESP8266_GetRecoverStats(tier);
+        fprintf(fp, "%s{\"tier\": %d, \"attempts\": %u, \"successes\": %u, \"max_ms\": %lu}",
+                tier == ESP8266_RECOVER_TCP ? "" : ", ", tier, s->attempts, s->successes,
+                (unsigned long)s->max_ms);
+    }
+    fprintf(fp, "],\n  \"alarms\": {");
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        fprintf(fp, "%s\"%s\": {\"raised\": %u, \"cleared\": %u}", ch ? ", " : "",
+                channel_names[ch], alarm_raised[ch], alarm_cleared[ch]);
+    fprintf(fp, "},\n  \"watchdog\": {\"boot_cause\": \"%s\", \"last_task\": \"%s\", "
+                "\"consecutive\": %u, \"feeds\": %u, \"min_margin_ms\": %.3f},",
+            reset_names[Watchdog_GetResetCause()], Watchdog_GetTaskName(Watchdog_GetLastTask()),
+            Watchdog_GetResetCount(), wdg->feeds, wdg->feeds ? wdg->min_margin_ns / 1e6 : 0.0);
+    fprintf(fp, "\n  \"checkpoint_age_s\": %ld,", (long)Checkpoint_GetRestoredAge());
+    fprintf(fp, "\n  \"boot_ms\": {");
+    for (stage = BOOT_STAGE_CORE; stage < BOOT_STAGE_COUNT; stage++)
+    {
+        uint32_t ms = Boot_GetStageMs(stage);
+        if (ms == BOOT_NOT_REACHED)
+            fprintf(fp, "%s\"%s\": null", stage ? ", " : "", Boot_GetStageName(stage));
+        else
+            fprintf(fp, "%s\"%s\": %lu", stage ? ", " : "", Boot_GetStageName(stage),
+                    (unsigned long)ms);
+    }
+    fprintf(fp, "},");
+    fprintf(fp, "\n  \"settings\": {\"source\": \"%s\", \"seq\": %lu, \"config_id\": %lu, "
+                "\"erases\": %u, \"words\": %u, \"errors\": %u},",
+            settings_names[Settings_GetSource()], (unsigned long)Settings_GetSequence(),
+            (unsigned long)Settings_Get()->config_id, flash->erases, flash->words, flash->errors);
+    fprintf(fp, "\n  \"remote\": {\"pushes\": %u, \"applied\": %u, \"rejected\": %u, "
+                "\"failed\": %u, \"ack_s\": ",
+            net->pushes, remote->applied, remote->rejected, remote->failed);
+    if (net->push_acked)
+        fprintf(fp, "%.3f},", net->push_ack_ns / 1e9);
+    else
+        fprintf(fp, "null},");
+    fprintf(fp, "\n  \"time\": {\"synced\": %s, \"error_ms\": ",
+            Sim_Stats_TimeError(&time_error) ? "true" : "false");
+    if (TimeSync_IsSynced())
+        fprintf(fp, "%.1f", time_error);
+    else
+        fprintf(fp, "null");
+    fprintf(fp, ", \"drift_ppm\": %ld, \"rtc_ppm\": %ld, \"samples\": %lu, \"steps\": %lu, "
+                "\"adjusts\": %lu},",
+            (long)ts->drift_ppm, (long)Sim_Config.rtc_ppm, (unsigned long)ts->samples,
+            (unsigned long)ts->steps, (unsigned long)ts->adjusts);
+    fprintf(fp, "\n  \"retry\": {\"state\": \"%s\", \"failures\": %lu, \"opens\": %lu, "
+                "\"probes\": %lu, \"early_probes\": %lu, \"max_wait_s\": %.3f},",
+            retry_names[Retry_GetState()], (unsigned long)retry->failures,
+            (unsigned long)retry->opens, (unsigned long)retry->probes,
+            (unsigned long)retry->early_probes, retry->max_wait_ms / 1e3);
+    fprintf(fp, "\n  \"history\": {\"raw\": %u, \"minute\": %u, \"quarter\": %u, "
+                "\"last_hour\": {",
+            History_GetDepth(HISTORY_TIER_RAW), History_GetDepth(HISTORY_TIER_MINUTE),
+            History_GetDepth(HISTORY_TIER_QUARTER));
+    if (Sim_Stats_LastHour(&hour))
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            fprintf(fp, "%s\"%s\": [%.1f, %.1f, %.1f]", ch ? ", " : "", channel_names[ch],
+                    hour.min.value[ch] / 10.0, hour.avg.value[ch] / 10.0,
+                    hour.max.value[ch] / 10.0);
+    fprintf(fp, "}},");
+    fprintf(fp, "\n  \"buzzer_on_s\": %.3f", Sim_BuzzerOnNs() / 1e9);
+    Sim_Trace_WriteJson(fp);
+    fprintf(fp, "\n}\n");
+    fclose(fp);
+}
+
+/**
+  * @brief  打印运行摘要
+  * @param  无
+  * @retval 无
+  */
+void Sim_Stats_Report(void)
+{
+    const SimNetStats_t *net = Sim_Esp_GetStats();
+    const SimPowerStats_t *pw = Sim_Power_GetStats();
+    const IdleStats_t *idle = Idle_GetStats();
+    const SimClockStats_t *rcc = Sim_Rcc_GetStats();
+    const ClockStats_t *cs = Clock_GetStats();
+    const SimWatchdogStats_t *wdg = Sim_Iwdg_GetStats();
+    const SimFlashStats_t *flash = Sim_Flash_GetStats();
+    const RemoteStats_t *remote = Remote_GetStats();
+    const TimeSyncStats_t *ts = TimeSync_GetStats();
+    const RetryStats_t *retry = Retry_GetStats();
+    HistoryRecord_t hour;
+    int minutes;
+    double time_error;
+    uint64_t total_ms;
+    ESP8266_RecoverTier_t tier;
+    BootStage_t stage;
+    TimingTask_t task;
+    int ch;
+
+    printf("[sim] ran %.3f s virtual, uart digest %016llx\n",
+           Sim_NowNs() / 1e9, (unsigned long long)Sim_Uart_Digest());
+    if (loop_count)
+        printf("[sim] loop: %llu runs, min %.1f ms, mean %.1f ms, p50 %u ms, p99 %u ms, "
+               "max %.1f ms at %.0f s\n",
+               (unsigned long long)loop_count, loop_min_ns / 1e6,
+               loop_sum_ns / 1e6 / loop_count, Sim_Stats_LoopPercentileMs(0.50),
+               Sim_Stats_LoopPercentileMs(0.99), loop_max_ns / 1e6, loop_max_at_ns / 1e9);
+    for (task = TIMING_TASK_PERIOD; task < TIMING_TASK_COUNT; task++)
+    {
+        const TimingStats_t *s = Timing_GetStats(task);
+        if (s->count)
+            printf("[sim] timing %-6s: p50 %u ms, p99 %u ms, max %u ms, %u/%u over %u ms\n",
+                   Timing_GetTaskName(task), Timing_GetPercentile(task, 50),
+                   Timing_GetPercentile(task, 99), s->max_ms, s->overruns, s->count,
+                   s->deadline_ms);
+    }
+    if (pw->stop_count || idle->sleep_ms)
+        printf("[sim] idle: firmware reports sleep %u%%, stop %u%%; %u stops, %.1f s stopped "
+               "(%.1f%%), %u rx wakeups, %u bytes lost\n",
+               Idle_GetPercent(IDLE_MODE_SLEEP), Idle_GetPercent(IDLE_MODE_STOP),
+               pw->stop_count, pw->stop_ns / 1e9,
+               Sim_NowNs() ? pw->stop_ns * 100.0 / Sim_NowNs() : 0.0,
+               pw->rx_wakeups, pw->rx_lost);
+    total_ms = (uint64_t)cs->time_ms[CLOCK_PROFILE_FULL] + cs->time_ms[CLOCK_PROFILE_HALF] +
+               cs->time_ms[CLOCK_PROFILE_LOW];
+    if (total_ms)
+        printf("[sim] clock: %u switches, last %u us, max %u us, %u hse failures, %u rx skips; "
+               "full %.1f%%, half %.1f%%, low %.1f%%; %u pll locks, %u clock errors\n",
+               cs->switches, cs->last_us, cs->max_us, cs->hse_failures, cs->rx_skips,
+               cs->time_ms[CLOCK_PROFILE_FULL] * 100.0 / total_ms,
+               cs->time_ms[CLOCK_PROFILE_HALF] * 100.0 / total_ms,
+               cs->time_ms[CLOCK_PROFILE_LOW] * 100.0 / total_ms,
+               rcc->pll_locks, rcc->clock_errors);
+    printf("[sim] power: mean %.2f mA (run %.1f, sleep %.1f, stop %.2f mA*s)\n",
+           Sim_Stats_MeanMa(rcc), rcc->run_mas, rcc->sleep_mas, rcc->stop_mas);
+    printf("[sim] uploads: %u received, %u answered, %u dropped, %u bytes lost on dead link\n",
+           net->requests, net->responses, net->dropped, net->lost);
+    if (net->summaries)
+        printf("[sim] summaries: %u windows covering %u samples\n",
+               net->summaries, net->summarized);
+    if (net->batches)
+        printf("[sim] batches: %u uploads carrying %u verified samples, %.1f bytes/sample on air "
+               "(%.2f packed), %u failed verification (%u samples mismatched), "
+               "%u dropped from full queue\n",
+               net->batches, net->batched,
+               net->batched ? (double)net->batch_bytes / net->batched : 0.0,
+               Batch_GetStats()->sent ? (double)Batch_GetStats()->sent_bytes / Batch_GetStats()->sent : 0.0,
+               net->batch_errors, net->batch_mismatched, Batch_GetStats()->dropped);
+    if (net->backfills)
+        printf("[sim] backfill: %u uploads carrying %u verified history slots, %lu acknowledged\n",
+               net->backfills, net->backfilled, (unsigned long)Batch_GetStats()->backfilled);
+    if (Event_GetStats()->raised)
+    {
+        const EventStats_t *es = Event_GetStats();
+        printf("[sim] events: %u raised, %u acked, %u dropped; sample to ack last %lu ms, "
+               "mean %lu ms, max %lu ms; server got %u in %u uploads\n",
+               es->raised, es->acked, es->dropped, (unsigned long)es->last_ms,
+               (unsigned long)(es->acked ? es->total_ms / es->acked : 0), (unsigned long)es->max_ms,
+               net->events, net->event_uploads);
+    }
+    printf("[sim] radio: on %.1f s (%.0f s/h), %u power-ups, mean %.2f mA\n",
+           net->on_ns / 1e9, Sim_NowNs() ? net->on_ns * 3600.0 / Sim_NowNs() : 0.0,
+           net->power_ups, Sim_Stats_RadioMeanMa(net));
+    if (net->closes || net->resets || net->outages)
+        printf("[sim] faults: %u tcp close, %u module reset, %u wifi outage\n",
+               net->closes, net->resets, net->outages);
+    for (tier = ESP8266_RECOVER_TCP; tier < ESP8266_RECOVER_TIER_COUNT; tier++)
+    {
+        const ESP8266_RecoverStats_t *s = ESP8266_GetRecoverStats(tier);
+        if (s->attempts)
+            printf("[sim] recover tier %d: %u/%u ok, max %lu ms\n", tier,
+                   s->successes, s->attempts, (unsigned long)s->max_ms);
+    }
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        if (alarm_raised[ch] || alarm_cleared[ch])
+            printf("[sim] alarm %-5s: raised %u, cleared %u\n", channel_names[ch],
+                   alarm_raised[ch], alarm_cleared[ch]);
+    printf("[sim] buzzer on %.1f s\n", Sim_BuzzerOnNs() / 1e9);
+    if (wdg->enabled)
+        printf("[sim] watchdog: boot cause %s, last task %s, %u consecutive; "
+               "%u feeds, min margin %.0f ms\n",
+               reset_names[Watchdog_GetResetCause()],
+               Watchdog_GetTaskName(Watchdog_GetLastTask()), Watchdog_GetResetCount(),
+               wdg->feeds, wdg->feeds ? wdg->min_margin_ns / 1e6 : 0.0);
+    printf("[sim] boot:");
+    for (stage = BOOT_STAGE_CORE; stage < BOOT_STAGE_COUNT; stage++)
+    {
+        if (Boot_GetStageMs(stage) == BOOT_NOT_REACHED)
+            printf(" %s -", Boot_GetStageName(stage));
+        else
+            printf(" %s %lu", Boot_GetStageName(stage), (unsigned long)Boot_GetStageMs(stage));
+    }
+    printf(" ms\n");
+    if (Sim_Dht11_EarlyStarts())
+        printf("[sim] dht11: %lu start signals during power-up, not answered\n",
+               (unsigned long)Sim_Dht11_EarlyStarts());
+    printf("[sim] settings: %s, seq %lu, cfg %lu; flash %u erases, %u words, %u errors\n",
+           settings_names[Settings_GetSource()], (unsigned long)Settings_GetSequence(),
+           (unsigned long)Settings_Get()->config_id, flash->erases, flash->words, flash->errors);
+    if (net->pushes || remote->applied || remote->rejected || remote->failed)
+    {
+        printf("[sim] remote: %u pushes, %u applied, %u rejected, %u failed; ",
+               net->pushes, remote->applied, remote->rejected, remote->failed);
+        if (net->push_acked)
+            printf("acknowledged at %.3f s\n", net->push_ack_ns / 1e9);
+        else
+            printf("not acknowledged\n");
+    }
+    if (retry->failures)
+        printf("[sim] retry: %s; %lu failures, %lu opens, %lu probes (%lu early), "
+               "longest wait %.1f s\n",
+               retry_names[Retry_GetState()], (unsigned long)retry->failures,
+               (unsigned long)retry->opens, (unsigned long)retry->probes,
+               (unsigned long)retry->early_probes, retry->max_wait_ms / 1e3);
+    if (Sim_Stats_TimeError(&time_error))
+        printf("[sim] time: synced, error %+.1f ms, drift %ld ppm (rtc %ld ppm); "
+               "%lu samples, %lu steps, %lu adjusts\n",
+               time_error, (long)ts->drift_ppm, (long)Sim_Config.rtc_ppm,
+               (unsigned long)ts->samples, (unsigned long)ts->steps, (unsigned long)ts->adjusts);
+    else
+        printf("[sim] time: not synced\n");
+    printf("[sim] history: %u raw, %u minute, %u quarter slots",
+           History_GetDepth(HISTORY_TIER_RAW), History_GetDepth(HISTORY_TIER_MINUTE),
+           History_GetDepth(HISTORY_TIER_QUARTER));
+    minutes = Sim_Stats_LastHour(&hour);
+    if (minutes)
+        printf("; last %d min temp %.1f..%.1f C, humi %.1f..%.1f %%",
+               minutes, hour.min.value[ALARM_CH_TEMP] / 10.0, hour.max.value[ALARM_CH_TEMP] / 10.0,
+               hour.min.value[ALARM_CH_HUMI] / 10.0, hour.max.value[ALARM_CH_HUMI] / 10.0);
+    printf("\n");
+    if (Checkpoint_GetRestoredAge() >= 0)
+        printf("[sim] filters: warm start from a %ld s old checkpoint\n",
+               (long)Checkpoint_GetRestoredAge());
+    Sim_Trace_Report();
+
+    if (Sim_Config.json)
+        Sim_Stats_WriteJson(Sim_Config.json);
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
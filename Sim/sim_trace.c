@@ -0,0 +1,443 @@
+/**
+  ******************************************************************************
+  * @file    sim_trace.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   采集轨迹的录制、回放与解码
+  * @note    固件经USART3输出的轨迹字节流（格式见System/Trace.h）在这里解码：
+  *          --trace=文件      原样保存，与板上用串口工具抓取的文件格式相同
+  *          --replay=文件     DHT11和ADC按顺序返回文件中记录的原始读数，
+  *                            固件算出的处理结果与文件中的逐条比较
+  *          --trace-dump=文件 把轨迹文件转成CSV打印后退出
+  *          固件输出的耗时统计记录（Prof.c）保留最新一组，结束时换算成微秒打印
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Trace.h"
+#include "DHT11.h"
+#include "Prof.h"
+#include "Boot.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  解码后的一条记录
+  */
+typedef struct {
+    uint8_t  type;
+    uint8_t  len;
+    uint32_t ms;
+    uint8_t  payload[TRACE_MAX_PAYLOAD];
+} SimTraceRec_t;
+
+/**
+  * @brief  字节流解码器，遇到校验错误时从下一个同步字重新对齐
+  */
+typedef struct {
+    uint8_t  buf[TRACE_HEADER_SIZE + TRACE_MAX_PAYLOAD + 1];
+    uint16_t n;
+    uint32_t records;
+    uint32_t bad;               // 校验失败或长度非法的记录
+} SimTraceParser_t;
+
+/**
+  * @brief  一个字段的回放偏差
+  */
+typedef struct {
+    double   sum;
+    double   max;
+    uint32_t max_at;            // 偏差最大的记录序号
+} SimTraceDiff_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static FILE *record_fp = NULL;
+static SimTraceParser_t live;           // 固件实时输出的解码器
+
+static SimTraceRec_t *replay = NULL;    // 回放文件中的全部记录
+static uint32_t replay_count = 0;
+static uint32_t replay_dht = 0;         // 各类记录的读取位置
+static uint32_t replay_adc = 0;
+static uint32_t replay_adc_channels = 0; // 回放文件中有ADC记录的通道位图
+static uint32_t replay_out = 0;
+static uint8_t  replay_active = 0;
+
+static uint32_t cmp_count = 0;          // 已比较的处理结果
+static uint32_t cmp_alarm_diff = 0;     // 报警位图不一致的次数
+static SimTraceDiff_t cmp_diff[3];      // 温度、湿度、光照
+
+static uint8_t prof_seen = 0;           // 收到过耗时统计的分区位图
+static uint32_t prof_last[PROF_ZONE_COUNT][4];  // 各分区最新的次数、最短、平均、最长
+
+static const char *const field_names[3] = { "temp", "humi", "light" };
+
+/* 私有函数 ------------------------------------------------------------------*/
+static uint16_t Sim_Trace_U16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t Sim_Trace_U32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/**
+  * @brief  向解码器送入一个字节
+  * @retval 1:解出一条完整记录 0:尚未完整
+  */
+static int Sim_Trace_Feed(SimTraceParser_t *ps, uint8_t byte, SimTraceRec_t *rec)
+{
+    uint16_t size;
+
+    if (ps->n == 0 && byte != TRACE_SYNC)
+        return 0;
+    ps->buf[ps->n++] = byte;
+    if (ps->n < 3)
+        return 0;
+    if (ps->buf[2] > TRACE_MAX_PAYLOAD)
+        goto resync;
+    size = TRACE_HEADER_SIZE + ps->buf[2] + 1;
+    if (ps->n < size)
+        return 0;
+    if (Trace_Crc8(&ps->buf[1], size - 2) != ps->buf[size - 1])
+        goto resync;
+
+    rec->type = ps->buf[1];
+    rec->len = ps->buf[2];
+    rec->ms = ps->buf[3] | ps->buf[4] << 8 | ps->buf[5] << 16 | (uint32_t)ps->buf[6] << 24;
+    memcpy(rec->payload, &ps->buf[TRACE_HEADER_SIZE], rec->len);
+    ps->n = 0;
+    ps->records++;
+    return 1;
+
+resync:
+    {
+        /* 丢弃这个同步字，剩余字节重新送入 */
+        uint8_t rest[sizeof(ps->buf)];
+        uint16_t len = ps->n - 1;
+        uint16_t i;
+        int got = 0;
+
+        ps->bad++;
+        memcpy(rest, &ps->buf[1], len);
+        ps->n = 0;
+        for (i = 0; i < len; i++)
+            got |= Sim_Trace_Feed(ps, rest[i], rec);
+        return got;
+    }
+}
+
+/**
+  * @brief  读入整个轨迹文件
+  * @retval 记录数，失败返回-1
+  */
+static int Sim_Trace_Load(const char *path, SimTraceRec_t **out, SimTraceParser_t *ps)
+{
+    FILE *fp = fopen(path, "rb");
+    SimTraceRec_t *recs = NULL;
+    uint32_t count = 0, cap = 0;
+    SimTraceRec_t rec;
+    int ch;
+
+    if (fp == NULL)
+        return -1;
+    memset(ps, 0, sizeof(*ps));
+    while ((ch = fgetc(fp)) != EOF)
+    {
+        if (!Sim_Trace_Feed(ps, (uint8_t)ch, &rec))
+            continue;
+        if (count == cap)
+        {
+            cap = cap ? cap * 2 : 4096;
+            recs = realloc(recs, cap * sizeof(*recs));
+            if (recs == NULL)
+            {
+                fclose(fp);
+                return -1;
+            }
+        }
+        recs[count++] = rec;
+    }
+    fclose(fp);
+    *out = recs;
+    return (int)count;
+}
+
+/**
+  * @brief  固件输出一条处理结果：与回放文件中的对应记录比较
+  */
+static void Sim_Trace_Compare(const SimTraceRec_t *rec)
+{
+    const SimTraceRec_t *ref;
+    double now[3], old[3];
+    int i;
+
+    while (replay_out < replay_count && replay[replay_out].type != TRACE_REC_OUTPUT)
+        replay_out++;
+    if (replay_out >= replay_count)
+        return;
+    ref = &replay[replay_out++];
+
+    now[0] = (int16_t)Sim_Trace_U16(&rec->payload[0]) / 10.0;
+    now[1] = (int16_t)Sim_Trace_U16(&rec->payload[2]) / 10.0;
+    now[2] = Sim_Trace_U16(&rec->payload[4]);
+    old[0] = (int16_t)Sim_Trace_U16(&ref->payload[0]) / 10.0;
+    old[1] = (int16_t)Sim_Trace_U16(&ref->payload[2]) / 10.0;
+    old[2] = Sim_Trace_U16(&ref->payload[4]);
+
+    for (i = 0; i < 3; i++)
+    {
+        double d = now[i] > old[i] ? now[i] - old[i] : old[i] - now[i];
+        cmp_diff[i].sum += d;
+        if (d > cmp_diff[i].max)
+        {
+            cmp_diff[i].max = d;
+            cmp_diff[i].max_at = cmp_count;
+        }
+    }
+    if (rec->payload[6] != ref->payload[6])
+    {
+        cmp_alarm_diff++;
+        if (Sim_Config.verbose)
+            printf("[trace] %10.3f s alarm mask %02x, recorded %02x at %.3f s\n",
+                   Sim_NowNs() / 1e9, rec->payload[6], ref->payload[6], ref->ms / 1e3);
+    }
+    cmp_count++;
+}
+
+/**
+  * @brief  取下一条指定类型的回放记录，取完时结束仿真
+  */
+static const SimTraceRec_t *Sim_Trace_Next(uint32_t *pos, uint8_t type, int channel)
+{
+    while (*pos < replay_count)
+    {
+        const SimTraceRec_t *rec = &replay[(*pos)++];
+        if (rec->type == type && (channel < 0 || rec->payload[0] == channel))
+            return rec;
+    }
+    printf("[sim] %10.3f s  replay exhausted\n", Sim_NowNs() / 1e9);
+    Sim_Finish();
+    return NULL;
+}
+
+/* 公共接口 ------------------------------------------------------------------*/
+/**
+  * @brief  打开录制和回放文件
+  * @param  record_path: 录制文件，可为NULL
+  * @param  replay_path: 回放文件，可为NULL
+  * @retval 0:成功 -1:失败
+  */
+int Sim_Trace_Open(const char *record_path, const char *replay_path)
+{
+    SimTraceParser_t ps;
+    uint32_t i;
+    int n;
+
+    if (record_path != NULL && (record_fp = fopen(record_path, "wb")) == NULL)
+        return -1;
+    if (replay_path == NULL)
+        return 0;
+
+    n = Sim_Trace_Load(replay_path, &replay, &ps);
+    if (n <= 0)
+        return -1;
+    replay_count = (uint32_t)n;
+    replay_active = 1;
+    for (i = 0; i < replay_count; i++)
+        if (replay[i].type == TRACE_REC_ADC && replay[i].payload[0] < 32)
+            replay_adc_channels |= 1UL << replay[i].payload[0];
+    printf("[sim] replaying %u records from %s (%u bad), %.1f s recorded\n",
+           replay_count, replay_path, ps.bad, replay[replay_count - 1].ms / 1e3);
+    return 0;
+}
+
+/**
+  * @brief  固件从USART3发出一个轨迹字节
+  * @param  byte: 数据
+  * @retval 无
+  */
+void Sim_Trace_Input(uint8_t byte)
+{
+    SimTraceRec_t rec;
+
+    if (record_fp != NULL)
+        fputc(byte, record_fp);
+    if (!Sim_Trace_Feed(&live, byte, &rec))
+        return;
+    if (replay_active && rec.type == TRACE_REC_OUTPUT)
+        Sim_Trace_Compare(&rec);
+    if (rec.type == TRACE_REC_OUTPUT)
+        Sim_Esp_Sample((int16_t)Sim_Trace_U16(&rec.payload[0]), (int16_t)Sim_Trace_U16(&rec.payload[2]),
+                       Sim_Trace_U16(&rec.payload[4]));
+    if (rec.type == TRACE_REC_PROF && rec.payload[0] < PROF_ZONE_COUNT)
+    {
+        int i;
+
+        for (i = 0; i < 4; i++)
+            prof_last[rec.payload[0]][i] = Sim_Trace_U32(&rec.payload[1 + i * 4]);
+        prof_seen |= 1 << rec.payload[0];
+    }
+}
+
+/**
+  * @brief  回放下一帧DHT11读数
+  * @param  data: 输出5字节原始数据
+  * @retval -1:未回放，按环境模型应答 0:该次读取无应答 1:按data应答
+  */
+int Sim_Trace_NextDht(uint8_t data[5])
+{
+    const SimTraceRec_t *rec;
+
+    if (!replay_active || (rec = Sim_Trace_Next(&replay_dht, TRACE_REC_DHT, -1)) == NULL)
+        return -1;
+    memcpy(data, &rec->payload[1], 5);
+    return rec->payload[0] != DHT_TIMEOUT;
+}
+
+/**
+  * @brief  回放文件中是否有该通道的ADC记录
+  * @param  channel: ADC通道
+  * @retval 1:有，按记录回放 0:没有或未回放，按环境模型
+  */
+int Sim_Trace_HasAdc(uint8_t channel)
+{
+    return replay_active && channel < 32 && (replay_adc_channels >> channel) & 1;
+}
+
+/**
+  * @brief  回放下一次ADC读取结果
+  * @param  channel: ADC通道
+  * @param  value: 输出固件读到的过采样之和
+  * @retval 1:已回放 0:未回放
+  */
+int Sim_Trace_NextAdc(uint8_t channel, uint16_t *value)
+{
+    const SimTraceRec_t *rec;
+
+    if (!Sim_Trace_HasAdc(channel) || (rec = Sim_Trace_Next(&replay_adc, TRACE_REC_ADC, channel)) == NULL)
+        return 0;
+    *value = Sim_Trace_U16(&rec->payload[1]);
+    return 1;
+}
+
+/**
+  * @brief  打印录制与回放摘要
+  * @param  无
+  * @retval 无
+  */
+void Sim_Trace_Report(void)
+{
+    int i;
+
+    if (record_fp != NULL)
+    {
+        fclose(record_fp);
+        record_fp = NULL;
+    }
+    if (live.records || live.bad)
+        printf("[sim] trace: %u records, %u bad, %lu dropped by firmware\n",
+               live.records, live.bad, (unsigned long)Trace_GetDropped());
+    for (i = 0; i < PROF_ZONE_COUNT; i++)
+    {
+        double us_per_cycle = 1e6 / PROF_REF_HZ;
+
+        if (!(prof_seen & (1 << i)))
+            continue;
+        printf("[sim] prof %-4s: %u calls, min %.0f us, avg %.0f us, max %.0f us\n",
+               Prof_GetZoneName((ProfZone_t)i), prof_last[i][0], prof_last[i][1] * us_per_cycle,
+               prof_last[i][2] * us_per_cycle, prof_last[i][3] * us_per_cycle);
+    }
+    if (!replay_active)
+        return;
+
+    printf("[sim] replay: %u outputs compared, %u alarm mask differences\n",
+           cmp_count, cmp_alarm_diff);
+    for (i = 0; i < 3 && cmp_count; i++)
+        printf("[sim] replay %-5s: mean |diff| %.3f, max %.1f at output #%u\n", field_names[i],
+               cmp_diff[i].sum / cmp_count, cmp_diff[i].max, cmp_diff[i].max_at);
+}
+
+/**
+  * @brief  把回放比较结果写入统计JSON
+  * @param  json: 已打开的JSON文件，写在顶层对象的末尾
+  * @retval 无
+  */
+void Sim_Trace_WriteJson(FILE *json)
+{
+    int i;
+
+    if (!replay_active)
+        return;
+    fprintf(json, ",\n  \"replay\": {\"compared\": %u, \"alarm_diff\": %u", cmp_count, cmp_alarm_diff);
+    for (i = 0; i < 3; i++)
+        fprintf(json, ", \"%s\": {\"mean\": %.4f, \"max\": %.1f}", field_names[i],
+                cmp_count ? cmp_diff[i].sum / cmp_count : 0.0, cmp_diff[i].max);
+    fprintf(json, "}");
+}
+
+/**
+  * @brief  把轨迹文件打印为CSV
+  * @param  path: 轨迹文件
+  * @retval 0:成功 -1:失败
+  */
+int Sim_Trace_Dump(const char *path)
+{
+    static const char *const dht_status[] = { "error", "ok", "timeout" };
+    SimTraceParser_t ps;
+    SimTraceRec_t *recs = NULL;
+    int n = Sim_Trace_Load(path, &recs, &ps);
+    int i;
+
+    if (n < 0)
+        return -1;
+    printf("ms,record,a,b,c,d,e,f\n");
+    for (i = 0; i < n; i++)
+    {
+        const SimTraceRec_t *r = &recs[i];
+        const uint8_t *p = r->payload;
+
+        switch (r->type)
+        {
+        case TRACE_REC_BOOT:
+            printf("%lu,boot,%u\n", (unsigned long)r->ms, p[0]);
+            break;
+        case TRACE_REC_STAGE:
+            printf("%lu,stage,%s\n", (unsigned long)r->ms, Boot_GetStageName((BootStage_t)p[0]));
+            break;
+        case TRACE_REC_DHT:
+            printf("%lu,dht,%s,%u,%u,%u,%u,%u\n", (unsigned long)r->ms,
+                   p[0] <= DHT_TIMEOUT ? dht_status[p[0]] : "?", p[1], p[2], p[3], p[4], p[5]);
+            break;
+        case TRACE_REC_ADC:
+            printf("%lu,adc,%u,%u\n", (unsigned long)r->ms, p[0], Sim_Trace_U16(&p[1]));
+            break;
+        case TRACE_REC_OUTPUT:
+            printf("%lu,output,%.1f,%.1f,%u,0x%02x\n", (unsigned long)r->ms,
+                   (int16_t)Sim_Trace_U16(&p[0]) / 10.0, (int16_t)Sim_Trace_U16(&p[2]) / 10.0,
+                   Sim_Trace_U16(&p[4]), p[6]);
+            break;
+        case TRACE_REC_PROF:
+            printf("%lu,prof,%s,%lu,%lu,%lu,%lu\n", (unsigned long)r->ms,
+                   Prof_GetZoneName((ProfZone_t)p[0]), (unsigned long)Sim_Trace_U32(&p[1]),
+                   (unsigned long)Sim_Trace_U32(&p[5]), (unsigned long)Sim_Trace_U32(&p[9]),
+                   (unsigned long)Sim_Trace_U32(&p[13]));
+            break;
+        default:
+            printf("%lu,0x%02x,%u bytes\n", (unsigned long)r->ms, r->type, r->len);
+            break;
+        }
+    }
+    if (ps.bad)
+        fprintf(stderr, "[sim] %u bad records skipped\n", ps.bad);
+    free(recs);
+    return 0;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file    sim_uart.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   USART1的仿真后端
+  * @note    model：内置ESP8266 AT模型，完全离线
+  *          pty  ：创建伪终端，可接串口调试助手或真实模块的桥接程序
+  *          tcp:主机:端口：串口字节直接经TCP转发，便于接入网络服务做联调
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+/* 固件中的重定向函数（经sim_retarget.h改名） --------------------------------*/
+int Sim_Fputc(int ch, FILE *f);
+
+/* 私有类型 ------------------------------------------------------------------*/
+typedef enum {
+    UART_BACKEND_MODEL = 0,
+    UART_BACKEND_FD
+} UartBackend_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static UartBackend_t backend = UART_BACKEND_MODEL;
+static int uart_fd = -1;
+
+static char log_line[2][128];           // 0:发送 1:接收
+static size_t log_len[2];
+static uint64_t digest = 0xCBF29CE484222325ULL;    // 收发内容与时刻的FNV-1a摘要
+
+/**
+  * @brief  把一个收发字节计入摘要
+  */
+static void Sim_Uart_Hash(int dir, uint8_t byte)
+{
+    uint64_t word = (Sim_NowNs() / 1000) << 9 | (uint64_t)dir << 8 | byte;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        digest ^= (uint8_t)(word >> (i * 8));
+        digest *= 0x100000001B3ULL;
+    }
+}
+
+/**
+  * @brief  按行打印串口收发内容
+  */
+static void Sim_Uart_Log(int dir, uint8_t byte)
+{
+    if (!Sim_Config.verbose)
+        return;
+    if (byte != '\n' && byte != '\r' && log_len[dir] < sizeof(log_line[dir]) - 1)
+    {
+        log_line[dir][log_len[dir]++] = (byte >= 0x20 && byte < 0x7F) ? (char)byte : '.';
+        return;
+    }
+    if (byte == '\r' || log_len[dir] == 0)
+        return;
+    log_line[dir][log_len[dir]] = '\0';
+    printf("[uart] %10.3f s %s %s\n", Sim_NowNs() / 1e9, dir ? "<<" : ">>", log_line[dir]);
+    log_len[dir] = 0;
+}
+
+static int Sim_Uart_OpenPty(void)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0)
+        return -1;
+    if (tcgetattr(fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    printf("[sim] USART1 on %s\n", ptsname(fd));
+    return fd;
+}
+
+static int Sim_Uart_OpenTcp(const char *hostport)
+{
+    struct addrinfo hints, *res, *ai;
+    char host[128];
+    const char *colon = strrchr(hostport, ':');
+    int fd = -1;
+
+    if (colon == NULL || (size_t)(colon - hostport) >= sizeof(host))
+        return -1;
+    memcpy(host, hostport, colon - hostport);
+    host[colon - hostport] = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, colon + 1, &hints, &res) != 0)
+        return -1;
+    for (ai = res; ai != NULL; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0)
+        printf("[sim] USART1 on tcp %s\n", hostport);
+    return fd;
+}
+
+/**
+  * @brief  打开串口后端
+  * @param  spec: "model" / "pty" / "tcp:主机:端口"
+  * @retval 0:成功 -1:失败
+  */
+int Sim_Uart_Open(const char *spec)
+{
+    if (spec == NULL || strcmp(spec, "model") == 0)
+    {
+        backend = UART_BACKEND_MODEL;
+        Sim_Esp_Reset();
+        return 0;
+    }
+
+    if (strcmp(spec, "pty") == 0)
+        uart_fd = Sim_Uart_OpenPty();
+    else if (strncmp(spec, "tcp:", 4) == 0)
+        uart_fd = Sim_Uart_OpenTcp(spec + 4);
+    else
+        return -1;
+
+    if (uart_fd < 0)
+        return -1;
+    fcntl(uart_fd, F_SETFL, fcntl(uart_fd, F_GETFL) | O_NONBLOCK);
+    backend = UART_BACKEND_FD;
+    return 0;
+}
+
+/**
+  * @brief  关闭串口后端
+  * @param  无
+  * @retval 无
+  */
+void Sim_Uart_Close(void)
+{
+    if (uart_fd >= 0)
+        close(uart_fd);
+    uart_fd = -1;
+}
+
+/**
+  * @brief  固件发送一个字节
+  * @param  byte: 数据
+  * @retval 无
+  */
+void Sim_Uart_Tx(uint8_t byte)
+{
+    Sim_Uart_Hash(0, byte);
+    Sim_Uart_Log(0, byte);
+    if (backend == UART_BACKEND_MODEL)
+        Sim_Esp_Input(byte);
+    else if (write(uart_fd, &byte, 1) < 0 && errno != EAGAIN)
+        perror("[sim] uart write");
+}
+
+/**
+  * @brief  取一个待送给固件的字节
+  * @param  byte: 输出数据
+  * @retval 1:有数据 0:无数据
+  */
+int Sim_Uart_Rx(uint8_t *byte)
+{
+    int got;
+
+    if (backend == UART_BACKEND_MODEL)
+        got = Sim_Esp_Output(byte);
+    else
+        got = (uart_fd >= 0 && read(uart_fd, byte, 1) == 1);
+
+    if (got)
+    {
+        Sim_Uart_Hash(1, *byte);
+        Sim_Uart_Log(1, *byte);
+    }
+    return got;
+}
+
+/**
+  * @brief  固件printf的仿真实现
+  * @note   与目标板的MicroLIB一样，格式化结果逐字符交给固件的fputc
+  */
+int Sim_Printf(const char *format, ...)
+{
+    char buf[1024];
+    va_list ap;
+    int len, i;
+
+    va_start(ap, format);
+    len = vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    if (len < 0)
+        return len;
+    if (len > (int)sizeof(buf) - 1)
+        len = sizeof(buf) - 1;
+    for (i = 0; i < len; i++)
+        Sim_Fputc((uint8_t)buf[i], stdout);
+    return len;
+}
+
+/**
+  * @brief  获取串口收发摘要
+  * @param  无
+  * @retval 摘要值，相同参数的两次运行应当一致
+  */
+uint64_t Sim_Uart_Digest(void)
+{
+    return digest;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
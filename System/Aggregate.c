@@ -0,0 +1,187 @@
+/**
+  ******************************************************************************
+  * @file    Aggregate.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   窗口统计量实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Aggregate.h"
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define AGGREGATE_Q_BITS        16          // 均值和方差的定点位数
+
+/* 私有变量 ------------------------------------------------------------------*/
+static AggregateWindow_t open;              // 正在累计的窗口
+static AggregateWindow_t pending;           // 已结束、待上传的窗口
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  四舍五入的有符号除法
+  */
+static int32_t Aggregate_Divide(int64_t num, uint32_t den)
+{
+    int64_t half = den / 2;
+
+    return (int32_t)((num >= 0 ? num + half : num - half) / (int64_t)den);
+}
+
+/**
+  * @brief  清空统计量
+  * @param  a: 统计量
+  * @retval 无
+  */
+void Aggregate_Reset(Aggregate_t *a)
+{
+    memset(a, 0, sizeof(*a));
+}
+
+/**
+  * @brief  累计一个采样
+  * @param  a: 统计量
+  * @param  value: 定点数值
+  * @retval 无
+  * @note   mean += d/n，m2 += d*(x-mean')；d与x-mean'同号，m2不会减小。
+  *          d为Q16，乘积为Q32，移回Q16后累加
+  */
+void Aggregate_Update(Aggregate_t *a, int16_t value)
+{
+    int32_t x = (int32_t)value * (1 << AGGREGATE_Q_BITS);
+    int64_t delta;
+
+    a->last = value;
+    if (a->count++ == 0)
+    {
+        a->min = a->max = value;
+        a->mean = x;
+        a->m2 = 0;
+        return;
+    }
+    if (value < a->min)
+        a->min = value;
+    if (value > a->max)
+        a->max = value;
+
+    delta = (int64_t)x - a->mean;
+    a->mean += Aggregate_Divide(delta, a->count);
+    a->m2 += (uint64_t)(delta * ((int64_t)x - a->mean)) >> AGGREGATE_Q_BITS;
+}
+
+/**
+  * @brief  把较新的一段统计量并入较早的一段
+  * @param  a: 较早的一段，存放合并结果
+  * @param  b: 较新的一段
+  * @retval 无
+  * @note   m2 = m2a + m2b + d^2*na*nb/n，d为两段均值之差；先除后乘，余数
+  *          单独计算，中间结果不溢出
+  */
+void Aggregate_Merge(Aggregate_t *a, const Aggregate_t *b)
+{
+    uint32_t n;
+    int64_t delta;
+    uint64_t d2;
+
+    if (b->count == 0)
+        return;
+    if (a->count == 0)
+    {
+        *a = *b;
+        return;
+    }
+
+    n = a->count + b->count;
+    delta = (int64_t)b->mean - a->mean;
+    d2 = (uint64_t)(delta * delta) >> AGGREGATE_Q_BITS;
+
+    a->mean += Aggregate_Divide(delta * b->count, n);
+    a->m2 += b->m2 + d2 / n * a->count * b->count + d2 % n * a->count / n * b->count;
+    a->count = n;
+    if (b->min < a->min)
+        a->min = b->min;
+    if (b->max > a->max)
+        a->max = b->max;
+    a->last = b->last;
+}
+
+/**
+  * @brief  获取均值
+  * @param  a: 统计量
+  * @retval 均值，Q16
+  */
+int32_t Aggregate_GetMean(const Aggregate_t *a)
+{
+    return a->mean;
+}
+
+/**
+  * @brief  获取样本方差
+  * @param  a: 统计量
+  * @retval 方差（除以n-1），Q16；少于两个采样时为0
+  */
+uint64_t Aggregate_GetVariance(const Aggregate_t *a)
+{
+    return a->count < 2 ? 0 : a->m2 / (a->count - 1);
+}
+
+/**
+  * @brief  在当前窗口中累计一次采样
+  * @param  values: 各通道的定点数值
+  * @param  now_ms: 采样时刻(ms)
+  * @param  epoch: 采样时的Unix时间(s)，未同步时为0
+  * @retval 无
+  */
+void Aggregate_Add(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms, uint32_t epoch)
+{
+    int ch;
+
+    if (open.ch[0].count == 0)
+    {
+        open.start_ms = now_ms;
+        open.epoch = epoch;
+    }
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        Aggregate_Update(&open.ch[ch], values[ch]);
+}
+
+/**
+  * @brief  结束当前窗口，并入待上传窗口
+  * @param  now_ms: 当前时刻(ms)
+  * @retval 待上传窗口，没有采样时为NULL
+  */
+const AggregateWindow_t *Aggregate_Close(uint32_t now_ms)
+{
+    int ch;
+
+    if (open.ch[0].count != 0)
+    {
+        if (pending.ch[0].count == 0)
+        {
+            pending.start_ms = open.start_ms;
+            pending.epoch = open.epoch;
+        }
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            Aggregate_Merge(&pending.ch[ch], &open.ch[ch]);
+        memset(&open, 0, sizeof(open));
+    }
+    if (pending.ch[0].count == 0)
+        return NULL;
+
+    pending.length_ms = now_ms - pending.start_ms;
+    return &pending;
+}
+
+/**
+  * @brief  待上传窗口已送达，清空
+  * @param  无
+  * @retval 无
+  */
+void Aggregate_Clear(void)
+{
+    memset(&pending, 0, sizeof(pending));
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
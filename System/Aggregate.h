@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    Aggregate.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   窗口统计量头文件
+  * @note    对温度、湿度和光照逐个采样累计个数、最小值、最大值、最后一个值、
+  *          均值和方差，不保存采样本身。均值和偏差平方和按Welford递推更新，
+  *          全部为定点整数运算：数值单位与报警判定相同（温湿度0.1，光照值x10），
+  *          绝对值不超过16383；均值、偏差平方和与方差均为Q16（x65536），一天的
+  *          1s采样累计下来均值的舍入误差约万分之一个单位。两段统计可按Chan的
+  *          公式合并，结果与连续累计相同。
+  *
+  *          采集路径上有一个正在累计的窗口和一个待上传的窗口：上传前
+  *          Aggregate_Close把当前窗口并入待上传窗口，上传成功后Aggregate_Clear
+  *          清空；上传失败时下一次上传的窗口自动包含这段时间，汇总不丢失
+  ******************************************************************************
+  */
+
+#ifndef __AGGREGATE_H
+#define __AGGREGATE_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  一个通道的统计量
+  */
+typedef struct {
+    uint32_t count;
+    int16_t  min;
+    int16_t  max;
+    int16_t  last;
+    int32_t  mean;              // 均值，Q16
+    uint64_t m2;                // 偏差平方和，Q16
+} Aggregate_t;
+
+/**
+  * @brief  一个窗口内各通道的统计量
+  */
+typedef struct {
+    uint32_t epoch;             // 第一个采样的Unix时间(s)，未同步时为0
+    uint32_t start_ms;          // 第一个采样的时刻(ms)
+    uint32_t length_ms;         // 窗口长度，关闭时更新
+    Aggregate_t ch[ALARM_CH_COUNT];
+} AggregateWindow_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  清空统计量
+  * @param  a: 统计量
+  * @retval 无
+  */
+void Aggregate_Reset(Aggregate_t *a);
+
+/**
+  * @brief  累计一个采样
+  * @param  a: 统计量
+  * @param  value: 定点数值
+  * @retval 无
+  */
+void Aggregate_Update(Aggregate_t *a, int16_t value);
+
+/**
+  * @brief  把较新的一段统计量并入较早的一段
+  * @param  a: 较早的一段，存放合并结果
+  * @param  b: 较新的一段
+  * @retval 无
+  * @note   数值跨度在10000以内时，较短一段不超过2^20个采样（1s采样约12天）
+  */
+void Aggregate_Merge(Aggregate_t *a, const Aggregate_t *b);
+
+/**
+  * @brief  获取均值
+  * @param  a: 统计量
+  * @retval 均值，Q16
+  */
+int32_t Aggregate_GetMean(const Aggregate_t *a);
+
+/**
+  * @brief  获取样本方差
+  * @param  a: 统计量
+  * @retval 方差（除以n-1），Q16；少于两个采样时为0
+  */
+uint64_t Aggregate_GetVariance(const Aggregate_t *a);
+
+/**
+  * @brief  在当前窗口中累计一次采样
+  * @param  values: 各通道的定点数值
+  * @param  now_ms: 采样时刻(ms)
+  * @param  epoch: 采样时的Unix时间(s)，未同步时为0
+  * @retval 无
+  */
+void Aggregate_Add(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms, uint32_t epoch);
+
+/**
+  * @brief  结束当前窗口，并入待上传窗口
+  * @param  now_ms: 当前时刻(ms)
+  * @retval 待上传窗口，没有采样时为NULL
+  */
+const AggregateWindow_t *Aggregate_Close(uint32_t now_ms);
+
+/**
+  * @brief  待上传窗口已送达，清空
+  * @param  无
+  * @retval 无
+  */
+void Aggregate_Clear(void);
+
+#endif /* __AGGREGATE_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
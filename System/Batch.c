@@ -0,0 +1,463 @@
+/**
+  ******************************************************************************
+  * @file    Batch.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   批量上传的采样队列与压缩编码实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Batch.h"
+#include "Config/config.h"
+#include <stddef.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define BATCH_HEADER_MAX        17          // 头部和第一个采样的最大字节数
+
+/* 私有类型 ------------------------------------------------------------------*/
+/**
+  * @brief  编码输出，按位写出时不足一字节的部分暂存在acc中
+  */
+typedef struct {
+    uint8_t *buf;
+    int size;
+    int pos;
+    uint16_t acc;
+    uint8_t bits;
+} BatchWriter_t;
+
+/**
+  * @brief  解码输入，err置位后读出的值均为0
+  */
+typedef struct {
+    const uint8_t *buf;
+    int len;
+    int pos;
+    uint8_t bit;                            // 当前字节已读的位数
+    uint8_t err;
+} BatchReader_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static BatchSample_t queue[BATCH_QUEUE_COUNT];
+static uint16_t head = 0;                   // 最旧的采样
+static uint16_t count = 0;
+static BatchStats_t stats;
+static uint16_t encode_index;               // Batch_Encode下一个取出的队列位置
+static uint8_t gap = 0;                     // 有尚未补传的缺口
+static uint32_t gap_first, gap_last;        // 缺口中最早和最晚的采样时刻
+
+static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  写出一个字节，调用前已确认空间足够
+  */
+static void Batch_PutByte(BatchWriter_t *w, uint8_t byte)
+{
+    w->buf[w->pos++] = byte;
+}
+
+/**
+  * @brief  写出varint
+  */
+static void Batch_PutVarint(BatchWriter_t *w, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        Batch_PutByte(w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    Batch_PutByte(w, (uint8_t)value);
+}
+
+/**
+  * @brief  按位写出，高位在前
+  * @param  w: 编码输出
+  * @param  value: 数据，取低n位
+  * @param  n: 位数，不超过32
+  */
+static void Batch_PutBits(BatchWriter_t *w, uint32_t value, uint8_t n)
+{
+    while (n > 0)
+    {
+        uint8_t take = n > 8 ? 8 : n;
+
+        n -= take;
+        w->acc = (uint16_t)((w->acc << take) | ((value >> n) & ((1U << take) - 1)));
+        w->bits += take;
+        if (w->bits >= 8)
+        {
+            w->bits -= 8;
+            Batch_PutByte(w, (uint8_t)(w->acc >> w->bits));
+        }
+    }
+}
+
+/**
+  * @brief  写出一个差值
+  * @param  w: 编码输出
+  * @param  d: 差值
+  * @param  flags: BATCH_FLAG_*
+  */
+static void Batch_PutDelta(BatchWriter_t *w, int32_t d, uint8_t flags)
+{
+    uint32_t z = ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+
+    if (!(flags & BATCH_FLAG_BITPACK))
+        Batch_PutVarint(w, z);
+    else if (z == 0)
+        Batch_PutBits(w, 0x0, 1);
+    else if (z <= 4)
+        Batch_PutBits(w, (0x2UL << 2) | (z - 1), 4);
+    else if (z <= 68)
+        Batch_PutBits(w, (0x6UL << 6) | (z - 5), 9);
+    else if (z <= 4164)
+        Batch_PutBits(w, (0xEUL << 12) | (z - 69), 16);
+    else
+    {
+        Batch_PutBits(w, 0xF, 4);
+        Batch_PutBits(w, z, 32);
+    }
+}
+
+/**
+  * @brief  读入一个字节，数据不足时置err
+  */
+static uint8_t Batch_GetByte(BatchReader_t *r)
+{
+    if (r->pos >= r->len)
+    {
+        r->err = 1;
+        return 0;
+    }
+    return r->buf[r->pos++];
+}
+
+/**
+  * @brief  读入varint
+  */
+static uint32_t Batch_GetVarint(BatchReader_t *r)
+{
+    uint32_t value = 0;
+    uint8_t shift, byte;
+
+    for (shift = 0; shift < 35; shift += 7)
+    {
+        byte = Batch_GetByte(r);
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    r->err = 1;
+    return 0;
+}
+
+/**
+  * @brief  按位读入，高位在前
+  */
+static uint32_t Batch_GetBits(BatchReader_t *r, uint8_t n)
+{
+    uint32_t value = 0;
+
+    while (n--)
+    {
+        if (r->pos >= r->len)
+        {
+            r->err = 1;
+            return 0;
+        }
+        value = (value << 1) | ((r->buf[r->pos] >> (7 - r->bit)) & 1);
+        if (++r->bit == 8)
+        {
+            r->bit = 0;
+            r->pos++;
+        }
+    }
+    return value;
+}
+
+/**
+  * @brief  读入一个差值
+  */
+static int32_t Batch_GetDelta(BatchReader_t *r, uint8_t flags)
+{
+    uint32_t z;
+
+    if (!(flags & BATCH_FLAG_BITPACK))
+        z = Batch_GetVarint(r);
+    else if (Batch_GetBits(r, 1) == 0)
+        z = 0;
+    else if (Batch_GetBits(r, 1) == 0)
+        z = Batch_GetBits(r, 2) + 1;
+    else if (Batch_GetBits(r, 1) == 0)
+        z = Batch_GetBits(r, 6) + 5;
+    else if (Batch_GetBits(r, 1) == 0)
+        z = Batch_GetBits(r, 12) + 69;
+    else
+        z = Batch_GetBits(r, 32);
+
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+/**
+  * @brief  把一个采样放入队列
+  * @param  ts: Unix时间(s)，未同步时为0
+  * @param  values: 温度(0.1℃)、湿度(0.1%)、光照值
+  * @retval 无
+  */
+void Batch_Add(uint32_t ts, const int16_t values[ALARM_CH_COUNT])
+{
+    BatchSample_t *s;
+    int ch;
+
+    if (count == BATCH_QUEUE_COUNT)
+    {
+        if (queue[head].ts != 0)
+        {
+            if (!gap)
+                gap_first = queue[head].ts;
+            gap_last = queue[head].ts;
+            gap = 1;
+        }
+        if (++head == BATCH_QUEUE_COUNT)
+            head = 0;
+        count--;
+        stats.dropped++;
+    }
+
+    s = &queue[(head + count) % BATCH_QUEUE_COUNT];
+    s->ts = ts;
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        s->value[ch] = values[ch];
+    count++;
+    stats.queued++;
+}
+
+/**
+  * @brief  获取队列中的采样数
+  * @param  无
+  * @retval 采样数
+  */
+uint16_t Batch_GetCount(void)
+{
+    return count;
+}
+
+/**
+  * @brief  读取队列中的采样
+  * @param  index: 0为最旧的采样
+  * @param  sample: 存放采样
+  * @retval 1:成功 0:超出队列长度
+  */
+uint8_t Batch_Peek(uint16_t index, BatchSample_t *sample)
+{
+    if (index >= count)
+        return 0;
+    *sample = queue[(head + index) % BATCH_QUEUE_COUNT];
+    return 1;
+}
+
+/**
+  * @brief  按顺序取出队列中的采样
+  */
+static uint8_t Batch_NextQueued(BatchSample_t *sample)
+{
+    return Batch_Peek(encode_index++, sample);
+}
+
+/**
+  * @brief  从最旧的采样起编码，直到队列取完或空间不足
+  * @param  out: 输出缓冲区
+  * @param  size: 缓冲区大小
+  * @param  flags: BATCH_FLAG_*
+  * @param  n: 存放编码的采样数
+  * @retval 编码后的字节数，队列为空或空间不足时为0
+  */
+int Batch_Encode(uint8_t *out, int size, uint8_t flags, uint16_t *n)
+{
+    encode_index = 0;
+    return Batch_EncodeFrom(Batch_NextQueued, out, size, flags, n);
+}
+
+/**
+  * @brief  编码调用者提供的采样
+  * @param  source: 按时间顺序取出采样，空间不足时不再调用
+  * @param  out: 输出缓冲区
+  * @param  size: 缓冲区大小
+  * @param  flags: BATCH_FLAG_*
+  * @param  n: 存放编码的采样数
+  * @retval 编码后的字节数，没有采样或空间不足时为0
+  */
+int Batch_EncodeFrom(BatchSource_t source, uint8_t *out, int size, uint8_t flags, uint16_t *n)
+{
+    BatchWriter_t w = { out, size, 0, 0, 0 };
+    BatchSample_t prev, s;
+    int32_t prev_delta = 0;
+    uint16_t i;
+    int ch;
+
+    *n = 0;
+    if (size < BATCH_HEADER_MAX || !source(&prev))
+        return 0;
+
+    Batch_PutByte(&w, (uint8_t)((BATCH_VERSION << 4) | flags));
+    Batch_PutByte(&w, 0);                   // 采样数最后填写
+    Batch_PutByte(&w, 0);
+    Batch_PutVarint(&w, prev.ts);
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        Batch_PutVarint(&w, ((uint32_t)prev.value[ch] << 1) ^ (uint32_t)(prev.value[ch] >> 15));
+
+    /* 预留一个采样的最大长度，放不下时其余采样留到下一次 */
+    for (i = 1; i < 0xFFFF && w.size - w.pos >= BATCH_SAMPLE_MAX && source(&s); i++)
+    {
+        int32_t delta = (int32_t)(s.ts - prev.ts);
+
+        Batch_PutDelta(&w, (int32_t)((uint32_t)delta - (uint32_t)prev_delta), flags);
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            Batch_PutDelta(&w, (int32_t)s.value[ch] - prev.value[ch], flags);
+        prev = s;
+        prev_delta = delta;
+    }
+    if (w.bits > 0)
+        Batch_PutByte(&w, (uint8_t)(w.acc << (8 - w.bits)));
+
+    out[1] = (uint8_t)i;
+    out[2] = (uint8_t)(i >> 8);
+    *n = i;
+    return w.pos;
+}
+
+/**
+  * @brief  移除已送达的采样
+  * @param  n: Batch_Encode给出的采样数
+  * @param  bytes: 编码后的字节数，计入统计
+  * @retval 无
+  */
+void Batch_Remove(uint16_t n, int bytes)
+{
+    if (n > count)
+        n = count;
+    head = (uint16_t)((head + n) % BATCH_QUEUE_COUNT);
+    count -= n;
+    stats.sent += n;
+    stats.sent_bytes += bytes;
+}
+
+/**
+  * @brief  获取队列满时丢弃的时段
+  * @param  first: 存放最早丢弃的采样时刻(Unix时间，s)，可为NULL
+  * @param  last: 存放最晚丢弃的采样时刻，可为NULL
+  * @retval 1:有尚未补传的缺口 0:没有
+  */
+uint8_t Batch_GetGap(uint32_t *first, uint32_t *last)
+{
+    if (first != NULL)
+        *first = gap_first;
+    if (last != NULL)
+        *last = gap_last;
+    return gap;
+}
+
+/**
+  * @brief  补传送达后缩小缺口
+  * @param  until: 已补传到的时刻，晚于缺口终点时缺口清除
+  * @param  n: 补传的采样数，计入统计
+  * @retval 无
+  */
+void Batch_CloseGap(uint32_t until, uint16_t n)
+{
+    stats.backfilled += n;
+    if (!gap)
+        return;
+    if ((int32_t)(until - gap_last) > 0)
+        gap = 0;
+    else if ((int32_t)(until - gap_first) > 0)
+        gap_first = until;
+}
+
+/**
+  * @brief  解码一段批量数据（服务器端参考实现）
+  * @param  data: Batch_Encode的输出
+  * @param  len: 字节数
+  * @param  out: 存放解码的采样
+  * @param  max: out的容量
+  * @retval 采样数，格式错误、数据截断或超出容量时为-1
+  */
+int Batch_Decode(const uint8_t *data, int len, BatchSample_t *out, int max)
+{
+    BatchReader_t r = { data, len, 0, 0, 0 };
+    uint8_t flags;
+    int32_t delta = 0;
+    int n, i, ch;
+
+    if (len < 3 || (data[0] >> 4) != BATCH_VERSION)
+        return -1;
+    flags = data[0] & 0x0F;
+    n = data[1] | (data[2] << 8);
+    if (n == 0 || n > max)
+        return -1;
+    r.pos = 3;
+
+    out[0].ts = Batch_GetVarint(&r);
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        uint32_t z = Batch_GetVarint(&r);
+        out[0].value[ch] = (int16_t)((int32_t)(z >> 1) ^ -(int32_t)(z & 1));
+    }
+
+    for (i = 1; i < n && !r.err; i++)
+    {
+        delta = (int32_t)((uint32_t)delta + (uint32_t)Batch_GetDelta(&r, flags));
+        out[i].ts = out[i - 1].ts + (uint32_t)delta;
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            out[i].value[ch] = (int16_t)(out[i - 1].value[ch] + Batch_GetDelta(&r, flags));
+    }
+
+    return r.err ? -1 : n;
+}
+
+/**
+  * @brief  base64编码
+  * @param  out: 输出缓冲区，以'\0'结尾
+  * @param  size: 缓冲区大小
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @retval 字符数，空间不足时为-1
+  */
+int Batch_Base64(char *out, int size, const uint8_t *data, int len)
+{
+    int i, n = 0;
+
+    if ((len + 2) / 3 * 4 >= size)
+        return -1;
+
+    for (i = 0; i < len; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+
+        if (i + 1 < len)
+            v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        out[n++] = base64[(v >> 18) & 0x3F];
+        out[n++] = base64[(v >> 12) & 0x3F];
+        out[n++] = i + 1 < len ? base64[(v >> 6) & 0x3F] : '=';
+        out[n++] = i + 2 < len ? base64[v & 0x3F] : '=';
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/**
+  * @brief  获取批量上传统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const BatchStats_t *Batch_GetStats(void)
+{
+    return &stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,180 @@
+/**
+  ******************************************************************************
+  * @file    Batch.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   批量上传的采样队列与压缩编码头文件
+  * @note    批量上传模式下每个采样先进入队列，上传时把队列中的采样压缩成
+  *          一段二进制数据，经base64放进上传JSON的"batch"字段；上传成功后
+  *          才从队列中移除，失败时留待下一次上传。队列满时丢弃最旧的采样，
+  *          丢弃的时段记为缺口，由应用按历史数据的汇总格补传（Batch_EncodeFrom）。
+  *
+  *          相邻采样高度相关：时间戳按固定周期递增，温湿度多数时候不变或只差
+  *          0.1。编码时时间戳取二阶差分（本次间隔减上次间隔），各通道取与
+  *          上一个采样之差，差值经zigzag映射为无符号数（0,-1,1,-2...→0,1,2,3...）
+  *          后用varint或前缀码写出，稳定时每个采样约半个字节。
+  *
+  *          格式（多字节整数均为小端）：
+  *            字节0      高4位为格式版本BATCH_VERSION，低4位为BATCH_FLAG_*
+  *            字节1~2    采样数n
+  *            varint     第一个采样的时间戳（Unix时间，s，未同步时为0）
+  *            zvarint x3 第一个采样的温度(0.1℃)、湿度(0.1%)、光照值
+  *            其后n-1个采样，每个依次为时间戳的二阶差分和三个通道的差值，
+  *            第二个采样的二阶差分即它与第一个采样的间隔
+  *
+  *          varint每字节低7位为数据、最高位为1表示后面还有字节；zvarint为
+  *          zigzag映射后的varint。没有BATCH_FLAG_BITPACK时差值均为zvarint；
+  *          有时改为按位写出（高位在前，末字节补0），zigzag后的值z编码为：
+  *            0                 z = 0
+  *            10   + 2位        z = 1~4，存z-1
+  *            110  + 6位        z = 5~68，存z-5
+  *            1110 + 12位       z = 69~4164，存z-69
+  *            1111 + 32位       其余
+  *
+  *          Batch_Decode为服务器端的参考实现，固件不调用，链接时被去除
+  ******************************************************************************
+  */
+
+#ifndef __BATCH_H
+#define __BATCH_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define BATCH_VERSION           1
+#define BATCH_FLAG_BITPACK      0x01        // 差值按位写出
+#define BATCH_SAMPLE_MAX        20          // 一个采样编码后的最大字节数
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  一个采样
+  */
+typedef struct {
+    uint32_t ts;                // Unix时间(s)，未同步时为0
+    int16_t  value[ALARM_CH_COUNT];     // 温度(0.1℃)、湿度(0.1%)、光照值
+} BatchSample_t;
+
+/**
+  * @brief  批量上传统计
+  */
+typedef struct {
+    uint32_t queued;            // 进入队列的采样
+    uint32_t dropped;           // 队列满时丢弃的采样
+    uint32_t sent;              // 已送达的采样
+    uint32_t sent_bytes;        // 已送达采样编码后的字节数
+    uint32_t backfilled;        // 按汇总格补传的采样
+} BatchStats_t;
+
+/**
+  * @brief  编码时逐个取出采样
+  * @param  sample: 存放取出的采样
+  * @retval 1:取出一个 0:没有更多采样
+  */
+typedef uint8_t (*BatchSource_t)(BatchSample_t *sample);
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  把一个采样放入队列
+  * @param  ts: Unix时间(s)，未同步时为0
+  * @param  values: 温度(0.1℃)、湿度(0.1%)、光照值
+  * @retval 无
+  * @note   队列满时丢弃最旧的采样
+  */
+void Batch_Add(uint32_t ts, const int16_t values[ALARM_CH_COUNT]);
+
+/**
+  * @brief  获取队列中的采样数
+  * @param  无
+  * @retval 采样数
+  */
+uint16_t Batch_GetCount(void);
+
+/**
+  * @brief  从最旧的采样起编码，直到队列取完或空间不足
+  * @param  out: 输出缓冲区
+  * @param  size: 缓冲区大小，至少能放下头部和一个采样
+  * @param  flags: BATCH_FLAG_*
+  * @param  n: 存放编码的采样数
+  * @retval 编码后的字节数，队列为空或空间不足时为0
+  * @note   采样仍留在队列中，送达后调用Batch_Remove
+  */
+int Batch_Encode(uint8_t *out, int size, uint8_t flags, uint16_t *n);
+
+/**
+  * @brief  读取队列中的采样
+  * @param  index: 0为最旧的采样
+  * @param  sample: 存放采样
+  * @retval 1:成功 0:超出队列长度
+  * @note   仿真器核对服务器解出的批量数据时使用，固件不调用
+  */
+uint8_t Batch_Peek(uint16_t index, BatchSample_t *sample);
+
+/**
+  * @brief  编码调用者提供的采样，格式与Batch_Encode相同
+  * @param  source: 按时间顺序取出采样，空间不足时不再调用
+  * @param  out: 输出缓冲区
+  * @param  size: 缓冲区大小
+  * @param  flags: BATCH_FLAG_*
+  * @param  n: 存放编码的采样数
+  * @retval 编码后的字节数，没有采样或空间不足时为0
+  */
+int Batch_EncodeFrom(BatchSource_t source, uint8_t *out, int size, uint8_t flags, uint16_t *n);
+
+/**
+  * @brief  移除已送达的采样
+  * @param  n: Batch_Encode给出的采样数
+  * @param  bytes: 编码后的字节数，计入统计
+  * @retval 无
+  */
+void Batch_Remove(uint16_t n, int bytes);
+
+/**
+  * @brief  获取队列满时丢弃的时段
+  * @param  first: 存放最早丢弃的采样时刻(Unix时间，s)，可为NULL
+  * @param  last: 存放最晚丢弃的采样时刻，可为NULL
+  * @retval 1:有尚未补传的缺口 0:没有
+  * @note   未同步时的采样没有时间戳，丢弃时不记入缺口
+  */
+uint8_t Batch_GetGap(uint32_t *first, uint32_t *last);
+
+/**
+  * @brief  补传送达后缩小缺口
+  * @param  until: 已补传到的时刻，晚于缺口终点时缺口清除
+  * @param  n: 补传的采样数，计入统计
+  * @retval 无
+  */
+void Batch_CloseGap(uint32_t until, uint16_t n);
+
+/**
+  * @brief  解码一段批量数据（服务器端参考实现）
+  * @param  data: Batch_Encode的输出
+  * @param  len: 字节数
+  * @param  out: 存放解码的采样
+  * @param  max: out的容量
+  * @retval 采样数，格式错误、数据截断或超出容量时为-1
+  */
+int Batch_Decode(const uint8_t *data, int len, BatchSample_t *out, int max);
+
+/**
+  * @brief  base64编码
+  * @param  out: 输出缓冲区，以'\0'结尾
+  * @param  size: 缓冲区大小
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @retval 字符数，空间不足时为-1
+  */
+int Batch_Base64(char *out, int size, const uint8_t *data, int len);
+
+/**
+  * @brief  获取批量上传统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const BatchStats_t *Batch_GetStats(void);
+
+#endif /* __BATCH_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    Boot.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   分阶段启动计时实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Boot.h"
+#include "Tick.h"
+#include "Trace.h"
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint32_t stage_ms[BOOT_STAGE_COUNT] = {
+    BOOT_NOT_REACHED, BOOT_NOT_REACHED, BOOT_NOT_REACHED, BOOT_NOT_REACHED,
+    BOOT_NOT_REACHED, BOOT_NOT_REACHED, BOOT_NOT_REACHED
+};
+
+static const char *const stage_names[BOOT_STAGE_COUNT] = {
+    "core", "sensors", "display", "init", "sample", "rtc", "network"
+};
+
+/**
+  * @brief  记录一个阶段完成
+  * @param  stage: 阶段
+  * @retval 无
+  */
+void Boot_Mark(BootStage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT || stage_ms[stage] != BOOT_NOT_REACHED)
+        return;
+    stage_ms[stage] = Tick_GetMs();
+    Trace_BootStage((uint8_t)stage);
+}
+
+/**
+  * @brief  获取阶段完成的时刻
+  * @param  stage: 阶段
+  * @retval 毫秒数，未完成时为BOOT_NOT_REACHED
+  */
+uint32_t Boot_GetStageMs(BootStage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT)
+        return BOOT_NOT_REACHED;
+    return stage_ms[stage];
+}
+
+/**
+  * @brief  获取阶段名称
+  * @param  stage: 阶段
+  * @retval 名称字符串
+  */
+const char *Boot_GetStageName(BootStage_t stage)
+{
+    if (stage >= BOOT_STAGE_COUNT)
+        return "?";
+    return stage_names[stage];
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
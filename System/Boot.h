@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    Boot.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   分阶段启动计时头文件
+  * @note    启动按阶段进行：先初始化时基和传感器，再初始化显示，随后进入主循环
+  *          开始采样；RTC（LSE起振约1s）和网络（入网数秒）在后台完成，不阻塞
+  *          第一次采样。各阶段第一次完成的时刻（自Tick_Init起的毫秒数）记录
+  *          下来，同时经采集轨迹输出，用于跟踪上电到第一个数据的耗时
+  ******************************************************************************
+  */
+
+#ifndef __BOOT_H
+#define __BOOT_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define BOOT_NOT_REACHED    0xFFFFFFFFUL    // 阶段尚未完成
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  启动阶段
+  */
+typedef enum {
+    BOOT_STAGE_CORE = 0,        // 时钟、时基、看门狗和轨迹输出
+    BOOT_STAGE_SENSORS,         // ADC和滤波器就绪
+    BOOT_STAGE_DISPLAY,         // OLED完成初始化
+    BOOT_STAGE_INIT,            // App_Init返回
+    BOOT_STAGE_FIRST_SAMPLE,    // 第一个数据显示在OLED上
+    BOOT_STAGE_RTC,             // RTC开始计数，此后才能进入Stop
+    BOOT_STAGE_NETWORK,         // 第一次上传成功
+    BOOT_STAGE_COUNT
+} BootStage_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  记录一个阶段完成
+  * @param  stage: 阶段
+  * @retval 无
+  * @note   只记录第一次，之后的调用直接返回
+  */
+void Boot_Mark(BootStage_t stage);
+
+/**
+  * @brief  获取阶段完成的时刻
+  * @param  stage: 阶段
+  * @retval 自Tick_Init起的毫秒数，未完成时为BOOT_NOT_REACHED
+  */
+uint32_t Boot_GetStageMs(BootStage_t stage);
+
+/**
+  * @brief  获取阶段名称
+  * @param  stage: 阶段
+  * @retval 名称字符串
+  */
+const char *Boot_GetStageName(BootStage_t stage);
+
+#endif /* __BOOT_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
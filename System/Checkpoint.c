@@ -0,0 +1,177 @@
+/**
+  ******************************************************************************
+  * @file    Checkpoint.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   滤波状态保存与恢复实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Checkpoint.h"
+#include "Tick.h"
+#include "Idle.h"
+#include "DHT11.h"
+#include "light.h"
+#include "Settings.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+/* 备份寄存器布局，DR1~DR3由Watchdog使用，DR10由TimeSync使用 */
+#define CHECKPOINT_BKP_TEMP     BKP_DR4     // 温度估计值，0.01℃，有符号
+#define CHECKPOINT_BKP_HUMI     BKP_DR5     // 湿度估计值，0.01%
+#define CHECKPOINT_BKP_LIGHT    BKP_DR6     // 光照估计值，0.1
+#define CHECKPOINT_BKP_P_TH     BKP_DR7     // 高字节温度P，低字节湿度P
+#define CHECKPOINT_BKP_P_LC     BKP_DR8     // 高字节光照P，低字节校验
+#define CHECKPOINT_BKP_STAMP    BKP_DR9     // 保存时的RTC秒数低16位
+
+#define CHECKPOINT_P_SCALE      256.0       // P按1/256量化，收敛后约0.13~0.31
+#define CHECKPOINT_CHECK_SEED   0xC5        // 备份域清零后校验不通过
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint32_t last_save_ms = 0;
+static int32_t restored_age = -1;
+
+/**
+  * @brief  量化协方差
+  * @param  P: 估计误差协方差
+  * @retval 0~255
+  */
+static uint8_t Checkpoint_PackP(double P)
+{
+    double q = P * CHECKPOINT_P_SCALE + 0.5;
+
+    return q >= 255.0 ? 255 : (uint8_t)q;
+}
+
+/**
+  * @brief  计算校验
+  * @param  regs: DR4~DR9的值，DR8的低字节不参与
+  * @retval 校验字节
+  * @note   六个寄存器不能一次写完，保存中途复位时校验不通过
+  */
+static uint8_t Checkpoint_Check(const uint16_t regs[6])
+{
+    uint8_t c = CHECKPOINT_CHECK_SEED;
+    uint8_t i;
+
+    for (i = 0; i < 6; i++)
+    {
+        uint16_t v = (i == 4) ? (regs[i] & 0xFF00) : regs[i];
+        c = (uint8_t)((c << 1) | (c >> 7)) ^ (uint8_t)(v >> 8) ^ (uint8_t)v;
+    }
+    return c;
+}
+
+/**
+  * @brief  恢复复位前保存的滤波状态
+  * @param  无
+  * @retval 1:已恢复 0:没有可用的状态
+  */
+uint8_t Checkpoint_Restore(void)
+{
+    uint16_t regs[6];
+    uint32_t now_s, age, steps;
+
+    restored_age = -1;
+    if (!CHECKPOINT_ENABLE || !Idle_GetRtcSeconds(&now_s))
+        return 0;
+
+    regs[0] = BKP_ReadBackupRegister(CHECKPOINT_BKP_TEMP);
+    regs[1] = BKP_ReadBackupRegister(CHECKPOINT_BKP_HUMI);
+    regs[2] = BKP_ReadBackupRegister(CHECKPOINT_BKP_LIGHT);
+    regs[3] = BKP_ReadBackupRegister(CHECKPOINT_BKP_P_TH);
+    regs[4] = BKP_ReadBackupRegister(CHECKPOINT_BKP_P_LC);
+    regs[5] = BKP_ReadBackupRegister(CHECKPOINT_BKP_STAMP);
+    if ((regs[4] & 0xFF) != Checkpoint_Check(regs))
+        return 0;
+
+    /* 只存了低16位，按回绕差值计算；RTC计数回绕时差值异常大，不恢复 */
+    age = (uint16_t)(now_s - regs[5]);
+    if (age > CHECKPOINT_MAX_AGE_S)
+        return 0;
+
+    steps = age * 1000 / Settings_Get()->sample_period_ms;
+    DHT_Filter_Restore((int16_t)regs[0] / 100.0, (regs[3] >> 8) / CHECKPOINT_P_SCALE,
+                       regs[1] / 100.0, (regs[3] & 0xFF) / CHECKPOINT_P_SCALE, steps);
+    Light_Filter_Restore(regs[2] / 10.0, (regs[4] >> 8) / CHECKPOINT_P_SCALE, steps);
+    restored_age = (int32_t)age;
+    return 1;
+}
+
+/**
+  * @brief  到期时保存滤波状态
+  * @param  无
+  * @retval 无
+  * @note   DHT11还没有读到过数据时滤波器里是默认值，不保存
+  */
+void Checkpoint_Poll(void)
+{
+    KalmanFilter_t temp, humi, light;
+    uint16_t regs[6];
+    uint32_t now_s;
+
+    if (!CHECKPOINT_ENABLE || Tick_ElapsedMs(last_save_ms) < CHECKPOINT_PERIOD_MS)
+        return;
+    last_save_ms = Tick_GetMs();
+
+    if (!DHT_Filter_GetState(&temp, &humi) || !Idle_GetRtcSeconds(&now_s))
+        return;
+    Light_Filter_GetState(&light);
+
+    regs[0] = (uint16_t)(int16_t)(temp.x * 100.0 + (temp.x >= 0 ? 0.5 : -0.5));
+    regs[1] = (uint16_t)(humi.x * 100.0 + 0.5);
+    regs[2] = (uint16_t)(light.x * 10.0 + 0.5);
+    regs[3] = (uint16_t)(Checkpoint_PackP(temp.P) << 8) | Checkpoint_PackP(humi.P);
+    regs[4] = (uint16_t)(Checkpoint_PackP(light.P) << 8);
+    regs[5] = (uint16_t)now_s;
+    regs[4] |= Checkpoint_Check(regs);
+
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_TEMP, regs[0]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_HUMI, regs[1]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_LIGHT, regs[2]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_P_TH, regs[3]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_STAMP, regs[5]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_P_LC, regs[4]);
+}
+
+/**
+  * @brief  RTC计数被改写后平移保存时刻
+  * @param  seconds: 计数折算的秒数的变化量
+  * @retval 无
+  * @note   只存了低16位，按回绕加法平移；没有有效状态时不写
+  */
+void Checkpoint_Shift(int32_t seconds)
+{
+    uint16_t regs[6];
+
+    if (!CHECKPOINT_ENABLE || (uint16_t)seconds == 0)
+        return;
+
+    regs[0] = BKP_ReadBackupRegister(CHECKPOINT_BKP_TEMP);
+    regs[1] = BKP_ReadBackupRegister(CHECKPOINT_BKP_HUMI);
+    regs[2] = BKP_ReadBackupRegister(CHECKPOINT_BKP_LIGHT);
+    regs[3] = BKP_ReadBackupRegister(CHECKPOINT_BKP_P_TH);
+    regs[4] = BKP_ReadBackupRegister(CHECKPOINT_BKP_P_LC);
+    regs[5] = BKP_ReadBackupRegister(CHECKPOINT_BKP_STAMP);
+    if ((regs[4] & 0xFF) != Checkpoint_Check(regs))
+        return;
+
+    regs[5] = (uint16_t)(regs[5] + seconds);
+    regs[4] = (regs[4] & 0xFF00) | Checkpoint_Check(regs);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_STAMP, regs[5]);
+    BKP_WriteBackupRegister(CHECKPOINT_BKP_P_LC, regs[4]);
+}
+
+/**
+  * @brief  获取启动时恢复的状态的时长
+  * @param  无
+  * @retval 秒数，未恢复时为-1
+  */
+int32_t Checkpoint_GetRestoredAge(void)
+{
+    return restored_age;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file    Checkpoint.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   滤波状态保存与恢复头文件
+  * @note    温度、湿度、光照三个卡尔曼滤波器的估计值和协方差每
+  *          CHECKPOINT_PERIOD_MS存入备份寄存器DR4~DR9，看门狗复位、复位引脚
+  *          或带VBAT电池的掉电后，启动时若保存时刻距今不超过
+  *          CHECKPOINT_MAX_AGE_S就恢复，第一次采样即使用已收敛的滤波器。
+  *          新旧按RTC计数判断，RTC未启用时不恢复
+  ******************************************************************************
+  */
+
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  恢复复位前保存的滤波状态
+  * @param  无
+  * @retval 1:已恢复 0:没有可用的状态，须按原方式初始化DHT11滤波器
+  * @note   须在Idle_Init和Light_Init之后调用
+  */
+uint8_t Checkpoint_Restore(void);
+
+/**
+  * @brief  到期时保存滤波状态，在主循环中调用
+  * @param  无
+  * @retval 无
+  */
+void Checkpoint_Poll(void);
+
+/**
+  * @brief  获取启动时恢复的状态的时长
+  * @param  无
+  * @retval 秒数，未恢复时为-1
+  */
+int32_t Checkpoint_GetRestoredAge(void);
+
+/**
+  * @brief  RTC计数被改写后平移保存时刻
+  * @param  seconds: 计数折算的秒数的变化量
+  * @retval 无
+  * @note   时间同步校正RTC时调用，保存的状态不因校正变旧或变新
+  */
+void Checkpoint_Shift(int32_t seconds);
+
+#endif /* __CHECKPOINT_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
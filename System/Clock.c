@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @file    Clock.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   系统时钟档位管理实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Clock.h"
+#include "Tick.h"
+#include "Trace.h"
+#include "Prof.h"
+#include "ESP8266.h"
+#include "Buzzer.h"
+#include "Config/config.h"
+#include <string.h>
+
+/* 私有类型 ------------------------------------------------------------------*/
+/**
+  * @brief  档位的时钟树配置
+  */
+typedef struct {
+    uint8_t  use_pll;           // 0:HSE直接作系统时钟
+    uint32_t pll_source;        // PLL输入
+    uint32_t apb1_div;          // APB1不能超过36MHz
+    uint32_t latency;           // Flash等待周期：<=24MHz为0，<=48MHz为1，否则为2
+    uint8_t  mhz;               // 系统时钟
+} ClockConfig_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static const ClockConfig_t clock_configs[CLOCK_PROFILE_COUNT] = {
+    { 1, RCC_PLLSource_HSE_Div1, RCC_HCLK_Div2, FLASH_Latency_2, 72 },
+    { 1, RCC_PLLSource_HSE_Div2, RCC_HCLK_Div1, FLASH_Latency_1, 36 },
+    { 0, 0,                      RCC_HCLK_Div1, FLASH_Latency_0, 8  },
+};
+
+static ClockProfile_t current = CLOCK_PROFILE_FULL;
+static uint32_t flash_latency = FLASH_Latency_2;    // SystemInit的配置
+static uint32_t profile_since_ms = 0;               // 进入当前档位的时刻
+static ClockStats_t clock_stats;
+
+/**
+  * @brief  按实际时钟重新配置依赖时钟的外设
+  * @param  无
+  * @retval 无
+  */
+static void Clock_UpdatePeripherals(void)
+{
+    SystemCoreClockUpdate();
+    Tick_ClockUpdate();
+    Buzzer_ClockUpdate();
+    Serial_ClockUpdate();
+    Trace_ClockUpdate();
+    Prof_ClockUpdate();
+}
+
+/**
+  * @brief  把周期数换算为微秒
+  * @param  cycles: 周期数
+  * @param  hz: 这段时间内的系统时钟
+  * @retval 微秒数
+  */
+static uint32_t Clock_CyclesToUs(uint32_t cycles, uint32_t hz)
+{
+    return cycles / (hz / 1000000);
+}
+
+/**
+  * @brief  把时钟树切换到档位配置
+  * @param  profile: 目标档位
+  * @param  from_hz: 切换前的系统时钟，用于换算耗时
+  * @retval 无
+  * @note   先切到HSE、关闭PLL，再按需重新锁定PLL。每次系统时钟变化后立即
+  *          更新外设，锁定PLL的约200us内串口和时基按8MHz工作
+  */
+static void Clock_Apply(ClockProfile_t profile, uint32_t from_hz)
+{
+    const ClockConfig_t *cfg = &clock_configs[profile];
+    uint32_t t0, t1, t2, t3, us;
+
+    t0 = DWT_CYCCNT;
+
+    /* Stop醒来后HSE是关闭的；起振失败时留在HSI上，下次恢复时再试 */
+    RCC_HSEConfig(RCC_HSE_ON);
+    if (RCC_WaitForHSEStartUp() != SUCCESS)
+    {
+        clock_stats.hse_failures++;
+        Clock_UpdatePeripherals();
+        return;
+    }
+
+    /* 升频前先加Flash等待周期 */
+    if (cfg->latency > flash_latency)
+        FLASH_SetLatency(cfg->latency);
+
+    /* PLL作系统时钟时不能修改，先切到HSE */
+    RCC_SYSCLKConfig(RCC_SYSCLKSource_HSE);
+    while (RCC_GetSYSCLKSource() != 0x04);
+    t1 = DWT_CYCCNT;
+
+    RCC_PLLCmd(DISABLE);
+    RCC_HCLKConfig(RCC_SYSCLK_Div1);
+    RCC_PCLK2Config(RCC_HCLK_Div1);
+    RCC_PCLK1Config(cfg->apb1_div);
+    Clock_UpdatePeripherals();
+
+    if (cfg->use_pll)
+    {
+        RCC_PLLConfig(cfg->pll_source, RCC_PLLMul_9);
+        RCC_PLLCmd(ENABLE);
+        while (RCC_GetFlagStatus(RCC_FLAG_PLLRDY) == RESET);
+
+        RCC_SYSCLKConfig(RCC_SYSCLKSource_PLLCLK);
+        while (RCC_GetSYSCLKSource() != 0x08);
+    }
+    t2 = DWT_CYCCNT;
+
+    FLASH_SetLatency(cfg->latency);
+    flash_latency = cfg->latency;
+    if (cfg->use_pll)
+        Clock_UpdatePeripherals();
+    t3 = DWT_CYCCNT;
+
+    /* 三段分别运行在原时钟、HSE和新时钟上 */
+    us = Clock_CyclesToUs(t1 - t0, from_hz) + Clock_CyclesToUs(t2 - t1, HSE_VALUE) +
+         Clock_CyclesToUs(t3 - t2, (uint32_t)cfg->mhz * 1000000);
+    clock_stats.switches++;
+    clock_stats.last_us = us;
+    if (us > clock_stats.max_us)
+        clock_stats.max_us = us;
+}
+
+/**
+  * @brief  把当前档位的时长累计到统计中
+  * @param  无
+  * @retval 无
+  */
+static void Clock_Account(void)
+{
+    uint32_t now = Tick_GetMs();
+
+    clock_stats.time_ms[current] += now - profile_since_ms;
+    profile_since_ms = now;
+}
+
+/**
+  * @brief  初始化时钟管理
+  * @param  无
+  * @retval 无
+  */
+void Clock_Init(void)
+{
+    /* 切换耗时用DWT周期计数器测量，与Prof共用 */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    current = CLOCK_PROFILE_FULL;
+    flash_latency = FLASH_Latency_2;
+    memset(&clock_stats, 0, sizeof(clock_stats));
+    profile_since_ms = Tick_GetMs();
+    SystemCoreClockUpdate();
+}
+
+/**
+  * @brief  切换时钟档位
+  * @param  profile: 目标档位
+  * @retval 无
+  */
+void Clock_SetProfile(ClockProfile_t profile)
+{
+    uint32_t start = Tick_GetMs();
+
+    if (!CLOCK_SCALING_ENABLE || profile >= CLOCK_PROFILE_COUNT || profile == current)
+        return;
+
+    /* 切换期间到达的字节（模块主动上报、应答的尾部）会按错误的分频接收 */
+    while (USART1_GetIdleMs() < IDLE_RX_QUIET_MS)
+    {
+        if (Tick_ElapsedMs(start) >= CLOCK_RX_WAIT_MS)
+        {
+            clock_stats.rx_skips++;
+            return;
+        }
+        __WFI();                // 由1ms时基或接收中断唤醒
+    }
+
+    /* 正在移出的字节会因波特率变化而出错 */
+    while (USART_GetFlagStatus(USART1, USART_FLAG_TC) == RESET);
+    while (!Trace_IsIdle());
+
+    Clock_Account();
+    current = profile;
+    Clock_Apply(profile, SystemCoreClock);
+}
+
+/**
+  * @brief  获取当前时钟档位
+  * @param  无
+  * @retval 当前档位
+  */
+ClockProfile_t Clock_GetProfile(void)
+{
+    return current;
+}
+
+/**
+  * @brief  Stop醒来后恢复当前档位
+  * @param  无
+  * @retval 无
+  */
+void Clock_Restore(void)
+{
+    /* 先按HSI更新外设，HSE起振的约1ms内串口仍按正确的波特率接收 */
+    Clock_UpdatePeripherals();
+    Clock_Apply(current, HSI_VALUE);
+}
+
+/**
+  * @brief  获取定时器的计数时钟
+  * @param  TIMx: 定时器
+  * @retval 频率(Hz)
+  */
+uint32_t Clock_GetTimerClock(TIM_TypeDef *TIMx)
+{
+    RCC_ClocksTypeDef clocks;
+    uint32_t pclk;
+
+    RCC_GetClocksFreq(&clocks);
+    pclk = (TIMx == TIM1) ? clocks.PCLK2_Frequency : clocks.PCLK1_Frequency;
+    return (pclk == clocks.HCLK_Frequency) ? pclk : pclk * 2;
+}
+
+/**
+  * @brief  获取切换统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const ClockStats_t *Clock_GetStats(void)
+{
+    Clock_Account();
+    return &clock_stats;
+}
+
+/**
+  * @brief  获取档位的系统时钟频率
+  * @param  profile: 档位
+  * @retval 频率(MHz)
+  */
+uint8_t Clock_GetProfileMHz(ClockProfile_t profile)
+{
+    if (profile >= CLOCK_PROFILE_COUNT)
+        return 0;
+    return clock_configs[profile].mhz;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file    Clock.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   系统时钟档位管理头文件
+  * @note    三个档位：FULL 72MHz（HSE×9）用于OLED刷新、拼包上传等CPU密集的突发；
+  *          HALF 36MHz（HSE/2×9）用于DHT11位解码等需要微秒级轮询的采集；
+  *          LOW 8MHz（HSE直接作系统时钟，PLL关闭）用于采样间隙的等待
+  *
+  *          切换后按RCC_GetClocksFreq重新计算TIM2时基、TIM1节拍、USART1/USART3
+  *          波特率分频和Prof的折算系数，Delay按SystemCoreClock计算重装值。
+  *          切换前等待两个串口发送完毕；接收无法暂停，还要等ESP8266串口静默
+  *          IDLE_RX_QUIET_MS，CLOCK_RX_WAIT_MS内等不到时放弃本次切换，保持原档位。
+  *          PROF_BEGIN/PROF_END之间不要切换档位
+  ******************************************************************************
+  */
+
+#ifndef __CLOCK_H
+#define __CLOCK_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  时钟档位
+  */
+typedef enum {
+    CLOCK_PROFILE_FULL = 0,     // 72MHz，APB1 36MHz
+    CLOCK_PROFILE_HALF,         // 36MHz，APB1/APB2均不分频
+    CLOCK_PROFILE_LOW,          // 8MHz，PLL关闭
+    CLOCK_PROFILE_COUNT
+} ClockProfile_t;
+
+/**
+  * @brief  切换统计
+  */
+typedef struct {
+    uint32_t switches;                      // 切换次数（含Stop醒来后的恢复）
+    uint32_t last_us;                       // 最近一次切换耗时
+    uint32_t max_us;                        // 最长一次切换耗时
+    uint32_t hse_failures;                  // HSE起振超时、暂用HSI的次数
+    uint32_t rx_skips;                      // 串口一直在接收、放弃切换的次数
+    uint32_t time_ms[CLOCK_PROFILE_COUNT];  // 各档位累计时长
+} ClockStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化时钟管理
+  * @param  无
+  * @retval 无
+  * @note   须在其他模块之前调用；SystemInit已把时钟配置为72MHz，即FULL档
+  */
+void Clock_Init(void);
+
+/**
+  * @brief  切换时钟档位
+  * @param  profile: 目标档位
+  * @retval 无
+  * @note   与当前档位相同时立即返回；需要重新锁定PLL时耗时约200us。
+  *          ESP8266串口未静默时先等待，超过CLOCK_RX_WAIT_MS仍未静默则不切换
+  */
+void Clock_SetProfile(ClockProfile_t profile);
+
+/**
+  * @brief  获取当前时钟档位
+  * @param  无
+  * @retval 当前档位
+  */
+ClockProfile_t Clock_GetProfile(void);
+
+/**
+  * @brief  Stop醒来后恢复当前档位
+  * @param  无
+  * @retval 无
+  * @note   醒来时系统时钟为HSI 8MHz，HSE和PLL均已关闭，代替SystemInit调用
+  */
+void Clock_Restore(void);
+
+/**
+  * @brief  获取定时器的计数时钟
+  * @param  TIMx: 定时器，TIM1挂在APB2上，其余挂在APB1上
+  * @retval 频率(Hz)，APB分频不为1时为PCLK的2倍
+  */
+uint32_t Clock_GetTimerClock(TIM_TypeDef *TIMx);
+
+/**
+  * @brief  获取切换统计
+  * @param  无
+  * @retval 统计数据指针，各档位时长已累计到调用时刻
+  */
+const ClockStats_t *Clock_GetStats(void);
+
+/**
+  * @brief  获取档位的系统时钟频率
+  * @param  profile: 档位
+  * @retval 频率(MHz)
+  */
+uint8_t Clock_GetProfileMHz(ClockProfile_t profile);
+
+#endif /* __CLOCK_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -2,12 +2,12 @@
 
 /**
   * @brief  微秒级延时
-  * @param  xus 延时时长，范围：0~233015
+  * @param  xus 延时时长，范围：0~233015（72MHz时，主频越低范围越大）
   * @retval 无
   */
 void Delay_us(uint32_t xus)
 {
-	SysTick->LOAD = 72 * xus;				//设置定时器重装值
+	SysTick->LOAD = SystemCoreClock / 1000000 * xus;	//按当前主频设置定时器重装值
 	SysTick->VAL = 0x00;					//清空当前计数值
 	SysTick->CTRL = 0x00000005;				//设置时钟源为HCLK，启动定时器
 	while(!(SysTick->CTRL & 0x00010000));	//等待计数到0
@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file    Event.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   报警事件优先上报实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Event.h"
+#include "Config/config.h"
+#include <stddef.h>
+
+/* 私有变量 ------------------------------------------------------------------*/
+static EventRecord_t queue[EVENT_QUEUE_COUNT];
+static uint8_t head = 0;                    // 最早的事件
+static uint8_t count = 0;
+static uint16_t next_id = 1;
+
+static EventLatency_t latency[EVENT_REPORT_COUNT];
+static uint8_t latency_head = 0;
+static uint8_t latency_count = 0;
+
+static EventStats_t stats;
+
+/**
+  * @brief  记录报警状态变化
+  * @param  changed: Alarm_Evaluate返回的变化位
+  * @param  values: 本次判定的采样值
+  * @param  ts: 采样时的Unix时间(s)
+  * @param  sample_ms: 采样时刻(ms)
+  * @retval 无
+  */
+void Event_OnAlarm(uint8_t changed, const int16_t values[ALARM_CH_COUNT], uint32_t ts,
+                   uint32_t sample_ms)
+{
+    uint8_t active = Alarm_GetActiveMask();
+    uint8_t bit;
+
+    for (bit = 0; bit < ALARM_CH_COUNT * 2; bit++)
+    {
+        EventRecord_t *e;
+
+        if (!(changed & (1 << bit)))
+            continue;
+
+        if (count == EVENT_QUEUE_COUNT)
+        {
+            head = (uint8_t)((head + 1) % EVENT_QUEUE_COUNT);
+            count--;
+            stats.dropped++;
+        }
+        e = &queue[(head + count) % EVENT_QUEUE_COUNT];
+        e->ts = ts;
+        e->sample_ms = sample_ms;
+        e->id = next_id++;
+        e->bit = bit;
+        e->onset = (active >> bit) & 1;
+        e->value = values[bit / 2];
+        count++;
+        stats.raised++;
+    }
+}
+
+/**
+  * @brief  获取待发送的事件数
+  * @param  无
+  * @retval 事件数
+  */
+uint8_t Event_GetCount(void)
+{
+    return count;
+}
+
+/**
+  * @brief  读取待发送的事件
+  * @param  index: 0为最早的事件
+  * @retval 事件指针，超出范围时为NULL
+  */
+const EventRecord_t *Event_Get(uint8_t index)
+{
+    if (index >= count)
+        return NULL;
+    return &queue[(head + index) % EVENT_QUEUE_COUNT];
+}
+
+/**
+  * @brief  最早的若干个事件已收到应答
+  * @param  n: 随上一次上传发出的事件数
+  * @param  now_ms: 收到应答的时刻(ms)
+  * @retval 无
+  * @note   待回报的延迟已满时丢弃最早的一个
+  */
+void Event_OnAcked(uint8_t n, uint32_t now_ms)
+{
+    while (n-- > 0 && count > 0)
+    {
+        const EventRecord_t *e = &queue[head];
+        uint32_t ms = now_ms - e->sample_ms;
+        EventLatency_t *l;
+
+        if (latency_count == EVENT_REPORT_COUNT)
+        {
+            latency_head = (uint8_t)((latency_head + 1) % EVENT_REPORT_COUNT);
+            latency_count--;
+        }
+        l = &latency[(latency_head + latency_count) % EVENT_REPORT_COUNT];
+        l->id = e->id;
+        l->latency_ms = ms > 0xFFFF ? 0xFFFF : (uint16_t)ms;
+        latency_count++;
+
+        stats.acked++;
+        stats.last_ms = ms;
+        stats.total_ms += ms;
+        if (ms > stats.max_ms)
+            stats.max_ms = ms;
+
+        head = (uint8_t)((head + 1) % EVENT_QUEUE_COUNT);
+        count--;
+    }
+}
+
+/**
+  * @brief  获取待回报的延迟数
+  * @param  无
+  * @retval 个数
+  */
+uint8_t Event_GetLatencyCount(void)
+{
+    return latency_count;
+}
+
+/**
+  * @brief  读取待回报的延迟
+  * @param  index: 0为最早的一个
+  * @retval 延迟指针，超出范围时为NULL
+  */
+const EventLatency_t *Event_GetLatency(uint8_t index)
+{
+    if (index >= latency_count)
+        return NULL;
+    return &latency[(latency_head + index) % EVENT_REPORT_COUNT];
+}
+
+/**
+  * @brief  最早的若干个延迟已回报
+  * @param  n: 随上一次上传回报的个数
+  * @retval 无
+  */
+void Event_RemoveLatencies(uint8_t n)
+{
+    if (n > latency_count)
+        n = latency_count;
+    latency_head = (uint8_t)((latency_head + n) % EVENT_REPORT_COUNT);
+    latency_count -= n;
+}
+
+/**
+  * @brief  获取事件统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const EventStats_t *Event_GetStats(void)
+{
+    return &stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
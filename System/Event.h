@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    Event.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   报警事件优先上报头文件
+  * @note    报警位每次产生或解除记为一个事件，带事件编号、采样时的Unix时间和
+  *          触发的采样值，进入事件队列。队列非空时下一次上传立即进行，且只发送
+  *          事件，排在批量数据、窗口汇总和逐点数据之前；断路期间按报警提前
+  *          试探一次。服务器应答后事件出队，并记下从采样到收到应答的延迟，
+  *          随后续上传回报。
+  *
+  *          事件编号上电后从1开始递增，复位后重新计数；未收到应答的事件原样
+  *          重发，服务器按编号和时间去重。队列满时丢弃最旧的事件
+  ******************************************************************************
+  */
+
+#ifndef __EVENT_H
+#define __EVENT_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  一个报警事件
+  */
+typedef struct {
+    uint32_t ts;                // 采样时的Unix时间(s)，未同步时为0
+    uint32_t sample_ms;         // 采样时刻(ms)，计算延迟用
+    uint16_t id;                // 事件编号
+    uint8_t  bit;               // 报警位序号，通道x2+方向（AlarmDir_t）
+    uint8_t  onset;             // 1:产生 0:解除
+    int16_t  value;             // 该通道的采样值，单位同报警判定
+} EventRecord_t;
+
+/**
+  * @brief  一个已确认事件的延迟
+  */
+typedef struct {
+    uint16_t id;
+    uint16_t latency_ms;        // 采样到收到应答，超过65535ms时取65535
+} EventLatency_t;
+
+/**
+  * @brief  事件统计
+  */
+typedef struct {
+    uint32_t raised;            // 产生的事件
+    uint32_t acked;             // 收到应答的事件
+    uint32_t dropped;           // 队列满时丢弃的事件
+    uint32_t last_ms;           // 最近一个事件的延迟
+    uint32_t max_ms;            // 最长延迟
+    uint32_t total_ms;          // 延迟之和，除以acked为平均值
+} EventStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  记录报警状态变化
+  * @param  changed: Alarm_Evaluate返回的变化位
+  * @param  values: 本次判定的采样值
+  * @param  ts: 采样时的Unix时间(s)
+  * @param  sample_ms: 采样时刻(ms)
+  * @retval 无
+  * @note   每个变化位记为一个事件，按Alarm_GetActiveMask区分产生与解除
+  */
+void Event_OnAlarm(uint8_t changed, const int16_t values[ALARM_CH_COUNT], uint32_t ts,
+                   uint32_t sample_ms);
+
+/**
+  * @brief  获取待发送的事件数
+  * @param  无
+  * @retval 事件数
+  */
+uint8_t Event_GetCount(void);
+
+/**
+  * @brief  读取待发送的事件
+  * @param  index: 0为最早的事件
+  * @retval 事件指针，超出范围时为NULL
+  */
+const EventRecord_t *Event_Get(uint8_t index);
+
+/**
+  * @brief  最早的若干个事件已收到应答
+  * @param  n: 随上一次上传发出的事件数
+  * @param  now_ms: 收到应答的时刻(ms)
+  * @retval 无
+  * @note   出队并记下延迟，待随后续上传回报
+  */
+void Event_OnAcked(uint8_t n, uint32_t now_ms);
+
+/**
+  * @brief  获取待回报的延迟数
+  * @param  无
+  * @retval 个数
+  */
+uint8_t Event_GetLatencyCount(void);
+
+/**
+  * @brief  读取待回报的延迟
+  * @param  index: 0为最早的一个
+  * @retval 延迟指针，超出范围时为NULL
+  */
+const EventLatency_t *Event_GetLatency(uint8_t index);
+
+/**
+  * @brief  最早的若干个延迟已回报
+  * @param  n: 随上一次上传回报的个数
+  * @retval 无
+  */
+void Event_RemoveLatencies(uint8_t n);
+
+/**
+  * @brief  获取事件统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const EventStats_t *Event_GetStats(void);
+
+#endif /* __EVENT_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,259 @@
+/**
+  ******************************************************************************
+  * @file    History.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   多分辨率历史数据实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "History.h"
+#include "Config/config.h"
+#include <string.h>
+
+/* 私有类型 ------------------------------------------------------------------*/
+/**
+  * @brief  当前格的汇总器
+  */
+typedef struct {
+    uint32_t slot;                          // 格编号，即起点秒数/格宽
+    uint32_t count;                         // 已累加的采样数
+    int32_t  sum[ALARM_CH_COUNT];
+    HistorySample_t min;
+    HistorySample_t max;
+} HistoryAcc_t;
+
+/**
+  * @brief  环形缓冲区，head为下一次写入的位置
+  */
+typedef struct {
+    uint16_t head;
+    uint16_t count;
+} HistoryRing_t;
+
+/* 私有变量 ------------------------------------------------------------------*/
+static const uint16_t resolution[HISTORY_TIER_COUNT] = { 1, 60, 900 };
+static const uint16_t capacity[HISTORY_TIER_COUNT] = {
+    HISTORY_RAW_COUNT, HISTORY_MINUTE_COUNT, HISTORY_QUARTER_COUNT
+};
+
+static HistorySample_t raw_ring[HISTORY_RAW_COUNT];
+static HistoryRecord_t minute_ring[HISTORY_MINUTE_COUNT];
+static HistoryRecord_t quarter_ring[HISTORY_QUARTER_COUNT];
+static HistoryRing_t ring[HISTORY_TIER_COUNT];
+static HistoryAcc_t acc[HISTORY_TIER_COUNT];
+
+static uint8_t started = 0;
+static uint32_t last_ms;                    // 上一次写入的毫秒时基
+static uint32_t clock_s;                    // 上电后的秒数
+static uint16_t clock_rem_ms;               // 不足1s的部分
+
+/* 私有函数 ------------------------------------------------------------------*/
+/**
+  * @brief  四舍五入的整数除法
+  */
+static int16_t History_Divide(int32_t sum, uint32_t count)
+{
+    int32_t half = (int32_t)(count / 2);
+
+    return (int16_t)((sum >= 0 ? sum + half : sum - half) / (int32_t)count);
+}
+
+/**
+  * @brief  把汇总器的结果或一个空格存入环形缓冲区
+  * @param  tier: 分辨率
+  * @param  a: 汇总器，NULL表示空格
+  * @retval 无
+  */
+static void History_Push(HistoryTier_t tier, const HistoryAcc_t *a)
+{
+    HistoryRing_t *r = &ring[tier];
+    HistoryRecord_t rec;
+    int ch;
+
+    if (a != NULL)
+    {
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            rec.avg.value[ch] = History_Divide(a->sum[ch], a->count);
+        rec.min = a->min;
+        rec.max = a->max;
+    }
+    else
+    {
+        rec.avg.value[0] = HISTORY_INVALID;
+    }
+
+    if (tier == HISTORY_TIER_RAW)
+        raw_ring[r->head] = rec.avg;
+    else if (tier == HISTORY_TIER_MINUTE)
+        minute_ring[r->head] = rec;
+    else
+        quarter_ring[r->head] = rec;
+
+    if (++r->head >= capacity[tier])
+        r->head = 0;
+    if (r->count < capacity[tier])
+        r->count++;
+}
+
+/**
+  * @brief  把一个采样累加到汇总器
+  */
+static void History_Accumulate(HistoryAcc_t *a, const int16_t values[ALARM_CH_COUNT])
+{
+    int ch;
+
+    if (a->count == 0)
+    {
+        memcpy(a->min.value, values, sizeof(a->min.value));
+        memcpy(a->max.value, values, sizeof(a->max.value));
+    }
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        a->sum[ch] += values[ch];
+        if (values[ch] < a->min.value[ch])
+            a->min.value[ch] = values[ch];
+        if (values[ch] > a->max.value[ch])
+            a->max.value[ch] = values[ch];
+    }
+    a->count++;
+}
+
+/**
+  * @brief  写入一次采样
+  * @param  values: 各通道的定点数值
+  * @param  now_ms: 采样时刻(ms)
+  * @retval 无
+  */
+void History_Add(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms)
+{
+    HistoryTier_t tier;
+
+    if (!HISTORY_ENABLE)
+        return;
+
+    /* 按毫秒差累加秒数，毫秒时基约49.7天回绕一次 */
+    if (!started)
+    {
+        clock_s = now_ms / 1000;
+        clock_rem_ms = (uint16_t)(now_ms % 1000);
+    }
+    else
+    {
+        uint32_t elapsed = now_ms - last_ms + clock_rem_ms;
+        clock_s += elapsed / 1000;
+        clock_rem_ms = (uint16_t)(elapsed % 1000);
+    }
+    last_ms = now_ms;
+
+    for (tier = HISTORY_TIER_RAW; tier < HISTORY_TIER_COUNT; tier++)
+    {
+        HistoryAcc_t *a = &acc[tier];
+        uint32_t slot = clock_s / resolution[tier];
+
+        if (!started)
+        {
+            a->slot = slot;
+        }
+        else if (slot != a->slot)
+        {
+            /* 存入上一格，跨过的格记为空，超过容量的部分不必逐格写入 */
+            uint32_t gap = slot - a->slot - 1;
+            History_Push(tier, a);
+            if (gap > capacity[tier])
+                gap = capacity[tier];
+            while (gap--)
+                History_Push(tier, NULL);
+
+            memset(a, 0, sizeof(*a));
+            a->slot = slot;
+        }
+        History_Accumulate(a, values);
+    }
+    started = 1;
+}
+
+/**
+  * @brief  读取一格
+  * @param  tier: 分辨率
+  * @param  age: 0为正在汇总的当前格，1为刚存入的一格，依此类推
+  * @param  rec: 存放汇总结果
+  * @retval 1:成功 0:超出保存范围或该格为空
+  */
+uint8_t History_Get(HistoryTier_t tier, uint16_t age, HistoryRecord_t *rec)
+{
+    const HistoryRing_t *r = &ring[tier];
+    uint16_t index;
+    int ch;
+
+    if (!started || age > r->count)
+        return 0;
+
+    if (age == 0)
+    {
+        for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+            rec->avg.value[ch] = History_Divide(acc[tier].sum[ch], acc[tier].count);
+        rec->min = acc[tier].min;
+        rec->max = acc[tier].max;
+        return 1;
+    }
+
+    index = r->head >= age ? r->head - age : r->head + capacity[tier] - age;
+    if (tier == HISTORY_TIER_RAW)
+    {
+        rec->avg = raw_ring[index];
+        rec->min = rec->avg;
+        rec->max = rec->avg;
+    }
+    else if (tier == HISTORY_TIER_MINUTE)
+        *rec = minute_ring[index];
+    else
+        *rec = quarter_ring[index];
+
+    return rec->avg.value[0] != HISTORY_INVALID;
+}
+
+/**
+  * @brief  获取可读取的格数
+  * @param  tier: 分辨率
+  * @retval 格数，含当前格；尚无采样时为0
+  */
+uint16_t History_GetDepth(HistoryTier_t tier)
+{
+    return started ? ring[tier].count + 1 : 0;
+}
+
+/**
+  * @brief  获取格宽
+  * @param  tier: 分辨率
+  * @retval 秒数
+  */
+uint16_t History_GetResolution(HistoryTier_t tier)
+{
+    return resolution[tier];
+}
+
+/**
+  * @brief  获取一格的起点
+  * @param  tier: 分辨率
+  * @param  age: 同History_Get
+  * @retval 上电后的秒数
+  */
+uint32_t History_GetSlotStart(HistoryTier_t tier, uint16_t age)
+{
+    return (acc[tier].slot - age) * resolution[tier];
+}
+
+/**
+  * @brief  获取最近一次写入的时间
+  * @param  无
+  * @retval 上电后的秒数
+  */
+uint32_t History_GetTime(void)
+{
+    return clock_s;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
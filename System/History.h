@@ -0,0 +1,115 @@
+/**
+  ******************************************************************************
+  * @file    History.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   多分辨率历史数据头文件
+  * @note    采样值在RAM中按三种分辨率保存，占用固定：
+  *            原始  1s一格，HISTORY_RAW_COUNT格（默认3分钟）
+  *            分钟  1min一格，HISTORY_MINUTE_COUNT格（默认3小时）
+  *            刻钟  15min一格，HISTORY_QUARTER_COUNT格（默认2天）
+  *
+  *          数值与报警判定使用的定点数相同（温湿度0.1，光照值x10）。每个
+  *          分辨率有一个汇总器，写入时累加和、最小值和最大值，进入下一格时
+  *          把平均值连同最值存入环形缓冲区，查询时不再计算。没有采样的格
+  *          （传感器故障、采样周期大于格宽）标记为空。原始格只保存平均值，
+  *          同一秒内有多个采样时取平均。
+  *
+  *          时间以上电后的秒数计，由写入时的毫秒时基累加，不受时基回绕和
+  *          RTC校正影响；需要墙上时间时用TimeSync_GetEpoch()减去
+  *          History_GetTime()与格起点之差。复位后历史清空。
+  *
+  *          批量上传模式下断网期间队列满时丢弃的时段，由应用按分钟格（超出
+  *          保存范围时按刻钟格）的平均值补传，见App_FormatBackfill
+  ******************************************************************************
+  */
+
+#ifndef __HISTORY_H
+#define __HISTORY_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define HISTORY_INVALID         INT16_MIN   // 空格的数值
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  分辨率
+  */
+typedef enum {
+    HISTORY_TIER_RAW = 0,       // 1s
+    HISTORY_TIER_MINUTE,        // 1min
+    HISTORY_TIER_QUARTER,       // 15min
+    HISTORY_TIER_COUNT
+} HistoryTier_t;
+
+/**
+  * @brief  一组采样值，通道顺序与报警通道相同
+  */
+typedef struct {
+    int16_t value[ALARM_CH_COUNT];
+} HistorySample_t;
+
+/**
+  * @brief  一格的汇总，原始格的三项相同
+  */
+typedef struct {
+    HistorySample_t avg;
+    HistorySample_t min;
+    HistorySample_t max;
+} HistoryRecord_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  写入一次采样
+  * @param  values: 各通道的定点数值
+  * @param  now_ms: 采样时刻(ms)
+  * @retval 无
+  * @note   各分辨率的汇总器同时更新；进入新格时存入上一格，跨过的格记为空
+  */
+void History_Add(const int16_t values[ALARM_CH_COUNT], uint32_t now_ms);
+
+/**
+  * @brief  读取一格
+  * @param  tier: 分辨率
+  * @param  age: 0为正在汇总的当前格，1为刚存入的一格，依此类推
+  * @param  rec: 存放汇总结果
+  * @retval 1:成功 0:超出保存范围或该格为空
+  */
+uint8_t History_Get(HistoryTier_t tier, uint16_t age, HistoryRecord_t *rec);
+
+/**
+  * @brief  获取可读取的格数
+  * @param  tier: 分辨率
+  * @retval 格数，含当前格；尚无采样时为0
+  */
+uint16_t History_GetDepth(HistoryTier_t tier);
+
+/**
+  * @brief  获取格宽
+  * @param  tier: 分辨率
+  * @retval 秒数
+  */
+uint16_t History_GetResolution(HistoryTier_t tier);
+
+/**
+  * @brief  获取一格的起点
+  * @param  tier: 分辨率
+  * @param  age: 同History_Get
+  * @retval 上电后的秒数
+  */
+uint32_t History_GetSlotStart(HistoryTier_t tier, uint16_t age);
+
+/**
+  * @brief  获取最近一次写入的时间
+  * @param  无
+  * @retval 上电后的秒数
+  */
+uint32_t History_GetTime(void);
+
+#endif /* __HISTORY_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,333 @@
+/**
+  ******************************************************************************
+  * @file    Idle.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   采样间隙低功耗等待实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Idle.h"
+#include "Tick.h"
+#include "Clock.h"
+#include "Trace.h"
+#include "ESP8266.h"
+#include "Watchdog.h"
+#include "Boot.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define IDLE_LSE_TIMEOUT_MS     3000    // LSE起振等待上限
+#define IDLE_LSE_PRESCALER      31      // 32768Hz / 32 = 1024Hz
+#define IDLE_LSI_PRESCALER      39      // 约40kHz / 40 = 1000Hz
+#define IDLE_STOP_MAX_MS        (WATCHDOG_TIMEOUT_MS / 2)   // IWDG在Stop期间继续计数
+
+/* 私有变量 ------------------------------------------------------------------*/
+static IdleStats_t idle_stats;
+static uint32_t rtc_hz = 0;                 // RTC计数频率，0表示未初始化
+static uint32_t rtc_frac = 0;               // 换算毫秒时的余数，避免误差累积
+static volatile uint8_t rx_wake = 0;        // 本次Stop被串口接收唤醒
+static uint8_t rtc_pending = 0;             // 正在等待LSE起振
+static uint32_t lse_start_ms = 0;           // 开始等待LSE的时刻
+
+/**
+  * @brief  配置串口接收引脚的唤醒中断
+  * @param  state: ENABLE:Stop前打开 DISABLE:醒来后关闭，避免每个接收字节都进中断
+  * @retval 无
+  */
+static void Idle_RxWakeConfig(FunctionalState state)
+{
+    EXTI_InitTypeDef EXTI_InitStructure;
+
+    EXTI_ClearITPendingBit(EXTI_Line10);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line10;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Falling;    // 起始位
+    EXTI_InitStructure.EXTI_LineCmd = state;
+    EXTI_Init(&EXTI_InitStructure);
+}
+
+/**
+  * @brief  判断两个串口是否都已静默
+  * @param  无
+  * @retval 1:静默 0:仍在收发
+  * @note   Stop和切换时钟都只能在静默时进行
+  */
+static uint8_t Idle_IsQuiet(void)
+{
+    /* 串口仍有数据在到达（如HTTP应答的正文），Stop会丢字节，切换时钟会收错字节 */
+    if (USART1_GetIdleMs() < IDLE_RX_QUIET_MS)
+        return 0;
+
+    /* USART3正在发送的字节会被截断 */
+    return Trace_IsIdle();
+}
+
+/**
+  * @brief  判断此时进入Stop是否安全
+  * @param  无
+  * @retval 1:可以 0:不可以
+  */
+static uint8_t Idle_CanStop(void)
+{
+    if (!IDLE_STOP_ENABLE || rtc_hz == 0)
+        return 0;
+
+    /* 模块上电时随时可能发来数据，唤醒Stop的第一个字节会丢失，改用Sleep接收 */
+    if (ESP8266_GetPowerState() != ESP8266_POWER_OFF)
+        return 0;
+    return Idle_IsQuiet();
+}
+
+/**
+  * @brief  进入Stop模式，由RTC闹钟或串口接收唤醒
+  * @param  ms: 计划停留的毫秒数
+  * @retval 1:被串口接收提前唤醒 0:闹钟到期
+  */
+static uint8_t Idle_Stop(uint32_t ms)
+{
+    uint32_t start, ticks, slept;
+
+    RTC_WaitForLastTask();
+    start = RTC_GetCounter();
+    RTC_SetAlarm(start + ms * rtc_hz / 1000);
+    RTC_WaitForLastTask();
+
+    rx_wake = 0;
+    Idle_RxWakeConfig(ENABLE);
+
+    /* IWDG在Stop期间继续计数 */
+    Watchdog_Feed();
+
+    PWR_EnterSTOPMode(PWR_Regulator_LowPower, PWR_STOPEntry_WFI);
+
+    /* 醒来时系统时钟为HSI 8MHz，恢复进入Stop前的档位 */
+    Clock_Restore();
+    Idle_RxWakeConfig(DISABLE);
+
+    /* APB1在Stop期间停止，读RTC计数前须等待寄存器同步 */
+    RTC_WaitForSynchro();
+    ticks = RTC_GetCounter() - start;
+
+    slept = ticks * 1000 + rtc_frac;
+    rtc_frac = slept % rtc_hz;
+    slept /= rtc_hz;
+
+    Tick_Compensate(slept);
+    idle_stats.stop_ms += slept;
+    idle_stats.stop_count++;
+    if (rx_wake)
+        idle_stats.rx_wakeups++;
+    return rx_wake;
+}
+
+/**
+  * @brief  LSE起振后完成RTC配置，超时时退回LSI
+  * @param  无
+  * @retval 无
+  * @note   LSE起振需要数百毫秒到数秒，不在初始化中等待，由Idle_Wait轮询；
+  *          RTC开始计数之前Idle_CanStop不允许进入Stop
+  */
+static void Idle_RtcPoll(void)
+{
+    if (!rtc_pending)
+        return;
+
+    if (RCC_GetFlagStatus(RCC_FLAG_LSERDY) == SET)
+    {
+        RCC_RTCCLKConfig(RCC_RTCCLKSource_LSE);
+        rtc_hz = 32768 / (IDLE_LSE_PRESCALER + 1);
+    }
+    else if (Tick_ElapsedMs(lse_start_ms) >= IDLE_LSE_TIMEOUT_MS)
+    {
+        RCC_LSEConfig(RCC_LSE_OFF);
+        RCC_LSICmd(ENABLE);
+        while (RCC_GetFlagStatus(RCC_FLAG_LSIRDY) == RESET);
+        RCC_RTCCLKConfig(RCC_RTCCLKSource_LSI);
+        rtc_hz = 40000 / (IDLE_LSI_PRESCALER + 1);
+    }
+    else
+        return;
+
+    rtc_pending = 0;
+    RCC_RTCCLKCmd(ENABLE);
+
+    RTC_WaitForSynchro();
+    RTC_WaitForLastTask();
+    RTC_SetPrescaler(rtc_hz == 1024 ? IDLE_LSE_PRESCALER : IDLE_LSI_PRESCALER);
+    RTC_WaitForLastTask();
+    RTC_ITConfig(RTC_IT_ALR, ENABLE);
+    RTC_WaitForLastTask();
+    Boot_Mark(BOOT_STAGE_RTC);
+}
+
+/**
+  * @brief  初始化RTC闹钟和唤醒源
+  * @param  无
+  * @retval 无
+  * @note   备份域在系统复位后保留，LSE已在运行时RTC立即可用（滤波状态恢复
+  *          依赖这一点）；上电时LSE在后台起振
+  */
+void Idle_Init(void)
+{
+    if (!IDLE_STOP_ENABLE)
+        return;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    /* RTC时钟源：LSE精度高，板上没有焊晶振时退回LSI */
+    if (RCC_GetFlagStatus(RCC_FLAG_LSERDY) == RESET)
+        RCC_LSEConfig(RCC_LSE_ON);
+    lse_start_ms = Tick_GetMs();
+    rtc_pending = 1;
+    Idle_RtcPoll();
+
+    /* RTC闹钟经EXTI17唤醒Stop */
+    EXTI_InitTypeDef EXTI_InitStructure;
+    EXTI_ClearITPendingBit(EXTI_Line17);
+    EXTI_InitStructure.EXTI_Line = EXTI_Line17;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    /* PA10(USART1_RX)接到EXTI10，只在Stop期间打开 */
+    GPIO_EXTILineConfig(GPIO_PortSourceGPIOA, GPIO_PinSource10);
+
+    NVIC_InitTypeDef NVIC_InitStructure;
+    NVIC_InitStructure.NVIC_IRQChannel = RTCAlarm_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 3;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = EXTI15_10_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+  * @brief  以尽可能低的功耗等待
+  * @param  ms: 等待的毫秒数
+  * @retval 无
+  * @note   串口静默后先降到LOW档；Stop提前IDLE_WAKE_MARGIN_MS醒来，
+  *          留出HSE起振的时间，剩余部分用Sleep补齐。配置的采样周期较长时
+  *          分段进入Stop，每段醒来喂狗
+  */
+void Idle_Wait(uint32_t ms)
+{
+    uint32_t start = Tick_GetMs();
+    uint32_t elapsed, t;
+    uint8_t stop_ok = 1;
+
+    Idle_RtcPoll();
+
+    while ((elapsed = Tick_ElapsedMs(start)) < ms)
+    {
+        if (Idle_IsQuiet())
+            Clock_SetProfile(CLOCK_PROFILE_LOW);
+
+        if (stop_ok && ms - elapsed >= IDLE_STOP_MIN_MS && Idle_CanStop())
+        {
+            t = ms - elapsed - IDLE_WAKE_MARGIN_MS;
+            if (t > IDLE_STOP_MAX_MS)
+                t = IDLE_STOP_MAX_MS;
+
+            /* 串口唤醒说明对端在发数据，本次剩余时间不再进入Stop */
+            if (Idle_Stop(t))
+                stop_ok = 0;
+            continue;
+        }
+
+        /* 每次由1ms时基或串口接收中断唤醒 */
+        t = Tick_GetMs();
+        __WFI();
+        idle_stats.sleep_ms += Tick_ElapsedMs(t);
+    }
+}
+
+/**
+  * @brief  获取低功耗统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const IdleStats_t *Idle_GetStats(void)
+{
+    return &idle_stats;
+}
+
+/**
+  * @brief  获取某一低功耗模式占运行时间的百分比
+  * @param  mode: 低功耗模式
+  * @retval 0~100
+  */
+uint8_t Idle_GetPercent(IdleMode_t mode)
+{
+    uint32_t now = Tick_GetMs();
+    uint32_t ms = (mode == IDLE_MODE_STOP) ? idle_stats.stop_ms : idle_stats.sleep_ms;
+
+    if (now == 0)
+        return 0;
+    return (uint8_t)((uint64_t)ms * 100 / now);
+}
+
+/**
+  * @brief  读取RTC计数折算的秒数
+  * @param  seconds: 存放秒数
+  * @retval 1:成功 0:RTC未启用
+  */
+uint8_t Idle_GetRtcSeconds(uint32_t *seconds)
+{
+    if (rtc_hz == 0)
+        return 0;
+    RTC_WaitForSynchro();
+    *seconds = RTC_GetCounter() / rtc_hz;
+    return 1;
+}
+
+/**
+  * @brief  获取RTC计数频率
+  * @param  无
+  * @retval LSE时为1024，LSI时为1000，RTC未启用时为0
+  */
+uint32_t Idle_GetRtcHz(void)
+{
+    return rtc_hz;
+}
+
+/**
+  * @brief  RTC闹钟中断处理函数
+  * @param  无
+  * @retval 无
+  * @note   只负责清除标志，唤醒后的工作在Idle_Stop中完成
+  */
+void RTCAlarm_IRQHandler(void)
+{
+    if (RTC_GetITStatus(RTC_IT_ALR) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line17);
+        RTC_WaitForLastTask();
+        RTC_ClearITPendingBit(RTC_IT_ALR);
+        RTC_WaitForLastTask();
+    }
+}
+
+/**
+  * @brief  EXTI10~15中断处理函数
+  * @param  无
+  * @retval 无
+  * @note   Stop期间USART1收到起始位
+  */
+void EXTI15_10_IRQHandler(void)
+{
+    if (EXTI_GetITStatus(EXTI_Line10) != RESET)
+    {
+        EXTI_ClearITPendingBit(EXTI_Line10);
+        rx_wake = 1;
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
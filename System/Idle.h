@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    Idle.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   采样间隙低功耗等待头文件
+  * @note    短等待用Sleep（WFI，由1ms时基中断唤醒）；长等待进入Stop模式，
+  *          由RTC闹钟唤醒，醒来后经Clock_Restore恢复进入前的时钟档位，并按RTC
+  *          计数补上TIM2在Stop期间停走的毫秒数。串口静默后等待在LOW档(8MHz)
+  *          进行
+  *
+  *          Stop模式下USART1不工作，唤醒Stop的字节会丢失，因此只在ESP8266已
+  *          断电、串口已静默IDLE_RX_QUIET_MS、采集轨迹已发完时才进入；模块上电
+  *          期间用Sleep等待，USART1照常接收。Stop期间PA10(USART1_RX)的下降沿
+  *          仍经EXTI10立即唤醒，唤醒后改用Sleep等待剩余时间
+  ******************************************************************************
+  */
+
+#ifndef __IDLE_H
+#define __IDLE_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  低功耗模式
+  */
+typedef enum {
+    IDLE_MODE_SLEEP = 0,        // WFI，外设时钟照常运行
+    IDLE_MODE_STOP              // Stop，1.8V域时钟全部停止
+} IdleMode_t;
+
+/**
+  * @brief  低功耗统计
+  */
+typedef struct {
+    uint32_t sleep_ms;          // Sleep累计时长
+    uint32_t stop_ms;           // Stop累计时长（按RTC计数）
+    uint32_t stop_count;        // 进入Stop的次数
+    uint32_t rx_wakeups;        // 被USART1接收提前唤醒的次数
+} IdleStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化RTC闹钟和唤醒源
+  * @param  无
+  * @retval 无
+  * @note   须在Tick_Init之后调用；优先使用LSE，起振在后台进行，超时后改用LSI
+  */
+void Idle_Init(void);
+
+/**
+  * @brief  以尽可能低的功耗等待
+  * @param  ms: 等待的毫秒数
+  * @retval 无
+  */
+void Idle_Wait(uint32_t ms);
+
+/**
+  * @brief  获取低功耗统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const IdleStats_t *Idle_GetStats(void);
+
+/**
+  * @brief  获取某一低功耗模式占运行时间的百分比
+  * @param  mode: 低功耗模式
+  * @retval 0~100
+  */
+uint8_t Idle_GetPercent(IdleMode_t mode);
+
+/**
+  * @brief  读取RTC计数折算的秒数
+  * @param  seconds: 存放秒数
+  * @retval 1:成功 0:RTC未启用
+  * @note   RTC在备份域中，系统复位后继续计数，可用于判断复位前保存的数据
+  *          有多旧；计数约48天回绕一次
+  */
+uint8_t Idle_GetRtcSeconds(uint32_t *seconds);
+
+/**
+  * @brief  获取RTC计数频率
+  * @param  无
+  * @retval LSE时为1024，LSI时为1000，RTC未启用时为0
+  */
+uint32_t Idle_GetRtcHz(void);
+
+#endif /* __IDLE_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
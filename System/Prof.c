@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    Prof.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   基于DWT周期计数器的分区耗时统计实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Prof.h"
+#include "Tick.h"
+#include "Trace.h"
+#include <string.h>
+
+/* 全局变量 ------------------------------------------------------------------*/
+uint32_t Prof_StartCycles[PROF_ZONE_COUNT];     // 各分区本次开始时的计数值
+ProfStats_t Prof_Stats[PROF_ZONE_COUNT];        // 各分区累计统计
+uint8_t Prof_CycleScale = 1;                    // PROF_REF_HZ与当前主频之比
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint32_t last_dump_ms = 0;               // 上次输出统计的时刻
+
+static const char *const zone_names[PROF_ZONE_COUNT] = {
+    "dht", "adc", "oled", "http"
+};
+
+/**
+  * @brief  开启DWT周期计数器并清除统计
+  * @param  无
+  * @retval 无
+  * @note   DWT属于调试组件，需先置位DEMCR.TRCENA；未接调试器时同样可用
+  */
+void Prof_Init(void)
+{
+    if (!PROF_ENABLE)
+        return;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Prof_ClockUpdate();
+    Prof_Reset();
+    last_dump_ms = Tick_GetMs();
+}
+
+/**
+  * @brief  系统时钟变化后更新周期数折算系数
+  * @param  无
+  * @retval 无
+  * @note   三个时钟档位72/36/8MHz都能整除基准
+  */
+void Prof_ClockUpdate(void)
+{
+    Prof_CycleScale = (uint8_t)(PROF_REF_HZ / SystemCoreClock);
+}
+
+/**
+  * @brief  清除全部分区的统计
+  * @param  无
+  * @retval 无
+  */
+void Prof_Reset(void)
+{
+    memset(Prof_Stats, 0, sizeof(Prof_Stats));
+}
+
+/**
+  * @brief  获取分区统计
+  * @param  zone: 统计分区
+  * @retval 统计结构体指针，分区无效时返回NULL
+  */
+const ProfStats_t *Prof_GetStats(ProfZone_t zone)
+{
+    if (zone >= PROF_ZONE_COUNT)
+        return NULL;
+    return &Prof_Stats[zone];
+}
+
+/**
+  * @brief  获取分区名称
+  * @param  zone: 统计分区
+  * @retval 名称字符串
+  */
+const char *Prof_GetZoneName(ProfZone_t zone)
+{
+    if (zone >= PROF_ZONE_COUNT)
+        return "?";
+    return zone_names[zone];
+}
+
+/**
+  * @brief  按PROF_DUMP_INTERVAL周期输出统计
+  * @param  无
+  * @retval 无
+  */
+void Prof_Poll(void)
+{
+    ProfZone_t zone;
+
+    if (!PROF_ENABLE || Tick_ElapsedMs(last_dump_ms) < PROF_DUMP_INTERVAL)
+        return;
+    last_dump_ms = Tick_GetMs();
+
+    for (zone = PROF_ZONE_DHT; zone < PROF_ZONE_COUNT; zone++)
+    {
+        const ProfStats_t *s = &Prof_Stats[zone];
+
+        if (s->count == 0)
+            continue;
+        Trace_Profile((uint8_t)zone, s->count, s->min, (uint32_t)(s->total / s->count), s->max);
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,140 @@
+/**
+  ******************************************************************************
+  * @file    Prof.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   基于DWT周期计数器的分区耗时统计头文件
+  * @note    PROF_BEGIN/PROF_END包住一段代码，按区记录次数、最短、平均和最长
+  *          周期数。开始探针只有一次读和一次写，结束探针为内联的比较和累加；
+  *          config.h中PROF_ENABLE为0时两个宏展开为空，不产生任何代码
+  *
+  *          周期数统一按72MHz折算，低速档下测得的周期数乘以主频倍数后记录，
+  *          因此统计值始终可按72MHz换算为时间；一次测量期间不要切换时钟档位
+  *
+  *          CYCCNT在72MHz下约59.6秒回绕一次，单次测量不应超过这个长度
+  ******************************************************************************
+  */
+
+#ifndef __PROF_H
+#define __PROF_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Config/config.h"
+
+/* DWT寄存器 -----------------------------------------------------------------*/
+/* CMSIS V1.30的core_cm3.h只定义了CoreDebug，没有DWT，这里按地址给出用到的两个寄存器 */
+#ifndef DWT_CYCCNT
+#define DWT_CTRL                (*(volatile uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT              (*(volatile uint32_t *)0xE0001004UL)
+#endif
+#define DWT_CTRL_CYCCNTENA_Msk  (1UL << 0)
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define PROF_REF_HZ             72000000UL  // 统计周期数的折算基准
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  统计分区
+  */
+typedef enum {
+    PROF_ZONE_DHT = 0,      // DHT11一次完整读取
+    PROF_ZONE_ADC,          // 一次光照ADC读取（累加DMA缓冲区）
+    PROF_ZONE_OLED,         // 主循环的OLED刷新
+    PROF_ZONE_HTTP,         // 一次HTTP上传（发送到收到应答）
+    PROF_ZONE_COUNT
+} ProfZone_t;
+
+/**
+  * @brief  分区统计
+  */
+typedef struct {
+    uint32_t count;         // 测量次数
+    uint32_t min;           // 最短周期数
+    uint32_t max;           // 最长周期数
+    uint64_t total;         // 累计周期数，除以count即平均值
+} ProfStats_t;
+
+/* 内部变量（供内联探针使用） ------------------------------------------------*/
+extern uint32_t Prof_StartCycles[PROF_ZONE_COUNT];
+extern ProfStats_t Prof_Stats[PROF_ZONE_COUNT];
+extern uint8_t Prof_CycleScale;         // PROF_REF_HZ与当前主频之比
+
+/* 探针宏 --------------------------------------------------------------------*/
+#if PROF_ENABLE
+#define PROF_BEGIN(zone)    (Prof_StartCycles[zone] = DWT_CYCCNT)
+#define PROF_END(zone)      Prof_Record((zone), DWT_CYCCNT - Prof_StartCycles[zone])
+#else
+#define PROF_BEGIN(zone)    ((void)0)
+#define PROF_END(zone)      ((void)0)
+#endif
+
+/**
+  * @brief  记录一次测量
+  * @param  zone: 统计分区
+  * @param  cycles: 本次周期数（当前主频）
+  * @retval 无
+  */
+static __INLINE void Prof_Record(ProfZone_t zone, uint32_t cycles)
+{
+    ProfStats_t *s = &Prof_Stats[zone];
+
+    cycles *= Prof_CycleScale;
+
+    if (s->count == 0 || cycles < s->min)
+        s->min = cycles;
+    if (cycles > s->max)
+        s->max = cycles;
+    s->total += cycles;
+    s->count++;
+}
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  开启DWT周期计数器并清除统计
+  * @param  无
+  * @retval 无
+  */
+void Prof_Init(void);
+
+/**
+  * @brief  系统时钟变化后更新周期数折算系数
+  * @param  无
+  * @retval 无
+  * @note   由Clock模块在每次切换系统时钟后调用
+  */
+void Prof_ClockUpdate(void);
+
+/**
+  * @brief  清除全部分区的统计
+  * @param  无
+  * @retval 无
+  */
+void Prof_Reset(void);
+
+/**
+  * @brief  获取分区统计
+  * @param  zone: 统计分区
+  * @retval 统计结构体指针，分区无效时返回NULL
+  */
+const ProfStats_t *Prof_GetStats(ProfZone_t zone);
+
+/**
+  * @brief  获取分区名称
+  * @param  zone: 统计分区
+  * @retval 名称字符串
+  */
+const char *Prof_GetZoneName(ProfZone_t zone);
+
+/**
+  * @brief  按PROF_DUMP_INTERVAL周期输出统计
+  * @param  无
+  * @retval 无
+  * @note   在主循环中调用，到期时每个分区写一条轨迹记录（见Trace.h）
+  */
+void Prof_Poll(void);
+
+#endif /* __PROF_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,334 @@
+/**
+  ******************************************************************************
+  * @file    Remote.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   服务器下发配置实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Remote.h"
+#include "Settings.h"
+#include "Alarm.h"
+#include <stddef.h>
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define REMOTE_KEY_SIZE         8       // 字段名最长7个字符，更长的一律视为不认识
+#define REMOTE_VALUE_MAX        0x7FFFFFFFUL
+
+/* 私有类型定义 --------------------------------------------------------------*/
+/**
+  * @brief  解析状态
+  */
+typedef enum {
+    REMOTE_STATE_START = 0,     // 等待'{'
+    REMOTE_STATE_OBJECT,        // '{'之后，等待字段名或'}'
+    REMOTE_STATE_NEXT,          // ','之后，等待字段名
+    REMOTE_STATE_KEY,           // 字段名中
+    REMOTE_STATE_COLON,         // 等待':'
+    REMOTE_STATE_VALUE,         // 等待数值的第一个字符
+    REMOTE_STATE_DIGITS,        // 数值中
+    REMOTE_STATE_STRING,        // 跳过字符串值
+    REMOTE_STATE_LITERAL,       // 跳过true/false/null
+    REMOTE_STATE_AFTER,         // 等待','或'}'
+    REMOTE_STATE_DONE,          // 已收到'}'，其后的字节忽略
+    REMOTE_STATE_ERROR
+} RemoteState_t;
+
+/**
+  * @brief  字段类型
+  */
+typedef enum {
+    REMOTE_U32 = 0,
+    REMOTE_I16,
+    REMOTE_U16,
+    REMOTE_U8
+} RemoteType_t;
+
+/**
+  * @brief  字段与配置结构体成员的对应关系
+  */
+typedef struct {
+    const char *name;
+    RemoteType_t type;
+    uint16_t offset;
+} RemoteKey_t;
+
+/* 私有常量 ------------------------------------------------------------------*/
+static const RemoteKey_t remote_keys[] = {
+    { "cfg",    REMOTE_U32, offsetof(Settings_t, config_id) },
+    { "period", REMOTE_U32, offsetof(Settings_t, sample_period_ms) },
+    { "upload", REMOTE_U32, offsetof(Settings_t, upload_interval_ms) },
+    { "t_lo",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_TEMP].low) },
+    { "t_hi",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_TEMP].high) },
+    { "t_db",   REMOTE_U16, offsetof(Settings_t, alarm[ALARM_CH_TEMP].hysteresis) },
+    { "h_lo",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_HUMI].low) },
+    { "h_hi",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_HUMI].high) },
+    { "h_db",   REMOTE_U16, offsetof(Settings_t, alarm[ALARM_CH_HUMI].hysteresis) },
+    { "l_lo",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_LIGHT].low) },
+    { "l_hi",   REMOTE_I16, offsetof(Settings_t, alarm[ALARM_CH_LIGHT].high) },
+    { "l_db",   REMOTE_U16, offsetof(Settings_t, alarm[ALARM_CH_LIGHT].hysteresis) },
+    { "buzzer", REMOTE_U8,  offsetof(Settings_t, buzzer_mode) },
+    { "window", REMOTE_U32, offsetof(Settings_t, summary_window_ms) },
+    { "batch",  REMOTE_U8,  offsetof(Settings_t, batch_format) },
+};
+#define REMOTE_KEY_COUNT        (sizeof(remote_keys) / sizeof(remote_keys[0]))
+
+/* 私有变量 ------------------------------------------------------------------*/
+static Settings_t pending;                  // 当前配置合并已收到的字段
+static RemoteState_t state = REMOTE_STATE_START;
+static char key[REMOTE_KEY_SIZE];
+static uint8_t key_len;
+static uint32_t value;
+static uint8_t negative;
+static uint8_t escape;                      // 字符串值中上一个字符是'\\'
+static uint8_t fed;                         // 收到过字节
+static uint8_t has_cfg;                     // 收到过cfg字段
+static RemoteStats_t stats;
+
+/**
+  * @brief  是否为JSON空白字符
+  */
+static uint8_t Remote_IsSpace(uint8_t c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+  * @brief  把一个字段的值写入待应用的配置
+  * @retval 1:成功或字段不认识 0:超出该字段的取值范围
+  */
+static uint8_t Remote_Store(void)
+{
+    uint8_t *field;
+    uint8_t i;
+
+    for (i = 0; i < REMOTE_KEY_COUNT; i++)
+        if (strcmp(key, remote_keys[i].name) == 0)
+            break;
+    if (i == REMOTE_KEY_COUNT)
+        return 1;
+
+    field = (uint8_t *)&pending + remote_keys[i].offset;
+    switch (remote_keys[i].type)
+    {
+        case REMOTE_U32:
+            if (negative)
+                return 0;
+            memcpy(field, &value, sizeof(uint32_t));
+            break;
+
+        case REMOTE_I16:
+        {
+            int16_t v;
+            if (value > (negative ? 32768U : 32767U))
+                return 0;
+            v = (int16_t)(negative ? -(int32_t)value : (int32_t)value);
+            memcpy(field, &v, sizeof(v));
+            break;
+        }
+
+        case REMOTE_U16:
+        {
+            uint16_t v = (uint16_t)value;
+            if (negative || value > 0xFFFF)
+                return 0;
+            memcpy(field, &v, sizeof(v));
+            break;
+        }
+
+        default:
+            if (negative || value > 0xFF)
+                return 0;
+            *field = (uint8_t)value;
+            break;
+    }
+
+    if (i == 0)
+        has_cfg = 1;
+    return 1;
+}
+
+/**
+  * @brief  开始接收一段应答体
+  * @param  无
+  * @retval 无
+  */
+void Remote_Begin(void)
+{
+    pending = *Settings_Get();
+    state = REMOTE_STATE_START;
+    fed = 0;
+    has_cfg = 0;
+}
+
+/**
+  * @brief  送入应答体的一个字节
+  * @param  byte: 字节
+  * @retval 无
+  */
+void Remote_Feed(uint8_t byte)
+{
+    fed = 1;
+
+    /* 数值和字面量在遇到第一个不属于它的字符时结束，该字符按AFTER状态继续处理 */
+    if (state == REMOTE_STATE_DIGITS)
+    {
+        if (byte >= '0' && byte <= '9')
+        {
+            if (value > (REMOTE_VALUE_MAX - (byte - '0')) / 10)
+                state = REMOTE_STATE_ERROR;
+            else
+                value = value * 10 + (byte - '0');
+            return;
+        }
+        state = Remote_Store() ? REMOTE_STATE_AFTER : REMOTE_STATE_ERROR;
+    }
+    else if (state == REMOTE_STATE_LITERAL)
+    {
+        if (byte >= 'a' && byte <= 'z')
+            return;
+        state = REMOTE_STATE_AFTER;
+    }
+
+    switch (state)
+    {
+        case REMOTE_STATE_START:
+            if (byte == '{')
+                state = REMOTE_STATE_OBJECT;
+            else if (!Remote_IsSpace(byte))
+                state = REMOTE_STATE_ERROR;
+            break;
+
+        case REMOTE_STATE_OBJECT:
+        case REMOTE_STATE_NEXT:
+            if (byte == '"')
+            {
+                key_len = 0;
+                state = REMOTE_STATE_KEY;
+            }
+            else if (byte == '}' && state == REMOTE_STATE_OBJECT)
+                state = REMOTE_STATE_DONE;
+            else if (!Remote_IsSpace(byte))
+                state = REMOTE_STATE_ERROR;
+            break;
+
+        case REMOTE_STATE_KEY:
+            if (byte == '"')
+            {
+                key[key_len < REMOTE_KEY_SIZE ? key_len : 0] = '\0';
+                state = REMOTE_STATE_COLON;
+            }
+            else if (byte < 0x20 || byte == '\\')
+                state = REMOTE_STATE_ERROR;
+            else if (key_len < REMOTE_KEY_SIZE - 1)
+                key[key_len++] = (char)byte;
+            else
+                key_len = REMOTE_KEY_SIZE;      // 过长，结束时清空为不认识的字段
+            break;
+
+        case REMOTE_STATE_COLON:
+            if (byte == ':')
+            {
+                value = 0;
+                negative = 0;
+                state = REMOTE_STATE_VALUE;
+            }
+            else if (!Remote_IsSpace(byte))
+                state = REMOTE_STATE_ERROR;
+            break;
+
+        case REMOTE_STATE_VALUE:
+            if (byte == '-' && !negative)
+                negative = 1;
+            else if (byte >= '0' && byte <= '9')
+            {
+                value = byte - '0';
+                state = REMOTE_STATE_DIGITS;
+            }
+            else if (negative)
+                state = REMOTE_STATE_ERROR;
+            else if (byte == '"')
+            {
+                /* 服务器应答中的其他字段（如"status": "ok"），跳过 */
+                escape = 0;
+                state = REMOTE_STATE_STRING;
+            }
+            else if (byte >= 'a' && byte <= 'z')
+                state = REMOTE_STATE_LITERAL;
+            else if (!Remote_IsSpace(byte))
+                state = REMOTE_STATE_ERROR;     // 不支持嵌套的对象和数组
+            break;
+
+        case REMOTE_STATE_STRING:
+            if (escape)
+                escape = 0;
+            else if (byte == '\\')
+                escape = 1;
+            else if (byte == '"')
+                state = REMOTE_STATE_AFTER;
+            break;
+
+        case REMOTE_STATE_AFTER:
+            if (byte == ',')
+                state = REMOTE_STATE_NEXT;
+            else if (byte == '}')
+                state = REMOTE_STATE_DONE;
+            else if (!Remote_IsSpace(byte))
+                state = REMOTE_STATE_ERROR;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+  * @brief  应答体接收完毕，校验并应用配置
+  * @param  无
+  * @retval 处理结果
+  */
+RemoteResult_t Remote_End(void)
+{
+    uint8_t ch;
+
+    /* 不含cfg的应答体不是下发的配置 */
+    if (!fed || !has_cfg)
+        return REMOTE_NONE;
+
+    /* 截断的应答体停在对象中间，不应用 */
+    if (state != REMOTE_STATE_DONE || !Settings_IsValid(&pending))
+    {
+        stats.rejected++;
+        return REMOTE_REJECTED;
+    }
+    if (pending.config_id == Settings_Get()->config_id)
+        return REMOTE_UNCHANGED;
+
+    if (!Settings_Save(&pending))
+    {
+        stats.failed++;
+        return REMOTE_FAILED;
+    }
+
+    /* 报警规则换新，已有的报警状态和消抖计时保留 */
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+        Alarm_SetRule((AlarmChannel_t)ch, &Settings_Get()->alarm[ch]);
+    stats.applied++;
+    return REMOTE_APPLIED;
+}
+
+/**
+  * @brief  获取处理结果统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const RemoteStats_t *Remote_GetStats(void)
+{
+    return &stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    Remote.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   服务器下发配置头文件
+  * @note    服务器可在上传的HTTP应答体中返回一段扁平的JSON，只含需要修改的
+  *          字段，值均为整数，例如：
+  *
+  *            {"cfg": 7, "upload": 60000, "t_hi": 320, "t_db": 10, "buzzer": 1}
+  *
+  *          cfg          配置编号，必须给出；与当前编号相同时不再写Flash
+  *          period       采样周期(ms)
+  *          upload       常规上传间隔(ms)
+  *          t_lo t_hi    温度报警下限/上限，0.1℃
+  *          h_lo h_hi    湿度报警下限/上限，0.1%
+  *          l_lo l_hi    光照报警下限/上限，光照值x10
+  *          t_db h_db l_db  各通道回差（死区），单位同上
+  *          buzzer       蜂鸣器模式，见SettingsBuzzer_t
+  *          window       汇总窗口(ms)，0表示逐点上传
+  *          batch        批量上传格式，见SettingsBatch_t
+  *
+  *          不认识的字段跳过，其值可以是整数、字符串或true/false/null；不含cfg
+  *          的应答体不当作配置。应答体逐字节送入解析器，不缓存整段、不用堆；
+  *          解析完成后与当前配置合并，整体校验通过才保存到Flash并立即生效。
+  *          当前配置编号随每次上传回报（"cfg"字段），服务器据此判断是否需要
+  *          重发，校验不通过的配置不会被回报
+  ******************************************************************************
+  */
+
+#ifndef __REMOTE_H
+#define __REMOTE_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  一次应答体的处理结果
+  */
+typedef enum {
+    REMOTE_NONE = 0,            // 应答体为空或不含cfg
+    REMOTE_UNCHANGED,           // 配置编号与当前相同，未写Flash
+    REMOTE_APPLIED,             // 已保存并生效
+    REMOTE_REJECTED,            // 格式错误、应答体不完整或字段超出范围
+    REMOTE_FAILED               // Flash写入失败
+} RemoteResult_t;
+
+/**
+  * @brief  处理结果统计
+  */
+typedef struct {
+    uint32_t applied;
+    uint32_t rejected;
+    uint32_t failed;
+} RemoteStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  开始接收一段应答体
+  * @param  无
+  * @retval 无
+  */
+void Remote_Begin(void);
+
+/**
+  * @brief  送入应答体的一个字节
+  * @param  byte: 字节
+  * @retval 无
+  */
+void Remote_Feed(uint8_t byte);
+
+/**
+  * @brief  应答体接收完毕，校验并应用配置
+  * @param  无
+  * @retval 处理结果
+  * @note   保存时擦除一页Flash约20ms；报警规则立即更新，采样和上传间隔
+  *          从下一个周期起生效
+  */
+RemoteResult_t Remote_End(void);
+
+/**
+  * @brief  获取处理结果统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const RemoteStats_t *Remote_GetStats(void);
+
+#endif /* __REMOTE_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/**
+  ******************************************************************************
+  * @file    Retry.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   上传重试退避与断路器实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Retry.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define RETRY_UID_BASE          0x1FFFF7E8  // 96位唯一ID，出厂写入系统存储区
+#define RETRY_MAX_LEVEL         16          // 翻倍次数上限，防止移位溢出
+
+/* 私有变量 ------------------------------------------------------------------*/
+static RetryState_t state = RETRY_CLOSED;
+static uint8_t failures = 0;                // 当前连续失败次数
+static uint8_t level = 0;                   // 当前连续断路次数
+static uint8_t urgent_used = 0;             // 本次断路已提前试探过
+static uint32_t probe_ms = 0;               // 断路到期时刻
+static uint32_t rng = 1;
+static RetryStats_t stats;
+
+/**
+  * @brief  xorshift32伪随机数
+  */
+static uint32_t Retry_Random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+/**
+  * @brief  打开断路器，按连续断路次数计算等待时间
+  * @param  now: 当前时刻(ms)
+  * @retval 无
+  */
+static void Retry_Open(uint32_t now)
+{
+    uint32_t wait = RETRY_MAX_MS;
+
+    if (level < RETRY_MAX_LEVEL && ((uint32_t)RETRY_BASE_MS << level) < RETRY_MAX_MS)
+        wait = (uint32_t)RETRY_BASE_MS << level;
+    if (level < RETRY_MAX_LEVEL)
+        level++;
+
+    /* 等待时间取1/2~1之间的随机值 */
+    wait = wait / 2 + Retry_Random() % (wait / 2 + 1);
+
+    state = RETRY_OPEN;
+    failures = 0;
+    urgent_used = 0;
+    probe_ms = now + wait;
+    stats.opens++;
+    if (wait > stats.max_wait_ms)
+        stats.max_wait_ms = wait;
+}
+
+/**
+  * @brief  按芯片唯一ID初始化随机数
+  * @param  无
+  * @retval 无
+  * @note   ID中批号、晶圆号和坐标相近的芯片只差几位，先混合再使用
+  */
+void Retry_Init(void)
+{
+    const volatile uint32_t *uid = (const volatile uint32_t *)RETRY_UID_BASE;
+    uint32_t h = uid[0] ^ (uid[1] * 0x9E3779B1UL) ^ (uid[2] * 0x85EBCA77UL);
+
+    h ^= h >> 16;
+    h *= 0x7FEB352DUL;
+    h ^= h >> 15;
+    h *= 0x846CA68BUL;
+    h ^= h >> 16;
+    rng = h ? h : 1;
+}
+
+/**
+  * @brief  判断此刻是否可以上传
+  * @param  now: 当前时刻(ms)
+  * @param  urgent: 1:报警状态变化，断路期间允许提前试探一次
+  * @retval 1:可以 0:断路中
+  */
+uint8_t Retry_CanAttempt(uint32_t now, uint8_t urgent)
+{
+    if (state != RETRY_OPEN)
+        return 1;
+
+    if ((int32_t)(now - probe_ms) < 0)
+    {
+        if (!urgent || urgent_used)
+            return 0;
+        urgent_used = 1;
+        stats.early_probes++;
+    }
+    state = RETRY_HALF_OPEN;
+    stats.probes++;
+    return 1;
+}
+
+/**
+  * @brief  记录一次上传成功
+  * @param  无
+  * @retval 无
+  */
+void Retry_OnSuccess(void)
+{
+    state = RETRY_CLOSED;
+    failures = 0;
+    level = 0;
+}
+
+/**
+  * @brief  记录一次上传失败
+  * @param  now: 当前时刻(ms)
+  * @retval 1:断路器刚刚打开，应做网络恢复 0:仍在CLOSED状态
+  * @note   报警提前的试探失败时保留原来的到期时刻，不推迟正常的试探
+  */
+uint8_t Retry_OnFailure(uint32_t now)
+{
+    stats.failures++;
+    if (failures < 0xFF)
+        failures++;
+
+    if (state == RETRY_HALF_OPEN && urgent_used && (int32_t)(now - probe_ms) < 0)
+    {
+        state = RETRY_OPEN;
+        return 0;
+    }
+    if (state == RETRY_HALF_OPEN || failures >= RETRY_OPEN_FAILURES)
+    {
+        Retry_Open(now);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+  * @brief  获取断路器状态
+  * @param  无
+  * @retval 状态
+  */
+RetryState_t Retry_GetState(void)
+{
+    return state;
+}
+
+/**
+  * @brief  获取当前连续失败次数
+  * @param  无
+  * @retval 次数，上传成功或断路后清零
+  */
+uint8_t Retry_GetFailures(void)
+{
+    return failures;
+}
+
+/**
+  * @brief  获取距下一次试探的时间
+  * @param  now: 当前时刻(ms)
+  * @retval 毫秒数，不在断路状态时为0
+  */
+uint32_t Retry_GetWaitMs(uint32_t now)
+{
+    if (state != RETRY_OPEN || (int32_t)(now - probe_ms) >= 0)
+        return 0;
+    return probe_ms - now;
+}
+
+/**
+  * @brief  获取重试统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const RetryStats_t *Retry_GetStats(void)
+{
+    return &stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
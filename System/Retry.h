@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    Retry.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   上传重试退避与断路器头文件
+  * @note    断路器有三个状态：
+  *            CLOSED     正常上传，连续失败RETRY_OPEN_FAILURES次后断路
+  *            OPEN       不再尝试，等待时间到期后转为HALF_OPEN
+  *            HALF_OPEN  放行一次试探上传，成功则恢复CLOSED，失败则再次断路
+  *
+  *          第n次连续断路的等待时间为RETRY_BASE_MS x 2^(n-1)，上限RETRY_MAX_MS，
+  *          实际取其1/2~1之间的随机值。随机数按芯片96位唯一ID播种，服务器
+  *          故障恢复时各节点的试探自然错开，不会同时涌入
+  ******************************************************************************
+  */
+
+#ifndef __RETRY_H
+#define __RETRY_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  断路器状态
+  */
+typedef enum {
+    RETRY_CLOSED = 0,           // 正常上传
+    RETRY_OPEN,                 // 断路，等待到期
+    RETRY_HALF_OPEN             // 正在试探
+} RetryState_t;
+
+/**
+  * @brief  重试统计
+  */
+typedef struct {
+    uint32_t failures;          // 失败的上传次数
+    uint32_t opens;             // 断路次数
+    uint32_t probes;            // 试探次数
+    uint32_t early_probes;      // 其中因报警提前的试探
+    uint32_t max_wait_ms;       // 最长一次断路等待
+} RetryStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  按芯片唯一ID初始化随机数
+  * @param  无
+  * @retval 无
+  */
+void Retry_Init(void);
+
+/**
+  * @brief  判断此刻是否可以上传
+  * @param  now: 当前时刻(ms)
+  * @param  urgent: 1:报警状态变化，断路期间允许提前试探一次
+  * @retval 1:可以 0:断路中
+  * @note   断路到期时转为HALF_OPEN，本次上传即为试探
+  */
+uint8_t Retry_CanAttempt(uint32_t now, uint8_t urgent);
+
+/**
+  * @brief  记录一次上传成功
+  * @param  无
+  * @retval 无
+  */
+void Retry_OnSuccess(void);
+
+/**
+  * @brief  记录一次上传失败
+  * @param  now: 当前时刻(ms)
+  * @retval 1:断路器刚刚打开，应做网络恢复 0:仍在CLOSED状态
+  */
+uint8_t Retry_OnFailure(uint32_t now);
+
+/**
+  * @brief  获取断路器状态
+  * @param  无
+  * @retval 状态
+  */
+RetryState_t Retry_GetState(void);
+
+/**
+  * @brief  获取当前连续失败次数
+  * @param  无
+  * @retval 次数，上传成功或断路后清零
+  */
+uint8_t Retry_GetFailures(void);
+
+/**
+  * @brief  获取距下一次试探的时间
+  * @param  now: 当前时刻(ms)
+  * @retval 毫秒数，不在断路状态时为0
+  */
+uint32_t Retry_GetWaitMs(uint32_t now);
+
+/**
+  * @brief  获取重试统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const RetryStats_t *Retry_GetStats(void);
+
+#endif /* __RETRY_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
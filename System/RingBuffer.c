@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file    RingBuffer.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   单生产者/单消费者无锁字节环形缓冲区实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "RingBuffer.h"
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+// 数据访问与下标发布之间的内存屏障，保证对方看到新下标时数据已就绪
+#define RINGBUFFER_BARRIER()  __DMB()
+
+/**
+  * @brief  初始化环形缓冲区
+  * @param  rb: 缓冲区结构体
+  * @param  storage: 存储区
+  * @param  size: 存储区字节数，必须为2的幂且不超过32768
+  * @retval 1:成功 0:容量不合法
+  */
+uint8_t RingBuffer_Init(RingBuffer_t *rb, uint8_t *storage, uint16_t size)
+{
+    if (size == 0 || size > 32768 || (size & (size - 1)) != 0)
+        return 0;
+
+    rb->buffer = storage;
+    rb->mask = size - 1;
+    rb->head = 0;
+    rb->tail = 0;
+    rb->high_water = 0;
+    rb->dropped = 0;
+
+    return 1;
+}
+
+/**
+  * @brief  获取可读字节数
+  * @param  rb: 缓冲区结构体
+  * @retval 可读字节数
+  */
+uint16_t RingBuffer_Count(const RingBuffer_t *rb)
+{
+    return (uint16_t)(rb->head - rb->tail);
+}
+
+/**
+  * @brief  写入一个字节（生产者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 写入的字节
+  * @retval 1:成功 0:缓冲区已满
+  */
+uint8_t RingBuffer_Put(RingBuffer_t *rb, uint8_t data)
+{
+    uint16_t head = rb->head;
+    uint16_t used = (uint16_t)(head - rb->tail);
+
+    if (used > rb->mask)
+    {
+        rb->dropped++;
+        return 0;
+    }
+
+    rb->buffer[head & rb->mask] = data;
+    RINGBUFFER_BARRIER();           // 先写数据再发布head
+    rb->head = head + 1;
+
+    if (used + 1 > rb->high_water)
+        rb->high_water = used + 1;
+
+    return 1;
+}
+
+/**
+  * @brief  批量写入（生产者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 源数据
+  * @param  len: 源数据字节数
+  * @retval 实际写入的字节数
+  */
+uint16_t RingBuffer_Write(RingBuffer_t *rb, const uint8_t *data, uint16_t len)
+{
+    uint16_t head = rb->head;
+    uint16_t used = (uint16_t)(head - rb->tail);
+    uint16_t space = rb->mask + 1 - used;
+    uint16_t offset = head & rb->mask;
+    uint16_t first;
+
+    if (len > space)
+    {
+        rb->dropped += len - space;
+        len = space;
+    }
+
+    /* 分两段拷贝：到存储区末尾，再从头开始 */
+    first = rb->mask + 1 - offset;
+    if (first > len)
+        first = len;
+    memcpy(&rb->buffer[offset], data, first);
+    memcpy(&rb->buffer[0], data + first, len - first);
+
+    RINGBUFFER_BARRIER();
+    rb->head = head + len;
+
+    if (used + len > rb->high_water)
+        rb->high_water = used + len;
+
+    return len;
+}
+
+/**
+  * @brief  读取一个字节（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 读取数据的存放地址
+  * @retval 1:成功 0:缓冲区为空
+  */
+uint8_t RingBuffer_Get(RingBuffer_t *rb, uint8_t *data)
+{
+    uint16_t tail = rb->tail;
+
+    if (rb->head == tail)
+        return 0;
+
+    RINGBUFFER_BARRIER();           // 看到head后再读数据
+    *data = rb->buffer[tail & rb->mask];
+    RINGBUFFER_BARRIER();           // 读完数据再释放空间
+    rb->tail = tail + 1;
+
+    return 1;
+}
+
+/**
+  * @brief  批量读取（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 目标缓冲区
+  * @param  len: 最多读取的字节数
+  * @retval 实际读取的字节数
+  */
+uint16_t RingBuffer_Read(RingBuffer_t *rb, uint8_t *data, uint16_t len)
+{
+    const uint8_t *span;
+    uint16_t total = 0;
+    uint16_t chunk;
+
+    /* 最多两段连续数据 */
+    while (total < len && (chunk = RingBuffer_Peek(rb, &span)) != 0)
+    {
+        if (chunk > len - total)
+            chunk = len - total;
+        memcpy(data + total, span, chunk);
+        RingBuffer_Consume(rb, chunk);
+        total += chunk;
+    }
+
+    return total;
+}
+
+/**
+  * @brief  获取一段连续可读数据（消费者，零拷贝）
+  * @param  rb: 缓冲区结构体
+  * @param  span: 返回连续数据的起始地址
+  * @retval 连续可读字节数
+  */
+uint16_t RingBuffer_Peek(const RingBuffer_t *rb, const uint8_t **span)
+{
+    uint16_t tail = rb->tail;
+    uint16_t count = (uint16_t)(rb->head - tail);
+    uint16_t offset = tail & rb->mask;
+    uint16_t to_end = rb->mask + 1 - offset;
+
+    RINGBUFFER_BARRIER();
+    *span = &rb->buffer[offset];
+
+    return (count < to_end) ? count : to_end;
+}
+
+/**
+  * @brief  释放已处理的数据（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  len: 释放的字节数
+  * @retval 无
+  */
+void RingBuffer_Consume(RingBuffer_t *rb, uint16_t len)
+{
+    uint16_t count = RingBuffer_Count(rb);
+
+    if (len > count)
+        len = count;
+
+    RINGBUFFER_BARRIER();
+    rb->tail = rb->tail + len;
+}
+
+/**
+  * @brief  丢弃全部未读数据（消费者）
+  * @param  rb: 缓冲区结构体
+  * @retval 无
+  */
+void RingBuffer_Flush(RingBuffer_t *rb)
+{
+    rb->tail = rb->head;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
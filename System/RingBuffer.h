@@ -0,0 +1,111 @@
+/**
+  ******************************************************************************
+  * @file    RingBuffer.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   单生产者/单消费者无锁字节环形缓冲区头文件
+  * @note    生产者（通常为中断）只写head，消费者（主循环）只写tail，
+  *          双方无需关中断；容量必须为2的幂，下标用掩码回绕
+  ******************************************************************************
+  */
+
+#ifndef __RINGBUFFER_H
+#define __RINGBUFFER_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  环形缓冲区结构体
+  * @note    head/tail为自由递增的计数值，count = head - tail
+  */
+typedef struct {
+    uint8_t *buffer;             // 存储区
+    uint16_t mask;               // 容量减一
+    volatile uint16_t head;      // 写入计数，仅生产者修改
+    volatile uint16_t tail;      // 读取计数，仅消费者修改
+    uint16_t high_water;         // 历史最高占用字节数，仅生产者修改
+    uint32_t dropped;            // 因缓冲区满丢弃的字节数，仅生产者修改
+} RingBuffer_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化环形缓冲区
+  * @param  rb: 缓冲区结构体
+  * @param  storage: 存储区
+  * @param  size: 存储区字节数，必须为2的幂且不超过32768
+  * @retval 1:成功 0:容量不合法
+  */
+uint8_t RingBuffer_Init(RingBuffer_t *rb, uint8_t *storage, uint16_t size);
+
+/**
+  * @brief  获取可读字节数
+  * @param  rb: 缓冲区结构体
+  * @retval 可读字节数
+  */
+uint16_t RingBuffer_Count(const RingBuffer_t *rb);
+
+/**
+  * @brief  写入一个字节（生产者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 写入的字节
+  * @retval 1:成功 0:缓冲区已满，字节被丢弃
+  */
+uint8_t RingBuffer_Put(RingBuffer_t *rb, uint8_t data);
+
+/**
+  * @brief  批量写入（生产者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 源数据
+  * @param  len: 源数据字节数
+  * @retval 实际写入的字节数，放不下的部分计入丢弃计数
+  */
+uint16_t RingBuffer_Write(RingBuffer_t *rb, const uint8_t *data, uint16_t len);
+
+/**
+  * @brief  读取一个字节（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 读取数据的存放地址
+  * @retval 1:成功 0:缓冲区为空
+  */
+uint8_t RingBuffer_Get(RingBuffer_t *rb, uint8_t *data);
+
+/**
+  * @brief  批量读取（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  data: 目标缓冲区
+  * @param  len: 最多读取的字节数
+  * @retval 实际读取的字节数
+  */
+uint16_t RingBuffer_Read(RingBuffer_t *rb, uint8_t *data, uint16_t len);
+
+/**
+  * @brief  获取一段连续可读数据（消费者，零拷贝）
+  * @param  rb: 缓冲区结构体
+  * @param  span: 返回连续数据的起始地址
+  * @retval 连续可读字节数，数据跨越存储区末尾时只返回前半段
+  * @note   处理完后调用RingBuffer_Consume释放
+  */
+uint16_t RingBuffer_Peek(const RingBuffer_t *rb, const uint8_t **span);
+
+/**
+  * @brief  释放已处理的数据（消费者）
+  * @param  rb: 缓冲区结构体
+  * @param  len: 释放的字节数，超过可读字节数时按可读字节数处理
+  * @retval 无
+  */
+void RingBuffer_Consume(RingBuffer_t *rb, uint16_t len);
+
+/**
+  * @brief  丢弃全部未读数据（消费者）
+  * @param  rb: 缓冲区结构体
+  * @retval 无
+  * @note   只移动tail，生产者可同时继续写入
+  */
+void RingBuffer_Flush(RingBuffer_t *rb);
+
+#endif /* __RINGBUFFER_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
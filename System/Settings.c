@@ -0,0 +1,305 @@
+/**
+  ******************************************************************************
+  * @file    Settings.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   Flash配置存储实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Settings.h"
+#include "Config/config.h"
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+/* 中容量器件64KB Flash的最后两页，工程中IROM1相应缩小为0xF800，程序不会占用 */
+#define SETTINGS_PAGE_SIZE      0x400
+#define SETTINGS_PAGE0_ADDR     (FLASH_BASE + 0x10000 - 2 * SETTINGS_PAGE_SIZE)
+#define SETTINGS_PAGE_ADDR(n)   (SETTINGS_PAGE0_ADDR + (n) * SETTINGS_PAGE_SIZE)
+#define SETTINGS_NO_PAGE        0xFF
+
+#define SETTINGS_MAGIC          0x5354      // "ST"，擦除后为0xFFFF
+
+/* 私有类型定义 --------------------------------------------------------------*/
+/**
+  * @brief  记录头，其后依次为length字节的配置数据和CRC-32
+  */
+typedef struct {
+    uint16_t magic;
+    uint16_t version;           // 写入时的SETTINGS_VERSION
+    uint32_t seq;               // 写入序号，每次保存加1
+    uint32_t length;            // 配置数据字节数，4的倍数
+} SettingsHeader_t;
+
+/* 私有常量 ------------------------------------------------------------------*/
+static const Settings_t settings_default = {
+    .sample_period_ms   = MAIN_LOOP_PERIOD_MS,
+    .upload_interval_ms = UPLOAD_INTERVAL_MS,
+    /* 与原蜂鸣器阈值一致：温度10~30℃，湿度30~70%，光照200~700 */
+    .alarm = {
+        [ALARM_CH_TEMP]  = { 100,  300,   5, 5000,  ALARM_SEVERITY_CRITICAL },
+        [ALARM_CH_HUMI]  = { 300,  700,  20, 5000,  ALARM_SEVERITY_WARNING  },
+        [ALARM_CH_LIGHT] = { 2000, 7000, 200, 10000, ALARM_SEVERITY_INFO     },
+    },
+    .kalman = {
+        [SETTINGS_FILTER_TEMP]  = { 0.02f, 1.0f  },
+        [SETTINGS_FILTER_HUMI]  = { 0.01f, 2.0f  },
+        [SETTINGS_FILTER_LIGHT] = { 0.01f, 10.0f },
+    },
+    .server_host   = SERVER_HOST,
+    .post_path     = POST_PATH,
+    .config_id     = 0,
+    .buzzer_mode   = SETTINGS_BUZZER_NORMAL,
+    .summary_window_ms = SUMMARY_WINDOW_MS,
+    .batch_format  = BATCH_FORMAT,
+};
+
+/* 私有变量 ------------------------------------------------------------------*/
+static const Settings_t *current = &settings_default;
+static Settings_t upgraded;                 // 旧版本记录补齐默认值后的配置
+static SettingsSource_t source = SETTINGS_SOURCE_DEFAULT;
+static uint8_t current_page = SETTINGS_NO_PAGE;
+static uint32_t current_seq = 0;
+
+/**
+  * @brief  获取某一页的记录头
+  * @param  page: 0或1
+  * @retval 记录头指针（Flash地址）
+  */
+static const SettingsHeader_t *Settings_Header(uint8_t page)
+{
+    return (const SettingsHeader_t *)(uintptr_t)SETTINGS_PAGE_ADDR(page);
+}
+
+/**
+  * @brief  计算记录的CRC-32
+  * @param  header: 记录头，数据紧随其后
+  * @retval CRC值
+  * @note   用硬件CRC单元，每个字4个周期
+  */
+static uint32_t Settings_Crc(const SettingsHeader_t *header)
+{
+    CRC_ResetDR();
+    return CRC_CalcBlockCRC((uint32_t *)(uintptr_t)header,
+                            (sizeof(SettingsHeader_t) + header->length) / 4);
+}
+
+/**
+  * @brief  检查某一页的记录是否完整
+  * @param  page: 0或1
+  * @retval 1:完整 0:已擦除、写入中途掉电或已损坏
+  */
+static uint8_t Settings_CheckPage(uint8_t page)
+{
+    const SettingsHeader_t *h = Settings_Header(page);
+    const uint32_t *crc;
+
+    if (h->magic != SETTINGS_MAGIC || h->length == 0 || (h->length & 3) ||
+        h->length > SETTINGS_PAGE_SIZE - sizeof(SettingsHeader_t) - 4)
+        return 0;
+
+    crc = (const uint32_t *)((const uint8_t *)(h + 1) + h->length);
+    return *crc == Settings_Crc(h);
+}
+
+/**
+  * @brief  检查字符串在缓冲区内有结束符
+  * @param  str: 字符串
+  * @param  size: 缓冲区大小
+  * @retval 1:有 0:没有
+  */
+static uint8_t Settings_IsTerminated(const char *str, uint32_t size)
+{
+    return memchr(str, '\0', size) != NULL;
+}
+
+/**
+  * @brief  从Flash载入配置
+  * @param  无
+  * @retval 无
+  */
+void Settings_Init(void)
+{
+    const SettingsHeader_t *h;
+    uint8_t ok[2], page;
+
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC, ENABLE);
+
+    current = &settings_default;
+    source = SETTINGS_SOURCE_DEFAULT;
+    current_page = SETTINGS_NO_PAGE;
+    current_seq = 0;
+
+    /* 两页都有效时取序号较大的一页，按回绕差值比较 */
+    ok[0] = Settings_CheckPage(0);
+    ok[1] = Settings_CheckPage(1);
+    if (!ok[0] && !ok[1])
+        return;
+    if (ok[0] && ok[1])
+        page = (int32_t)(Settings_Header(1)->seq - Settings_Header(0)->seq) > 0 ? 1 : 0;
+    else
+        page = ok[1] ? 1 : 0;
+
+    h = Settings_Header(page);
+    if (h->version == SETTINGS_VERSION && h->length == sizeof(Settings_t))
+    {
+        if (!Settings_IsValid((const Settings_t *)(h + 1)))
+            return;
+        current = (const Settings_t *)(h + 1);
+        source = SETTINGS_SOURCE_FLASH;
+    }
+    else if (h->version < SETTINGS_VERSION && h->length < sizeof(Settings_t))
+    {
+        /* 旧版本的记录是当前格式的前缀 */
+        upgraded = settings_default;
+        memcpy(&upgraded, h + 1, h->length);
+        if (!Settings_IsValid(&upgraded))
+            return;
+        current = &upgraded;
+        source = SETTINGS_SOURCE_UPGRADED;
+    }
+    else
+    {
+        /* 新版本程序写入的记录，降级后不认识，用默认值但不覆盖 */
+        return;
+    }
+    current_page = page;
+    current_seq = h->seq;
+}
+
+/**
+  * @brief  获取当前配置
+  * @param  无
+  * @retval 配置指针
+  */
+const Settings_t *Settings_Get(void)
+{
+    return current;
+}
+
+/**
+  * @brief  获取编译时的默认配置
+  * @param  无
+  * @retval 配置指针
+  */
+const Settings_t *Settings_GetDefault(void)
+{
+    return &settings_default;
+}
+
+/**
+  * @brief  检查配置是否合法
+  * @param  settings: 待检查的配置
+  * @retval 1:合法 0:不合法
+  * @note   长于看门狗超时的采样周期由Idle_Wait分段进入Stop，不受看门狗限制
+  */
+uint8_t Settings_IsValid(const Settings_t *settings)
+{
+    const char *port;
+    uint8_t i;
+
+    if (settings->sample_period_ms < 200 || settings->sample_period_ms > 3600000 ||
+        settings->upload_interval_ms < settings->sample_period_ms ||
+        settings->upload_interval_ms > 86400000)
+        return 0;
+    if (settings->summary_window_ms != 0 &&
+        (settings->summary_window_ms < settings->sample_period_ms ||
+         settings->summary_window_ms > 86400000))
+        return 0;
+
+    for (i = 0; i < ALARM_CH_COUNT; i++)
+    {
+        const AlarmRule_t *r = &settings->alarm[i];
+        if (r->low >= r->high || r->severity > ALARM_SEVERITY_CRITICAL ||
+            r->hysteresis > (uint16_t)(r->high - r->low))
+            return 0;
+    }
+
+    /* NaN不满足任何比较，一并排除 */
+    for (i = 0; i < SETTINGS_FILTER_COUNT; i++)
+        if (!(settings->kalman[i].Q > 0.0f && settings->kalman[i].Q < 1000.0f &&
+              settings->kalman[i].R > 0.0f && settings->kalman[i].R < 1000.0f))
+            return 0;
+
+    if (settings->buzzer_mode > SETTINGS_BUZZER_MUTE ||
+        settings->batch_format > SETTINGS_BATCH_BITPACK)
+        return 0;
+
+    if (!Settings_IsTerminated(settings->server_host, SETTINGS_HOST_SIZE) ||
+        !Settings_IsTerminated(settings->post_path, SETTINGS_PATH_SIZE))
+        return 0;
+
+    /* 地址须为"主机:端口"，建立TCP连接时拆开使用 */
+    port = strchr(settings->server_host, ':');
+    if (port == NULL || port == settings->server_host || port[1] < '0' || port[1] > '9')
+        return 0;
+    return settings->post_path[0] == '/';
+}
+
+/**
+  * @brief  保存配置
+  * @param  settings: 新配置
+  * @retval 1:成功 0:失败
+  */
+uint8_t Settings_Save(const Settings_t *settings)
+{
+    static uint32_t words[(sizeof(SettingsHeader_t) + sizeof(Settings_t)) / 4 + 1];
+    SettingsHeader_t *h = (SettingsHeader_t *)words;
+    uint8_t page = (current_page == 0) ? 1 : 0;
+    uint32_t addr = SETTINGS_PAGE_ADDR(page);
+    uint32_t i, n = sizeof(words) / 4;
+    FLASH_Status status;
+
+    if (!Settings_IsValid(settings))
+        return 0;
+    if (memcmp(settings, current, sizeof(Settings_t)) == 0)
+        return 1;
+
+    h->magic = SETTINGS_MAGIC;
+    h->version = SETTINGS_VERSION;
+    h->seq = current_seq + 1;
+    h->length = sizeof(Settings_t);
+    memcpy(h + 1, settings, sizeof(Settings_t));
+    words[n - 1] = Settings_Crc(h);
+
+    /* 只擦写当前记录之外的一页，CRC最后写入 */
+    FLASH_Unlock();
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+    status = FLASH_ErasePage(addr);
+    for (i = 0; i < n && status == FLASH_COMPLETE; i++)
+        status = FLASH_ProgramWord(addr + i * 4, words[i]);
+    FLASH_Lock();
+
+    if (status != FLASH_COMPLETE || !Settings_CheckPage(page))
+        return 0;
+
+    current = (const Settings_t *)(Settings_Header(page) + 1);
+    source = SETTINGS_SOURCE_FLASH;
+    current_page = page;
+    current_seq = h->seq;
+    return 1;
+}
+
+/**
+  * @brief  获取当前配置的来源
+  * @param  无
+  * @retval 来源
+  */
+SettingsSource_t Settings_GetSource(void)
+{
+    return source;
+}
+
+/**
+  * @brief  获取当前记录的写入序号
+  * @param  无
+  * @retval 序号
+  */
+uint32_t Settings_GetSequence(void)
+{
+    return current_seq;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
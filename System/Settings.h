@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    Settings.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   Flash配置存储头文件
+  * @note    报警阈值、卡尔曼滤波参数、服务器地址、WiFi热点和采样/上传间隔
+  *          保存在Flash最后两页中，修改后不必重新烧录程序。每页存一条记录：
+  *          记录头（标记、版本、序号、长度）+ 配置数据 + CRC-32，两页轮流写入，
+  *          启动时取校验通过且序号较大的一条。写入新记录时先擦除另一页，
+  *          CRC最后写入，中途掉电时旧记录仍然有效
+  *
+  *          启动时用硬件CRC单元校验两页（共约120个字），记录有效时各模块
+  *          直接读取Flash中的配置，不拷贝；没有有效记录时使用config.h中的
+  *          默认值。新版本只在Settings_t末尾追加字段，旧版本的记录仍可载入，
+  *          追加的字段取默认值
+  ******************************************************************************
+  */
+
+#ifndef __SETTINGS_H
+#define __SETTINGS_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+#include "Alarm.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define SETTINGS_VERSION        4       // 配置数据格式版本，追加字段时加1
+#define SETTINGS_HOST_SIZE      32      // 服务器地址"IP:端口"，含结束符
+#define SETTINGS_PATH_SIZE      32      // POST路径，含结束符
+#define SETTINGS_RESERVED_SIZE  98      // 原热点名称和密码，保留以兼容旧记录
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  卡尔曼滤波器编号
+  */
+typedef enum {
+    SETTINGS_FILTER_TEMP = 0,   // DHT11温度
+    SETTINGS_FILTER_HUMI,       // DHT11湿度
+    SETTINGS_FILTER_LIGHT,      // 光照
+    SETTINGS_FILTER_COUNT
+} SettingsFilter_t;
+
+/**
+  * @brief  蜂鸣器模式
+  */
+typedef enum {
+    SETTINGS_BUZZER_NORMAL = 0,     // 警告和严重报警都鸣响
+    SETTINGS_BUZZER_CRITICAL,       // 只在严重报警时鸣响
+    SETTINGS_BUZZER_MUTE            // 静音，报警仍然上传
+} SettingsBuzzer_t;
+
+/**
+  * @brief  批量上传格式
+  */
+typedef enum {
+    SETTINGS_BATCH_OFF = 0,         // 逐点上传
+    SETTINGS_BATCH_VARINT,          // 批量上传，差值为varint
+    SETTINGS_BATCH_BITPACK          // 批量上传，差值按位压缩
+} SettingsBatch_t;
+
+/**
+  * @brief  卡尔曼滤波器噪声参数
+  */
+typedef struct {
+    float Q;                    // 过程噪声协方差
+    float R;                    // 测量噪声协方差
+} SettingsKalman_t;
+
+/**
+  * @brief  系统配置，各模块通过Settings_Get读取
+  */
+typedef struct {
+    uint32_t sample_period_ms;                  // 采样周期
+    uint32_t upload_interval_ms;                // 常规上传间隔
+    AlarmRule_t alarm[ALARM_CH_COUNT];          // 各通道报警规则
+    SettingsKalman_t kalman[SETTINGS_FILTER_COUNT];
+    char server_host[SETTINGS_HOST_SIZE];       // 如"117.72.118.76:3000"
+    char post_path[SETTINGS_PATH_SIZE];         // 如"/api/data"
+    uint8_t reserved[SETTINGS_RESERVED_SIZE];   // 不再使用，模块连接自身保存的热点
+    /* 版本2 */
+    uint32_t config_id;                         // 服务器下发的配置编号，随上传回报
+    uint8_t buzzer_mode;                        // SettingsBuzzer_t
+    /* 版本3，从4字节边界开始，旧记录末尾的填充字节不会覆盖 */
+    uint32_t summary_window_ms;                 // 汇总窗口，0表示逐点上传
+    /* 版本4 */
+    uint8_t batch_format;                       // SettingsBatch_t，汇总上传时不起作用
+} Settings_t;
+
+/**
+  * @brief  当前配置的来源
+  */
+typedef enum {
+    SETTINGS_SOURCE_DEFAULT = 0,    // 没有有效记录，使用编译时的默认值
+    SETTINGS_SOURCE_FLASH,          // Flash中当前版本的记录
+    SETTINGS_SOURCE_UPGRADED        // Flash中旧版本的记录，追加的字段取默认值
+} SettingsSource_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  从Flash载入配置
+  * @param  无
+  * @retval 无
+  * @note   须在读取配置的各模块初始化之前调用；调用前Settings_Get返回默认值
+  */
+void Settings_Init(void);
+
+/**
+  * @brief  获取当前配置
+  * @param  无
+  * @retval 配置指针，指向Flash中的记录或默认值，只读
+  */
+const Settings_t *Settings_Get(void);
+
+/**
+  * @brief  获取编译时的默认配置
+  * @param  无
+  * @retval 配置指针
+  */
+const Settings_t *Settings_GetDefault(void);
+
+/**
+  * @brief  检查配置是否合法
+  * @param  settings: 待检查的配置
+  * @retval 1:合法 0:有字段超出范围或字符串没有结束符
+  */
+uint8_t Settings_IsValid(const Settings_t *settings);
+
+/**
+  * @brief  保存配置
+  * @param  settings: 新配置
+  * @retval 1:成功（与当前配置相同时不写Flash） 0:配置不合法或写入失败
+  * @note   擦除一页约20ms，期间CPU停止取指；成功后Settings_Get立即返回新配置，
+  *          已按旧配置初始化的模块（如滤波器）在下次初始化时生效
+  */
+uint8_t Settings_Save(const Settings_t *settings);
+
+/**
+  * @brief  获取当前配置的来源
+  * @param  无
+  * @retval 来源
+  */
+SettingsSource_t Settings_GetSource(void);
+
+/**
+  * @brief  获取当前记录的写入序号
+  * @param  无
+  * @retval 序号，使用默认值时为0
+  */
+uint32_t Settings_GetSequence(void);
+
+#endif /* __SETTINGS_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
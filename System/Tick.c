@@ -0,0 +1,124 @@
+/**
+  ******************************************************************************
+  * @file    Tick.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   系统毫秒时基实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Tick.h"
+#include "Clock.h"
+#include "Watchdog.h"
+
+/* 私有变量 ------------------------------------------------------------------*/
+static volatile uint32_t tick_ms = 0;   // 毫秒计数，仅在TIM2中断中递增
+
+/**
+  * @brief  初始化系统毫秒时基
+  * @param  无
+  * @retval 无
+  * @note   TIM2挂在APB1上，预分频到1MHz后每1000个计数溢出一次；预分频值按
+  *          当前定时器时钟计算，72MHz档为72
+  */
+void Tick_Init(void)
+{
+    /* 开启TIM2时钟 */
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+    /* 时基配置：定时器时钟分频到1MHz，计满1000为1ms */
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure;
+    TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInitStructure.TIM_Period = 1000 - 1;
+    TIM_TimeBaseInitStructure.TIM_Prescaler = Clock_GetTimerClock(TIM2) / 1000000 - 1;
+    TIM_TimeBaseInitStructure.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseInitStructure);
+
+    /* 只有计数溢出产生更新中断，切换时钟时立即重装预分频不会多计1ms */
+    TIM_UpdateRequestConfig(TIM2, TIM_UpdateSource_Regular);
+
+    /* 清除初始化时产生的更新标志，避免立即进入一次中断 */
+    TIM_ClearFlag(TIM2, TIM_FLAG_Update);
+    TIM_ITConfig(TIM2, TIM_IT_Update, ENABLE);
+
+    /* 中断配置：优先级低于串口接收 */
+    NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+
+    NVIC_InitTypeDef NVIC_InitStructure;
+    NVIC_InitStructure.NVIC_IRQChannel = TIM2_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_Init(&NVIC_InitStructure);
+
+    TIM_Cmd(TIM2, ENABLE);
+}
+
+/**
+  * @brief  获取系统运行毫秒数
+  * @param  无
+  * @retval 自Tick_Init以来经过的毫秒数
+  * @note   32位读取在Cortex-M3上是原子操作，无需关中断
+  */
+uint32_t Tick_GetMs(void)
+{
+    return tick_ms;
+}
+
+/**
+  * @brief  计算自某一时刻起经过的毫秒数
+  * @param  since: 起始时刻
+  * @retval 经过的毫秒数
+  */
+uint32_t Tick_ElapsedMs(uint32_t since)
+{
+    return tick_ms - since;  // 无符号减法天然处理回绕
+}
+
+/**
+  * @brief  补上TIM2停走期间的毫秒数
+  * @param  ms: 补偿的毫秒数
+  * @retval 无
+  * @note   读改写期间关中断，避免与TIM2中断中的递增冲突
+  */
+void Tick_Compensate(uint32_t ms)
+{
+    __disable_irq();
+    tick_ms += ms;
+    __enable_irq();
+}
+
+/**
+  * @brief  系统时钟变化后重新计算预分频
+  * @param  无
+  * @retval 无
+  * @note   立即重装预分频会清零计数器，这里恢复原计数值，本毫秒内已走过的
+  *          部分不丢失
+  */
+void Tick_ClockUpdate(void)
+{
+    uint16_t count = TIM_GetCounter(TIM2);
+
+    TIM_PrescalerConfig(TIM2, Clock_GetTimerClock(TIM2) / 1000000 - 1, TIM_PSCReloadMode_Immediate);
+    TIM_SetCounter(TIM2, count);
+}
+
+/**
+  * @brief  TIM2中断处理函数
+  * @param  无
+  * @retval 无
+  */
+void TIM2_IRQHandler(void)
+{
+    if (TIM_GetITStatus(TIM2, TIM_IT_Update) != RESET)
+    {
+        tick_ms++;
+        TIM_ClearITPendingBit(TIM2, TIM_IT_Update);
+        Watchdog_Poll(tick_ms);
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
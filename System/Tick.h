@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    Tick.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   系统毫秒时基头文件
+  * @note    使用TIM2产生1ms更新中断，为超时判断、统计等提供单调递增的时间戳
+  *          SysTick仍由Delay模块用于忙等待延时，二者互不干扰
+  ******************************************************************************
+  */
+
+#ifndef __TICK_H
+#define __TICK_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化系统毫秒时基
+  * @param  无
+  * @retval 无
+  */
+void Tick_Init(void);
+
+/**
+  * @brief  获取系统运行毫秒数
+  * @param  无
+  * @retval 自Tick_Init以来经过的毫秒数（约49.7天回绕一次）
+  */
+uint32_t Tick_GetMs(void);
+
+/**
+  * @brief  计算自某一时刻起经过的毫秒数
+  * @param  since: 起始时刻（Tick_GetMs的返回值）
+  * @retval 经过的毫秒数，计数器回绕时结果仍然正确
+  */
+uint32_t Tick_ElapsedMs(uint32_t since);
+
+/**
+  * @brief  补上TIM2停走期间的毫秒数
+  * @param  ms: 补偿的毫秒数
+  * @retval 无
+  * @note   Stop模式下TIM2不计数，醒来后由Idle模块按RTC计数调用
+  */
+void Tick_Compensate(uint32_t ms);
+
+/**
+  * @brief  系统时钟变化后重新计算预分频
+  * @param  无
+  * @retval 无
+  * @note   由Clock模块在每次切换系统时钟后调用
+  */
+void Tick_ClockUpdate(void);
+
+#endif /* __TICK_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,256 @@
+/**
+  ******************************************************************************
+  * @file    TimeSync.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   时间同步实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "TimeSync.h"
+#include "Idle.h"
+#include "Checkpoint.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define TIMESYNC_BKP_EPOCH_HI   BKP_DR10    // Unix时间高16位，0表示未同步
+#define TIMESYNC_HI_MS          65536000ULL // DR10的一个单位
+#define TIMESYNC_RENORM_TICKS   0x80000000UL
+#define TIMESYNC_DRIFT_MAX_PPM  500000      // LSI标称40kHz，实际30~60kHz
+#define TIMESYNC_DRIFT_MIN_MS   600000      // 直接校正时距上次校正不足此值不估计漂移
+
+/* 私有变量 ------------------------------------------------------------------*/
+static TimeSyncStats_t stats;
+static uint32_t set_ticks;                  // 上次校正后的RTC计数，漂移修正的起点
+static uint8_t set_valid = 0;               // 本次运行中校正过
+static double sum_t, sum_o, sum_tt, sum_ot; // 窗口内偏差对时间的拟合
+static uint32_t window_n;
+
+/**
+  * @brief  读取RTC中未经漂移修正的时间
+  * @param  ms: 存放Unix时间(ms)
+  * @param  ticks: 存放RTC计数
+  * @retval 1:成功 0:未同步
+  */
+static uint8_t TimeSync_ReadRaw(uint64_t *ms, uint32_t *ticks)
+{
+    uint32_t hz = Idle_GetRtcHz();
+    uint16_t hi;
+
+    if (!TIMESYNC_ENABLE || hz == 0)
+        return 0;
+    hi = BKP_ReadBackupRegister(TIMESYNC_BKP_EPOCH_HI);
+    if (hi == 0)
+        return 0;
+
+    RTC_WaitForSynchro();
+    *ticks = RTC_GetCounter();
+    *ms = hi * TIMESYNC_HI_MS + (uint64_t)*ticks * 1000 / hz;
+    return 1;
+}
+
+/**
+  * @brief  上次校正以来RTC走过的毫秒数
+  */
+static uint32_t TimeSync_SinceSet(uint32_t ticks)
+{
+    return (uint32_t)((uint64_t)(ticks - set_ticks) * 1000 / Idle_GetRtcHz());
+}
+
+/**
+  * @brief  按漂移估计修正上次校正以来走过的时间
+  */
+static void TimeSync_Correct(uint64_t *ms, uint32_t ticks)
+{
+    if (set_valid && stats.drift_ppm != 0)
+        *ms -= (int64_t)TimeSync_SinceSet(ticks) * stats.drift_ppm / 1000000;
+}
+
+/**
+  * @brief  把时间写入RTC，并以此为新的拟合起点
+  * @param  ms: Unix时间(ms)
+  * @retval 无
+  * @note   先写计数后写DR10；两次写之间复位时时间错一段，下一次同步时校正
+  */
+static void TimeSync_Set(uint64_t ms)
+{
+    uint32_t hz = Idle_GetRtcHz();
+    uint16_t hi = (uint16_t)(ms / TIMESYNC_HI_MS);
+    uint32_t ticks = (uint32_t)((ms - hi * TIMESYNC_HI_MS) * hz / 1000);
+    uint32_t old_ticks;
+
+    RTC_WaitForSynchro();
+    old_ticks = RTC_GetCounter();
+    RTC_WaitForLastTask();
+    RTC_SetCounter(ticks);
+    RTC_WaitForLastTask();
+    BKP_WriteBackupRegister(TIMESYNC_BKP_EPOCH_HI, hi);
+
+    Checkpoint_Shift((int32_t)(ticks / hz - old_ticks / hz));
+
+    set_ticks = ticks;
+    set_valid = 1;
+    sum_t = sum_o = sum_tt = sum_ot = 0;
+    window_n = 0;
+}
+
+/**
+  * @brief  按拟合的斜率更新漂移估计
+  * @param  residual_ppm: 偏差随时间增长的斜率，正值表示RTC仍然偏慢
+  * @retval 无
+  */
+static void TimeSync_UpdateDrift(double residual_ppm)
+{
+    double drift = stats.drift_ppm - residual_ppm;
+
+    if (drift > TIMESYNC_DRIFT_MAX_PPM)
+        drift = TIMESYNC_DRIFT_MAX_PPM;
+    else if (drift < -TIMESYNC_DRIFT_MAX_PPM)
+        drift = -TIMESYNC_DRIFT_MAX_PPM;
+    stats.drift_ppm = (int32_t)(drift >= 0 ? drift + 0.5 : drift - 0.5);
+}
+
+/**
+  * @brief  处理一次服务器时间
+  * @param  epoch: 应答Date头中的Unix时间(s)，0表示没有
+  * @param  rtt_ms: 从发出请求到收到应答的毫秒数
+  * @retval 无
+  */
+void TimeSync_OnServerTime(uint32_t epoch, uint32_t rtt_ms)
+{
+    uint64_t now, server;
+    uint32_t ticks;
+    double t, offset, a, b, d;
+
+    if (!TIMESYNC_ENABLE || epoch == 0 || Idle_GetRtcHz() == 0)
+        return;
+    stats.samples++;
+
+    /* Date在服务器处理请求时取值并截断到秒，按往返对称估计此刻的服务器时间 */
+    server = (uint64_t)epoch * 1000 + 500 + rtt_ms / 2;
+
+    if (!set_valid || !TimeSync_ReadRaw(&now, &ticks))
+    {
+        /* 首次同步，或复位后漂移修正的起点未知 */
+        stats.last_offset_ms = 0;
+        stats.steps++;
+        TimeSync_Set(server);
+        return;
+    }
+
+    TimeSync_Correct(&now, ticks);
+    t = TimeSync_SinceSet(ticks);
+    offset = (double)(int64_t)(server - now);
+
+    /* 偏差过大时直接校正，距上次校正足够久时按单点估计漂移 */
+    if (offset > TIMESYNC_STEP_MS || offset < -TIMESYNC_STEP_MS)
+    {
+        if (t >= TIMESYNC_DRIFT_MIN_MS)
+            TimeSync_UpdateDrift(offset * 1e6 / t);
+        stats.last_offset_ms = (int32_t)offset;
+        stats.steps++;
+        TimeSync_Set(server);
+        return;
+    }
+
+    sum_t += t;
+    sum_o += offset;
+    sum_tt += t * t;
+    sum_ot += t * offset;
+    window_n++;
+    if (t < TIMESYNC_WINDOW_MS)
+        return;
+
+    /* 偏差 = a + b*t；截距吸收Date截断和上次校正的误差，斜率是剩余的漂移 */
+    d = window_n * sum_tt - sum_t * sum_t;
+    b = (window_n >= 2 && d > 0) ? (window_n * sum_ot - sum_t * sum_o) / d : 0;
+    a = (sum_o - b * sum_t) / window_n;
+    TimeSync_UpdateDrift(b * 1e6);
+
+    stats.last_offset_ms = (int32_t)(a + b * t);
+    stats.adjusts++;
+    TimeSync_Set(now + (int64_t)stats.last_offset_ms);
+}
+
+/**
+  * @brief  是否已同步
+  * @param  无
+  * @retval 1:RTC中的时间有效 0:未同步或RTC未启用
+  */
+uint8_t TimeSync_IsSynced(void)
+{
+    uint64_t ms;
+    uint32_t ticks;
+
+    return TimeSync_ReadRaw(&ms, &ticks);
+}
+
+/**
+  * @brief  读取当前Unix时间(ms)
+  * @param  ms: 存放毫秒数
+  * @retval 1:成功 0:未同步
+  * @note   按漂移估计修正上次校正以来走过的时间
+  */
+uint8_t TimeSync_GetEpochMs(uint64_t *ms)
+{
+    uint32_t ticks;
+
+    if (!TimeSync_ReadRaw(ms, &ticks))
+        return 0;
+    TimeSync_Correct(ms, ticks);
+    return 1;
+}
+
+/**
+  * @brief  读取当前Unix时间(s)
+  * @param  无
+  * @retval 秒数，未同步时为0
+  */
+uint32_t TimeSync_GetEpoch(void)
+{
+    uint64_t ms;
+
+    return TimeSync_GetEpochMs(&ms) ? (uint32_t)(ms / 1000) : 0;
+}
+
+/**
+  * @brief  RTC计数过半时把整段的秒数移入DR10，在主循环中调用
+  * @param  无
+  * @retval 无
+  * @note   移走的是65536s的整数倍，计数折算的秒数低16位不变
+  */
+void TimeSync_Poll(void)
+{
+    uint32_t hz = Idle_GetRtcHz();
+    uint32_t ticks, units;
+    uint16_t hi;
+
+    if (!TIMESYNC_ENABLE || hz == 0)
+        return;
+    hi = BKP_ReadBackupRegister(TIMESYNC_BKP_EPOCH_HI);
+    RTC_WaitForSynchro();
+    ticks = RTC_GetCounter();
+    if (hi == 0 || ticks < TIMESYNC_RENORM_TICKS)
+        return;
+
+    units = ticks / hz / 65536;
+    RTC_WaitForLastTask();
+    RTC_SetCounter(ticks - units * 65536 * hz);
+    RTC_WaitForLastTask();
+    BKP_WriteBackupRegister(TIMESYNC_BKP_EPOCH_HI, (uint16_t)(hi + units));
+    set_ticks -= units * 65536 * hz;
+}
+
+/**
+  * @brief  获取同步统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const TimeSyncStats_t *TimeSync_GetStats(void)
+{
+    return &stats;
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,89 @@
+/**
+  ******************************************************************************
+  * @file    TimeSync.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   时间同步头文件
+  * @note    墙上时间保存在RTC中：备份寄存器DR10存Unix时间（秒）的高16位，
+  *          RTC计数存其余部分，即(秒数低16位 x 计数频率 + 毫秒折算的计数)。
+  *          RTC在备份域中，看门狗复位或带VBAT电池掉电后时间仍然有效，DR10为0
+  *          表示从未同步。计数折算的秒数低16位与Unix时间一致，Checkpoint保存的
+  *          时刻因此也是墙上时间
+  *
+  *          时间来源是每次上传应答中的HTTP Date头，只有秒分辨率，按截断取
+  *          该秒的中点，并按往返耗时的一半补偿传输延迟。偏差超过
+  *          TIMESYNC_STEP_MS时立即校正；否则在TIMESYNC_WINDOW_MS窗口内对偏差
+  *          随时间的变化做直线拟合，窗口结束时按拟合结果校正RTC，斜率计入
+  *          漂移估计，此后读取时间时按漂移估计修正（LSI可偏差百分之几十，
+  *          LSE约20ppm）。漂移估计只在RAM中，复位后重新学习
+  ******************************************************************************
+  */
+
+#ifndef __TIMESYNC_H
+#define __TIMESYNC_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  同步统计
+  */
+typedef struct {
+    uint32_t samples;           // 收到的服务器时间个数
+    uint32_t steps;             // 偏差过大或首次同步时的直接校正次数
+    uint32_t adjusts;           // 窗口结束时的拟合校正次数
+    int32_t  last_offset_ms;    // 最近一次校正量，正值表示RTC慢了
+    int32_t  drift_ppm;         // RTC快于实际时间的百万分率估计
+} TimeSyncStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  处理一次服务器时间
+  * @param  epoch: 应答Date头中的Unix时间(s)，0表示没有
+  * @param  rtt_ms: 从发出请求到收到应答的毫秒数
+  * @retval 无
+  * @note   RTC未启用时忽略。校正时改写RTC计数，Checkpoint保存的时刻随之平移
+  */
+void TimeSync_OnServerTime(uint32_t epoch, uint32_t rtt_ms);
+
+/**
+  * @brief  是否已同步
+  * @param  无
+  * @retval 1:RTC中的时间有效 0:未同步或RTC未启用
+  */
+uint8_t TimeSync_IsSynced(void);
+
+/**
+  * @brief  读取当前Unix时间(ms)
+  * @param  ms: 存放毫秒数
+  * @retval 1:成功 0:未同步
+  */
+uint8_t TimeSync_GetEpochMs(uint64_t *ms);
+
+/**
+  * @brief  读取当前Unix时间(s)
+  * @param  无
+  * @retval 秒数，未同步时为0
+  */
+uint32_t TimeSync_GetEpoch(void);
+
+/**
+  * @brief  RTC计数过半时把整段的秒数移入DR10，在主循环中调用
+  * @param  无
+  * @retval 无
+  * @note   长期收不到服务器时间时避免约48天后计数回绕
+  */
+void TimeSync_Poll(void);
+
+/**
+  * @brief  获取同步统计
+  * @param  无
+  * @retval 统计数据指针
+  */
+const TimeSyncStats_t *TimeSync_GetStats(void);
+
+#endif /* __TIMESYNC_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
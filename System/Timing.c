@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file    Timing.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主循环定时健康监测实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Timing.h"
+#include "Settings.h"
+#include "Config/config.h"
+#include <string.h>
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define TIMING_LINEAR       16      // 逐毫秒的格数
+#define TIMING_SUB_BITS     3       // 每个2的幂区间再分2^3格
+
+/* 私有变量 ------------------------------------------------------------------*/
+static TimingStats_t timing_stats[TIMING_TASK_COUNT];
+static uint16_t timing_hist[TIMING_TASK_COUNT][TIMING_BUCKETS];
+static uint32_t last_sample_ms = 0;     // 上次采样开始时刻
+static uint8_t  have_sample = 0;        // 是否已有上次采样
+
+static const uint32_t timing_deadlines[TIMING_TASK_COUNT] = {
+    TIMING_JITTER_LIMIT_MS,
+    TIMING_SENSOR_DEADLINE_MS,
+    TIMING_UPLOAD_DEADLINE_MS,
+    0                               // 整个循环：配置的采样周期，初始化时填入
+};
+
+static const char *const task_names[TIMING_TASK_COUNT] = {
+    "period", "sensor", "upload", "loop"
+};
+
+/**
+  * @brief  计算数值所在的直方图格
+  * @param  value: 毫秒数
+  * @retval 格序号
+  */
+static uint8_t Timing_Bucket(uint32_t value)
+{
+    uint8_t e = 4;
+
+    if (value < TIMING_LINEAR)
+        return (uint8_t)value;
+    if (value > 0xFFFF)
+        return TIMING_BUCKETS - 1;
+
+    /* e为最高位所在位置，其下3位决定区间内的格 */
+    while (value >> (e + 1))
+        e++;
+    return (uint8_t)(TIMING_LINEAR + ((e - 4) << TIMING_SUB_BITS) +
+                     ((value >> (e - TIMING_SUB_BITS)) & ((1 << TIMING_SUB_BITS) - 1)));
+}
+
+/**
+  * @brief  计算直方图格的上界
+  * @param  bucket: 格序号
+  * @retval 该格能容纳的最大毫秒数
+  */
+static uint32_t Timing_BucketUpper(uint8_t bucket)
+{
+    uint8_t k, shift;
+
+    if (bucket < TIMING_LINEAR)
+        return bucket;
+    k = bucket - TIMING_LINEAR;
+    shift = (k >> TIMING_SUB_BITS) + 4 - TIMING_SUB_BITS;
+    return ((uint32_t)((1 << TIMING_SUB_BITS) + (k & ((1 << TIMING_SUB_BITS) - 1)) + 1) << shift) - 1;
+}
+
+/**
+  * @brief  清除全部统计
+  * @param  无
+  * @retval 无
+  */
+void Timing_Init(void)
+{
+    TimingTask_t task;
+
+    memset(timing_stats, 0, sizeof(timing_stats));
+    memset(timing_hist, 0, sizeof(timing_hist));
+    for (task = TIMING_TASK_PERIOD; task < TIMING_TASK_COUNT; task++)
+        timing_stats[task].deadline_ms = timing_deadlines[task];
+    timing_stats[TIMING_TASK_LOOP].deadline_ms = Settings_Get()->sample_period_ms;
+    have_sample = 0;
+}
+
+/**
+  * @brief  标记一次采样开始
+  * @param  now_ms: 开始时刻
+  * @retval 无
+  */
+void Timing_SampleStart(uint32_t now_ms)
+{
+    uint32_t period = now_ms - last_sample_ms;
+    uint32_t nominal = Settings_Get()->sample_period_ms;
+
+    if (have_sample)
+        Timing_Record(TIMING_TASK_PERIOD, period > nominal ? period - nominal : nominal - period);
+    last_sample_ms = now_ms;
+
+    /* 采样周期可由服务器在运行中修改 */
+    timing_stats[TIMING_TASK_LOOP].deadline_ms = nominal;
+    have_sample = 1;
+}
+
+/**
+  * @brief  记录一次任务耗时
+  * @param  task: 任务
+  * @param  elapsed_ms: 耗时(ms)
+  * @retval 无
+  */
+void Timing_Record(TimingTask_t task, uint32_t elapsed_ms)
+{
+    TimingStats_t *s;
+    uint16_t *hist;
+    uint8_t i;
+
+    if (task >= TIMING_TASK_COUNT)
+        return;
+    s = &timing_stats[task];
+    hist = timing_hist[task];
+
+    s->count++;
+    s->last_ms = elapsed_ms;
+    if (elapsed_ms > s->max_ms)
+        s->max_ms = elapsed_ms;
+    if (elapsed_ms > s->deadline_ms)
+        s->overruns++;
+
+    /* 计数将溢出时整体减半，分位数仍然有效 */
+    i = Timing_Bucket(elapsed_ms);
+    if (hist[i] == 0xFFFF)
+    {
+        uint8_t j;
+        for (j = 0; j < TIMING_BUCKETS; j++)
+            hist[j] >>= 1;
+    }
+    hist[i]++;
+}
+
+/**
+  * @brief  获取任务统计
+  * @param  task: 任务
+  * @retval 统计数据指针，任务无效时返回NULL
+  */
+const TimingStats_t *Timing_GetStats(TimingTask_t task)
+{
+    if (task >= TIMING_TASK_COUNT)
+        return NULL;
+    return &timing_stats[task];
+}
+
+/**
+  * @brief  按直方图求分位数
+  * @param  task: 任务
+  * @param  percent: 分位(1~100)
+  * @retval 该分位所在格的上界(ms)
+  */
+uint32_t Timing_GetPercentile(TimingTask_t task, uint8_t percent)
+{
+    const uint16_t *hist;
+    uint32_t total = 0;
+    uint32_t target, seen = 0;
+    uint8_t i;
+
+    if (task >= TIMING_TASK_COUNT)
+        return 0;
+    hist = timing_hist[task];
+    for (i = 0; i < TIMING_BUCKETS; i++)
+        total += hist[i];
+    if (total == 0)
+        return 0;
+
+    target = (total * percent + 99) / 100;
+    for (i = 0; i < TIMING_BUCKETS; i++)
+    {
+        seen += hist[i];
+        if (seen >= target)
+            break;
+    }
+    if (i == TIMING_BUCKETS || Timing_BucketUpper(i) > timing_stats[task].max_ms)
+        return timing_stats[task].max_ms;
+    return Timing_BucketUpper(i);
+}
+
+/**
+  * @brief  获取任务名称
+  * @param  task: 任务
+  * @retval 名称字符串
+  */
+const char *Timing_GetTaskName(TimingTask_t task)
+{
+    if (task >= TIMING_TASK_COUNT)
+        return "?";
+    return task_names[task];
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file    Timing.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   主循环定时健康监测头文件
+  * @note    记录实际采样周期相对标称值的偏差以及各任务的耗时，按任务统计
+  *          超过截止时间的次数，并用对数直方图给出P50/P99/最大值
+  *
+  *          直方图：0~15ms逐毫秒一格，之后每个2的幂区间分8格，分辨率约12.5%，
+  *          最大记录65535ms；某格计数将溢出时全部减半，统计偏向近期
+  ******************************************************************************
+  */
+
+#ifndef __TIMING_H
+#define __TIMING_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define TIMING_BUCKETS      112     // 直方图格数
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  监测的任务
+  */
+typedef enum {
+    TIMING_TASK_PERIOD = 0,     // 采样周期抖动：|实际周期 - 标称周期|
+    TIMING_TASK_SENSOR,         // 采集、滤波、报警判定和显示
+    TIMING_TASK_UPLOAD,         // 一次上传，含失败后的网络恢复
+    TIMING_TASK_LOOP,           // 一次主循环的全部处理
+    TIMING_TASK_COUNT
+} TimingTask_t;
+
+/**
+  * @brief  任务统计
+  */
+typedef struct {
+    uint32_t count;             // 记录次数
+    uint32_t overruns;          // 超过截止时间的次数
+    uint32_t last_ms;           // 最近一次
+    uint32_t max_ms;            // 最大值
+    uint32_t deadline_ms;       // 截止时间
+} TimingStats_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  清除全部统计
+  * @param  无
+  * @retval 无
+  */
+void Timing_Init(void);
+
+/**
+  * @brief  标记一次采样开始
+  * @param  now_ms: 开始时刻（Tick_GetMs）
+  * @retval 无
+  * @note   与上次采样开始的间隔减去配置的采样周期的绝对值计入TIMING_TASK_PERIOD
+  */
+void Timing_SampleStart(uint32_t now_ms);
+
+/**
+  * @brief  记录一次任务耗时
+  * @param  task: 任务
+  * @param  elapsed_ms: 耗时(ms)
+  * @retval 无
+  */
+void Timing_Record(TimingTask_t task, uint32_t elapsed_ms);
+
+/**
+  * @brief  获取任务统计
+  * @param  task: 任务
+  * @retval 统计数据指针，任务无效时返回NULL
+  */
+const TimingStats_t *Timing_GetStats(TimingTask_t task);
+
+/**
+  * @brief  按直方图求分位数
+  * @param  task: 任务
+  * @param  percent: 分位(1~100)
+  * @retval 该分位所在格的上界(ms)，不超过记录到的最大值；无记录时返回0
+  */
+uint32_t Timing_GetPercentile(TimingTask_t task, uint8_t percent);
+
+/**
+  * @brief  获取任务名称
+  * @param  task: 任务
+  * @retval 名称字符串
+  */
+const char *Timing_GetTaskName(TimingTask_t task);
+
+#endif /* __TIMING_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,304 @@
+/**
+  ******************************************************************************
+  * @file    Trace.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   传感器采集轨迹记录实现
+  * @note    采集路径只把编码好的记录写入环形缓冲区，由USART3发送空中断逐字节
+  *          送出，不阻塞主循环；缓冲区放不下整条记录时丢弃该条并计数
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Trace.h"
+#include "Tick.h"
+#include "RingBuffer.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define TRACE_BUFFER_SIZE   512         // 发送缓冲区大小，必须为2的幂
+#define TRACE_BAUDRATE      115200      // 每秒一组记录约40字节，留足启动时的突发余量
+
+/* 私有变量 ------------------------------------------------------------------*/
+static uint8_t Trace_TxStorage[TRACE_BUFFER_SIZE];
+static RingBuffer_t Trace_TxBuffer;     // 主循环写入、发送中断读取
+static uint8_t trace_ready = 0;         // 已初始化且允许输出
+static uint32_t trace_dropped = 0;      // 丢弃的记录数
+
+/**
+  * @brief  计算记录校验值
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @retval CRC-8
+  */
+uint8_t Trace_Crc8(const uint8_t *data, uint16_t len)
+{
+    uint8_t crc = 0;
+    uint8_t i;
+
+    while (len--)
+    {
+        crc ^= *data++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+  * @brief  编码一条记录并放入发送缓冲区
+  * @param  type: 记录类型
+  * @param  payload: 负载
+  * @param  len: 负载字节数
+  * @retval 无
+  */
+static void Trace_Write(TraceRecord_t type, const uint8_t *payload, uint8_t len)
+{
+    uint8_t record[TRACE_HEADER_SIZE + TRACE_MAX_PAYLOAD + 1];
+    uint32_t now = Tick_GetMs();
+    uint16_t size = TRACE_HEADER_SIZE + len + 1;
+    uint8_t i;
+
+    if (!trace_ready || len > TRACE_MAX_PAYLOAD)
+        return;
+
+    /* 整条记录放不下时丢弃，避免接收端收到半条记录 */
+    if (TRACE_BUFFER_SIZE - RingBuffer_Count(&Trace_TxBuffer) < size)
+    {
+        trace_dropped++;
+        return;
+    }
+
+    record[0] = TRACE_SYNC;
+    record[1] = (uint8_t)type;
+    record[2] = len;
+    record[3] = (uint8_t)now;
+    record[4] = (uint8_t)(now >> 8);
+    record[5] = (uint8_t)(now >> 16);
+    record[6] = (uint8_t)(now >> 24);
+    for (i = 0; i < len; i++)
+        record[TRACE_HEADER_SIZE + i] = payload[i];
+    record[size - 1] = Trace_Crc8(&record[1], size - 2);
+
+    RingBuffer_Write(&Trace_TxBuffer, record, size);
+
+    /* 发送空中断在缓冲区取空后自行关闭，这里重新打开 */
+    USART_ITConfig(USART3, USART_IT_TXE, ENABLE);
+}
+
+/**
+  * @brief  配置USART3参数
+  * @param  无
+  * @retval 无
+  * @note   波特率分频按当前PCLK1计算，切换系统时钟后须重新调用
+  */
+static void Trace_UsartConfig(void)
+{
+    USART_InitTypeDef USART_InitStructure;
+    USART_InitStructure.USART_BaudRate = TRACE_BAUDRATE;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Tx;
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_Init(USART3, &USART_InitStructure);
+}
+
+/**
+  * @brief  初始化轨迹输出并写入启动记录
+  * @param  无
+  * @retval 无
+  * @note   须在Tick_Init之后、传感器初始化之前调用，初始化阶段的采集也会被记录
+  */
+void Trace_Init(void)
+{
+    uint8_t version = TRACE_VERSION;
+
+    if (!TRACE_ENABLE)
+        return;
+
+    RingBuffer_Init(&Trace_TxBuffer, Trace_TxStorage, TRACE_BUFFER_SIZE);
+
+    /* 开启外设时钟 */
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART3, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+
+    /* PB10: USART3_TX，复用推挽输出；不使用接收 */
+    GPIO_InitTypeDef GPIO_InitStructure;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_10;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    Trace_UsartConfig();
+
+    /* 中断配置：优先级最低，不影响ESP8266接收和毫秒时基 */
+    NVIC_InitTypeDef NVIC_InitStructure;
+    NVIC_InitStructure.NVIC_IRQChannel = USART3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 3;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_Init(&NVIC_InitStructure);
+
+    USART_Cmd(USART3, ENABLE);
+
+    trace_ready = 1;
+    Trace_Write(TRACE_REC_BOOT, &version, 1);
+}
+
+/**
+  * @brief  记录一次DHT11读取
+  * @param  status: 读取结果
+  * @param  raw: 原始数据
+  * @retval 无
+  */
+void Trace_DhtFrame(uint8_t status, const uint8_t raw[5])
+{
+    uint8_t payload[6];
+    uint8_t i;
+
+    payload[0] = status;
+    for (i = 0; i < 5; i++)
+        payload[1 + i] = raw[i];
+    Trace_Write(TRACE_REC_DHT, payload, sizeof(payload));
+}
+
+/**
+  * @brief  记录一次ADC读取
+  * @param  channel: ADC通道
+  * @param  value: 过采样的转换结果之和
+  * @retval 无
+  */
+void Trace_Adc(uint8_t channel, uint16_t value)
+{
+    uint8_t payload[3];
+
+    payload[0] = channel;
+    payload[1] = (uint8_t)value;
+    payload[2] = (uint8_t)(value >> 8);
+    Trace_Write(TRACE_REC_ADC, payload, sizeof(payload));
+}
+
+/**
+  * @brief  记录一次处理结果
+  * @param  temp: 温度(0.1℃)
+  * @param  humi: 湿度(0.1%RH)
+  * @param  light: 光照
+  * @param  alarm_mask: 报警位图
+  * @retval 无
+  */
+void Trace_Output(int16_t temp, int16_t humi, uint16_t light, uint8_t alarm_mask)
+{
+    uint8_t payload[7];
+
+    payload[0] = (uint8_t)temp;
+    payload[1] = (uint8_t)((uint16_t)temp >> 8);
+    payload[2] = (uint8_t)humi;
+    payload[3] = (uint8_t)((uint16_t)humi >> 8);
+    payload[4] = (uint8_t)light;
+    payload[5] = (uint8_t)(light >> 8);
+    payload[6] = alarm_mask;
+    Trace_Write(TRACE_REC_OUTPUT, payload, sizeof(payload));
+}
+
+/**
+  * @brief  按小端写入32位值
+  * @param  buf: 目标地址
+  * @param  value: 数值
+  * @retval 无
+  */
+static void Trace_PutU32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = (uint8_t)value;
+    buf[1] = (uint8_t)(value >> 8);
+    buf[2] = (uint8_t)(value >> 16);
+    buf[3] = (uint8_t)(value >> 24);
+}
+
+/**
+  * @brief  记录一个分区的耗时统计
+  * @param  zone: 分区编号
+  * @param  count: 测量次数
+  * @param  min: 最短周期数
+  * @param  avg: 平均周期数
+  * @param  max: 最长周期数
+  * @retval 无
+  */
+void Trace_Profile(uint8_t zone, uint32_t count, uint32_t min, uint32_t avg, uint32_t max)
+{
+    uint8_t payload[17];
+
+    payload[0] = zone;
+    Trace_PutU32(&payload[1], count);
+    Trace_PutU32(&payload[5], min);
+    Trace_PutU32(&payload[9], avg);
+    Trace_PutU32(&payload[13], max);
+    Trace_Write(TRACE_REC_PROF, payload, sizeof(payload));
+}
+
+/**
+  * @brief  记录一个启动阶段完成
+  * @param  stage: 阶段编号
+  * @retval 无
+  */
+void Trace_BootStage(uint8_t stage)
+{
+    Trace_Write(TRACE_REC_STAGE, &stage, 1);
+}
+
+/**
+  * @brief  查询轨迹输出是否已全部发完
+  * @param  无
+  * @retval 1:已发完 0:仍在发送
+  */
+uint8_t Trace_IsIdle(void)
+{
+    if (!trace_ready)
+        return 1;
+    return USART_GetFlagStatus(USART3, USART_FLAG_TC) == SET &&
+           RingBuffer_Count(&Trace_TxBuffer) == 0;
+}
+
+/**
+  * @brief  系统时钟变化后重新计算波特率分频
+  * @param  无
+  * @retval 无
+  */
+void Trace_ClockUpdate(void)
+{
+    if (!trace_ready)
+        return;
+    Trace_UsartConfig();
+}
+
+/**
+  * @brief  获取丢弃的记录数
+  * @param  无
+  * @retval 丢弃的记录数
+  */
+uint32_t Trace_GetDropped(void)
+{
+    return trace_dropped;
+}
+
+/**
+  * @brief  USART3中断处理函数
+  * @param  无
+  * @retval 无
+  * @note   每次发送空送出一个字节，缓冲区取空后关闭发送空中断
+  */
+void USART3_IRQHandler(void)
+{
+    uint8_t data;
+
+    if (USART_GetITStatus(USART3, USART_IT_TXE) != RESET)
+    {
+        if (RingBuffer_Get(&Trace_TxBuffer, &data))
+            USART_SendData(USART3, data);
+        else
+            USART_ITConfig(USART3, USART_IT_TXE, DISABLE);
+    }
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
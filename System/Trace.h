@@ -0,0 +1,133 @@
+/**
+  ******************************************************************************
+  * @file    Trace.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   传感器采集轨迹记录头文件
+  * @note    把DHT11原始帧、ADC计数值和滤波/报警输出按时间戳编码成紧凑的
+  *          二进制记录，经USART3(PB10，仅发送)输出，供主机回放和比较
+  *
+  *          记录格式（多字节字段均为小端）：
+  *            偏移  长度  内容
+  *            0     1     同步字 TRACE_SYNC
+  *            1     1     记录类型 TRACE_REC_xxx
+  *            2     1     负载长度N
+  *            3     4     时间戳，Tick_GetMs()
+  *            7     N     负载
+  *            7+N   1     CRC-8（多项式0x07，初值0），覆盖类型到负载末尾
+  ******************************************************************************
+  */
+
+#ifndef __TRACE_H
+#define __TRACE_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 格式定义 ------------------------------------------------------------------*/
+#define TRACE_SYNC          0xA5    // 记录起始同步字
+#define TRACE_VERSION       2       // 格式版本，写在启动记录中；版本2起ADC记录为过采样之和
+#define TRACE_HEADER_SIZE   7       // 同步字+类型+长度+时间戳
+#define TRACE_MAX_PAYLOAD   24      // 单条记录负载上限
+
+/**
+  * @brief  记录类型
+  */
+typedef enum {
+    TRACE_REC_BOOT   = 0x01,    // 启动：版本(1)
+    TRACE_REC_STAGE  = 0x02,    // 启动阶段完成：阶段(1)，见Boot.h，时刻即记录时间戳
+    TRACE_REC_DHT    = 0x10,    // DHT11读取：结果(1) + 原始5字节，结果取DHT_OK/DHT_ERROR/DHT_TIMEOUT
+    TRACE_REC_ADC    = 0x11,    // ADC读取：通道(1) + 16次转换结果之和(2)
+    TRACE_REC_OUTPUT = 0x20,    // 处理结果：温度(2,0.1℃) + 湿度(2,0.1%) + 光照(2) + 报警位图(1)
+    TRACE_REC_PROF   = 0x21     // 耗时统计：分区(1) + 次数(4) + 最短(4) + 平均(4) + 最长(4)，单位为CPU周期
+} TraceRecord_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  初始化轨迹输出并写入启动记录
+  * @param  无
+  * @retval 无
+  * @note   config.h中TRACE_ENABLE为0时不占用USART3，其余接口均为空操作
+  */
+void Trace_Init(void);
+
+/**
+  * @brief  记录一次DHT11读取
+  * @param  status: DHT_OK / DHT_ERROR(校验失败) / DHT_TIMEOUT(无应答)
+  * @param  raw: 收到的5字节原始数据
+  * @retval 无
+  */
+void Trace_DhtFrame(uint8_t status, const uint8_t raw[5]);
+
+/**
+  * @brief  记录一次ADC读取
+  * @param  channel: ADC通道
+  * @param  value: 过采样的16次12位转换结果之和
+  * @retval 无
+  */
+void Trace_Adc(uint8_t channel, uint16_t value);
+
+/**
+  * @brief  记录一次处理结果
+  * @param  temp: 滤波后温度(0.1℃)
+  * @param  humi: 滤波后湿度(0.1%RH)
+  * @param  light: 滤波后光照
+  * @param  alarm_mask: 报警位图
+  * @retval 无
+  */
+void Trace_Output(int16_t temp, int16_t humi, uint16_t light, uint8_t alarm_mask);
+
+/**
+  * @brief  记录一个分区的耗时统计
+  * @param  zone: 分区编号，见Prof.h
+  * @param  count: 测量次数
+  * @param  min: 最短周期数
+  * @param  avg: 平均周期数
+  * @param  max: 最长周期数
+  * @retval 无
+  */
+void Trace_Profile(uint8_t zone, uint32_t count, uint32_t min, uint32_t avg, uint32_t max);
+
+/**
+  * @brief  记录一个启动阶段完成
+  * @param  stage: 阶段编号，见Boot.h
+  * @retval 无
+  */
+void Trace_BootStage(uint8_t stage);
+
+/**
+  * @brief  查询轨迹输出是否已全部发完
+  * @param  无
+  * @retval 1:缓冲区为空且最后一个字节已移出 0:仍在发送
+  * @note   进入Stop前调用，Stop会截断正在发送的字节
+  */
+uint8_t Trace_IsIdle(void);
+
+/**
+  * @brief  系统时钟变化后重新计算波特率分频
+  * @param  无
+  * @retval 无
+  * @note   由Clock模块在每次切换系统时钟后调用
+  */
+void Trace_ClockUpdate(void);
+
+/**
+  * @brief  获取因发送缓冲区满而丢弃的记录数
+  * @param  无
+  * @retval 丢弃的记录数
+  */
+uint32_t Trace_GetDropped(void);
+
+/**
+  * @brief  计算记录校验值
+  * @param  data: 数据
+  * @param  len: 字节数
+  * @retval CRC-8
+  * @note   主机回放工具使用同一实现
+  */
+uint8_t Trace_Crc8(const uint8_t *data, uint16_t len);
+
+#endif /* __TRACE_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
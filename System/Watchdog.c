@@ -0,0 +1,263 @@
+/**
+  ******************************************************************************
+  * @file    Watchdog.c
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   独立看门狗任务监督实现
+  ******************************************************************************
+  */
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "Watchdog.h"
+#include "Tick.h"
+#include "Settings.h"
+#include "Config/config.h"
+
+/* 私有宏定义 ----------------------------------------------------------------*/
+#define WATCHDOG_BKP_MAGIC      0x5744      // "WD"，备份寄存器有效标记
+#define WATCHDOG_BKP_VALID      BKP_DR1
+#define WATCHDOG_BKP_TASK       BKP_DR2
+#define WATCHDOG_BKP_COUNT      BKP_DR3
+#define WATCHDOG_LSI_HZ         40000       // LSI标称值，实际30~60kHz
+#define WATCHDOG_PRESCALER_DIV  64
+
+/* 私有变量 ------------------------------------------------------------------*/
+/* 各任务一次执行的时间预算(ms)，按最坏情况留余量：上传含模块唤醒入网、
+   建立连接和应答超时；网络恢复最坏为复位模块后重新入网；初始化不等待入网
+   和LSE起振，只含OLED上电等待；等待另加配置的采样周期 */
+static const uint32_t task_budgets[WATCHDOG_TASK_COUNT] = {
+    5000,                           // INIT
+    2000,                           // LOOP
+    1000,                           // DHT
+    100,                            // ADC
+    1000,                           // OLED
+    30000,                          // UPLOAD
+    1000,                           // IDLE
+    60000                           // RECOVER
+};
+
+static const char *const task_names[WATCHDOG_TASK_COUNT + 1] = {
+    "init", "loop", "dht", "adc", "oled", "upload", "idle", "recover", "none"
+};
+
+static volatile WatchdogTask_t current = WATCHDOG_TASK_INIT;
+static volatile uint32_t task_start_ms = 0;     // 当前任务开始的时刻
+static uint32_t last_feed_ms = 0;               // 上次喂狗检查的时刻
+static uint8_t started = 0;                     // IWDG已启动
+static uint8_t stable = 0;                      // 已稳定运行，连续复位计数已清零
+static WatchdogReset_t reset_cause = WATCHDOG_RESET_POWER;
+static WatchdogTask_t last_task = WATCHDOG_TASK_COUNT;
+static uint16_t reset_count = 0;
+
+/**
+  * @brief  读取并清除RCC复位标志
+  * @param  无
+  * @retval 复位原因
+  * @note   内部复位同时拉低NRST，PINRST总会置位，须先判断其他标志
+  */
+static WatchdogReset_t Watchdog_ReadResetCause(void)
+{
+    WatchdogReset_t cause;
+
+    if (RCC_GetFlagStatus(RCC_FLAG_IWDGRST) == SET)
+        cause = WATCHDOG_RESET_IWDG;
+    else if (RCC_GetFlagStatus(RCC_FLAG_LPWRRST) == SET)
+        cause = WATCHDOG_RESET_LOWPOWER;
+    else if (RCC_GetFlagStatus(RCC_FLAG_SFTRST) == SET)
+        cause = WATCHDOG_RESET_SOFTWARE;
+    else if (RCC_GetFlagStatus(RCC_FLAG_PORRST) == SET)
+        cause = WATCHDOG_RESET_POWER;
+    else
+        cause = WATCHDOG_RESET_PIN;
+
+    RCC_ClearFlag();
+    return cause;
+}
+
+/**
+  * @brief  判断当前任务是否在预算内
+  * @param  now_ms: 当前毫秒数
+  * @retval 1:健康 0:超时
+  */
+static uint8_t Watchdog_IsHealthy(uint32_t now_ms)
+{
+    WatchdogTask_t task = current;
+    uint32_t budget = task_budgets[task];
+
+    if (task == WATCHDOG_TASK_IDLE)
+        budget += Settings_Get()->sample_period_ms;
+    return now_ms - task_start_ms <= budget;
+}
+
+/**
+  * @brief  读取复位原因并启动独立看门狗
+  * @param  无
+  * @retval 无
+  */
+void Watchdog_Init(void)
+{
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR | RCC_APB1Periph_BKP, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    reset_cause = Watchdog_ReadResetCause();
+
+    /* 掉电后备份寄存器被清零，上一次的任务记录无效 */
+    if (BKP_ReadBackupRegister(WATCHDOG_BKP_VALID) == WATCHDOG_BKP_MAGIC)
+    {
+        last_task = (WatchdogTask_t)BKP_ReadBackupRegister(WATCHDOG_BKP_TASK);
+        if (last_task > WATCHDOG_TASK_COUNT)
+            last_task = WATCHDOG_TASK_COUNT;
+        reset_count = BKP_ReadBackupRegister(WATCHDOG_BKP_COUNT);
+    }
+    else
+    {
+        last_task = WATCHDOG_TASK_COUNT;
+        reset_count = 0;
+        BKP_WriteBackupRegister(WATCHDOG_BKP_VALID, WATCHDOG_BKP_MAGIC);
+    }
+
+    if (reset_cause == WATCHDOG_RESET_IWDG)
+        reset_count++;
+    BKP_WriteBackupRegister(WATCHDOG_BKP_COUNT, reset_count);
+
+    Watchdog_Begin(WATCHDOG_TASK_INIT);
+    stable = 0;
+
+    if (!WATCHDOG_ENABLE)
+        return;
+
+    /* 40kHz/64 = 625Hz，重装值最大4095，超时上限约6.5s */
+    IWDG_WriteAccessCmd(IWDG_WriteAccess_Enable);
+    IWDG_SetPrescaler(IWDG_Prescaler_64);
+    IWDG_SetReload(WATCHDOG_TIMEOUT_MS * (WATCHDOG_LSI_HZ / WATCHDOG_PRESCALER_DIV) / 1000);
+    IWDG_ReloadCounter();
+    IWDG_Enable();
+    started = 1;
+}
+
+/**
+  * @brief  登记当前任务
+  * @param  task: 开始执行的任务
+  * @retval 无
+  * @note   起始时刻和任务须一起更新，否则中断可能用旧时刻判定新任务超时
+  */
+void Watchdog_Begin(WatchdogTask_t task)
+{
+    __disable_irq();
+    task_start_ms = Tick_GetMs();
+    current = task;
+    __enable_irq();
+
+    BKP_WriteBackupRegister(WATCHDOG_BKP_TASK, task);
+}
+
+/**
+  * @brief  当前任务完成签到
+  * @param  无
+  * @retval 无
+  */
+void Watchdog_CheckIn(void)
+{
+    Watchdog_Begin(WATCHDOG_TASK_LOOP);
+}
+
+/**
+  * @brief  当前任务未超出预算时喂狗
+  * @param  无
+  * @retval 无
+  */
+void Watchdog_Feed(void)
+{
+    if (started && Watchdog_IsHealthy(Tick_GetMs()))
+        IWDG_ReloadCounter();
+}
+
+/**
+  * @brief  监督检查
+  * @param  now_ms: 当前毫秒数
+  * @retval 无
+  * @note   超时时只是不喂狗，当前任务已记入备份寄存器，复位后可查
+  */
+void Watchdog_Poll(uint32_t now_ms)
+{
+    /* Stop醒来后毫秒数会跳变，按间隔而不是整倍数判断 */
+    if (!started || now_ms - last_feed_ms < WATCHDOG_FEED_MS)
+        return;
+    last_feed_ms = now_ms;
+
+    if (Watchdog_IsHealthy(now_ms))
+        IWDG_ReloadCounter();
+
+    /* 稳定运行一段时间后认为故障已排除 */
+    if (!stable && now_ms >= WATCHDOG_STABLE_MS)
+    {
+        stable = 1;
+        BKP_WriteBackupRegister(WATCHDOG_BKP_COUNT, 0);
+    }
+}
+
+/**
+  * @brief  获取本次启动的复位原因
+  * @param  无
+  * @retval 复位原因
+  */
+WatchdogReset_t Watchdog_GetResetCause(void)
+{
+    return reset_cause;
+}
+
+/**
+  * @brief  获取复位前正在执行的任务
+  * @param  无
+  * @retval 任务
+  */
+WatchdogTask_t Watchdog_GetLastTask(void)
+{
+    return last_task;
+}
+
+/**
+  * @brief  获取连续看门狗复位次数
+  * @param  无
+  * @retval 次数
+  */
+uint16_t Watchdog_GetResetCount(void)
+{
+    return reset_count;
+}
+
+/**
+  * @brief  本次启动是否由看门狗复位引起
+  * @param  无
+  * @retval 1:是 0:否
+  */
+uint8_t Watchdog_IsDegraded(void)
+{
+    return reset_cause == WATCHDOG_RESET_IWDG;
+}
+
+/**
+  * @brief  判断任务是否因反复卡死而暂停
+  * @param  task: 任务
+  * @retval 1:暂停 0:照常执行
+  */
+uint8_t Watchdog_IsSuspended(WatchdogTask_t task)
+{
+    return WATCHDOG_SUSPEND_RESETS && !stable && last_task == task &&
+           reset_count >= WATCHDOG_SUSPEND_RESETS;
+}
+
+/**
+  * @brief  获取任务名称
+  * @param  task: 任务
+  * @retval 名称字符串
+  */
+const char *Watchdog_GetTaskName(WatchdogTask_t task)
+{
+    if (task > WATCHDOG_TASK_COUNT)
+        task = WATCHDOG_TASK_COUNT;
+    return task_names[task];
+}
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file    Watchdog.h
+  * @author  农业大棚监控小组
+  * @version V1.0
+  * @date    2026-10-18
+  * @brief   独立看门狗任务监督头文件
+  * @note    主循环的每一段（采集、显示、上传、低功耗等待等）开始时登记为当前
+  *          任务，结束时签到。TIM2时基中断每WATCHDOG_FEED_MS检查一次：当前任务
+  *          未超出各自的时间预算才喂狗，任一任务卡死（如ADC校准不结束）
+  *          时停止喂狗，由IWDG复位。同一时刻只监督一个当前任务：各任务在主循环
+  *          中顺序执行，签到只是把当前任务交回LOOP，卡死的发现时间即该任务的
+  *          预算。耗时差别大的阶段（如上传中的网络恢复）单独登记为任务，各用
+  *          各的预算
+  *
+  *          备份寄存器在复位后保留：DR1为有效标记，DR2为当前任务，DR3为连续
+  *          看门狗复位次数。下次启动时据此报告复位原因和卡死的任务；同一个
+  *          采集任务连续卡死WATCHDOG_SUSPEND_RESETS次后，稳定运行前跳过该任务
+  *          （见Watchdog_IsSuspended）。DR4~DR9由Checkpoint使用，DR10由TimeSync使用
+  *
+  *          IWDG在Stop模式下继续计数，进入Stop前须喂狗，且Stop时长不能超过
+  *          WATCHDOG_TIMEOUT_MS
+  ******************************************************************************
+  */
+
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+/* 包含头文件 ----------------------------------------------------------------*/
+#include "stm32f10x.h"
+
+/* 宏定义 --------------------------------------------------------------------*/
+#define WATCHDOG_FEED_MS    250     // 喂狗检查间隔(ms)
+
+/* 类型定义 ------------------------------------------------------------------*/
+/**
+  * @brief  受监督的任务
+  */
+typedef enum {
+    WATCHDOG_TASK_INIT = 0,     // 上电初始化，入网在后台进行
+    WATCHDOG_TASK_LOOP,         // 主循环中各任务之间的部分
+    WATCHDOG_TASK_DHT,          // DHT11读取与滤波
+    WATCHDOG_TASK_ADC,          // 光照ADC采样
+    WATCHDOG_TASK_OLED,         // 显示刷新
+    WATCHDOG_TASK_UPLOAD,       // 一次上传，发送到收到应答
+    WATCHDOG_TASK_IDLE,         // 低功耗等待
+    WATCHDOG_TASK_RECOVER,      // 断路后的分级网络恢复
+    WATCHDOG_TASK_COUNT         // 作为任务值时表示未知（备份寄存器无效）
+} WatchdogTask_t;
+
+/**
+  * @brief  复位原因
+  */
+typedef enum {
+    WATCHDOG_RESET_POWER = 0,   // 上电或掉电复位
+    WATCHDOG_RESET_PIN,         // NRST引脚
+    WATCHDOG_RESET_SOFTWARE,    // NVIC_SystemReset
+    WATCHDOG_RESET_IWDG,        // 独立看门狗
+    WATCHDOG_RESET_LOWPOWER     // 低功耗管理复位
+} WatchdogReset_t;
+
+/* 函数声明 ------------------------------------------------------------------*/
+/**
+  * @brief  读取复位原因并启动独立看门狗
+  * @param  无
+  * @retval 无
+  * @note   须在Tick_Init之后调用，返回时当前任务为WATCHDOG_TASK_INIT
+  */
+void Watchdog_Init(void);
+
+/**
+  * @brief  登记当前任务
+  * @param  task: 开始执行的任务
+  * @retval 无
+  * @note   替换原来的当前任务并重新开始计时
+  */
+void Watchdog_Begin(WatchdogTask_t task);
+
+/**
+  * @brief  当前任务完成签到
+  * @param  无
+  * @retval 无
+  * @note   当前任务回到WATCHDOG_TASK_LOOP
+  */
+void Watchdog_CheckIn(void);
+
+/**
+  * @brief  当前任务未超出预算时喂狗
+  * @param  无
+  * @retval 无
+  * @note   进入Stop前调用
+  */
+void Watchdog_Feed(void);
+
+/**
+  * @brief  监督检查，由TIM2时基中断每毫秒调用
+  * @param  now_ms: 当前毫秒数
+  * @retval 无
+  */
+void Watchdog_Poll(uint32_t now_ms);
+
+/**
+  * @brief  获取本次启动的复位原因
+  * @param  无
+  * @retval 复位原因
+  */
+WatchdogReset_t Watchdog_GetResetCause(void);
+
+/**
+  * @brief  获取复位前正在执行的任务
+  * @param  无
+  * @retval 任务，备份寄存器无效（如掉电）时为WATCHDOG_TASK_COUNT
+  */
+WatchdogTask_t Watchdog_GetLastTask(void);
+
+/**
+  * @brief  获取连续看门狗复位次数
+  * @param  无
+  * @retval 次数，稳定运行WATCHDOG_STABLE_MS后清零
+  */
+uint16_t Watchdog_GetResetCount(void);
+
+/**
+  * @brief  本次启动是否由看门狗复位引起
+  * @param  无
+  * @retval 1:是 0:否
+  */
+uint8_t Watchdog_IsDegraded(void);
+
+/**
+  * @brief  判断任务是否因反复卡死而暂停
+  * @param  task: 任务
+  * @retval 1:暂停，调用方跳过该任务并沿用旧数据 0:照常执行
+  * @note   复位前卡死的正是该任务且连续看门狗复位达到WATCHDOG_SUSPEND_RESETS次
+  *          时暂停，稳定运行WATCHDOG_STABLE_MS后恢复执行；仍然卡死时重新计数
+  */
+uint8_t Watchdog_IsSuspended(WatchdogTask_t task);
+
+/**
+  * @brief  获取任务名称
+  * @param  task: 任务
+  * @retval 名称字符串
+  */
+const char *Watchdog_GetTaskName(WatchdogTask_t task);
+
+#endif /* __WATCHDOG_H */
+
+/* 文件结束 -----------------------------------------------------------------*/
@@ -17,58 +17,238 @@
 #include "light.h"
 #include "esp8266.h"
 #include "buzzer.h"
+#include "alarm.h"
+#include "tick.h"
+#include "trace.h"
+#include "prof.h"
+#include "timing.h"
+#include "idle.h"
+#include "clock.h"
+#include "watchdog.h"
+#include "checkpoint.h"
+#include "boot.h"
+#include "settings.h"
+#include "remote.h"
+#include "timesync.h"
+#include "retry.h"
+#include "history.h"
+#include "aggregate.h"
+#include "batch.h"
+#include "event.h"
 #include "../Config/config.h"
 #include <stdio.h>
+#include <stdarg.h>
 
 /* 全局变量 ----------------------------------------------------------------*/
 static uint8_t dht_error_count = 0;                // 传感器错误计数
-static uint8_t network_error_count = 0;            // 网络错误计数
-static uint32_t last_successful_time = 0;          // 上次成功上传时间
+static uint8_t batch_upload_pending = 0;           // 队列中还有一次没放下的采样或待补传的时段，待立即上传
+static uint8_t latency_reported = 0;               // 本次上传回报的事件延迟数
+static uint32_t next_sample_ms = 0;                // 下一次采样的计划时刻
+static uint32_t next_upload_ms = 0;                // 下一次常规上传的计划时刻
+static uint8_t batch_packed[BATCH_PACKED_SIZE];    // 批量上传和补传共用的压缩数据
+
+/* 补传时从历史数据中取格的位置，由App_FormatBackfill设置 */
+static HistoryTier_t backfill_tier;                // 分辨率
+static int32_t backfill_age;                       // 下一个取出的格
+static int32_t backfill_stop;                      // 最后一个取出的格
+static uint32_t backfill_end;                      // 已取出部分的终点（上电后的秒数）
+static uint32_t backfill_offset;                   // Unix时间减上电后的秒数
+
+/* 私有函数 ----------------------------------------------------------------*/
+/**
+  * @brief  浮点数转换为0.1单位的定点数（四舍五入）
+  * @param  value: 浮点数值
+  * @retval 定点数值
+  */
+static int16_t App_ToTenths(double value)
+{
+    return (int16_t)(value >= 0 ? value * 10 + 0.5 : value * 10 - 0.5);
+}
+
+/**
+  * @brief  获取通道报警标记
+  * @param  ch: 报警通道
+  * @retval 显示在行尾的4字符标记，未报警时为空串
+  */
+static const char *App_AlarmTag(AlarmChannel_t ch)
+{
+    uint8_t mask = Alarm_GetActiveMask();
+    
+    if (mask & ALARM_BIT(ch, ALARM_DIR_HIGH))
+        return " HI!";
+    if (mask & ALARM_BIT(ch, ALARM_DIR_LOW))
+        return " LO!";
+    return "";
+}
+
+/**
+  * @brief  根据报警严重等级更新蜂鸣器
+  * @param  无
+  * @retval 无
+  * @note   提示级报警只显示和上报，不鸣叫；配置的蜂鸣器模式可进一步
+  *          限制为只在严重报警时鸣叫或完全静音
+  */
+static void App_UpdateBuzzer(void)
+{
+    uint8_t mode = Settings_Get()->buzzer_mode;
+    
+    switch (Alarm_GetSeverity())
+    {
+        case ALARM_SEVERITY_CRITICAL:
+            Buzzer_Alert(mode == SETTINGS_BUZZER_MUTE ? BUZZER_ALERT_NONE : BUZZER_ALERT_CRITICAL);
+            break;
+        
+        case ALARM_SEVERITY_WARNING:
+            Buzzer_Alert(mode == SETTINGS_BUZZER_NORMAL ? BUZZER_ALERT_WARNING : BUZZER_ALERT_NONE);
+            break;
+        
+        default:
+            Buzzer_Alert(BUZZER_ALERT_NONE);
+            break;
+    }
+}
 
 /**
   * @brief  系统初始化
   * @param  无
   * @retval 无
-  * @note   初始化所有外设模块，包括OLED、传感器、WiFi等
+  * @note   初始化所有外设模块，包括OLED、传感器、WiFi等。按阶段启动，
+  *          只完成第一次采样必需的部分：RTC和网络在后台就绪，DHT11滤波器
+  *          由第一次读数初始化，各阶段耗时见Boot.h
   */
 void App_Init(void)
 {
-    /* 初始化OLED显示 */
-    OLED_Init();
-    OLED_ShowString(1, 1, "System Init...");
+    /* 时钟档位管理，初始化期间保持72MHz */
+    Clock_Init();
+
+    /* 初始化毫秒时基 */
+    Tick_Init();
+
+    /* 读取复位原因，启动看门狗监督，初始化本身也计入预算 */
+    Watchdog_Init();
+
+    /* 初始化采集轨迹输出，传感器初始化阶段的读数也会被记录 */
+    Trace_Init();
+
+    /* 开启DWT周期计数器，统计各分区耗时 */
+    Prof_Init();
+
+    /* 载入Flash中的配置，后面各模块的阈值、滤波参数和网络地址都从这里读取 */
+    Settings_Init();
+    Boot_Mark(BOOT_STAGE_CORE);
+
+    /* 初始化RTC闹钟，采样间隙进入低功耗；RTC在复位后继续计数，
+       同时用于判断保存的滤波状态是否过旧 */
+    Idle_Init();
 
     /* 初始化光照传感器 */
     Light_Init();
     
-    /* 初始化DHT11卡尔曼滤波器 */
-    DHT_Filter_Init();
+    /* 恢复复位前保存的滤波状态；没有可用的状态时DHT11滤波器由第一次读数初始化 */
+    Checkpoint_Restore();
+    Boot_Mark(BOOT_STAGE_SENSORS);
 
-    /* 初始化ESP8266 */
-    ESP8266_Init();
+    /* 初始化ESP8266，不等待入网：模块断电重启后在后台连接，入网完成前
+       跳过上传，采集不受影响 */
+    ESP8266_InitAsync();
+    
+    /* 重试退避的随机数按芯片唯一ID播种 */
+    Retry_Init();
 
-    /* 初始化蜂鸣器 */
+    /* 初始化蜂鸣器和报警规则 */
     Buzzer_Init();
+    Alarm_Init();
 
-    /* 延时确保传感器稳定 */
-    Delay_ms(100);
+    /* 上电时OLED须等电源稳定后才能初始化，前面各阶段的耗时计入等待；
+       其他复位时OLED一直上电 */
+    if (Watchdog_GetResetCause() == WATCHDOG_RESET_POWER && Tick_GetMs() < OLED_POWER_ON_MS)
+        Delay_ms(OLED_POWER_ON_MS - Tick_GetMs());
+
+    /* 初始化OLED显示，初始化时已清屏 */
+    OLED_Init();
+    if (Watchdog_IsDegraded())
+    {
+        char msg[OLED_LINE_WIDTH + 1];
+        sprintf(msg, "WDT %-6s x%-3u", Watchdog_GetTaskName(Watchdog_GetLastTask()),
+                Watchdog_GetResetCount());
+        OLED_ShowString(4, 1, msg);
+    }
+    Boot_Mark(BOOT_STAGE_DISPLAY);
+
+    /* 上电后DHT11须经过不稳定期才能应答，期间先显示光照值，等待结束后再做
+       第一次采样；其他复位时DHT11一直上电 */
+    if (Watchdog_GetResetCause() == WATCHDOG_RESET_POWER && Tick_GetMs() < DHT_POWER_ON_MS)
+    {
+        if (!Watchdog_IsSuspended(WATCHDOG_TASK_ADC))
+        {
+            char msg[OLED_LINE_WIDTH + 1];
+            Watchdog_Begin(WATCHDOG_TASK_ADC);
+            sprintf(msg, "Lux:%4d", Light_Get());
+            Watchdog_Begin(WATCHDOG_TASK_INIT);
+            OLED_ShowString(1, 1, msg);
+        }
+        Delay_ms(DHT_POWER_ON_MS - Tick_GetMs());
+    }
 
-    /* 清屏显示 */
-    OLED_Clear();
+    /* 定时监测从第一次采样开始计 */
+    Timing_Init();
+    next_sample_ms = Tick_GetMs();
+    next_upload_ms = next_sample_ms;
+    Watchdog_CheckIn();
+    Boot_Mark(BOOT_STAGE_INIT);
 }
 
 /**
   * @brief  主循环处理函数
   * @param  无
   * @retval 无
-  * @note   循环处理传感器数据采集、显示和上传
+  * @note   循环处理传感器数据采集、显示和上传；按配置的采样周期以固定
+  *          节拍等待，处理耗时不累加到采样周期上
   */
 void App_MainLoop(void)
 {
+    uint32_t start = Tick_GetMs();
+    uint32_t period = Settings_Get()->sample_period_ms;
+    int32_t slack;
+
+    Timing_SampleStart(start);
+
+    /* 采集阶段以DHT11的微秒级轮询为主，36MHz足够 */
+    Clock_SetProfile(CLOCK_PROFILE_HALF);
+
     /* 处理传感器数据 - 数据采集和处理已封装在传感器驱动层 */
     App_ProcessSensorData();
 
-    /* 系统延时 */
-    Delay_ms(MAIN_LOOP_DELAY_MS);
+    /* 到期时输出各分区耗时统计 */
+    Prof_Poll();
+
+    /* 定期把滤波状态存入备份寄存器 */
+    Checkpoint_Poll();
+    
+    /* 长期未同步时整理RTC计数，避免回绕 */
+    TimeSync_Poll();
+
+    Timing_Record(TIMING_TASK_LOOP, Tick_ElapsedMs(start));
+
+    /* 模块断电时按入网耗时提前唤醒，下一次上传时模块已经入网 */
+    if (ESP8266_GetPowerState() == ESP8266_POWER_OFF &&
+        (int32_t)(next_upload_ms - Tick_GetMs()) <=
+        (int32_t)(ESP8266_GetWakeLeadMs() + MODEM_WAKE_MARGIN_MS + period))
+    {
+        ESP8266_PowerOnAsync();
+    }
+
+    /* 低功耗等到下一个采样时刻；已经错过时从当前时刻重新对齐，不连续补采 */
+    next_sample_ms += period;
+    slack = (int32_t)(next_sample_ms - Tick_GetMs());
+    if (slack > 0)
+    {
+        Watchdog_Begin(WATCHDOG_TASK_IDLE);
+        Idle_Wait(slack);
+        Watchdog_CheckIn();
+    }
+    else
+        next_sample_ms = Tick_GetMs();
 }
 
 /**
@@ -80,12 +260,34 @@ void App_MainLoop(void)
 void App_ProcessSensorData(void)
 {
     DHT_FilteredData_t filtered_data;
+    int16_t alarm_values[ALARM_CH_COUNT];
+    char valueStr[OLED_LINE_WIDTH + 1];
     char tempDisplayStr[OLED_LINE_WIDTH + 1];
     char humiDisplayStr[OLED_LINE_WIDTH + 1];
     char lightDisplayStr[OLED_LINE_WIDTH + 1];
+    uint32_t start = Tick_GetMs();
+    uint32_t timestamp = TimeSync_GetEpoch();   // 采样时刻，上传时随数据发送
+    uint8_t dht_hold = Watchdog_IsSuspended(WATCHDOG_TASK_DHT);
+    uint8_t adc_hold = Watchdog_IsSuspended(WATCHDOG_TASK_ADC);
+    KalmanFilter_t temp_state, humi_state, light_state;
+    int dht_ok;
+    uint16_t light;
     
-    /* 获取处理后的温湿度数据 */
-    if (!DHT_GetProcessedData(&filtered_data)) {
+    /* 获取处理后的温湿度数据；反复卡死的任务暂停执行，沿用复位前保存的或
+       启动时读到的滤波值，没有可用的值时按传感器错误处理 */
+    if (dht_hold)
+    {
+        dht_ok = DHT_Filter_GetState(&temp_state, &humi_state);
+        filtered_data.temperature = temp_state.x;
+        filtered_data.humidity = humi_state.x;
+    }
+    else
+    {
+        Watchdog_Begin(WATCHDOG_TASK_DHT);
+        dht_ok = DHT_GetProcessedData(&filtered_data);
+        Watchdog_CheckIn();
+    }
+    if (!dht_ok) {
         App_HandleSensorError();
         return;
     }
@@ -94,23 +296,78 @@ void App_ProcessSensorData(void)
     dht_error_count = 0;
     
     /* 获取光照值 */
-    uint16_t light = Light_Get();
+    if (adc_hold)
+    {
+        Light_Filter_GetState(&light_state);
+        light = (uint16_t)(light_state.x + 0.5);
+    }
+    else
+    {
+        Watchdog_Begin(WATCHDOG_TASK_ADC);
+        light = Light_Get();
+        Watchdog_CheckIn();
+    }
+    
+    /* 新采样到达后判定报警，状态变化时更新蜂鸣器，产生或解除记为事件优先上报 */
+    alarm_values[ALARM_CH_TEMP] = App_ToTenths(filtered_data.temperature);
+    alarm_values[ALARM_CH_HUMI] = App_ToTenths(filtered_data.humidity);
+    alarm_values[ALARM_CH_LIGHT] = (int16_t)(light * 10);
+    
+    uint8_t changed = Alarm_Evaluate(alarm_values, Tick_GetMs());
+    if (changed)
+    {
+        App_UpdateBuzzer();
+        Event_OnAlarm(changed, alarm_values, timestamp, start);
+    }
+    
+    /* 记入历史数据，各分辨率的汇总随写入更新 */
+    History_Add(alarm_values, start);
+    
+    /* 汇总上传模式下累计窗口统计量，批量上传模式下放入待上传队列，
+       光照按原值保存，差值更小 */
+    if (Settings_Get()->summary_window_ms)
+    {
+        Aggregate_Add(alarm_values, start, timestamp);
+    }
+    else if (Settings_Get()->batch_format != SETTINGS_BATCH_OFF)
+    {
+        int16_t batch_values[ALARM_CH_COUNT] = {
+            alarm_values[ALARM_CH_TEMP], alarm_values[ALARM_CH_HUMI], (int16_t)light
+        };
+        Batch_Add(timestamp, batch_values);
+    }
     
-    /* 格式化显示字符串 */
-    sprintf(tempDisplayStr, "T:%.1lfC", filtered_data.temperature);
-    sprintf(humiDisplayStr, "H:%.1lf%%", filtered_data.humidity);
-    sprintf(lightDisplayStr, "Lux:%4d", light);
+    /* 滤波和报警判定结果记入采集轨迹，回放时与新算法的输出逐条比较 */
+    Trace_Output(alarm_values[ALARM_CH_TEMP], alarm_values[ALARM_CH_HUMI], light,
+                 Alarm_GetActiveMask());
+    
+    /* 显示刷新和拼包上传是CPU密集的突发，全速执行后尽早回到低功耗等待 */
+    Clock_SetProfile(CLOCK_PROFILE_FULL);
+    
+    /* 格式化显示字符串，报警通道在行尾标注，沿用旧值的通道标注hold */
+    sprintf(valueStr, "T:%.1lfC", filtered_data.temperature);
+    sprintf(tempDisplayStr, "%-12s%4s", valueStr, dht_hold ? "hold" : App_AlarmTag(ALARM_CH_TEMP));
+    sprintf(valueStr, "H:%.1lf%%", filtered_data.humidity);
+    sprintf(humiDisplayStr, "%-12s%4s", valueStr, dht_hold ? "hold" : App_AlarmTag(ALARM_CH_HUMI));
+    sprintf(valueStr, "Lux:%4d", light);
+    sprintf(lightDisplayStr, "%-12s%4s", valueStr, adc_hold ? "hold" : App_AlarmTag(ALARM_CH_LIGHT));
     
     /* 更新OLED显示 */
+    Watchdog_Begin(WATCHDOG_TASK_OLED);
+    PROF_BEGIN(PROF_ZONE_OLED);
     OLED_ShowString(1, 1, lightDisplayStr);
     OLED_ShowString(2, 1, tempDisplayStr);
     OLED_ShowString(3, 1, humiDisplayStr);
+    PROF_END(PROF_ZONE_OLED);
+    Watchdog_CheckIn();
+    Boot_Mark(BOOT_STAGE_FIRST_SAMPLE);
     
-    /* 根据滤波后的传感器数据控制蜂鸣器报警 */
-    Buzzer_Control(light, (int)filtered_data.temperature, (int)filtered_data.humidity);
+    Timing_Record(TIMING_TASK_SENSOR, Tick_ElapsedMs(start));
     
     /* 上传数据 */
-    App_UploadData(filtered_data.temperature, filtered_data.humidity, light);
+    Watchdog_Begin(WATCHDOG_TASK_UPLOAD);
+    App_UploadData(filtered_data.temperature, filtered_data.humidity, light, timestamp);
+    Watchdog_CheckIn();
 }
 
 /**
@@ -139,64 +396,479 @@ void App_HandleSensorError(void)
     }
 }
 
+/**
+  * @brief  在输出末尾追加格式化文本
+  * @param  out: 输出缓冲区
+  * @param  size: 缓冲区大小
+  * @param  n: 已有的长度
+  * @param  format: 格式字符串
+  * @retval 追加后的长度，放不下时截断为size - 1
+  */
+static int App_Append(char *out, int size, int n, const char *format, ...)
+{
+    va_list args;
+    int len;
+    
+    if (n >= size - 1)
+        return size - 1;
+    va_start(args, format);
+    len = vsnprintf(out + n, size - n, format, args);
+    va_end(args);
+    if (len < 0)
+        return n;
+    return (len < size - n) ? n + len : size - 1;
+}
+
+/**
+  * @brief  拼接上传JSON末尾的运行状态
+  * @param  out: 输出位置
+  * @param  size: 剩余空间
+  * @retval 字符串长度
+  */
+static int App_FormatStatus(char *out, int size)
+{
+    int n = 0;
+    uint8_t i;
+    
+    /* 已确认事件的延迟，[编号, ms]；上传成功后移除 */
+    latency_reported = Event_GetLatencyCount();
+    if (latency_reported > 0)
+    {
+        n = App_Append(out, size, n, "\"acked\": [");
+        for (i = 0; i < latency_reported; i++)
+            n = App_Append(out, size, n, "%s[%u, %u]", i ? ", " : "",
+                           Event_GetLatency(i)->id, Event_GetLatency(i)->latency_ms);
+        n = App_Append(out, size, n, "], ");
+    }
+    
+    return App_Append(out, size, n,
+                      "\"alarm\": %d, "
+                      "\"jitter\": {\"p50\": %lu, \"p99\": %lu, \"max\": %lu}, \"overrun\": [%lu, %lu, %lu, %lu], "
+                      "\"idle\": [%u, %u], \"radio\": %lu, \"reset\": [%u, %u, %u], \"cfg\": %lu}",
+                      Alarm_GetActiveMask(),
+                      (unsigned long)Timing_GetPercentile(TIMING_TASK_PERIOD, 50),
+                      (unsigned long)Timing_GetPercentile(TIMING_TASK_PERIOD, 99),
+                      (unsigned long)Timing_GetStats(TIMING_TASK_PERIOD)->max_ms,
+                      (unsigned long)Timing_GetStats(TIMING_TASK_PERIOD)->overruns,
+                      (unsigned long)Timing_GetStats(TIMING_TASK_SENSOR)->overruns,
+                      (unsigned long)Timing_GetStats(TIMING_TASK_UPLOAD)->overruns,
+                      (unsigned long)Timing_GetStats(TIMING_TASK_LOOP)->overruns,
+                      Idle_GetPercent(IDLE_MODE_SLEEP), Idle_GetPercent(IDLE_MODE_STOP),
+                      (unsigned long)(ESP8266_GetPowerStats()->on_ms_last_hour / 1000),
+                      Watchdog_GetResetCause(), Watchdog_GetLastTask(), Watchdog_GetResetCount(),
+                      (unsigned long)Settings_Get()->config_id);
+}
+
+/**
+  * @brief  拼接上传的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  temperature: 温度数据
+  * @param  humidity: 湿度数据
+  * @param  light: 光照数据
+  * @param  timestamp: 采样时的Unix时间(s)，未同步时为0
+  * @retval 字符串长度
+  */
+int App_FormatPayload(char *json, float temperature, float humidity, uint16_t light,
+                      uint32_t timestamp)
+{
+    int n = App_Append(json, APP_PAYLOAD_SIZE, 0,
+                       "{\"ts\": %lu, \"temperature\": %.1f, \"humidity\": %.1f, \"light\": %d, ",
+                       (unsigned long)timestamp, temperature, humidity, light);
+    
+    return n + App_FormatStatus(json + n, APP_PAYLOAD_SIZE - n);
+}
+
+/**
+  * @brief  拼接上传的窗口汇总
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  window: 窗口统计量
+  * @retval 字符串长度
+  * @note   定点数在这里才换算为小数：均值为0.1单位的Q16，方差为其平方的Q16
+  */
+int App_FormatSummary(char *json, const AggregateWindow_t *window)
+{
+    static const char *const names[ALARM_CH_COUNT] = { "temperature", "humidity", "light" };
+    int n, ch;
+    
+    n = App_Append(json, APP_PAYLOAD_SIZE, 0, "{\"ts\": %lu, \"window\": %lu, \"n\": %lu, ",
+                   (unsigned long)window->epoch, (unsigned long)((window->length_ms + 500) / 1000),
+                   (unsigned long)window->ch[0].count);
+    for (ch = 0; ch < ALARM_CH_COUNT; ch++)
+    {
+        const Aggregate_t *a = &window->ch[ch];
+        n = App_Append(json, APP_PAYLOAD_SIZE, n,
+                       "\"%s\": {\"min\": %.1f, \"max\": %.1f, \"mean\": %.2f, \"var\": %.3f, "
+                       "\"last\": %.1f}, ",
+                       names[ch], a->min / 10.0, a->max / 10.0, Aggregate_GetMean(a) / 655360.0,
+                       (double)Aggregate_GetVariance(a) / 6553600.0, a->last / 10.0);
+    }
+    
+    return n + App_FormatStatus(json + n, APP_PAYLOAD_SIZE - n);
+}
+
+/**
+  * @brief  拼接batch_packed中的压缩数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  count: 采样数
+  * @param  res: 补传的格宽(s)，0表示逐个采样
+  * @param  bytes: 压缩后的字节数
+  * @retval 字符串长度
+  */
+static int App_FormatPacked(char *json, uint16_t count, uint16_t res, int bytes)
+{
+    int n, len;
+    
+    n = App_Append(json, APP_PAYLOAD_SIZE, 0, "{\"n\": %u, ", count);
+    if (res)
+        n = App_Append(json, APP_PAYLOAD_SIZE, n, "\"res\": %u, ", res);
+    n = App_Append(json, APP_PAYLOAD_SIZE, n, "\"batch\": \"");
+    len = Batch_Base64(json + n, APP_PAYLOAD_SIZE - n, batch_packed, bytes);
+    if (len > 0)
+        n += len;
+    n = App_Append(json, APP_PAYLOAD_SIZE, n, "\", ");
+    
+    return n + App_FormatStatus(json + n, APP_PAYLOAD_SIZE - n);
+}
+
+/**
+  * @brief  按时间顺序取出补传的格，跳过空格
+  * @param  sample: 存放格的平均值，时间戳为格起点
+  * @retval 1:取出一格 0:已取完
+  */
+static uint8_t App_NextBackfill(BatchSample_t *sample)
+{
+    HistoryRecord_t rec;
+    
+    while (backfill_age >= backfill_stop)
+    {
+        uint32_t start = History_GetSlotStart(backfill_tier, (uint16_t)backfill_age);
+        uint8_t valid = History_Get(backfill_tier, (uint16_t)backfill_age, &rec);
+        
+        backfill_age--;
+        backfill_end = start + History_GetResolution(backfill_tier);
+        if (valid)
+        {
+            /* 历史数据中光照值x10，批量数据中为原值 */
+            sample->ts = backfill_offset + start;
+            sample->value[ALARM_CH_TEMP] = rec.avg.value[ALARM_CH_TEMP];
+            sample->value[ALARM_CH_HUMI] = rec.avg.value[ALARM_CH_HUMI];
+            sample->value[ALARM_CH_LIGHT] = (int16_t)((rec.avg.value[ALARM_CH_LIGHT] + 5) / 10);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+  * @brief  拼接批量上传的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  flags: BATCH_FLAG_*
+  * @param  count: 存放本次编码的采样数，送达后从队列中移除
+  * @param  bytes: 存放压缩后的字节数
+  * @retval 字符串长度
+  */
+int App_FormatBatch(char *json, uint8_t flags, uint16_t *count, int *bytes)
+{
+    *bytes = Batch_Encode(batch_packed, sizeof(batch_packed), flags, count);
+    return App_FormatPacked(json, *count, 0, *bytes);
+}
+
+/**
+  * @brief  拼接补传数据的JSON：队列满时丢弃的时段按历史数据的汇总格补传
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  flags: BATCH_FLAG_*
+  * @param  timestamp: 最近一次记入历史数据的采样时刻(Unix时间，s)
+  * @param  count: 存放本次补传的格数
+  * @param  until: 存放补传到的时刻，送达后交给Batch_CloseGap
+  * @retval 字符串长度，没有可补传的格时为0
+  */
+int App_FormatBackfill(char *json, uint8_t flags, uint32_t timestamp, uint16_t *count, uint32_t *until)
+{
+    uint32_t first, last, now_s = History_GetTime();
+    uint32_t first_s, last_s;
+    uint16_t res = 0, depth = 0;
+    int bytes;
+    
+    *count = 0;
+    if (!Batch_GetGap(&first, &last))
+        return 0;
+    
+    /* 未同步时无法对应到历史数据的格，复位前的时段历史数据中也没有，缺口作废 */
+    backfill_offset = timestamp - now_s;
+    if (timestamp == 0 || (int32_t)(last - backfill_offset) < 0 || History_GetDepth(HISTORY_TIER_QUARTER) == 0)
+    {
+        Batch_CloseGap(last + 1, 0);
+        return 0;
+    }
+    first_s = (int32_t)(first - backfill_offset) > 0 ? first - backfill_offset : 0;
+    last_s = last - backfill_offset;
+    
+    /* 从缺口起点所在的格开始，取仍保存着它的最细分辨率；刻钟格只补到分钟格
+       覆盖的范围之前，超出保存范围的部分从最旧的格补起 */
+    for (backfill_tier = HISTORY_TIER_MINUTE; backfill_tier < HISTORY_TIER_COUNT; backfill_tier++)
+    {
+        res = History_GetResolution(backfill_tier);
+        depth = History_GetDepth(backfill_tier);
+        backfill_age = (int32_t)(now_s / res) - (int32_t)(first_s / res);
+        if (backfill_age < depth)
+            break;
+    }
+    if (backfill_tier == HISTORY_TIER_COUNT)
+    {
+        backfill_tier = HISTORY_TIER_QUARTER;
+        backfill_age = depth - 1;
+    }
+    backfill_stop = (int32_t)(now_s / res) - (int32_t)(last_s / res);
+    if (backfill_tier == HISTORY_TIER_QUARTER)
+    {
+        uint32_t minute_s = History_GetSlotStart(HISTORY_TIER_MINUTE,
+                                                 History_GetDepth(HISTORY_TIER_MINUTE) - 1);
+        int32_t stop = (int32_t)(now_s / res) - (int32_t)((minute_s - 1) / res);
+        
+        if (minute_s > 0 && stop > backfill_stop)
+            backfill_stop = stop;
+    }
+    if (backfill_stop < 0)
+        backfill_stop = 0;
+    backfill_end = first_s;
+    
+    bytes = Batch_EncodeFrom(App_NextBackfill, batch_packed, sizeof(batch_packed), flags, count);
+    *until = backfill_offset + backfill_end;
+    if (*count == 0)
+    {
+        /* 余下的格都是空格，直接跳过 */
+        Batch_CloseGap(backfill_end > first_s ? *until : last + 1, 0);
+        return 0;
+    }
+    return App_FormatPacked(json, *count, res, bytes);
+}
+
+/**
+  * @brief  拼接报警事件的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  count: 存放本次携带的事件数，收到应答后出队
+  * @retval 字符串长度
+  */
+int App_FormatEvents(char *json, uint8_t *count)
+{
+    int n = App_Append(json, APP_PAYLOAD_SIZE, 0, "{\"events\": [");
+    uint8_t i;
+    
+    for (i = 0; i < Event_GetCount() && i < EVENT_PER_UPLOAD; i++)
+    {
+        const EventRecord_t *e = Event_Get(i);
+        n = App_Append(json, APP_PAYLOAD_SIZE, n,
+                       "%s{\"id\": %u, \"ts\": %lu, \"ch\": %u, \"dir\": %u, \"on\": %u, \"value\": %d}",
+                       i ? ", " : "", e->id, (unsigned long)e->ts, e->bit / 2, e->bit % 2,
+                       e->onset, e->value);
+    }
+    *count = i;
+    n = App_Append(json, APP_PAYLOAD_SIZE, n, "], ");
+    
+    return n + App_FormatStatus(json + n, APP_PAYLOAD_SIZE - n);
+}
+
 /**
   * @brief  上传数据到服务器
   * @param  temperature: 温度数据
   * @param  humidity: 湿度数据
   * @param  light: 光照数据
+  * @param  timestamp: 采样时的Unix时间(s)，未同步时为0
   * @retval 无
-  * @note   将传感器数据通过WiFi上传到服务器
+  * @note   将传感器数据通过WiFi上传到服务器。按配置的上传间隔上传，
+  *          有报警事件时立即只上传事件；上传后距下一次足够久时给模块断电。
+  *          批量上传模式下一次放不下的采样紧接着在下一个采样周期上传
   */
-void App_UploadData(float temperature, float humidity, uint16_t light)
+void App_UploadData(float temperature, float humidity, uint16_t light, uint32_t timestamp)
 {
-    uint32_t current_time = 0; /* 此处应使用系统滴答计时器 */
+    uint32_t current_time = Tick_GetMs();
     uint32_t code;
     char statusStr[OLED_LINE_WIDTH + 1];
+    uint8_t urgent = Event_GetCount() > 0;
+    uint8_t due = urgent || batch_upload_pending || (int32_t)(current_time - next_upload_ms) >= 0;
     
-    /* 检查是否需要上传数据 */
-    if (network_error_count == 0 || 
-        (current_time - last_successful_time > NETWORK_RETRY_INTERVAL))
+    /* 模块刚上电、离预计入网还早时等待会推迟后面的采样，本周期先跳过，
+       计划时刻不推进，入网后立即补传 */
+    if (due && !ESP8266_IsWakeDue())
     {
-        /* 拼接JSON格式的传感器数据 */
-        char json[250];
-        sprintf(json, "{\"temperature\": %.1f, \"humidity\": %.1f, \"light\": %d}",
-                temperature, humidity, light);
-
-        /* 发送HTTP POST请求到服务器 */
-        if (ESP8266_Send_http_post(POST_PATH, SERVER_HOST, json))
+        sprintf(statusStr, "net starting   ");
+    }
+    /* 断路期间等待退避到期，报警状态变化时可提前试探一次 */
+    else if (due && Retry_CanAttempt(current_time, urgent))
+    {
+        /* 拼接JSON格式的传感器数据，缓冲区静态分配，不占用1KB的栈 */
+        static char json[APP_PAYLOAD_SIZE];
+        const AggregateWindow_t *window = NULL;
+        uint8_t batch_flags = Settings_Get()->batch_format == SETTINGS_BATCH_BITPACK ? BATCH_FLAG_BITPACK : 0;
+        uint16_t batched = 0, backfilled = 0;
+        uint32_t backfill_until = 0;
+        int packed = 0;
+        uint8_t events = 0;
+        
+        if (urgent)
+        {
+            /* 报警事件优先，本次只发送事件；常规上传的计划时刻不推进，
+               到期的常规上传紧接着在下一个采样周期进行 */
+            App_FormatEvents(json, &events);
+        }
+        else
         {
-            /* 处理HTTP响应 */
-            if (ESP8266_Receive_http_response(&code))
+            /* 计划时刻按固定间隔推进，事件触发的提前上传不打乱节拍；汇总模式下
+               按窗口长度上传 */
+            while ((int32_t)(current_time - next_upload_ms) >= 0)
+                next_upload_ms += Settings_Get()->summary_window_ms ? Settings_Get()->summary_window_ms
+                                                                     : Settings_Get()->upload_interval_ms;
+            
+            /* 汇总模式下结束当前窗口并上传统计量，批量模式下压缩上传队列中的采样 */
+            if (Settings_Get()->summary_window_ms)
+                window = Aggregate_Close(current_time);
+            if (window != NULL)
             {
-                sprintf(statusStr, "send:%4d       ", code);
-                last_successful_time = current_time;
-                network_error_count = 0;
+                App_FormatSummary(json, window);
+            }
+            else if (Settings_Get()->batch_format != SETTINGS_BATCH_OFF && Batch_GetCount() > 0)
+            {
+                /* 队列满时丢弃的时段按历史数据补传；队列已满时先上传队列，补传期间
+                   不再丢弃采样，缺口不会延伸到补传中的格 */
+                if (Batch_GetCount() >= BATCH_QUEUE_COUNT ||
+                    !App_FormatBackfill(json, batch_flags, timestamp, &backfilled, &backfill_until))
+                    App_FormatBatch(json, batch_flags, &batched, &packed);
             }
             else
             {
-                network_error_count++;
-                sprintf(statusStr, "err %d/%d       ", network_error_count, MAX_ERROR_COUNT);
+                App_FormatPayload(json, temperature, humidity, light, timestamp);
+            }
+            batch_upload_pending = 0;
+        }
+
+        /* 模块断电或仍在入网时先等它重建透传连接，失败时按发送失败处理 */
+        int ready = ESP8266_PowerOnWait();
+        uint8_t opened = 0;
+
+        /* 发送HTTP POST请求到服务器，发送到收到应答计入HTTP分区耗时 */
+        uint32_t send_ms = Tick_GetMs();
+        PROF_BEGIN(PROF_ZONE_HTTP);
+        if (ready && ESP8266_Send_http_post(Settings_Get()->post_path,
+                                         Settings_Get()->server_host, json))
+        {
+            /* 处理HTTP响应，应答体交给配置解析器 */
+            Remote_Begin();
+            int received = ESP8266_Receive_http_response(&code, Remote_Feed);
+            PROF_END(PROF_ZONE_HTTP);
+            
+            if (received)
+            {
+                sprintf(statusStr, "send:%4d       ", code);
                 
-                if (network_error_count >= MAX_ERROR_COUNT)
+                /* 应答的Date头校准RTC，往返耗时的一半作为传输延迟 */
+                TimeSync_OnServerTime(ESP8266_GetHttpDate(), Tick_ElapsedMs(send_ms));
+                
+                if (code >= 200 && code < 300)
+                {
+                    /* 事件已送达，记下从采样到收到应答的延迟，随后续上传回报；
+                       被拒收时事件和已回报的延迟都留在队列中重发 */
+                    Event_RemoveLatencies(latency_reported);
+                    if (events > 0)
+                    {
+                        Event_OnAcked(events, Tick_GetMs());
+                        snprintf(statusStr, sizeof(statusStr), "alm ack %5lums ",
+                                 (unsigned long)Event_GetStats()->last_ms);
+                    }
+                    
+                    /* 服务器随应答下发的配置，应用后下一次上传回报新的编号 */
+                    switch (Remote_End())
+                    {
+                        case REMOTE_APPLIED:
+                            snprintf(statusStr, sizeof(statusStr), "cfg %-6lu set  ",
+                                     (unsigned long)Settings_Get()->config_id);
+                            App_UpdateBuzzer();
+                            break;
+                        
+                        case REMOTE_REJECTED:
+                        case REMOTE_FAILED:
+                            sprintf(statusStr, "cfg rejected   ");
+                            break;
+                        
+                        default:
+                            break;
+                    }
+                    Retry_OnSuccess();
+                    
+                    /* 汇总已送达；失败或被拒收时保留，并入下一次上传的窗口 */
+                    if (window != NULL)
+                        Aggregate_Clear();
+                    
+                    /* 批量数据已送达，从队列中移除，补传的部分从缺口中去掉；失败或被拒收时
+                       保留，下一次重新编码 */
+                    if (batched > 0)
+                        Batch_Remove(batched, packed);
+                    if (backfilled > 0)
+                        Batch_CloseGap(backfill_until, backfilled);
+                    if (batched > 0 || backfilled > 0)
+                        batch_upload_pending = Batch_GetCount() > 0 || Batch_GetGap(NULL, NULL);
+                }
+                else if (code >= 500 || code == 429)
                 {
-                    sprintf(statusStr, "restart wifi...");
-                    OLED_ShowString(4, 1, statusStr);
-                    ESP8266_Restart();
-                    network_error_count = 0;
-                    Delay_ms(3000);
-                    return;
+                    /* 服务器故障或限流，与发送失败一样计入退避；其他应答说明链路
+                       正常，不影响断路器 */
+                    opened = Retry_OnFailure(Tick_GetMs());
                 }
+                Boot_Mark(BOOT_STAGE_NETWORK);
+            }
+            else
+            {
+                opened = Retry_OnFailure(Tick_GetMs());
+                sprintf(statusStr, "err %d/%d       ", Retry_GetFailures(), RETRY_OPEN_FAILURES);
             }
         }
         else
         {
-            network_error_count++;
-            sprintf(statusStr, "send err %d/%d  ", network_error_count, MAX_ERROR_COUNT);
+            opened = Retry_OnFailure(Tick_GetMs());
+            sprintf(statusStr, "send err %d/%d  ", Retry_GetFailures(), RETRY_OPEN_FAILURES);
         }
+        
+        /* 每次断路时做一次恢复，之后按退避时间试探 */
+        if (opened)
+        {
+            OLED_ShowString(4, 1, "recover wifi...");
+            
+            /* 分级恢复：优先重建TCP连接，必要时才复位模块；复位后重新入网的
+               耗时远超一次上传，单独登记预算 */
+            Watchdog_Begin(WATCHDOG_TASK_RECOVER);
+            ESP8266_RecoverTier_t tier = ESP8266_Recover();
+            Watchdog_Begin(WATCHDOG_TASK_UPLOAD);
+            if (tier != ESP8266_RECOVER_NONE)
+            {
+                const ESP8266_RecoverStats_t *stats = ESP8266_GetRecoverStats(tier);
+                sprintf(statusStr, "fix T%d %5lums ", tier, (unsigned long)stats->last_ms);
+            }
+            else
+            {
+                sprintf(statusStr, "recover failed ");
+            }
+        }
+        
+        Timing_Record(TIMING_TASK_UPLOAD, Tick_ElapsedMs(current_time));
+        
+        /* 距下一次上传足够久时断电，重新入网的耗时远小于这段时间内的射频功耗 */
+        if (MODEM_OFF_ENABLE && Retry_GetState() == RETRY_CLOSED &&
+            Retry_GetFailures() == 0 && !batch_upload_pending && Event_GetCount() == 0 &&
+            (int32_t)(next_upload_ms - Tick_GetMs()) >= MODEM_OFF_MIN_MS)
+        {
+            ESP8266_PowerOff();
+        }
+    }
+    else if (due)
+    {
+        /* 断路中，显示距下一次试探的时间 */
+        sprintf(statusStr, "net open %4lus ",
+                (unsigned long)((Retry_GetWaitMs(current_time) + 999) / 1000));
     }
     else
     {
-        sprintf(statusStr, "wait to retry  ");
+        /* 两次上传之间显示倒计时 */
+        sprintf(statusStr, ESP8266_GetPowerState() == ESP8266_POWER_OFF ? "radio off %4lus" : "next up %4lus  ",
+                (unsigned long)((next_upload_ms - current_time + 999) / 1000));
     }
     
     OLED_ShowString(4, 1, statusStr);
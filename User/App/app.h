@@ -15,8 +15,12 @@
 
 /* 包含头文件 ----------------------------------------------------------------*/
 #include "stm32f10x.h"
+#include "aggregate.h"
 #include "../Config/config.h"
 
+/* 宏定义 ------------------------------------------------------------------*/
+#define APP_PAYLOAD_SIZE    680     /* 上传JSON缓冲区大小，汇总模式约需520字节，批量和事件最多约660字节 */
+
 /* 函数声明 ----------------------------------------------------------------*/
 /**
   * @brief  系统初始化
@@ -55,10 +59,72 @@ void App_HandleSensorError(void);
   * @param  temperature: 温度数据
   * @param  humidity: 湿度数据
   * @param  light: 光照数据
+  * @param  timestamp: 采样时的Unix时间(s)，未同步时为0
   * @retval 无
   * @note   将传感器数据通过WiFi上传到服务器
   */
-void App_UploadData(float temperature, float humidity, uint16_t light);
+void App_UploadData(float temperature, float humidity, uint16_t light, uint32_t timestamp);
+
+/**
+  * @brief  拼接上传的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  temperature: 温度数据
+  * @param  humidity: 湿度数据
+  * @param  light: 光照数据
+  * @param  timestamp: 采样时的Unix时间(s)，未同步时为0
+  * @retval 字符串长度
+  * @note   包含采样时间戳、当前报警位图、采样周期抖动、各任务超时次数和
+  *          低功耗占比，主机基准测试直接调用本函数
+  */
+int App_FormatPayload(char *json, float temperature, float humidity, uint16_t light,
+                      uint32_t timestamp);
+
+/**
+  * @brief  拼接上传的窗口汇总
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  window: 窗口统计量
+  * @retval 字符串长度
+  * @note   ts为窗口第一个采样的时间，window为窗口秒数，n为采样数；各通道给出
+  *          min/max/mean/var/last，其余字段与逐点上传相同
+  */
+int App_FormatSummary(char *json, const AggregateWindow_t *window);
+
+/**
+  * @brief  拼接批量上传的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  flags: BATCH_FLAG_*
+  * @param  count: 存放本次编码的采样数，送达后从队列中移除
+  * @param  bytes: 存放压缩后的字节数
+  * @retval 字符串长度
+  * @note   n为采样数，batch为队列中最旧的采样起压缩、base64编码后的数据，
+  *          最多BATCH_PACKED_SIZE字节；其余字段与逐点上传相同
+  */
+int App_FormatBatch(char *json, uint8_t flags, uint16_t *count, int *bytes);
+
+/**
+  * @brief  拼接补传数据的JSON：队列满时丢弃的时段按历史数据的汇总格补传
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  flags: BATCH_FLAG_*
+  * @param  timestamp: 最近一次记入历史数据的采样时刻(Unix时间，s)
+  * @param  count: 存放本次补传的格数
+  * @param  until: 存放补传到的时刻，送达后交给Batch_CloseGap
+  * @retval 字符串长度，没有可补传的格时为0
+  * @note   从缺口起点取仍保存着它的最细分辨率（1min，超出时15min），每格的
+  *          平均值作为一个采样，时间戳为格起点；res为格宽(s)，batch的格式与
+  *          批量上传相同。余下的格都为空或已超出保存范围时直接从缺口中去掉
+  */
+int App_FormatBackfill(char *json, uint8_t flags, uint32_t timestamp, uint16_t *count, uint32_t *until);
+
+/**
+  * @brief  拼接报警事件的JSON数据
+  * @param  json: 输出缓冲区，至少APP_PAYLOAD_SIZE字节
+  * @param  count: 存放本次携带的事件数，收到应答后出队
+  * @retval 字符串长度
+  * @note   events为最早的至多EVENT_PER_UPLOAD个事件，各含编号id、采样时间ts、
+  *          通道ch、方向dir（0下限，1上限）、on（1产生，0解除）和采样值value，
+  *          单位同报警判定；其余字段与逐点上传相同
+  */
+int App_FormatEvents(char *json, uint8_t *count);
 
 #endif /* __APP_H */ 
 
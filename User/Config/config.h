@@ -6,7 +6,8 @@
   * @date    2024-03-07
   * @brief   系统配置文件
   * @note    本文件包含系统运行所需的配置参数
-  *          包括系统参数、网络参数等
+  *          包括系统参数、网络参数等。采样周期、上传间隔、服务器地址和
+  *          WiFi热点只是默认值，Flash中有有效配置记录时以记录为准
   ******************************************************************************
   */
 
@@ -14,10 +15,70 @@
 #define __CONFIG_H
 
 /* 系统配置参数 ----------------------------------------------------------------*/
-#define MAIN_LOOP_DELAY_MS    1000     /* 主循环间隔（毫秒） */
+#define MAIN_LOOP_PERIOD_MS   1000     /* 采样周期（毫秒），按固定节拍执行，不随处理耗时漂移 */
 #define OLED_LINE_WIDTH        16      /* OLED每行显示字符数 */
 #define MAX_ERROR_COUNT         3      /* 最大错误次数 */
-#define NETWORK_RETRY_INTERVAL 60000   /* 网络重试间隔(ms) */
+#define TRACE_ENABLE            1      /* 采集轨迹经USART3(PB10)输出，0:关闭 */
+#define PROF_ENABLE             1      /* DWT分区耗时统计，0:探针编译为空 */
+#define PROF_DUMP_INTERVAL  60000      /* 耗时统计输出间隔(ms)，经轨迹记录输出 */
+
+/* 定时监测参数 --------------------------------------------------------------*/
+#define TIMING_JITTER_LIMIT_MS     50  /* 采样周期偏差超过此值计为一次超时(ms) */
+#define TIMING_SENSOR_DEADLINE_MS 100  /* 采集、滤波和显示的截止时间(ms) */
+#define TIMING_UPLOAD_DEADLINE_MS 2000 /* 一次上传（含网络恢复）的截止时间(ms) */
+
+/* 低功耗参数 ----------------------------------------------------------------*/
+#define IDLE_STOP_ENABLE        1      /* 采样间隙进入Stop模式，0:只用Sleep */
+#define IDLE_STOP_MIN_MS       20      /* 剩余等待不少于此值才进入Stop(ms) */
+#define IDLE_WAKE_MARGIN_MS     3      /* Stop提前醒来，留给时钟恢复(ms) */
+#define IDLE_RX_QUIET_MS       50      /* ESP8266串口静默多久后才允许Stop和降频(ms) */
+#define CLOCK_SCALING_ENABLE    1      /* 按任务切换72/36/8MHz时钟档位，0:始终72MHz */
+#define CLOCK_RX_WAIT_MS      100      /* 切换档位前等待ESP8266串口静默的上限，超时放弃切换(ms) */
+
+/* 重试退避参数 --------------------------------------------------------------*/
+#define RETRY_OPEN_FAILURES     3      /* 连续失败多少次断路，并做分级网络恢复 */
+#define RETRY_BASE_MS        5000      /* 第一次断路的等待时间(ms)，之后每次试探失败翻倍 */
+#define RETRY_MAX_MS       120000      /* 断路等待时间上限(ms)，实际等待取其1/2~1之间的随机值 */
+
+/* 模块功耗参数 --------------------------------------------------------------*/
+#define UPLOAD_INTERVAL_MS   1000      /* 常规上传间隔(ms)，报警状态变化时立即上传 */
+#define SUMMARY_WINDOW_MS       0      /* 非0时按此窗口上传统计汇总，代替逐点上传(ms) */
+#define BATCH_FORMAT            0      /* 1:按上传间隔批量上传压缩后的全部采样 2:另按位压缩 0:逐点上传 */
+#define MODEM_SLEEP_ENABLE      1      /* 入网后设置AT+SLEEP=2，模块在信标间隙关闭射频 */
+#define MODEM_OFF_ENABLE        1      /* 距下一次上传足够久时经PA4(CH_PD)给模块断电 */
+#define MODEM_OFF_MIN_MS    20000      /* 距下一次上传不少于此值才断电(ms)，重新入网约需3s */
+#define MODEM_WAKE_MARGIN_MS  500      /* 提前唤醒时在入网耗时之外多留的时间(ms) */
+
+/* 看门狗参数 ----------------------------------------------------------------*/
+#define WATCHDOG_ENABLE         1      /* IWDG监督各任务，0:只记录任务、不启动IWDG */
+#define WATCHDOG_TIMEOUT_MS  4000      /* IWDG超时(ms)，按LSI 40kHz计算，实际约2.7~5.3s */
+#define WATCHDOG_STABLE_MS 600000      /* 连续运行多久后清零连续看门狗复位计数(ms) */
+#define WATCHDOG_SUSPEND_RESETS  2     /* 同一任务连续卡死复位几次后，稳定运行前跳过该任务，0:不跳过 */
+
+/* 滤波状态保存参数 ----------------------------------------------------------*/
+#define CHECKPOINT_ENABLE       1      /* 滤波状态定期存入备份寄存器，复位后恢复 */
+#define CHECKPOINT_PERIOD_MS 10000     /* 保存间隔(ms) */
+#define CHECKPOINT_MAX_AGE_S    600    /* 复位时保存的状态超过此时长(s)则不恢复 */
+
+/* 时间同步参数 --------------------------------------------------------------*/
+#define TIMESYNC_ENABLE         1      /* 按HTTP应答的Date头校准RTC，上传中带采样时间戳 */
+#define TIMESYNC_WINDOW_MS  3600000    /* 漂移估计窗口(ms)，窗口内的偏差拟合后一次校正 */
+#define TIMESYNC_STEP_MS     2000      /* 偏差超过此值时立即校正(ms) */
+
+/* 历史数据参数 --------------------------------------------------------------*/
+#define HISTORY_ENABLE          1      /* 在RAM中按1s/1min/15min三种分辨率保存历史数据，批量上传据此补传 */
+#define HISTORY_RAW_COUNT     180      /* 1s原始格数（3分钟），每格6字节 */
+#define HISTORY_MINUTE_COUNT  180      /* 1min汇总格数（3小时），每格18字节 */
+#define HISTORY_QUARTER_COUNT 192      /* 15min汇总格数（2天），每格18字节；三者合计约7.6KB */
+
+/* 批量上传参数 --------------------------------------------------------------*/
+#define BATCH_QUEUE_COUNT      90      /* 待上传采样队列长度，每个12字节；满时丢弃最旧的 */
+#define BATCH_PACKED_SIZE     240      /* 一次上传的压缩数据上限(字节)，base64后320字符 */
+
+/* 报警事件参数 --------------------------------------------------------------*/
+#define EVENT_QUEUE_COUNT       8      /* 待上报的报警事件队列长度，满时丢弃最旧的 */
+#define EVENT_REPORT_COUNT      4      /* 待回报的事件延迟个数 */
+#define EVENT_PER_UPLOAD        4      /* 一次上传最多携带的事件数 */
 
 /* API配置 -------------------------------------------------------------------*/
 #define POST_PATH "/api/data"          /* POST请求路径 */